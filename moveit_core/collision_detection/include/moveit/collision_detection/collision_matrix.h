@@ -195,6 +195,14 @@ public:
   /** @brief Clear the allowed collision matrix */
   void clear();
 
+  /** @brief Get a fingerprint of the entries and default entries of the allowed collision matrix.
+   *  Matrices with equal entries have equal fingerprints. The value is maintained by all modifying functions, so this
+   *  call is O(1). Conditional entries only contribute their type, the decision callbacks are not fingerprinted. */
+  uint64_t getFingerprint() const
+  {
+    return fingerprint_;
+  }
+
   /** @brief Get the size of the allowed collision matrix (number of specified entries) */
   std::size_t getSize() const
   {
@@ -250,10 +258,19 @@ private:
   bool getDefaultEntry(const std::string& name1, const std::string& name2,
                        AllowedCollision::Type& allowed_collision) const;
 
+  /** @brief Set the directed entry from \e name1 to \e name2 and update the fingerprint */
+  void setEntryType(const std::string& name1, const std::string& name2, AllowedCollision::Type type);
+
+  /** @brief Set the default entry for \e name and update the fingerprint */
+  void setDefaultEntryType(const std::string& name, AllowedCollision::Type type);
+
   std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
   std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
 
   std::map<std::string, AllowedCollision::Type> default_entries_;
   std::map<std::string, DecideContactFn> default_allowed_contacts_;
+
+  /** XOR of the fingerprints of all entries and default entries */
+  uint64_t fingerprint_ = 0;
 };
 }  // namespace collision_detection
@@ -0,0 +1,84 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <Eigen/Geometry>
+#include <geometric_shapes/shapes.h>
+
+namespace collision_detection
+{
+/** \brief Mix the bits of a 64 bit value (splitmix64 finalizer) */
+inline uint64_t mixFingerprint(uint64_t value)
+{
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+/** \brief Fold \e value into the fingerprint \e seed. The result depends on the order of the combined values. */
+inline uint64_t combineFingerprint(uint64_t seed, uint64_t value)
+{
+  return mixFingerprint(seed + 0x9e3779b97f4a7c15ULL + mixFingerprint(value));
+}
+
+/** \brief Fold the bit pattern of \e value into the fingerprint \e seed */
+inline uint64_t combineFingerprint(uint64_t seed, double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return combineFingerprint(seed, bits);
+}
+
+/** \brief Fold the characters of \e value into the fingerprint \e seed */
+uint64_t combineFingerprint(uint64_t seed, const std::string& value);
+
+/** \brief Fold the translation and rotation of \e value into the fingerprint \e seed */
+uint64_t combineFingerprint(uint64_t seed, const Eigen::Isometry3d& value);
+
+/** \brief Compute a fingerprint of the geometry of \e shape.
+
+    Primitives and meshes are fingerprinted by content, so equal shapes yield equal fingerprints.
+    Octrees (and shape types without a known layout) are fingerprinted by identity: every instance
+    gets its own value, changes to the octree contents are not reflected.
+    The result is cached per shape instance, so repeated calls for the same shape are cheap. This function is thread
+    safe. */
+uint64_t getShapeFingerprint(const shapes::ShapeConstPtr& shape);
+}  // namespace collision_detection
@@ -114,6 +114,9 @@ public:
     /** \brief Transforms from the world frame to the object subframes.
      */
     moveit::core::FixedTransformsMap global_subframe_poses_;
+
+    /** \brief Fingerprint of the id, pose, shapes and subframes of this object. Maintained by World. */
+    uint64_t fingerprint_ = 0;
   };
 
   /** \brief Get the list of Object ids */
@@ -122,6 +125,16 @@ public:
   /** \brief Get a particular object */
   ObjectConstPtr getObject(const std::string& object_id) const;
 
+  /** \brief Get a fingerprint of the contents of the world: object ids, poses, shapes and subframes.
+   *
+   * Worlds with equal contents have equal fingerprints, independent of the order in which objects were added.
+   * The value is maintained incrementally by all modifying functions, so this call is O(1).
+   * Octree shapes are fingerprinted by instance, not by content (see getShapeFingerprint()). */
+  uint64_t getFingerprint() const
+  {
+    return fingerprint_;
+  }
+
   /** iterator over the objects in the world. */
   using const_iterator = std::map<std::string, ObjectPtr>::const_iterator;
   /** iterator pointing to first change */
@@ -332,9 +345,15 @@ private:
   /** \brief Updates the global shape and subframe poses. */
   void updateGlobalPosesInternal(ObjectPtr& obj, bool update_shape_poses = true, bool update_subframe_poses = true);
 
+  /** \brief Recompute the fingerprint of \e obj after a change and update the world fingerprint accordingly. */
+  void updateFingerprint(Object& obj);
+
   /** The objects maintained in the world */
   std::map<std::string, ObjectPtr> objects_;
 
+  /** XOR of the fingerprints of all objects */
+  uint64_t fingerprint_ = 0;
+
   /** Wrapper for a callback function to call when something changes in the world */
   class Observer
   {
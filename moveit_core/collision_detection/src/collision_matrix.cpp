@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan, E. Gil Jones */
 
 #include <moveit/collision_detection/collision_matrix.h>
+#include <moveit/collision_detection/fingerprint.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <functional>
@@ -49,6 +50,17 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.collision_detection_matrix");
 }
+
+uint64_t entryFingerprint(const std::string& name1, const std::string& name2, AllowedCollision::Type type)
+{
+  return combineFingerprint(combineFingerprint(combineFingerprint(0, name1), name2), static_cast<uint64_t>(type));
+}
+
+uint64_t defaultEntryFingerprint(const std::string& name, AllowedCollision::Type type)
+{
+  // distinct seed, so default entries cannot cancel out regular entries
+  return combineFingerprint(combineFingerprint(1, name), static_cast<uint64_t>(type));
+}
 }  // namespace
 
 AllowedCollisionMatrix::AllowedCollisionMatrix()
@@ -154,7 +166,8 @@ bool AllowedCollisionMatrix::hasEntry(const std::string& name1, const std::strin
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, const bool allowed)
 {
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
-  entries_[name1][name2] = entries_[name2][name1] = v;
+  setEntryType(name1, name2, v);
+  setEntryType(name2, name1, v);
 
   // remove function pointers, if any
   auto it = allowed_contacts_.find(name1);
@@ -175,16 +188,42 @@ void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::strin
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, DecideContactFn& fn)
 {
-  entries_[name1][name2] = entries_[name2][name1] = AllowedCollision::CONDITIONAL;
+  setEntryType(name1, name2, AllowedCollision::CONDITIONAL);
+  setEntryType(name2, name1, AllowedCollision::CONDITIONAL);
   allowed_contacts_[name1][name2] = allowed_contacts_[name2][name1] = fn;
 }
 
+void AllowedCollisionMatrix::setEntryType(const std::string& name1, const std::string& name2,
+                                          AllowedCollision::Type type)
+{
+  const auto inserted = entries_[name1].emplace(name2, type);
+  if (!inserted.second)
+  {
+    fingerprint_ ^= entryFingerprint(name1, name2, inserted.first->second);
+    inserted.first->second = type;
+  }
+  fingerprint_ ^= entryFingerprint(name1, name2, type);
+}
+
 void AllowedCollisionMatrix::removeEntry(const std::string& name)
 {
-  entries_.erase(name);
+  const auto row = entries_.find(name);
+  if (row != entries_.end())
+  {
+    for (const auto& entry : row->second)
+      fingerprint_ ^= entryFingerprint(name, entry.first, entry.second);
+    entries_.erase(row);
+  }
   allowed_contacts_.erase(name);
   for (auto& entry : entries_)
-    entry.second.erase(name);
+  {
+    const auto it = entry.second.find(name);
+    if (it != entry.second.end())
+    {
+      fingerprint_ ^= entryFingerprint(entry.first, name, it->second);
+      entry.second.erase(it);
+    }
+  }
   for (auto& allowed_contact : allowed_contacts_)
     allowed_contact.second.erase(name);
 }
@@ -196,14 +235,20 @@ void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::st
   {
     auto it = jt->second.find(name2);
     if (it != jt->second.end())
+    {
+      fingerprint_ ^= entryFingerprint(name1, name2, it->second);
       jt->second.erase(it);
+    }
   }
   jt = entries_.find(name2);
   if (jt != entries_.end())
   {
     auto it = jt->second.find(name1);
     if (it != jt->second.end())
+    {
+      fingerprint_ ^= entryFingerprint(name2, name1, it->second);
       jt->second.erase(it);
+    }
   }
 
   auto it = allowed_contacts_.find(name1);
@@ -258,23 +303,38 @@ void AllowedCollisionMatrix::setEntry(const bool allowed)
   for (auto& entry : entries_)
   {
     for (auto& it2 : entry.second)
+    {
+      fingerprint_ ^= entryFingerprint(entry.first, it2.first, it2.second);
+      fingerprint_ ^= entryFingerprint(entry.first, it2.first, v);
       it2.second = v;
+    }
   }
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const bool allowed)
 {
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
-  default_entries_[name] = v;
+  setDefaultEntryType(name, v);
   default_allowed_contacts_.erase(name);
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, DecideContactFn& fn)
 {
-  default_entries_[name] = AllowedCollision::CONDITIONAL;
+  setDefaultEntryType(name, AllowedCollision::CONDITIONAL);
   default_allowed_contacts_[name] = fn;
 }
 
+void AllowedCollisionMatrix::setDefaultEntryType(const std::string& name, AllowedCollision::Type type)
+{
+  const auto inserted = default_entries_.emplace(name, type);
+  if (!inserted.second)
+  {
+    fingerprint_ ^= defaultEntryFingerprint(name, inserted.first->second);
+    inserted.first->second = type;
+  }
+  fingerprint_ ^= defaultEntryFingerprint(name, type);
+}
+
 bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, AllowedCollision::Type& allowed_collision) const
 {
   auto it = default_entries_.find(name);
@@ -375,6 +435,7 @@ void AllowedCollisionMatrix::clear()
   allowed_contacts_.clear();
   default_entries_.clear();
   default_allowed_contacts_.clear();
+  fingerprint_ = 0;
 }
 
 void AllowedCollisionMatrix::getAllEntryNames(std::vector<std::string>& names) const
@@ -0,0 +1,167 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/collision_detection/fingerprint.h>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace collision_detection
+{
+namespace
+{
+using ShapeFingerprintCache =
+    std::map<std::weak_ptr<const shapes::Shape>, uint64_t, std::owner_less<std::weak_ptr<const shapes::Shape>>>;
+
+// Shapes fingerprinted by identity get a value no other shape instance ever had, so a shape allocated at the
+// address of a destroyed one cannot alias its fingerprint
+uint64_t nextIdentityFingerprint()
+{
+  static std::atomic<uint64_t> counter{ 0 };
+  return mixFingerprint(++counter);
+}
+
+uint64_t computeShapeFingerprint(const shapes::Shape& shape)
+{
+  uint64_t fp = combineFingerprint(0, static_cast<uint64_t>(shape.type));
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      return combineFingerprint(fp, static_cast<const shapes::Sphere&>(shape).radius);
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      return combineFingerprint(combineFingerprint(fp, cylinder.radius), cylinder.length);
+    }
+    case shapes::CONE:
+    {
+      const auto& cone = static_cast<const shapes::Cone&>(shape);
+      return combineFingerprint(combineFingerprint(fp, cone.radius), cone.length);
+    }
+    case shapes::BOX:
+    {
+      const auto& box = static_cast<const shapes::Box&>(shape);
+      for (double size : box.size)
+        fp = combineFingerprint(fp, size);
+      return fp;
+    }
+    case shapes::PLANE:
+    {
+      const auto& plane = static_cast<const shapes::Plane&>(shape);
+      for (double coefficient : { plane.a, plane.b, plane.c, plane.d })
+        fp = combineFingerprint(fp, coefficient);
+      return fp;
+    }
+    case shapes::MESH:
+    {
+      const auto& mesh = static_cast<const shapes::Mesh&>(shape);
+      fp = combineFingerprint(fp, static_cast<uint64_t>(mesh.vertex_count));
+      for (unsigned int i = 0; i < 3 * mesh.vertex_count; ++i)
+        fp = combineFingerprint(fp, mesh.vertices[i]);
+      fp = combineFingerprint(fp, static_cast<uint64_t>(mesh.triangle_count));
+      for (unsigned int i = 0; i < 3 * mesh.triangle_count; ++i)
+        fp = combineFingerprint(fp, static_cast<uint64_t>(mesh.triangles[i]));
+      return fp;
+    }
+    default:
+      return combineFingerprint(fp, nextIdentityFingerprint());
+  }
+}
+}  // namespace
+
+uint64_t combineFingerprint(uint64_t seed, const std::string& value)
+{
+  uint64_t fp = combineFingerprint(seed, static_cast<uint64_t>(value.size()));
+  std::size_t i = 0;
+  for (; i + sizeof(uint64_t) <= value.size(); i += sizeof(uint64_t))
+  {
+    uint64_t chunk;
+    std::memcpy(&chunk, value.data() + i, sizeof(chunk));
+    fp = combineFingerprint(fp, chunk);
+  }
+  if (i < value.size())
+  {
+    uint64_t chunk = 0;
+    std::memcpy(&chunk, value.data() + i, value.size() - i);
+    fp = combineFingerprint(fp, chunk);
+  }
+  return fp;
+}
+
+uint64_t combineFingerprint(uint64_t seed, const Eigen::Isometry3d& value)
+{
+  const Eigen::Matrix4d& matrix = value.matrix();
+  // the last row of an isometry is constant
+  for (Eigen::Index col = 0; col < 4; ++col)
+  {
+    for (Eigen::Index row = 0; row < 3; ++row)
+      seed = combineFingerprint(seed, matrix(row, col));
+  }
+  return seed;
+}
+
+uint64_t getShapeFingerprint(const shapes::ShapeConstPtr& shape)
+{
+  if (!shape)
+    return 0;
+
+  static std::mutex lock;
+  static ShapeFingerprintCache cache;
+  static std::size_t prune_size = 64;
+
+  {
+    std::scoped_lock slock(lock);
+    const auto it = cache.find(shape);
+    if (it != cache.end())
+      return it->second;
+  }
+
+  // hash outside of the lock, large meshes take a while
+  const uint64_t fp = computeShapeFingerprint(*shape);
+
+  std::scoped_lock slock(lock);
+  const auto inserted = cache.emplace(shape, fp);
+  if (cache.size() > prune_size)
+  {
+    // drop entries of destroyed shapes; growing the threshold keeps this amortized constant per insertion
+    for (auto it = cache.begin(); it != cache.end();)
+      it = it->first.expired() ? cache.erase(it) : std::next(it);
+    prune_size = std::max<std::size_t>(64, 2 * cache.size());
+  }
+  return inserted.first->second;
+}
+}  // namespace collision_detection
@@ -35,6 +35,7 @@
 /* Author: Acorn Pooley, Ioan Sucan */
 
 #include <moveit/collision_detection/world.h>
+#include <moveit/collision_detection/fingerprint.h>
 #include <geometric_shapes/check_isometry.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
@@ -57,6 +58,7 @@ World::World()
 World::World(const World& other)
 {
   objects_ = other.objects_;
+  fingerprint_ = other.fingerprint_;
 }
 
 World::~World()
@@ -103,6 +105,7 @@ void World::addToObject(const std::string& object_id, const Eigen::Isometry3d& p
   for (std::size_t i = 0; i < shapes.size(); ++i)
     addToObjectInternal(obj, shapes[i], shape_poses[i]);
 
+  updateFingerprint(*obj);
   notify(obj, Action(action));
 }
 
@@ -251,6 +254,7 @@ bool World::moveShapeInObject(const std::string& object_id, const shapes::ShapeC
         it->second->shape_poses_[i] = shape_pose;
         it->second->global_shape_poses_[i] = it->second->pose_ * shape_pose;
 
+        updateFingerprint(*it->second);
         notify(it->second, MOVE_SHAPE);
         return true;
       }
@@ -289,6 +293,7 @@ bool World::setObjectPose(const std::string& object_id, const Eigen::Isometry3d&
 
   obj->pose_ = pose;
   updateGlobalPosesInternal(obj);
+  updateFingerprint(*obj);
   notify(obj, Action(action));
   return true;
 }
@@ -310,11 +315,13 @@ bool World::removeShapeFromObject(const std::string& object_id, const shapes::Sh
 
         if (it->second->shapes_.empty())
         {
+          fingerprint_ ^= it->second->fingerprint_;
           notify(it->second, DESTROY);
           objects_.erase(it);
         }
         else
         {
+          updateFingerprint(*it->second);
           notify(it->second, REMOVE_SHAPE);
         }
         return true;
@@ -329,6 +336,7 @@ bool World::removeObject(const std::string& object_id)
   const auto it = objects_.find(object_id);
   if (it != objects_.end())
   {
+    fingerprint_ ^= it->second->fingerprint_;
     notify(it->second, DESTROY);
     objects_.erase(it);
     return true;
@@ -340,6 +348,7 @@ void World::clearObjects()
 {
   notifyAll(DESTROY);
   objects_.clear();
+  fingerprint_ = 0;
 }
 
 bool World::setSubframesOfObject(const std::string& object_id, const moveit::core::FixedTransformsMap& subframe_poses)
@@ -353,9 +362,11 @@ bool World::setSubframesOfObject(const std::string& object_id, const moveit::cor
   {
     ASSERT_ISOMETRY(t.second)  // unsanitized input, could contain a non-isometry
   }
+  ensureUnique(obj_pair->second);
   obj_pair->second->subframe_poses_ = subframe_poses;
   obj_pair->second->global_subframe_poses_ = subframe_poses;
   updateGlobalPosesInternal(obj_pair->second, false, true);
+  updateFingerprint(*obj_pair->second);
   return true;
 }
 
@@ -380,6 +391,18 @@ void World::updateGlobalPosesInternal(ObjectPtr& obj, bool update_shape_poses, b
   }
 }
 
+void World::updateFingerprint(Object& obj)
+{
+  uint64_t fp = combineFingerprint(combineFingerprint(0, obj.id_), obj.pose_);
+  for (std::size_t i = 0; i < obj.shapes_.size(); ++i)
+    fp = combineFingerprint(combineFingerprint(fp, getShapeFingerprint(obj.shapes_[i])), obj.shape_poses_[i]);
+  for (const auto& subframe : obj.subframe_poses_)
+    fp = combineFingerprint(combineFingerprint(fp, subframe.first), subframe.second);
+
+  fingerprint_ ^= obj.fingerprint_ ^ fp;
+  obj.fingerprint_ = fp;
+}
+
 World::ObserverHandle World::addObserver(const ObserverCallbackFn& callback)
 {
   const auto o = new Observer(callback);
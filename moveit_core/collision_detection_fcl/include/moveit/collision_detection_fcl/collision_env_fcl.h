@@ -46,6 +46,7 @@
 #endif
 
 #include <memory>
+#include <unordered_set>
 
 namespace collision_detection
 {
@@ -145,15 +146,49 @@ protected:
   /** \brief Vector of shared pointers to the FCL collision objects which make up the robot */
   std::vector<FCLCollisionObjectConstPtr> robot_fcl_objs_;
 
-  /// FCL collision manager which handles the collision checking process
+  /// FCL collision manager for the world objects in fcl_objs_
   std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
 
+  /// FCL objects for the world objects that were added or changed since shared_world_ was built
   std::map<std::string, FCLObject> fcl_objs_;
 
 private:
+  /** \brief A world object in a SharedWorld. The World::Object is kept alive, so it is never modified in place. */
+  struct SharedWorldObject
+  {
+    World::ObjectConstPtr object;
+    FCLObject fcl_object;
+  };
+
+  /** \brief FCL objects and their collision manager for a set of world objects. It is never modified once it is built,
+   *  so that copies of this environment can share it instead of copying the FCL objects and rebuilding the manager. */
+  struct SharedWorld
+  {
+    std::map<std::string, SharedWorldObject> objects;
+    std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager;
+  };
+
   /** \brief Callback function executed for each change to the world environment */
   void notifyObjectChange(const ObjectConstPtr& obj, World::Action action);
 
+  /** \brief Hide the object \e id of shared_world_ (if any) from collision queries, because it changed */
+  void hideSharedWorldObject(const std::string& id);
+
+  /** \brief Build a new shared_world_ once fcl_objs_ and the hidden objects grew too large compared to it */
+  void shareWorldObjectsIfNeeded();
+
+  /** \brief Check \e obj for collision with all world objects */
+  void collideWorld(fcl::CollisionObjectd* obj, CollisionData& cd) const;
+
+  /** \brief Compute the distance of \e obj to all world objects */
+  void distanceWorld(fcl::CollisionObjectd* obj, DistanceData& drd) const;
+
+  /// World objects shared with the environments this one was copied from, or copied to
+  std::shared_ptr<const SharedWorld> shared_world_;
+
+  /// Objects of shared_world_ that were changed or removed since, and which collision queries ignore
+  std::unordered_set<const World::Object*> hidden_shared_objects_;
+
   World::ObserverHandle observer_handle_;
 };
 }  // namespace collision_detection
@@ -79,6 +79,46 @@ void checkFCLCapabilities(const DistanceRequest& req)
   static_cast<void>(req);  // silent -Wunused-parameter
 #endif
 }
+
+// A new shared world is built once the changed and removed objects outnumber this plus a fraction of the shared
+// objects. This bounds the cost of copying an environment, and amortizes the cost of rebuilding over the changes.
+constexpr std::size_t MIN_CHANGED_OBJECTS_TO_SHARE = 16;
+constexpr std::size_t SHARED_OBJECTS_PER_CHANGED_OBJECT = 4;
+
+bool isHiddenObject(fcl::CollisionObjectd* o, const std::unordered_set<const World::Object*>& hidden_objects)
+{
+  const auto* data = static_cast<const CollisionGeometryData*>(o->collisionGeometry()->getUserData());
+  return data->type == BodyTypes::WORLD_OBJECT && hidden_objects.find(data->ptr.obj) != hidden_objects.end();
+}
+
+// Collision and distance data for queries against a shared world, with some of its objects hidden
+struct SharedWorldCollisionData
+{
+  CollisionData* cd;
+  const std::unordered_set<const World::Object*>* hidden_objects;
+};
+
+struct SharedWorldDistanceData
+{
+  DistanceData* drd;
+  const std::unordered_set<const World::Object*>* hidden_objects;
+};
+
+bool sharedWorldCollisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data)
+{
+  auto* shared_data = reinterpret_cast<SharedWorldCollisionData*>(data);
+  if (isHiddenObject(o1, *shared_data->hidden_objects) || isHiddenObject(o2, *shared_data->hidden_objects))
+    return shared_data->cd->done_;
+  return collisionCallback(o1, o2, shared_data->cd);
+}
+
+bool sharedWorldDistanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& min_dist)
+{
+  auto* shared_data = reinterpret_cast<SharedWorldDistanceData*>(data);
+  if (isHiddenObject(o1, *shared_data->hidden_objects) || isHiddenObject(o2, *shared_data->hidden_objects))
+    return shared_data->drd->done;
+  return distanceCallback(o1, o2, shared_data->drd, min_dist);
+}
 }  // namespace
 
 CollisionEnvFCL::CollisionEnvFCL(const moveit::core::RobotModelConstPtr& model, double padding, double scale)
@@ -168,6 +208,10 @@ CollisionEnvFCL::CollisionEnvFCL(const CollisionEnvFCL& other, const WorldPtr& w
   robot_geoms_ = other.robot_geoms_;
   robot_fcl_objs_ = other.robot_fcl_objs_;
 
+  // the shared world objects are reused as they are, only the objects that changed since need to be registered again
+  shared_world_ = other.shared_world_;
+  hidden_shared_objects_ = other.hidden_shared_objects_;
+
   manager_ = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
 
   fcl_objs_ = other.fcl_objs_;
@@ -335,7 +379,7 @@ void CollisionEnvFCL::checkRobotCollisionHelper(const CollisionRequest& req, Col
   CollisionData cd(&req, &res, acm);
   cd.enableGroup(getRobotModel());
   for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
+    collideWorld(fcl_obj.collision_objects_[i].get(), cd);
 
   if (req.distance)
   {
@@ -376,7 +420,41 @@ void CollisionEnvFCL::distanceRobot(const DistanceRequest& req, DistanceResult&
 
   DistanceData drd(&req, &res);
   for (std::size_t i = 0; !drd.done && i < fcl_obj.collision_objects_.size(); ++i)
-    manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
+    distanceWorld(fcl_obj.collision_objects_[i].get(), drd);
+}
+
+void CollisionEnvFCL::collideWorld(fcl::CollisionObjectd* obj, CollisionData& cd) const
+{
+  manager_->collide(obj, &cd, &collisionCallback);
+  if (!shared_world_ || cd.done_)
+    return;
+
+  if (hidden_shared_objects_.empty())
+  {
+    shared_world_->manager->collide(obj, &cd, &collisionCallback);
+  }
+  else
+  {
+    SharedWorldCollisionData shared_data{ &cd, &hidden_shared_objects_ };
+    shared_world_->manager->collide(obj, &shared_data, &sharedWorldCollisionCallback);
+  }
+}
+
+void CollisionEnvFCL::distanceWorld(fcl::CollisionObjectd* obj, DistanceData& drd) const
+{
+  manager_->distance(obj, &drd, &distanceCallback);
+  if (!shared_world_ || drd.done)
+    return;
+
+  if (hidden_shared_objects_.empty())
+  {
+    shared_world_->manager->distance(obj, &drd, &distanceCallback);
+  }
+  else
+  {
+    SharedWorldDistanceData shared_data{ &drd, &hidden_shared_objects_ };
+    shared_world_->manager->distance(obj, &shared_data, &sharedWorldDistanceCallback);
+  }
 }
 
 void CollisionEnvFCL::updateFCLObject(const std::string& id)
@@ -388,6 +466,10 @@ void CollisionEnvFCL::updateFCLObject(const std::string& id)
     jt->second.unregisterFrom(manager_.get());
     jt->second.clear();
   }
+  else
+  {
+    hideSharedWorldObject(id);
+  }
 
   // check to see if we have this object
   auto it = getWorld()->find(id);
@@ -412,6 +494,56 @@ void CollisionEnvFCL::updateFCLObject(const std::string& id)
   }
 
   // manager_->update();
+  shareWorldObjectsIfNeeded();
+}
+
+void CollisionEnvFCL::hideSharedWorldObject(const std::string& id)
+{
+  if (!shared_world_)
+    return;
+
+  auto it = shared_world_->objects.find(id);
+  if (it != shared_world_->objects.end())
+    hidden_shared_objects_.insert(it->second.object.get());
+}
+
+void CollisionEnvFCL::shareWorldObjectsIfNeeded()
+{
+  const std::size_t num_shared = shared_world_ ? shared_world_->objects.size() : 0;
+  if (fcl_objs_.size() + hidden_shared_objects_.size() <=
+      MIN_CHANGED_OBJECTS_TO_SHARE + num_shared / SHARED_OBJECTS_PER_CHANGED_OBJECT)
+    return;
+
+  auto shared_world = std::make_shared<SharedWorld>();
+  if (shared_world_)
+  {
+    for (const auto& [id, shared_object] : shared_world_->objects)
+    {
+      if (hidden_shared_objects_.find(shared_object.object.get()) == hidden_shared_objects_.end())
+        shared_world->objects.emplace(id, shared_object);
+    }
+  }
+  for (auto& [id, fcl_obj] : fcl_objs_)
+  {
+    World::ObjectConstPtr object = getWorld()->getObject(id);
+    if (object)
+      shared_world->objects[id] = SharedWorldObject{ object, std::move(fcl_obj) };
+  }
+
+  std::vector<fcl::CollisionObjectd*> collision_objects;
+  for (const auto& [id, shared_object] : shared_world->objects)
+  {
+    for (const FCLCollisionObjectPtr& collision_object : shared_object.fcl_object.collision_objects_)
+      collision_objects.push_back(collision_object.get());
+  }
+  shared_world->manager = std::make_unique<fcl::DynamicAABBTreeCollisionManagerd>();
+  if (!collision_objects.empty())
+    shared_world->manager->registerObjects(collision_objects);
+
+  manager_->clear();
+  fcl_objs_.clear();
+  hidden_shared_objects_.clear();
+  shared_world_ = std::move(shared_world);
 }
 
 void CollisionEnvFCL::setWorld(const WorldPtr& world)
@@ -425,6 +557,8 @@ void CollisionEnvFCL::setWorld(const WorldPtr& world)
   // clear out objects from old world
   manager_->clear();
   fcl_objs_.clear();
+  shared_world_.reset();
+  hidden_shared_objects_.clear();
   cleanCollisionGeometryCache();
 
   CollisionEnv::setWorld(world);
@@ -448,6 +582,8 @@ void CollisionEnvFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Actio
       it->second.clear();
       fcl_objs_.erase(it);
     }
+    hideSharedWorldObject(obj->id_);
+    shareWorldObjectsIfNeeded();
     cleanCollisionGeometryCache();
   }
   else
@@ -195,6 +195,66 @@ TEST_F(CollisionDetectionEnvTest, RobotWorldCollision_2)
   res.clear();
 }
 
+/** \brief Copies of an environment share their world objects, and changes to a copy must not affect the original. */
+TEST_F(CollisionDetectionEnvTest, CopiedWorldCollision)
+{
+  collision_detection::CollisionRequest req;
+  collision_detection::CollisionResult res;
+
+  // enough objects for them to be shared between copies
+  const shapes::ShapeConstPtr shape_ptr = std::make_shared<const shapes::Box>(.1, .1, .1);
+  for (std::size_t i = 0; i < 40; ++i)
+  {
+    Eigen::Isometry3d pos = Eigen::Isometry3d::Identity();
+    pos.translation().x() = 2.0 + 0.2 * static_cast<double>(i);
+    c_env_->getWorld()->addToObject("box_" + std::to_string(i), pos, shape_ptr, Eigen::Isometry3d::Identity());
+  }
+  Eigen::Isometry3d colliding_pos = Eigen::Isometry3d::Identity();
+  colliding_pos.translation().z() = 0.3;
+  c_env_->getWorld()->addToObject("colliding_box", colliding_pos, shape_ptr, Eigen::Isometry3d::Identity());
+
+  auto world_copy = std::make_shared<collision_detection::World>(*c_env_->getWorld());
+  collision_detection::CollisionEnvFCL c_env_copy(dynamic_cast<const collision_detection::CollisionEnvFCL&>(*c_env_),
+                                                  world_copy);
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+
+  // removing an object from the copy does not remove it from the original
+  world_copy->removeObject("colliding_box");
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+
+  // moving an object in the copy does not move it in the original
+  c_env_->getWorld()->removeObject("colliding_box");
+  world_copy->setObjectPose("box_0", colliding_pos);
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+  c_env_->checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+
+  // changing many objects of the copy rebuilds its shared objects, with the same result
+  for (std::size_t i = 1; i < 40; ++i)
+  {
+    Eigen::Isometry3d pos = Eigen::Isometry3d::Identity();
+    pos.translation().y() = 2.0 + 0.2 * static_cast<double>(i);
+    world_copy->setObjectPose("box_" + std::to_string(i), pos);
+  }
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_TRUE(res.collision);
+  res.clear();
+  world_copy->removeObject("box_0");
+  c_env_copy.checkRobotCollision(req, res, *robot_state_, *acm_);
+  ASSERT_FALSE(res.collision);
+  res.clear();
+}
+
 /** \brief Tests the padding through expanding the link geometry in such a way that a collision occurs. */
 TEST_F(CollisionDetectionEnvTest, PaddingTest)
 {
@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler_allocator.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/macros/class_forward.h>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/clock.hpp>
@@ -75,6 +76,18 @@ public:
   {
     sampler_alloc_.push_back(sa);
   }
+  /**
+   * \brief Registers a precomputed reachability map.
+   *
+   * Every \ref IKConstraintSampler returned by \ref selectSampler
+   * whose group and constrained link match a registered map will use
+   * that map for sampling.  A later map for the same group and link
+   * replaces an earlier one.
+   *
+   * @param map The reachability map
+   */
+  void registerReachabilityMap(const ReachabilityMapConstPtr& map);
+
   /**
    * \brief Selects among the potential sampler allocators.
    *
@@ -142,7 +155,11 @@ public:
                                                    const moveit_msgs::msg::Constraints& constr);
 
 private:
+  /// \brief Hands the registered reachability maps to the IK samplers contained in \e sampler
+  void attachReachabilityMaps(const ConstraintSamplerPtr& sampler) const;
+
   std::vector<ConstraintSamplerAllocatorPtr>
       sampler_alloc_; /**< \brief Holds the constraint sampler allocators, which will be tested in order  */
+  std::vector<ReachabilityMapConstPtr> reachability_maps_; /**< \brief Registered reachability maps */
 };
 }  // namespace constraint_samplers
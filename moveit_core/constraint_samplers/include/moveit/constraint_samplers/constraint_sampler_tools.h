@@ -55,4 +55,10 @@ double countSamplesPerSecond(const ConstraintSamplerPtr& sampler, const moveit::
 
 double countSamplesPerSecond(const moveit_msgs::msg::Constraints& constr,
                              const planning_scene::PlanningSceneConstPtr& scene, const std::string& group);
+
+/** \brief Give every IK sampler contained in \e sampler a kinematics solver instance of its own.
+
+    Kinematics solvers keep internal state, so samplers that run on different threads must not share the solver
+    instance of their group. Returns false if a separate instance could not be allocated for one of the samplers. */
+bool allocateKinematicsSolvers(const ConstraintSamplerPtr& sampler);
 }  // namespace constraint_samplers
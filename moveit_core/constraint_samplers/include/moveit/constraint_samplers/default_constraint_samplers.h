@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/constraint_samplers/constraint_sampler.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/macros/class_forward.h>
 #include <random_numbers/random_numbers.h>
 #include <rclcpp/rclcpp.hpp>
@@ -418,6 +419,48 @@ public:
     ik_timeout_ = timeout;
   }
 
+  /**
+   * \brief Sets a precomputed reachability map used to guide sampling
+   *
+   * The map is only used if it was generated for the group of this
+   * sampler and for the constrained link.  Position samples are then
+   * drawn from reachable cells inside the constraint region, and IK is
+   * seeded with the stored solution closest to the sampled pose
+   * instead of a random seed.  Constraints with a target point offset
+   * only use the map for seeding.
+   *
+   * @param map The map to use, or an empty pointer to disable
+   */
+  void setReachabilityMap(const ReachabilityMapConstPtr& map)
+  {
+    reachability_map_ = map;
+    reachable_cells_.clear();
+    reachable_cells_valid_ = false;
+  }
+
+  /**
+   * \brief Gets the reachability map used by this sampler
+   *
+   * @return The map, or an empty pointer if none has been set
+   */
+  const ReachabilityMapConstPtr& getReachabilityMap() const
+  {
+    return reachability_map_;
+  }
+
+  /**
+   * \brief Sets a kinematics solver to use instead of the solver instance of the group
+   *
+   * Kinematics solvers keep internal state, so samplers that are used
+   * concurrently from different threads each need their own instance.
+   * If the sampler is already configured, the solver is loaded right away.
+   *
+   * @param solver The solver to use, or an empty pointer to use the solver of the group
+   *
+   * @return True if the sampler is not configured yet, or if it could be reconfigured with the solver
+   */
+  bool setKinematicsSolver(const kinematics::KinematicsBaseConstPtr& solver);
+
   /**
    * \brief Gets the position constraint associated with this sampler.
    *
@@ -546,6 +589,29 @@ protected:
   bool callIK(const geometry_msgs::msg::Pose& ik_query,
               const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback, double timeout,
               moveit::core::RobotState& state, bool use_as_seed);
+
+  /**
+   * \brief Calls IK on the given pose, using the given group variable values as seed
+   *
+   * @param seed_values The seed, in the order of the group variables
+   */
+  bool callIK(const geometry_msgs::msg::Pose& ik_query,
+              const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback, double timeout,
+              moveit::core::RobotState& state, const std::vector<double>& seed_values);
+
+  /// \brief True if a reachability map matching this sampler's group and link is set
+  bool useReachabilityMap() const;
+
+  /**
+   * \brief Samples a position inside the constraint region from the reachable cells of the reachability map
+   *
+   * @param [out] pos The sampled position, in the model frame
+   * @param [in] ks The reference state used for performing transforms
+   * @param [in] max_attempts The maximum number of cells to try
+   *
+   * @return True if a position was sampled, false if the regular region sampling should be used instead
+   */
+  bool sampleReachablePosition(Eigen::Vector3d& pos, const moveit::core::RobotState& ks, unsigned int max_attempts);
   bool sampleHelper(moveit::core::RobotState& state, const moveit::core::RobotState& reference_state,
                     unsigned int max_attempts);
   bool validate(moveit::core::RobotState& state) const;
@@ -553,6 +619,7 @@ protected:
   random_numbers::RandomNumberGenerator random_number_generator_; /**< \brief Random generator used by the sampler */
   IKSamplingPose sampling_pose_;                                  /**< \brief Holder for the pose used for sampling */
   kinematics::KinematicsBaseConstPtr kb_;                         /**< \brief Holds the kinematics solver */
+  kinematics::KinematicsBaseConstPtr own_kb_; /**< \brief Solver set with setKinematicsSolver(), if any */
   double ik_timeout_;                                             /**< \brief Holds the timeout associated with IK */
   std::string ik_frame_;                                          /**< \brief Holds the base from of the IK solver */
   bool transform_ik_; /**< \brief True if the frame associated with the kinematic model is different than the base frame
@@ -560,5 +627,10 @@ protected:
   bool need_eef_to_ik_tip_transform_; /**< \brief True if the tip frame of the inverse kinematic is different than the
                                         frame of the end effector */
   Eigen::Isometry3d eef_to_ik_tip_transform_; /**< \brief Holds the transformation from end effector to IK tip frame */
+
+  ReachabilityMapConstPtr reachability_map_; /**< \brief Optional map of reachable poses used to guide sampling */
+  std::vector<const ReachabilityMap::Cell*> reachable_cells_; /**< \brief Map cells overlapping the constraint region */
+  Eigen::Isometry3d reachable_cells_transform_; /**< \brief Map to region transform reachable_cells_ was computed for */
+  bool reachable_cells_valid_ = false;          /**< \brief True if reachable_cells_ is up to date */
 };
 }  // namespace constraint_samplers
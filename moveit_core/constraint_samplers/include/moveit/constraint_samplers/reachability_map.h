@@ -0,0 +1,206 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/robot_state/robot_state.h>
+#include <random_numbers/random_numbers.h>
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace constraint_samplers
+{
+MOVEIT_CLASS_FORWARD(ReachabilityMap);  // Defines ReachabilityMapPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A voxelized map of the poses a link of a group can reach,
+ * together with joint solutions that reach them.
+ *
+ * Tip poses are expressed in the frame of the link the group is
+ * attached to (the parent link of the group's common root joint), so
+ * a map stays valid when the robot moves as a whole.  Every occupied
+ * cell stores up to a fixed number of joint configurations of the
+ * group (in group variable order) whose tip position falls into that
+ * cell, together with the tip orientation they produce.
+ *
+ * The map is typically generated offline by sampling random joint
+ * configurations and is then used by the \ref IKConstraintSampler to
+ * restrict position samples to reachable space and to seed IK.
+ */
+class ReachabilityMap
+{
+public:
+  /// \brief A single joint configuration stored in a cell
+  struct Solution
+  {
+    Eigen::Quaterniond orientation; /**< \brief Orientation of the tip link in the map frame */
+    std::vector<double> positions;  /**< \brief Group variable values producing this tip pose */
+  };
+
+  /// \brief The content of a single occupied voxel
+  struct Cell
+  {
+    Eigen::Vector3d center;          /**< \brief Center of the cell in the map frame */
+    std::vector<Solution> solutions; /**< \brief Known solutions reaching into this cell */
+  };
+
+  /**
+   * \brief Constructor
+   *
+   * @param [in] jmg The group the map is generated for
+   * @param [in] tip_link The name of the link whose reachability is recorded
+   * @param [in] resolution Edge length of a cell, in meters
+   * @param [in] max_solutions_per_cell Maximum number of joint solutions stored per cell
+   */
+  ReachabilityMap(const moveit::core::JointModelGroup* jmg, const std::string& tip_link, double resolution,
+                  std::size_t max_solutions_per_cell = 8);
+
+  /**
+   * \brief Create a map by reading it from a stream previously written with \ref writeToStream
+   *
+   * @return The map, or an empty pointer if the stream does not hold a map for a group of \e robot_model
+   */
+  static ReachabilityMapPtr readFromStream(const moveit::core::RobotModelConstPtr& robot_model, std::istream& is);
+
+  /// \brief Convenience wrapper around \ref readFromStream that reads from a file
+  static ReachabilityMapPtr loadFromFile(const moveit::core::RobotModelConstPtr& robot_model,
+                                         const std::string& filename);
+
+  /// \brief Write the map to a stream: a short text header followed by binary cell data
+  bool writeToStream(std::ostream& os) const;
+
+  /// \brief Convenience wrapper around \ref writeToStream that writes to a file
+  bool saveToFile(const std::string& filename) const;
+
+  /**
+   * \brief Fill the map by sampling random configurations of the group.
+   *
+   * Joints outside of the group keep the values from \e reference_state.
+   *
+   * @param [in] reference_state State providing the values of joints not in the group
+   * @param [in] samples The number of random configurations to try
+   * @param [in] rng The random number generator used for sampling
+   * @param [in] validity_callback If set, only configurations accepted by this callback are inserted
+   *
+   * @return The number of configurations inserted into the map
+   */
+  std::size_t generate(const moveit::core::RobotState& reference_state, std::size_t samples,
+                       random_numbers::RandomNumberGenerator& rng,
+                       const moveit::core::GroupStateValidityCallbackFn& validity_callback =
+                           moveit::core::GroupStateValidityCallbackFn());
+
+  /**
+   * \brief Record the tip pose reached by the group configuration of \e state
+   *
+   * @return True if the configuration was stored, false if its cell is already full
+   */
+  bool insert(moveit::core::RobotState& state);
+
+  /// \brief Get the group this map was generated for
+  const moveit::core::JointModelGroup* getJointModelGroup() const
+  {
+    return jmg_;
+  }
+
+  /// \brief Get the link whose reachability is recorded
+  const moveit::core::LinkModel* getTipLink() const
+  {
+    return tip_link_;
+  }
+
+  /// \brief Get the link whose frame the map is expressed in; nullptr means the model frame
+  const moveit::core::LinkModel* getBaseLink() const
+  {
+    return base_link_;
+  }
+
+  double getResolution() const
+  {
+    return resolution_;
+  }
+
+  std::size_t getMaxSolutionsPerCell() const
+  {
+    return max_solutions_per_cell_;
+  }
+
+  /// \brief Get the number of occupied cells
+  std::size_t getCellCount() const
+  {
+    return cells_.size();
+  }
+
+  /// \brief Get all occupied cells
+  std::vector<const Cell*> getCells() const;
+
+  /// \brief Get the transform from the model frame to the map frame for a given state
+  Eigen::Isometry3d getMapFrameTransform(const moveit::core::RobotState& state) const;
+
+  /**
+   * \brief Get the cell containing \e position (expressed in the map frame)
+   *
+   * @return The cell, or nullptr if the position is not known to be reachable
+   */
+  const Cell* getCell(const Eigen::Vector3d& position) const;
+
+  /**
+   * \brief Find the stored solution closest to a desired tip pose.
+   *
+   * Only the cell containing \e position is searched; among its
+   * solutions the one whose tip orientation is closest to \e
+   * orientation is returned.
+   *
+   * @return The solution, or nullptr if the cell is empty
+   */
+  const Solution* getNearestSolution(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) const;
+
+private:
+  using Key = std::int64_t;
+
+  Key getKey(const Eigen::Vector3d& position) const;
+  Eigen::Vector3d getCellCenter(Key key) const;
+
+  const moveit::core::JointModelGroup* jmg_;
+  const moveit::core::LinkModel* tip_link_;
+  const moveit::core::LinkModel* base_link_;
+  double resolution_;
+  std::size_t max_solutions_per_cell_;
+  std::unordered_map<Key, Cell> cells_;
+};
+}  // namespace constraint_samplers
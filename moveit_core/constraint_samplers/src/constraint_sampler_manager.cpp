@@ -52,18 +52,73 @@ rclcpp::Logger getLogger()
 }
 }  // namespace
 
+void ConstraintSamplerManager::registerReachabilityMap(const ReachabilityMapConstPtr& map)
+{
+  if (!map || !map->getTipLink())
+    return;
+  for (ReachabilityMapConstPtr& existing : reachability_maps_)
+  {
+    if (existing->getJointModelGroup()->getName() == map->getJointModelGroup()->getName() &&
+        existing->getTipLink()->getName() == map->getTipLink()->getName())
+    {
+      existing = map;
+      return;
+    }
+  }
+  reachability_maps_.push_back(map);
+}
+
+void ConstraintSamplerManager::attachReachabilityMaps(const ConstraintSamplerPtr& sampler) const
+{
+  if (!sampler || reachability_maps_.empty())
+    return;
+
+  if (const auto union_sampler = std::dynamic_pointer_cast<UnionConstraintSampler>(sampler))
+  {
+    for (const ConstraintSamplerPtr& sub_sampler : union_sampler->getSamplers())
+      attachReachabilityMaps(sub_sampler);
+  }
+  else if (const auto ik_sampler = std::dynamic_pointer_cast<IKConstraintSampler>(sampler))
+  {
+    // maps are matched by name, since they may have been loaded for a different instance of the same robot model
+    for (const ReachabilityMapConstPtr& map : reachability_maps_)
+    {
+      if (map->getJointModelGroup()->getName() == ik_sampler->getGroupName() &&
+          map->getTipLink()->getName() == ik_sampler->getLinkName())
+      {
+        if (map->getJointModelGroup() == ik_sampler->getJointModelGroup())
+        {
+          ik_sampler->setReachabilityMap(map);
+        }
+        else
+        {
+          RCLCPP_WARN(getLogger(), "Reachability map for group '%s' was created for a different robot model instance",
+                      map->getJointModelGroup()->getName().c_str());
+        }
+        break;
+      }
+    }
+  }
+}
+
 ConstraintSamplerPtr ConstraintSamplerManager::selectSampler(const planning_scene::PlanningSceneConstPtr& scene,
                                                              const std::string& group_name,
                                                              const moveit_msgs::msg::Constraints& constr) const
 {
-  for (const ConstraintSamplerAllocatorPtr& sampler : sampler_alloc_)
+  for (const ConstraintSamplerAllocatorPtr& allocator : sampler_alloc_)
   {
-    if (sampler->canService(scene, group_name, constr))
-      return sampler->alloc(scene, group_name, constr);
+    if (allocator->canService(scene, group_name, constr))
+    {
+      ConstraintSamplerPtr sampler = allocator->alloc(scene, group_name, constr);
+      attachReachabilityMaps(sampler);
+      return sampler;
+    }
   }
 
   // if no default sampler was used, try a default one
-  return selectDefaultSampler(scene, group_name, constr);
+  ConstraintSamplerPtr sampler = selectDefaultSampler(scene, group_name, constr);
+  attachReachabilityMaps(sampler);
+  return sampler;
 }
 
 ConstraintSamplerPtr ConstraintSamplerManager::selectDefaultSampler(const planning_scene::PlanningSceneConstPtr& scene,
@@ -36,6 +36,8 @@
 
 #include <moveit/constraint_samplers/constraint_sampler_tools.h>
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
+#include <moveit/constraint_samplers/default_constraint_samplers.h>
+#include <moveit/constraint_samplers/union_constraint_sampler.h>
 #include <rclcpp/clock.hpp>
 #include <rclcpp/duration.hpp>
 #include <rclcpp/logger.hpp>
@@ -133,4 +135,30 @@ void visualizeDistribution(const ConstraintSamplerPtr& sampler, const moveit::co
     markers.markers.push_back(mk);
   }
 }
+
+bool allocateKinematicsSolvers(const ConstraintSamplerPtr& sampler)
+{
+  if (const auto union_sampler = std::dynamic_pointer_cast<UnionConstraintSampler>(sampler))
+  {
+    for (const ConstraintSamplerPtr& s : union_sampler->getSamplers())
+    {
+      if (!allocateKinematicsSolvers(s))
+        return false;
+    }
+    return true;
+  }
+
+  const auto ik_sampler = std::dynamic_pointer_cast<IKConstraintSampler>(sampler);
+  if (!ik_sampler)
+    return true;
+  const moveit::core::JointModelGroup* jmg = ik_sampler->getJointModelGroup();
+  const moveit::core::SolverAllocatorFn& allocator = jmg->getGroupKinematics().first.allocator_;
+  kinematics::KinematicsBaseConstPtr solver = allocator ? allocator(jmg) : kinematics::KinematicsBaseConstPtr();
+  if (!solver || solver == jmg->getSolverInstance())
+  {
+    RCLCPP_DEBUG(getLogger(), "Unable to allocate a separate kinematics solver for group '%s'", jmg->getName().c_str());
+    return false;
+  }
+  return ik_sampler->setKinematicsSolver(solver);
+}
 }  // namespace constraint_samplers
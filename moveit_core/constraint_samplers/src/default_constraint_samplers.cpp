@@ -38,6 +38,7 @@
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <cassert>
+#include <cmath>
 #include <functional>
 #include <moveit/utils/logger.hpp>
 
@@ -248,6 +249,8 @@ void IKConstraintSampler::clear()
   transform_ik_ = false;
   eef_to_ik_tip_transform_ = Eigen::Isometry3d::Identity();
   need_eef_to_ik_tip_transform_ = false;
+  reachable_cells_.clear();
+  reachable_cells_valid_ = false;
 }
 
 bool IKConstraintSampler::configure(const IKSamplingPose& sp)
@@ -281,7 +284,7 @@ bool IKConstraintSampler::configure(const IKSamplingPose& sp)
     frame_depends_.push_back(sampling_pose_.position_constraint_->getReferenceFrame());
   if (sampling_pose_.orientation_constraint_ && sampling_pose_.orientation_constraint_->mobileReferenceFrame())
     frame_depends_.push_back(sampling_pose_.orientation_constraint_->getReferenceFrame());
-  kb_ = jmg_->getSolverInstance();
+  kb_ = own_kb_ ? own_kb_ : jmg_->getSolverInstance();
   if (!kb_)
   {
     RCLCPP_WARN(getLogger(), "No solver instance in setup");
@@ -359,6 +362,16 @@ const std::string& IKConstraintSampler::getLinkName() const
   return sampling_pose_.position_constraint_->getLinkModel()->getName();
 }
 
+bool IKConstraintSampler::setKinematicsSolver(const kinematics::KinematicsBaseConstPtr& solver)
+{
+  own_kb_ = solver;
+  if (!kb_)
+    return true;
+  kb_ = own_kb_ ? own_kb_ : jmg_->getSolverInstance();
+  is_valid_ = loadIKSolver();
+  return is_valid_;
+}
+
 bool IKConstraintSampler::loadIKSolver()
 {
   if (!kb_)
@@ -451,36 +464,39 @@ bool IKConstraintSampler::samplePose(Eigen::Vector3d& pos, Eigen::Quaterniond& q
 
   if (sampling_pose_.position_constraint_)
   {
-    const std::vector<bodies::BodyPtr>& b = sampling_pose_.position_constraint_->getConstraintRegions();
-    if (!b.empty())
+    if (!sampleReachablePosition(pos, ks, max_attempts))
     {
-      bool found = false;
-      std::size_t k = random_number_generator_.uniformInteger(0, b.size() - 1);
-      for (std::size_t i = 0; i < b.size(); ++i)
+      const std::vector<bodies::BodyPtr>& b = sampling_pose_.position_constraint_->getConstraintRegions();
+      if (!b.empty())
       {
-        if (b[(i + k) % b.size()]->samplePointInside(random_number_generator_, max_attempts, pos))
+        bool found = false;
+        std::size_t k = random_number_generator_.uniformInteger(0, b.size() - 1);
+        for (std::size_t i = 0; i < b.size(); ++i)
         {
-          found = true;
-          break;
+          if (b[(i + k) % b.size()]->samplePointInside(random_number_generator_, max_attempts, pos))
+          {
+            found = true;
+            break;
+          }
+        }
+        if (!found)
+        {
+          RCLCPP_ERROR(getLogger(), "Unable to sample a point inside the constraint region");
+          return false;
         }
       }
-      if (!found)
+      else
       {
-        RCLCPP_ERROR(getLogger(), "Unable to sample a point inside the constraint region");
+        RCLCPP_ERROR(getLogger(), "Unable to sample a point inside the constraint region. "
+                                  "Constraint region is empty when it should not be.");
         return false;
       }
-    }
-    else
-    {
-      RCLCPP_ERROR(getLogger(), "Unable to sample a point inside the constraint region. "
-                                "Constraint region is empty when it should not be.");
-      return false;
-    }
 
-    // if this constraint is with respect a mobile frame, we need to convert this rotation to the root frame of the
-    // model
-    if (sampling_pose_.position_constraint_->mobileReferenceFrame())
-      pos = ks.getFrameTransform(sampling_pose_.position_constraint_->getReferenceFrame()) * pos;
+      // if this constraint is with respect a mobile frame, we need to convert this rotation to the root frame of the
+      // model
+      if (sampling_pose_.position_constraint_->mobileReferenceFrame())
+        pos = ks.getFrameTransform(sampling_pose_.position_constraint_->getReferenceFrame()) * pos;
+    }
   }
   else
   {
@@ -557,6 +573,81 @@ bool IKConstraintSampler::samplePose(Eigen::Vector3d& pos, Eigen::Quaterniond& q
   return true;
 }
 
+bool IKConstraintSampler::useReachabilityMap() const
+{
+  return reachability_map_ && reachability_map_->getJointModelGroup() == jmg_ &&
+         reachability_map_->getTipLink()->getName() == getLinkName();
+}
+
+bool IKConstraintSampler::sampleReachablePosition(Eigen::Vector3d& pos, const moveit::core::RobotState& ks,
+                                                  unsigned int max_attempts)
+{
+  if (!useReachabilityMap() || sampling_pose_.position_constraint_->hasLinkOffset())
+    return false;
+
+  // the constraint regions are expressed in the model frame, or in the reference frame if that one is mobile
+  const Eigen::Isometry3d map_to_model = reachability_map_->getMapFrameTransform(ks).inverse();
+  Eigen::Isometry3d map_to_region = map_to_model;
+  if (sampling_pose_.position_constraint_->mobileReferenceFrame())
+    map_to_region = ks.getFrameTransform(sampling_pose_.position_constraint_->getReferenceFrame()).inverse() *
+                    map_to_model;
+
+  const std::vector<bodies::BodyPtr>& b = sampling_pose_.position_constraint_->getConstraintRegions();
+  const double half_cell = 0.5 * reachability_map_->getResolution();
+  if (!reachable_cells_valid_ || !map_to_region.isApprox(reachable_cells_transform_))
+  {
+    // collect the cells that may overlap one of the regions; regions smaller than a cell are sampled directly
+    reachable_cells_.clear();
+    bool regions_large_enough = true;
+    std::vector<bodies::BoundingSphere> spheres(b.size());
+    for (std::size_t i = 0; i < b.size(); ++i)
+    {
+      b[i]->computeBoundingSphere(spheres[i]);
+      regions_large_enough = regions_large_enough && spheres[i].radius >= 2.0 * half_cell;
+    }
+    if (regions_large_enough)
+    {
+      const double cell_radius = std::sqrt(3.0) * half_cell;
+      for (const ReachabilityMap::Cell* cell : reachability_map_->getCells())
+      {
+        const Eigen::Vector3d center = map_to_region * cell->center;
+        for (const bodies::BoundingSphere& sphere : spheres)
+        {
+          if ((center - sphere.center).norm() <= sphere.radius + cell_radius)
+          {
+            reachable_cells_.push_back(cell);
+            break;
+          }
+        }
+      }
+    }
+    reachable_cells_transform_ = map_to_region;
+    reachable_cells_valid_ = true;
+  }
+
+  if (reachable_cells_.empty())
+    return false;
+
+  for (unsigned int a = 0; a < max_attempts; ++a)
+  {
+    const ReachabilityMap::Cell* cell =
+        reachable_cells_[random_number_generator_.uniformInteger(0, reachable_cells_.size() - 1)];
+    const Eigen::Vector3d p(cell->center.x() + random_number_generator_.uniformReal(-half_cell, half_cell),
+                            cell->center.y() + random_number_generator_.uniformReal(-half_cell, half_cell),
+                            cell->center.z() + random_number_generator_.uniformReal(-half_cell, half_cell));
+    const Eigen::Vector3d p_region = map_to_region * p;
+    for (const bodies::BodyPtr& body : b)
+    {
+      if (body->containsPoint(p_region))
+      {
+        pos = map_to_model * p;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 namespace
 {
 void samplingIkCallbackFnAdapter(moveit::core::RobotState* state, const moveit::core::JointModelGroup* jmg,
@@ -603,6 +694,7 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     };
   }
 
+  const bool seed_from_map = useReachabilityMap();
   for (unsigned int a = 0; a < max_attempts; ++a)
   {
     // sample a point in the constraint region
@@ -615,6 +707,10 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
       return false;
     }
 
+    // remember the pose of the constrained link in the planning frame for the map lookup
+    const Eigen::Vector3d map_point = point;
+    const Eigen::Quaterniond map_quat = quat;
+
     // we now have the transform we wish to perform IK for, in the planning frame
     if (transform_ik_)
     {
@@ -645,6 +741,17 @@ bool IKConstraintSampler::sampleHelper(moveit::core::RobotState& state, const mo
     ik_query.orientation.z = quat.z();
     ik_query.orientation.w = quat.w();
 
+    if (seed_from_map)
+    {
+      // seed IK with the known solution that best matches the sampled pose
+      const Eigen::Isometry3d map_transform = reachability_map_->getMapFrameTransform(reference_state);
+      const ReachabilityMap::Solution* solution = reachability_map_->getNearestSolution(
+          map_transform * map_point, Eigen::Quaterniond(map_transform.linear() * map_quat));
+      // if the stored solution does not converge, fall back to the regular seed below
+      if (solution && callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, solution->positions))
+        return true;
+    }
+
     if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, a == 0))
       return true;
   }
@@ -664,8 +771,6 @@ bool IKConstraintSampler::callIK(const geometry_msgs::msg::Pose& ik_query,
                                  const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback,
                                  double timeout, moveit::core::RobotState& state, bool use_as_seed)
 {
-  const std::vector<size_t>& ik_joint_bijection = jmg_->getKinematicsSolverJointBijection();
-  std::vector<double> seed(ik_joint_bijection.size(), 0.0);
   std::vector<double> vals;
 
   if (use_as_seed)
@@ -678,9 +783,20 @@ bool IKConstraintSampler::callIK(const geometry_msgs::msg::Pose& ik_query,
     jmg_->getVariableRandomPositions(random_number_generator_, vals);
   }
 
-  assert(vals.size() == ik_joint_bijection.size());
+  return callIK(ik_query, adapted_ik_validity_callback, timeout, state, vals);
+}
+
+bool IKConstraintSampler::callIK(const geometry_msgs::msg::Pose& ik_query,
+                                 const kinematics::KinematicsBase::IKCallbackFn& adapted_ik_validity_callback,
+                                 double timeout, moveit::core::RobotState& state,
+                                 const std::vector<double>& seed_values)
+{
+  const std::vector<size_t>& ik_joint_bijection = jmg_->getKinematicsSolverJointBijection();
+  std::vector<double> seed(ik_joint_bijection.size(), 0.0);
+
+  assert(seed_values.size() == ik_joint_bijection.size());
   for (std::size_t i = 0; i < ik_joint_bijection.size(); ++i)
-    seed[i] = vals[ik_joint_bijection[i]];
+    seed[i] = seed_values[ik_joint_bijection[i]];
 
   std::vector<double> ik_sol;
   moveit_msgs::msg::MoveItErrorCodes error;
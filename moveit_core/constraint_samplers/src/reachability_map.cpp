@@ -0,0 +1,364 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/constraint_samplers/reachability_map.h>
+#include <moveit/utils/logger.hpp>
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace constraint_samplers
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.reachability_map");
+}
+
+const std::string MAP_FILE_TAG = "moveit_reachability_map";
+const unsigned int MAP_FILE_VERSION = 1;
+
+// each cell index is packed into 21 bits, which covers +-10km at 1cm resolution
+constexpr int KEY_BITS = 21;
+constexpr std::int64_t KEY_OFFSET = std::int64_t(1) << (KEY_BITS - 1);
+constexpr std::int64_t KEY_MASK = (std::int64_t(1) << KEY_BITS) - 1;
+
+template <typename T>
+void writeBinary(std::ostream& os, const T& value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readBinary(std::istream& is, T& value)
+{
+  return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// number of bytes left in a seekable stream, or the maximum value if the stream cannot seek
+std::uint64_t getRemainingBytes(std::istream& is)
+{
+  const std::istream::pos_type current = is.tellg();
+  if (current == std::istream::pos_type(-1) || !is.seekg(0, std::ios::end))
+  {
+    is.clear();
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  const std::istream::pos_type end = is.tellg();
+  is.seekg(current);
+  if (end == std::istream::pos_type(-1) || end < current)
+    return std::numeric_limits<std::uint64_t>::max();
+  return static_cast<std::uint64_t>(end - current);
+}
+}  // namespace
+
+ReachabilityMap::ReachabilityMap(const moveit::core::JointModelGroup* jmg, const std::string& tip_link,
+                                 double resolution, std::size_t max_solutions_per_cell)
+  : jmg_(jmg)
+  , tip_link_(nullptr)
+  , base_link_(nullptr)
+  , resolution_(resolution)
+  , max_solutions_per_cell_(std::max<std::size_t>(max_solutions_per_cell, 1))
+{
+  if (jmg_->getParentModel().hasLinkModel(tip_link))
+  {
+    tip_link_ = jmg_->getParentModel().getLinkModel(tip_link);
+  }
+  else
+  {
+    RCLCPP_ERROR(getLogger(), "Link '%s' is not known to robot model '%s'", tip_link.c_str(),
+                 jmg_->getParentModel().getName().c_str());
+  }
+  if (jmg_->getCommonRoot())
+    base_link_ = jmg_->getCommonRoot()->getParentLinkModel();
+  if (resolution_ <= 0.0)
+  {
+    RCLCPP_ERROR(getLogger(), "Invalid reachability map resolution %f, using 0.05", resolution_);
+    resolution_ = 0.05;
+  }
+}
+
+ReachabilityMap::Key ReachabilityMap::getKey(const Eigen::Vector3d& position) const
+{
+  Key key = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const auto index = static_cast<std::int64_t>(std::floor(position[i] / resolution_)) + KEY_OFFSET;
+    key |= (index & KEY_MASK) << (i * KEY_BITS);
+  }
+  return key;
+}
+
+Eigen::Vector3d ReachabilityMap::getCellCenter(Key key) const
+{
+  Eigen::Vector3d center;
+  for (int i = 0; i < 3; ++i)
+    center[i] = (static_cast<double>(((key >> (i * KEY_BITS)) & KEY_MASK) - KEY_OFFSET) + 0.5) * resolution_;
+  return center;
+}
+
+Eigen::Isometry3d ReachabilityMap::getMapFrameTransform(const moveit::core::RobotState& state) const
+{
+  if (!base_link_)
+    return Eigen::Isometry3d::Identity();
+  // getGlobalLinkTransform() returns a valid isometry by contract
+  return state.getGlobalLinkTransform(base_link_).inverse();
+}
+
+bool ReachabilityMap::insert(moveit::core::RobotState& state)
+{
+  if (!tip_link_)
+    return false;
+
+  state.updateLinkTransforms();
+  const Eigen::Isometry3d tip = getMapFrameTransform(state) * state.getGlobalLinkTransform(tip_link_);
+  const Key key = getKey(tip.translation());
+  auto it = cells_.find(key);
+  if (it == cells_.end())
+  {
+    it = cells_.emplace(key, Cell()).first;
+    it->second.center = getCellCenter(key);
+  }
+  else if (it->second.solutions.size() >= max_solutions_per_cell_)
+  {
+    return false;
+  }
+
+  Solution solution;
+  solution.orientation = Eigen::Quaterniond(tip.linear());
+  state.copyJointGroupPositions(jmg_, solution.positions);
+  it->second.solutions.push_back(std::move(solution));
+  return true;
+}
+
+std::size_t ReachabilityMap::generate(const moveit::core::RobotState& reference_state, std::size_t samples,
+                                      random_numbers::RandomNumberGenerator& rng,
+                                      const moveit::core::GroupStateValidityCallbackFn& validity_callback)
+{
+  moveit::core::RobotState state(reference_state);
+  std::vector<double> values(jmg_->getVariableCount());
+  std::size_t inserted = 0;
+  for (std::size_t i = 0; i < samples; ++i)
+  {
+    state.setToRandomPositions(jmg_, rng);
+    if (validity_callback)
+    {
+      state.copyJointGroupPositions(jmg_, values);
+      if (!validity_callback(&state, jmg_, values.data()))
+        continue;
+    }
+    if (insert(state))
+      ++inserted;
+  }
+  RCLCPP_DEBUG(getLogger(), "Inserted %zu of %zu sampled configurations of group '%s' into %zu cells", inserted,
+               samples, jmg_->getName().c_str(), cells_.size());
+  return inserted;
+}
+
+std::vector<const ReachabilityMap::Cell*> ReachabilityMap::getCells() const
+{
+  std::vector<const Cell*> cells;
+  cells.reserve(cells_.size());
+  for (const auto& [key, cell] : cells_)
+    cells.push_back(&cell);
+  return cells;
+}
+
+const ReachabilityMap::Cell* ReachabilityMap::getCell(const Eigen::Vector3d& position) const
+{
+  const auto it = cells_.find(getKey(position));
+  return it == cells_.end() ? nullptr : &it->second;
+}
+
+const ReachabilityMap::Solution* ReachabilityMap::getNearestSolution(const Eigen::Vector3d& position,
+                                                                      const Eigen::Quaterniond& orientation) const
+{
+  const Cell* cell = getCell(position);
+  if (!cell)
+    return nullptr;
+
+  const Solution* best = nullptr;
+  double best_distance = std::numeric_limits<double>::infinity();
+  for (const Solution& solution : cell->solutions)
+  {
+    const double distance = solution.orientation.angularDistance(orientation);
+    if (distance < best_distance)
+    {
+      best_distance = distance;
+      best = &solution;
+    }
+  }
+  return best;
+}
+
+bool ReachabilityMap::writeToStream(std::ostream& os) const
+{
+  if (!tip_link_)
+    return false;
+
+  os << MAP_FILE_TAG << ' ' << MAP_FILE_VERSION << '\n';
+  os << "group: " << jmg_->getName() << '\n';
+  os << "tip_link: " << tip_link_->getName() << '\n';
+  os << "variables: " << jmg_->getVariableCount() << '\n';
+  os << "resolution: " << std::setprecision(std::numeric_limits<double>::max_digits10) << resolution_ << '\n';
+  os << "max_solutions_per_cell: " << max_solutions_per_cell_ << '\n';
+  os << "cells: " << cells_.size() << '\n';
+
+  // now the binary stuff
+  for (const auto& [key, cell] : cells_)
+  {
+    writeBinary(os, key);
+    writeBinary(os, static_cast<std::uint32_t>(cell.solutions.size()));
+    for (const Solution& solution : cell.solutions)
+    {
+      writeBinary(os, solution.orientation.x());
+      writeBinary(os, solution.orientation.y());
+      writeBinary(os, solution.orientation.z());
+      writeBinary(os, solution.orientation.w());
+      os.write(reinterpret_cast<const char*>(solution.positions.data()), sizeof(double) * solution.positions.size());
+    }
+  }
+  return static_cast<bool>(os);
+}
+
+ReachabilityMapPtr ReachabilityMap::readFromStream(const moveit::core::RobotModelConstPtr& robot_model,
+                                                   std::istream& is)
+{
+  std::string tag, temp, group, tip_link;
+  unsigned int version = 0;
+  std::size_t variables = 0, max_solutions = 0, cell_count = 0;
+  double resolution = 0.0;
+
+  is >> tag >> version;
+  if (!is || tag != MAP_FILE_TAG || version != MAP_FILE_VERSION)
+  {
+    RCLCPP_ERROR(getLogger(), "Stream does not contain a reachability map of version %u", MAP_FILE_VERSION);
+    return ReachabilityMapPtr();
+  }
+  is >> temp >> group >> temp >> tip_link >> temp >> variables >> temp >> resolution >> temp >> max_solutions >>
+      temp >> cell_count;
+  // skip the newline ending the header
+  is.get();
+  if (!is)
+  {
+    RCLCPP_ERROR(getLogger(), "Malformed reachability map header");
+    return ReachabilityMapPtr();
+  }
+
+  const moveit::core::JointModelGroup* jmg =
+      robot_model->hasJointModelGroup(group) ? robot_model->getJointModelGroup(group) : nullptr;
+  if (!jmg || jmg->getVariableCount() != variables || !robot_model->hasLinkModel(tip_link))
+  {
+    RCLCPP_ERROR(getLogger(), "Reachability map for group '%s' and link '%s' does not match robot model '%s'",
+                 group.c_str(), tip_link.c_str(), robot_model->getName().c_str());
+    return ReachabilityMapPtr();
+  }
+
+  // every count read from the stream is bounded by the bytes that are actually left, so that a corrupt file fails
+  // with an error instead of triggering a huge allocation
+  std::uint64_t remaining = getRemainingBytes(is);
+  const std::uint64_t cell_header_size = sizeof(Key) + sizeof(std::uint32_t);
+  const std::uint64_t solution_size = sizeof(double) * (4 + variables);
+  if (cell_count > remaining / cell_header_size)
+  {
+    RCLCPP_ERROR(getLogger(), "Reachability map for group '%s' is truncated", group.c_str());
+    return ReachabilityMapPtr();
+  }
+
+  auto map = std::make_shared<ReachabilityMap>(jmg, tip_link, resolution, max_solutions);
+  map->cells_.reserve(cell_count);
+  for (std::size_t i = 0; i < cell_count; ++i)
+  {
+    Key key;
+    std::uint32_t solution_count;
+    if (!readBinary(is, key) || !readBinary(is, solution_count))
+    {
+      RCLCPP_ERROR(getLogger(), "Reachability map for group '%s' is truncated", group.c_str());
+      return ReachabilityMapPtr();
+    }
+    remaining = remaining == std::numeric_limits<std::uint64_t>::max() ? remaining : remaining - cell_header_size;
+    if (solution_count > remaining / solution_size)
+    {
+      RCLCPP_ERROR(getLogger(), "Reachability map for group '%s' is truncated", group.c_str());
+      return ReachabilityMapPtr();
+    }
+    if (remaining != std::numeric_limits<std::uint64_t>::max())
+      remaining -= solution_count * solution_size;
+    Cell& cell = map->cells_[key];
+    cell.center = map->getCellCenter(key);
+    cell.solutions.resize(solution_count);
+    for (Solution& solution : cell.solutions)
+    {
+      double x, y, z, w;
+      solution.positions.resize(variables);
+      if (!readBinary(is, x) || !readBinary(is, y) || !readBinary(is, z) || !readBinary(is, w) ||
+          !is.read(reinterpret_cast<char*>(solution.positions.data()), sizeof(double) * variables))
+      {
+        RCLCPP_ERROR(getLogger(), "Reachability map for group '%s' is truncated", group.c_str());
+        return ReachabilityMapPtr();
+      }
+      solution.orientation = Eigen::Quaterniond(w, x, y, z);
+    }
+  }
+  return map;
+}
+
+ReachabilityMapPtr ReachabilityMap::loadFromFile(const moveit::core::RobotModelConstPtr& robot_model,
+                                                 const std::string& filename)
+{
+  std::ifstream is(filename, std::ios::in | std::ios::binary);
+  if (!is.good())
+  {
+    RCLCPP_ERROR(getLogger(), "Unable to open reachability map file '%s'", filename.c_str());
+    return ReachabilityMapPtr();
+  }
+  return readFromStream(robot_model, is);
+}
+
+bool ReachabilityMap::saveToFile(const std::string& filename) const
+{
+  std::ofstream os(filename, std::ios::out | std::ios::binary);
+  if (!os.good())
+  {
+    RCLCPP_ERROR(getLogger(), "Unable to open '%s' for writing", filename.c_str());
+    return false;
+  }
+  return writeToStream(os);
+}
+}  // namespace constraint_samplers
@@ -40,6 +40,7 @@
 #include <moveit/constraint_samplers/union_constraint_sampler.h>
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
 #include <moveit/constraint_samplers/constraint_sampler_tools.h>
+#include <moveit/constraint_samplers/reachability_map.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
@@ -51,6 +52,7 @@
 #include <urdf_parser/urdf_parser.h>
 #include <fstream>
 #include <functional>
+#include <sstream>
 
 #include "pr2_arm_kinematics_plugin.h"
 
@@ -1236,6 +1238,87 @@ TEST_F(LoadPlanningModelsPr2, IKConstraintsSamplerSeeded)
   EXPECT_FALSE((root_to_left_tool2 * root_to_left_tool3.inverse()).matrix().isIdentity(1e-7));
 }
 
+TEST_F(LoadPlanningModelsPr2, ReachabilityMapIKConstraintsSampler)
+{
+  moveit::core::RobotState ks(robot_model_);
+  ks.setToDefaultValues();
+  ks.update();
+
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("left_arm");
+  auto map = std::make_shared<constraint_samplers::ReachabilityMap>(jmg, "l_wrist_roll_link", 0.05, 4);
+  random_numbers::RandomNumberGenerator rng(265358);
+  EXPECT_GT(map->generate(ks, 20000, rng), 0u);
+  EXPECT_GT(map->getCellCount(), 0u);
+
+  // the map survives a round trip through its serialized form
+  std::stringstream stream;
+  EXPECT_TRUE(map->writeToStream(stream));
+  constraint_samplers::ReachabilityMapPtr loaded_map =
+      constraint_samplers::ReachabilityMap::readFromStream(robot_model_, stream);
+  ASSERT_TRUE(loaded_map);
+  EXPECT_EQ(loaded_map->getCellCount(), map->getCellCount());
+  EXPECT_EQ(loaded_map->getTipLink(), map->getTipLink());
+  EXPECT_DOUBLE_EQ(loaded_map->getResolution(), map->getResolution());
+
+  // counts that exceed the remaining data are rejected instead of being allocated
+  std::string corrupt = stream.str();
+  const std::string cells_field = "cells: " + std::to_string(map->getCellCount());
+  const std::size_t cells_pos = corrupt.find(cells_field);
+  ASSERT_NE(cells_pos, std::string::npos);
+  corrupt.replace(cells_pos, cells_field.size(), "cells: 18446744073709551615");
+  std::stringstream corrupt_stream(corrupt);
+  EXPECT_FALSE(constraint_samplers::ReachabilityMap::readFromStream(robot_model_, corrupt_stream));
+  std::stringstream truncated_stream(stream.str().substr(0, stream.str().size() / 2));
+  EXPECT_FALSE(constraint_samplers::ReachabilityMap::readFromStream(robot_model_, truncated_stream));
+
+  // every stored solution reaches into its own cell
+  moveit::core::RobotState check_state(ks);
+  for (const constraint_samplers::ReachabilityMap::Cell* cell : loaded_map->getCells())
+  {
+    ASSERT_FALSE(cell->solutions.empty());
+    check_state.setJointGroupPositions(jmg, cell->solutions.front().positions);
+    check_state.update();
+    const Eigen::Vector3d tip = loaded_map->getMapFrameTransform(check_state) *
+                                check_state.getGlobalLinkTransform("l_wrist_roll_link").translation();
+    EXPECT_EQ(loaded_map->getCell(tip), cell);
+  }
+
+  kinematic_constraints::PositionConstraint pc(robot_model_);
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions.resize(1);
+  pcm.constraint_region.primitives[0].dimensions[0] = 0.15;
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.55;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.2;
+  pcm.constraint_region.primitive_poses[0].position.z = 1.25;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  EXPECT_TRUE(pc.configure(pcm, ps_->getTransforms()));
+
+  constraint_samplers::IKConstraintSampler iks(ps_, "left_arm");
+  EXPECT_TRUE(iks.configure(constraint_samplers::IKSamplingPose(pc)));
+  iks.setReachabilityMap(loaded_map);
+  for (int t = 0; t < 100; ++t)
+  {
+    EXPECT_TRUE(iks.sample(ks, ks, 100));
+    EXPECT_TRUE(pc.decide(ks).satisfied);
+  }
+
+  // the manager hands registered maps to the IK samplers it allocates
+  constraint_samplers::ConstraintSamplerManager csm;
+  csm.registerReachabilityMap(loaded_map);
+  moveit_msgs::msg::Constraints constr;
+  constr.position_constraints.push_back(pcm);
+  constraint_samplers::ConstraintSamplerPtr s = csm.selectSampler(ps_, "left_arm", constr);
+  auto ik_sampler = std::dynamic_pointer_cast<constraint_samplers::IKConstraintSampler>(s);
+  ASSERT_TRUE(ik_sampler);
+  EXPECT_EQ(ik_sampler->getReachabilityMap(), loaded_map);
+}
+
 int main(int argc, char** argv)
 {
   rclcpp::init(argc, argv);
@@ -41,6 +41,7 @@
 #include <kdl/chainidsolver_recursive_newton_euler.hpp>
 
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 #include <geometry_msgs/msg/vector3.hpp>
 #include <geometry_msgs/msg/wrench.hpp>
 #include <memory>
@@ -87,6 +88,32 @@ public:
                   const std::vector<double>& joint_accelerations,
                   const std::vector<geometry_msgs::msg::Wrench>& wrenches, std::vector<double>& torques) const;
 
+  /**
+   * @brief Get the torques for many samples at once, e.g. all the samples along a trajectory. Every column of the
+   * input matrices is one sample (without external wrenches) and must have as many rows as there are joints in the
+   * group. Unlike getTorques(), this is safe to call from multiple threads.
+   * @param joint_angles The joint angles of every sample
+   * @param joint_velocities The joint velocities of every sample
+   * @param joint_accelerations The joint accelerations of every sample
+   * @param torques Computed torques of every sample are filled in here, resized to match the inputs
+   * @param num_threads Number of threads splitting the samples among them. 0 uses the number of hardware threads.
+   * @return False if any of the input matrices are of the wrong size
+   */
+  bool getTorquesBatch(const Eigen::MatrixXd& joint_angles, const Eigen::MatrixXd& joint_velocities,
+                       const Eigen::MatrixXd& joint_accelerations, Eigen::MatrixXd& torques,
+                       unsigned int num_threads = 1) const;
+
+  /**
+   * @brief Get the torques at every waypoint of a trajectory. Waypoints without velocities or accelerations are
+   * evaluated with zero velocities or accelerations.
+   * @param trajectory The trajectory to evaluate, the joint values of this group are used
+   * @param torques Computed torques are filled in here, one column per waypoint
+   * @param num_threads Number of threads splitting the waypoints among them. 0 uses the number of hardware threads.
+   * @return False if the torques could not be computed
+   */
+  bool getTorques(const robot_trajectory::RobotTrajectory& trajectory, Eigen::MatrixXd& torques,
+                  unsigned int num_threads = 1) const;
+
   /**
    * @brief Get the maximum payload for this group (in kg). Payload is
    * the weight that this group can hold when the weight is attached to the origin
@@ -100,6 +127,30 @@ public:
    */
   bool getMaxPayload(const std::vector<double>& joint_angles, double& payload, unsigned int& joint_saturated) const;
 
+  /**
+   * @brief Get the maximum payload like getMaxPayload() for many joint configurations at once. Unlike
+   * getMaxPayload(), this is safe to call from multiple threads.
+   * @param joint_angles The joint angles, one column per configuration with as many rows as joints in the group
+   * @param payloads The computed maximum payload of every configuration
+   * @param joints_saturated The first saturated joint of every configuration
+   * @param num_threads Number of threads splitting the configurations among them. 0 uses the number of hardware
+   * threads.
+   * @return False if the input matrix is of the wrong size
+   */
+  bool getMaxPayloads(const Eigen::MatrixXd& joint_angles, std::vector<double>& payloads,
+                      std::vector<unsigned int>& joints_saturated, unsigned int num_threads = 1) const;
+
+  /**
+   * @brief Get the maximum payload at every waypoint of a trajectory, see getMaxPayloads()
+   * @param trajectory The trajectory to evaluate, the joint values of this group are used
+   * @param payloads The computed maximum payload of every waypoint
+   * @param joints_saturated The first saturated joint of every waypoint
+   * @param num_threads Number of threads splitting the waypoints among them. 0 uses the number of hardware threads.
+   * @return False if the payloads could not be computed
+   */
+  bool getMaxPayloads(const robot_trajectory::RobotTrajectory& trajectory, std::vector<double>& payloads,
+                      std::vector<unsigned int>& joints_saturated, unsigned int num_threads = 1) const;
+
   /**
    * @brief Get torques corresponding to a particular payload value.  Payload is
    * the weight that this group can hold when the weight is attached to the origin
@@ -146,6 +197,7 @@ private:
   unsigned int num_joints_, num_segments_;  // number of joints in group, number of segments in group
   std::vector<double> max_torques_;         // vector of max torques
 
-  double gravity_;  // Norm of the gravity vector passed in initialize()
+  KDL::Vector kdl_gravity_;  // Gravity vector passed in initialize()
+  double gravity_;           // Norm of the gravity vector passed in initialize()
 };
 }  // namespace dynamics_solver
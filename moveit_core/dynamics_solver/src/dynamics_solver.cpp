@@ -42,6 +42,10 @@
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <moveit/utils/logger.hpp>
+#include <moveit/utils/parallel_for.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
 
 namespace dynamics_solver
 {
@@ -55,6 +59,53 @@ rclcpp::Logger getLogger()
 
 namespace
 {
+// Inverse dynamics solver with preallocated buffers. KDL solvers keep their intermediate results as members, so every
+// thread needs its own.
+struct InverseDynamicsWorkspace
+{
+  InverseDynamicsWorkspace(const KDL::Chain& chain, const KDL::Vector& gravity)
+    : solver(chain, gravity)
+    , angles(chain.getNrOfJoints())
+    , velocities(chain.getNrOfJoints())
+    , accelerations(chain.getNrOfJoints())
+    , torques(chain.getNrOfJoints())
+    , wrenches(chain.getNrOfSegments(), KDL::Wrench::Zero())
+  {
+  }
+
+  bool solve(const Eigen::Ref<const Eigen::VectorXd>& joint_angles,
+             const Eigen::Ref<const Eigen::VectorXd>& joint_velocities,
+             const Eigen::Ref<const Eigen::VectorXd>& joint_accelerations, Eigen::Ref<Eigen::VectorXd> joint_torques)
+  {
+    angles.data = joint_angles;
+    velocities.data = joint_velocities;
+    accelerations.data = joint_accelerations;
+    if (solver.CartToJnt(angles, velocities, accelerations, wrenches, torques) < 0)
+      return false;
+    joint_torques = torques.data;
+    return true;
+  }
+
+  KDL::ChainIdSolver_RNE solver;
+  KDL::JntArray angles, velocities, accelerations, torques;
+  KDL::Wrenches wrenches;
+};
+
+// Calls job(workspace, sample) for every sample with moveit::core::parallelFor(), which starts num_threads threads
+// (0 uses the number of hardware threads) with a workspace from make_workspace() each. Returns false if any job failed.
+template <typename MakeWorkspace, typename Job>
+bool forEachSample(Eigen::Index num_samples, unsigned int num_threads, const MakeWorkspace& make_workspace,
+                   const Job& job)
+{
+  std::atomic<bool> success{ true };
+  moveit::core::parallelFor(static_cast<std::size_t>(num_samples), num_threads, make_workspace,
+                            [&](auto& workspace, std::size_t sample) {
+                              if (!job(workspace, static_cast<Eigen::Index>(sample)))
+                                success = false;
+                            });
+  return success;
+}
+
 inline geometry_msgs::msg::Vector3 transformVector(const Eigen::Isometry3d& transform,
                                                    const geometry_msgs::msg::Vector3& vector)
 {
@@ -129,7 +180,8 @@ DynamicsSolver::DynamicsSolver(const moveit::core::RobotModelConstPtr& robot_mod
   state_ = std::make_shared<moveit::core::RobotState>(robot_model_);
   state_->setToDefaultValues();
 
-  const std::vector<std::string>& joint_model_names = joint_model_group_->getJointModelNames();
+  // One limit per KDL joint, so fixed joints of the group are skipped
+  const std::vector<std::string>& joint_model_names = joint_model_group_->getActiveJointModelNames();
   for (const std::string& joint_model_name : joint_model_names)
   {
     const urdf::Joint* ujoint = urdf_model->getJoint(joint_model_name).get();
@@ -143,12 +195,12 @@ DynamicsSolver::DynamicsSolver(const moveit::core::RobotModelConstPtr& robot_mod
     }
   }
 
-  KDL::Vector gravity(gravity_vector.x, gravity_vector.y,
-                      gravity_vector.z);  // \todo Not sure if KDL expects the negative of this (Sachin)
-  gravity_ = gravity.Norm();
+  kdl_gravity_ = KDL::Vector(gravity_vector.x, gravity_vector.y,
+                             gravity_vector.z);  // \todo Not sure if KDL expects the negative of this (Sachin)
+  gravity_ = kdl_gravity_.Norm();
   RCLCPP_DEBUG(getLogger(), "Gravity norm set to %f", gravity_);
 
-  chain_id_solver_ = std::make_shared<KDL::ChainIdSolver_RNE>(kdl_chain_, gravity);
+  chain_id_solver_ = std::make_shared<KDL::ChainIdSolver_RNE>(kdl_chain_, kdl_gravity_);
 }
 
 bool DynamicsSolver::getTorques(const std::vector<double>& joint_angles, const std::vector<double>& joint_velocities,
@@ -222,6 +274,71 @@ bool DynamicsSolver::getTorques(const std::vector<double>& joint_angles, const s
   return true;
 }
 
+bool DynamicsSolver::getTorquesBatch(const Eigen::MatrixXd& joint_angles, const Eigen::MatrixXd& joint_velocities,
+                                     const Eigen::MatrixXd& joint_accelerations, Eigen::MatrixXd& torques,
+                                     unsigned int num_threads) const
+{
+  if (!joint_model_group_)
+  {
+    RCLCPP_DEBUG(getLogger(), "Did not construct DynamicsSolver object properly. "
+                              "Check error logs.");
+    return false;
+  }
+  const Eigen::Index num_joints = num_joints_;
+  const Eigen::Index num_samples = joint_angles.cols();
+  if (joint_angles.rows() != num_joints || joint_velocities.rows() != num_joints ||
+      joint_accelerations.rows() != num_joints)
+  {
+    RCLCPP_ERROR(getLogger(), "Joint angles, velocities and accelerations should have %d rows", num_joints_);
+    return false;
+  }
+  if (joint_velocities.cols() != num_samples || joint_accelerations.cols() != num_samples)
+  {
+    RCLCPP_ERROR(getLogger(), "Joint angles, velocities and accelerations should have the same number of samples");
+    return false;
+  }
+  torques.resize(num_joints, num_samples);
+  const bool success = forEachSample(
+      num_samples, num_threads, [this] { return InverseDynamicsWorkspace(kdl_chain_, kdl_gravity_); },
+      [&](InverseDynamicsWorkspace& workspace, Eigen::Index sample) {
+        return workspace.solve(joint_angles.col(sample), joint_velocities.col(sample), joint_accelerations.col(sample),
+                               torques.col(sample));
+      });
+  if (!success)
+  {
+    RCLCPP_ERROR(getLogger(), "Something went wrong computing torques");
+    return false;
+  }
+  return true;
+}
+
+bool DynamicsSolver::getTorques(const robot_trajectory::RobotTrajectory& trajectory, Eigen::MatrixXd& torques,
+                                unsigned int num_threads) const
+{
+  if (!joint_model_group_)
+  {
+    RCLCPP_DEBUG(getLogger(), "Did not construct DynamicsSolver object properly. "
+                              "Check error logs.");
+    return false;
+  }
+
+  // Waypoints without velocities or accelerations contribute zeros
+  const std::size_t num_waypoints = trajectory.getWayPointCount();
+  Eigen::MatrixXd joint_angles(num_joints_, num_waypoints);
+  Eigen::MatrixXd joint_velocities = Eigen::MatrixXd::Zero(num_joints_, num_waypoints);
+  Eigen::MatrixXd joint_accelerations = Eigen::MatrixXd::Zero(num_joints_, num_waypoints);
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+  {
+    const moveit::core::RobotState& waypoint = trajectory.getWayPoint(i);
+    waypoint.copyJointGroupPositions(joint_model_group_, joint_angles.col(i).data());
+    if (waypoint.hasVelocities())
+      waypoint.copyJointGroupVelocities(joint_model_group_, joint_velocities.col(i).data());
+    if (waypoint.hasAccelerations())
+      waypoint.copyJointGroupAccelerations(joint_model_group_, joint_accelerations.col(i).data());
+  }
+  return getTorquesBatch(joint_angles, joint_velocities, joint_accelerations, torques, num_threads);
+}
+
 bool DynamicsSolver::getMaxPayload(const std::vector<double>& joint_angles, double& payload,
                                    unsigned int& joint_saturated) const
 {
@@ -287,6 +404,102 @@ bool DynamicsSolver::getMaxPayload(const std::vector<double>& joint_angles, doub
   return true;
 }
 
+bool DynamicsSolver::getMaxPayloads(const Eigen::MatrixXd& joint_angles, std::vector<double>& payloads,
+                                    std::vector<unsigned int>& joints_saturated, unsigned int num_threads) const
+{
+  if (!joint_model_group_)
+  {
+    RCLCPP_DEBUG(getLogger(), "Did not construct DynamicsSolver object properly. "
+                              "Check error logs.");
+    return false;
+  }
+  if (joint_angles.rows() != static_cast<Eigen::Index>(num_joints_))
+  {
+    RCLCPP_ERROR(getLogger(), "Joint angles should have %d rows", num_joints_);
+    return false;
+  }
+  const Eigen::Index num_samples = joint_angles.cols();
+  payloads.assign(num_samples, 0.0);
+  joints_saturated.assign(num_samples, 0);
+
+  // Same computation as getMaxPayload(), but with a robot state per thread instead of the shared state_
+  struct PayloadWorkspace
+  {
+    InverseDynamicsWorkspace dynamics;
+    moveit::core::RobotState state;
+    Eigen::VectorXd zero_torques, payload_torques;
+  };
+  const Eigen::VectorXd zero = Eigen::VectorXd::Zero(num_joints_);
+  const bool success = forEachSample(
+      num_samples, num_threads,
+      [this] {
+        return PayloadWorkspace{ InverseDynamicsWorkspace(kdl_chain_, kdl_gravity_), moveit::core::RobotState(*state_),
+                                 Eigen::VectorXd(num_joints_), Eigen::VectorXd(num_joints_) };
+      },
+      [&](PayloadWorkspace& workspace, Eigen::Index sample) {
+        const auto angles = joint_angles.col(sample);
+        if (!workspace.dynamics.solve(angles, zero, zero, workspace.zero_torques))
+          return false;
+        for (unsigned int i = 0; i < num_joints_; ++i)
+        {
+          if (std::abs(workspace.zero_torques[i]) >= max_torques_[i])
+          {
+            payloads[sample] = 0.0;
+            joints_saturated[sample] = i;
+            return true;
+          }
+        }
+
+        // Torques for a unit force along gravity at the tip, in the tip frame
+        workspace.state.setJointGroupPositions(joint_model_group_, angles.data());
+        const Eigen::Isometry3d& base_frame = workspace.state.getFrameTransform(base_name_);
+        const Eigen::Isometry3d& tip_frame = workspace.state.getFrameTransform(tip_name_);
+        const Eigen::Vector3d force = (tip_frame.inverse() * base_frame).linear() * Eigen::Vector3d::UnitZ();
+        workspace.dynamics.wrenches.back().force = KDL::Vector(force.x(), force.y(), force.z());
+        const bool solved = workspace.dynamics.solve(angles, zero, zero, workspace.payload_torques);
+        workspace.dynamics.wrenches.back() = KDL::Wrench::Zero();
+        if (!solved)
+          return false;
+
+        double min_payload = std::numeric_limits<double>::max();
+        for (unsigned int i = 0; i < num_joints_; ++i)
+        {
+          const double torque_per_unit = workspace.payload_torques[i] - workspace.zero_torques[i];
+          const double payload_joint = std::max((max_torques_[i] - workspace.zero_torques[i]) / torque_per_unit,
+                                                (-max_torques_[i] - workspace.zero_torques[i]) / torque_per_unit);
+          if (payload_joint < min_payload)
+          {
+            min_payload = payload_joint;
+            joints_saturated[sample] = i;
+          }
+        }
+        payloads[sample] = min_payload / gravity_;
+        return true;
+      });
+  if (!success)
+  {
+    RCLCPP_ERROR(getLogger(), "Something went wrong computing torques");
+    return false;
+  }
+  return true;
+}
+
+bool DynamicsSolver::getMaxPayloads(const robot_trajectory::RobotTrajectory& trajectory, std::vector<double>& payloads,
+                                    std::vector<unsigned int>& joints_saturated, unsigned int num_threads) const
+{
+  if (!joint_model_group_)
+  {
+    RCLCPP_DEBUG(getLogger(), "Did not construct DynamicsSolver object properly. "
+                              "Check error logs.");
+    return false;
+  }
+  const std::size_t num_waypoints = trajectory.getWayPointCount();
+  Eigen::MatrixXd joint_angles(num_joints_, num_waypoints);
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+    trajectory.getWayPoint(i).copyJointGroupPositions(joint_model_group_, joint_angles.col(i).data());
+  return getMaxPayloads(joint_angles, payloads, joints_saturated, num_threads);
+}
+
 bool DynamicsSolver::getPayloadTorques(const std::vector<double>& joint_angles, double payload,
                                        std::vector<double>& joint_torques) const
 {
@@ -0,0 +1,147 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <moveit/dynamics_solver/dynamics_solver.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+
+#include <algorithm>
+#include <cmath>
+
+class DynamicsSolverTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+    group_ = robot_model_->getJointModelGroup("panda_arm");
+    geometry_msgs::msg::Vector3 gravity;
+    gravity.z = -9.81;
+    solver_ = std::make_unique<dynamics_solver::DynamicsSolver>(robot_model_, "panda_arm", gravity);
+
+    // Random configurations within the joint limits, one per column
+    moveit::core::RobotState state(robot_model_);
+    state.setToDefaultValues();
+    random_numbers::RandomNumberGenerator rng(42);
+    const Eigen::Index num_joints = group_->getActiveJointModels().size();
+    joint_angles_.resize(num_joints, NUM_SAMPLES);
+    joint_velocities_.resize(num_joints, NUM_SAMPLES);
+    joint_accelerations_.resize(num_joints, NUM_SAMPLES);
+    for (Eigen::Index sample = 0; sample < NUM_SAMPLES; ++sample)
+    {
+      state.setToRandomPositions(group_, rng);
+      state.copyJointGroupPositions(group_, joint_angles_.col(sample).data());
+      for (Eigen::Index joint = 0; joint < num_joints; ++joint)
+      {
+        joint_velocities_(joint, sample) = rng.uniformReal(-1.0, 1.0);
+        joint_accelerations_(joint, sample) = rng.uniformReal(-1.0, 1.0);
+      }
+    }
+  }
+
+  static std::vector<double> toVector(const Eigen::VectorXd& vector)
+  {
+    return std::vector<double>(vector.data(), vector.data() + vector.size());
+  }
+
+  static constexpr Eigen::Index NUM_SAMPLES = 20;
+  moveit::core::RobotModelPtr robot_model_;
+  const moveit::core::JointModelGroup* group_;
+  std::unique_ptr<dynamics_solver::DynamicsSolver> solver_;
+  Eigen::MatrixXd joint_angles_, joint_velocities_, joint_accelerations_;
+};
+
+TEST_F(DynamicsSolverTest, TorquesBatchMatchesSingleSamples)
+{
+  // One wrench per segment of the chain, i.e. per link of the group
+  const std::vector<geometry_msgs::msg::Wrench> wrenches(group_->getLinkModels().size());
+  for (const unsigned int num_threads : { 1u, 0u, 3u })
+  {
+    Eigen::MatrixXd torques;
+    ASSERT_TRUE(
+        solver_->getTorquesBatch(joint_angles_, joint_velocities_, joint_accelerations_, torques, num_threads));
+    ASSERT_EQ(torques.rows(), joint_angles_.rows());
+    ASSERT_EQ(torques.cols(), NUM_SAMPLES);
+    for (Eigen::Index sample = 0; sample < NUM_SAMPLES; ++sample)
+    {
+      std::vector<double> expected(joint_angles_.rows());
+      ASSERT_TRUE(solver_->getTorques(toVector(joint_angles_.col(sample)), toVector(joint_velocities_.col(sample)),
+                                      toVector(joint_accelerations_.col(sample)), wrenches, expected));
+      for (Eigen::Index joint = 0; joint < torques.rows(); ++joint)
+      {
+        EXPECT_NEAR(torques(joint, sample), expected[joint], 1e-9 * std::max(1.0, std::abs(expected[joint])))
+            << "sample " << sample << ", joint " << joint;
+      }
+    }
+  }
+}
+
+TEST_F(DynamicsSolverTest, MaxPayloadsMatchSingleSamples)
+{
+  for (const unsigned int num_threads : { 1u, 0u, 3u })
+  {
+    std::vector<double> payloads;
+    std::vector<unsigned int> joints_saturated;
+    ASSERT_TRUE(solver_->getMaxPayloads(joint_angles_, payloads, joints_saturated, num_threads));
+    ASSERT_EQ(payloads.size(), static_cast<std::size_t>(NUM_SAMPLES));
+    ASSERT_EQ(joints_saturated.size(), static_cast<std::size_t>(NUM_SAMPLES));
+    for (Eigen::Index sample = 0; sample < NUM_SAMPLES; ++sample)
+    {
+      double payload;
+      unsigned int joint_saturated;
+      ASSERT_TRUE(solver_->getMaxPayload(toVector(joint_angles_.col(sample)), payload, joint_saturated));
+      EXPECT_NEAR(payloads[sample], payload, 1e-9 * std::max(1.0, std::abs(payload))) << "sample " << sample;
+      EXPECT_EQ(joints_saturated[sample], joint_saturated) << "sample " << sample;
+    }
+  }
+}
+
+TEST_F(DynamicsSolverTest, BatchRejectsWrongSizes)
+{
+  Eigen::MatrixXd torques;
+  EXPECT_FALSE(solver_->getTorquesBatch(joint_angles_.topRows(2), joint_velocities_, joint_accelerations_, torques));
+  EXPECT_FALSE(solver_->getTorquesBatch(joint_angles_, joint_velocities_.leftCols(1), joint_accelerations_, torques));
+  std::vector<double> payloads;
+  std::vector<unsigned int> joints_saturated;
+  EXPECT_FALSE(solver_->getMaxPayloads(joint_angles_.topRows(2), payloads, joints_saturated));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
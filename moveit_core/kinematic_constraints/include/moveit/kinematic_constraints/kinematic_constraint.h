@@ -45,6 +45,7 @@
 #include <geometric_shapes/bodies.h>
 #include <moveit_msgs/msg/constraints.hpp>
 
+#include <functional>
 #include <iostream>
 #include <vector>
 
@@ -1068,6 +1069,16 @@ public:
     return kinematic_constraints_.empty();
   }
 
+  /**
+   * \brief Get all constraint objects in the set, in the order they were added
+   *
+   * @return All kinematic constraints, including ones that failed to configure
+   */
+  const std::vector<KinematicConstraintPtr>& getKinematicConstraints() const
+  {
+    return kinematic_constraints_;
+  }
+
 protected:
   moveit::core::RobotModelConstPtr robot_model_; /**< \brief The kinematic model used for by the Set */
   std::vector<KinematicConstraintPtr>
@@ -1085,4 +1096,133 @@ protected:
                                                                                internal visibility constraints */
   moveit_msgs::msg::Constraints all_constraints_; /**<  \brief Messages corresponding to all internal constraints */
 };
+
+MOVEIT_CLASS_FORWARD(CompiledConstraintSet);  // Defines CompiledConstraintSetPtr, ConstPtr, WeakPtr... etc
+
+/**
+ * \brief A flattened, read-only form of a KinematicConstraintSet for
+ * evaluating the same constraints against many states.
+ *
+ * Link models, reference frames and variable indices are resolved once
+ * when the set is compiled, and the parameters of joint, position and
+ * orientation constraints are stored in contiguous arrays. Evaluating a
+ * state then involves no virtual calls, no frame lookups by name and no
+ * memory allocation. Constraints that cannot be compiled (visibility
+ * constraints, and constraints expressed relative to a mobile frame that
+ * is not a link of the robot model) are evaluated through the original
+ * constraint objects.
+ *
+ * The compiled set is a snapshot: it has to be recreated if constraints
+ * are added to the KinematicConstraintSet it was compiled from.
+ */
+class CompiledConstraintSet
+{
+public:
+  /**
+   * \brief Compile the constraints contained in a set
+   *
+   * Constraints that are not enabled (e.g., because they failed to
+   * configure) are skipped, matching KinematicConstraintSet::decide().
+   *
+   * @param [in] set The constraint set to compile
+   */
+  CompiledConstraintSet(const KinematicConstraintSet& set);
+
+  /**
+   * \brief Evaluate all constraints, returning the same result as
+   * KinematicConstraintSet::decide()
+   *
+   * @param [in] state The state to test. Its link transforms must be up to date.
+   *
+   * @return Whether all constraints are satisfied, and the sum of the individual distances
+   */
+  ConstraintEvaluationResult decide(const moveit::core::RobotState& state) const;
+
+  /**
+   * \brief Check whether all constraints are satisfied by state
+   *
+   * Cheap joint constraints are checked first and the evaluation stops at
+   * the first violated constraint; no distances are computed.
+   *
+   * @param [in] state The state to test. Its link transforms must be up to date.
+   *
+   * @return True if all constraints are satisfied
+   */
+  bool satisfied(const moveit::core::RobotState& state) const;
+
+  /**
+   * \brief Check a sequence of states, e.g. the waypoints of a trajectory
+   *
+   * @param [in] state_count The number of states to check
+   * @param [in] state_at Accessor returning the state at a given index
+   * @param [out] invalid_index If not nullptr, all states are checked and the
+   * indices of the violating ones are stored here. Otherwise the evaluation
+   * stops at the first violation.
+   *
+   * @return True if all states satisfy all constraints
+   */
+  bool satisfied(std::size_t state_count, const std::function<const moveit::core::RobotState&(std::size_t)>& state_at,
+                 std::vector<std::size_t>* invalid_index = nullptr) const;
+
+  /** \brief Check a vector of states. See the accessor-based overload for details. */
+  bool satisfied(const std::vector<moveit::core::RobotStatePtr>& states,
+                 std::vector<std::size_t>* invalid_index = nullptr) const;
+
+  /** \brief Returns whether the compiled set contains no constraints */
+  bool empty() const
+  {
+    return joint_terms_.empty() && position_terms_.empty() && orientation_terms_.empty() && fallback_.empty();
+  }
+
+  /** \brief Get the number of constraints that are evaluated through the original constraint objects */
+  std::size_t getFallbackCount() const
+  {
+    return fallback_.size();
+  }
+
+private:
+  struct JointTerm
+  {
+    int variable_index;
+    bool continuous;
+    double position;
+    double tolerance_above;
+    double tolerance_below;
+    double weight;
+  };
+
+  struct PositionTerm
+  {
+    const moveit::core::LinkModel* link;
+    const moveit::core::LinkModel* frame_link; /**< \brief The mobile reference frame, nullptr for fixed frames */
+    Eigen::Vector3d offset;
+    std::size_t regions_begin; /**< \brief Range of this constraint's regions in regions_ */
+    std::size_t regions_end;
+    double weight;
+  };
+
+  struct OrientationTerm
+  {
+    const moveit::core::LinkModel* link;
+    const moveit::core::LinkModel* frame_link; /**< \brief The mobile reference frame, nullptr for fixed frames */
+    Eigen::Matrix3d desired_rotation;
+    Eigen::Matrix3d desired_rotation_inv;
+    int parameterization_type;
+    Eigen::Vector3d tolerance;
+    double weight;
+  };
+
+  /** \brief Evaluate a single compiled constraint. If \e distance is not nullptr, the weighted distance is stored
+   * there */
+  bool decideJoint(const JointTerm& term, const moveit::core::RobotState& state, double* distance) const;
+  bool decidePosition(const PositionTerm& term, const moveit::core::RobotState& state, double* distance) const;
+  bool decideOrientation(const OrientationTerm& term, const moveit::core::RobotState& state, double* distance) const;
+
+  std::vector<JointTerm> joint_terms_;
+  std::vector<PositionTerm> position_terms_;
+  std::vector<OrientationTerm> orientation_terms_;
+  std::vector<bodies::BodyPtr> regions_; /**< \brief Constraint regions of all position terms; for mobile frames the
+                                            region poses are relative to the frame */
+  std::vector<KinematicConstraintConstPtr> fallback_; /**< \brief Constraints evaluated through their decide() */
+};
 }  // namespace kinematic_constraints
@@ -130,6 +130,70 @@ calcEulerAngles(const Eigen::MatrixBase<Derived>& R)
   return { res, false };
 }
 
+// Signed difference between a joint value and the desired position, taking wrapping into account for continuous joints
+static inline double computeJointDifference(double current_joint_position, double joint_position, bool continuous)
+{
+  // compute signed shortest distance for continuous joints
+  if (continuous)
+  {
+    double dif = normalizeAngle(current_joint_position) - joint_position;
+
+    if (dif > M_PI)
+    {
+      dif = 2.0 * M_PI - dif;
+    }
+    else if (dif < -M_PI)
+    {
+      dif += 2.0 * M_PI;  // we include a sign change to have dif > 0
+    }
+    return dif;
+  }
+  return current_joint_position - joint_position;
+}
+
+// Absolute rotation error around the X, Y and Z axes for the rotation difference between the desired and the actual
+// orientation, according to the parameterization of an orientation constraint
+static Eigen::Vector3d computeOrientationError(const Eigen::Matrix3d& diff, int parameterization_type,
+                                               double absolute_z_axis_tolerance)
+{
+  Eigen::Vector3d xyz_rotation;
+  if (parameterization_type == moveit_msgs::msg::OrientationConstraint::XYZ_EULER_ANGLES)
+  {
+    std::tuple<Eigen::Vector3d, bool> euler_angles_error = calcEulerAngles(diff);
+    // Converting from a rotation matrix to intrinsic XYZ Euler angles has 2 singularities:
+    // pitch ~= pi/2 ==> roll + yaw = theta
+    // pitch ~= -pi/2 ==> roll - yaw = theta
+    // in those cases calcEulerAngles will set roll (xyz_rotation(0)) to theta and yaw (xyz_rotation(2)) to zero, so for
+    // us to be able to capture yaw tolerance violations we do the following: If theta violates the absolute yaw
+    // tolerance we think of it as a pure yaw rotation and set roll to zero.
+    xyz_rotation = std::get<Eigen::Vector3d>(euler_angles_error);
+    if (!std::get<bool>(euler_angles_error))
+    {
+      if (normalizeAbsoluteAngle(xyz_rotation(0)) > absolute_z_axis_tolerance + std::numeric_limits<double>::epsilon())
+      {
+        xyz_rotation(2) = xyz_rotation(0);
+        xyz_rotation(0) = 0;
+      }
+    }
+    // Account for angle wrapping
+    xyz_rotation = xyz_rotation.unaryExpr(&normalizeAbsoluteAngle);
+  }
+  else if (parameterization_type == moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR)
+  {
+    Eigen::AngleAxisd aa(diff);
+    xyz_rotation = aa.axis() * aa.angle();
+    xyz_rotation(0) = fabs(xyz_rotation(0));
+    xyz_rotation(1) = fabs(xyz_rotation(1));
+    xyz_rotation(2) = fabs(xyz_rotation(2));
+  }
+  else
+  {
+    /* The parameterization type should be validated in configure, so this should never happen. */
+    RCLCPP_ERROR(getLogger(), "The parameterization type for the orientation constraints is invalid.");
+  }
+  return xyz_rotation;
+}
+
 KinematicConstraint::KinematicConstraint(const moveit::core::RobotModelConstPtr& model)
   : type_(UNKNOWN_CONSTRAINT), robot_model_(model), constraint_weight_(std::numeric_limits<double>::epsilon())
 {
@@ -292,24 +356,7 @@ ConstraintEvaluationResult JointConstraint::decide(const moveit::core::RobotStat
     return ConstraintEvaluationResult(true, 0.0);
 
   double current_joint_position = state.getVariablePosition(joint_variable_index_);
-  double dif = 0.0;
-
-  // compute signed shortest distance for continuous joints
-  if (joint_is_continuous_)
-  {
-    dif = normalizeAngle(current_joint_position) - joint_position_;
-
-    if (dif > M_PI)
-    {
-      dif = 2.0 * M_PI - dif;
-    }
-    else if (dif < -M_PI)
-    {
-      dif += 2.0 * M_PI;  // we include a sign change to have dif > 0
-    }
-  }
-  else
-    dif = current_joint_position - joint_position_;
+  double dif = computeJointDifference(current_joint_position, joint_position_, joint_is_continuous_);
 
   // check bounds
   bool result = dif <= (joint_tolerance_above_ + 2.0 * std::numeric_limits<double>::epsilon()) &&
@@ -722,43 +769,8 @@ ConstraintEvaluationResult OrientationConstraint::decide(const moveit::core::Rob
     diff = Eigen::Isometry3d(desired_rotation_matrix_inv_ * state.getGlobalLinkTransform(link_model_).linear());
   }
 
-  // This needs to live outside the if-block scope (as xyz_rotation points to its data).
-  std::tuple<Eigen::Vector3d, bool> euler_angles_error;
-  Eigen::Vector3d xyz_rotation;
-  if (parameterization_type_ == moveit_msgs::msg::OrientationConstraint::XYZ_EULER_ANGLES)
-  {
-    euler_angles_error = calcEulerAngles(diff.linear());
-    // Converting from a rotation matrix to intrinsic XYZ Euler angles has 2 singularities:
-    // pitch ~= pi/2 ==> roll + yaw = theta
-    // pitch ~= -pi/2 ==> roll - yaw = theta
-    // in those cases calcEulerAngles will set roll (xyz_rotation(0)) to theta and yaw (xyz_rotation(2)) to zero, so for
-    // us to be able to capture yaw tolerance violations we do the following: If theta violates the absolute yaw
-    // tolerance we think of it as a pure yaw rotation and set roll to zero.
-    xyz_rotation = std::get<Eigen::Vector3d>(euler_angles_error);
-    if (!std::get<bool>(euler_angles_error))
-    {
-      if (normalizeAbsoluteAngle(xyz_rotation(0)) > absolute_z_axis_tolerance_ + std::numeric_limits<double>::epsilon())
-      {
-        xyz_rotation(2) = xyz_rotation(0);
-        xyz_rotation(0) = 0;
-      }
-    }
-    // Account for angle wrapping
-    xyz_rotation = xyz_rotation.unaryExpr(&normalizeAbsoluteAngle);
-  }
-  else if (parameterization_type_ == moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR)
-  {
-    Eigen::AngleAxisd aa(diff.linear());
-    xyz_rotation = aa.axis() * aa.angle();
-    xyz_rotation(0) = fabs(xyz_rotation(0));
-    xyz_rotation(1) = fabs(xyz_rotation(1));
-    xyz_rotation(2) = fabs(xyz_rotation(2));
-  }
-  else
-  {
-    /* The parameterization type should be validated in configure, so this should never happen. */
-    RCLCPP_ERROR(getLogger(), "The parameterization type for the orientation constraints is invalid.");
-  }
+  Eigen::Vector3d xyz_rotation =
+      computeOrientationError(diff.linear(), parameterization_type_, absolute_z_axis_tolerance_);
 
   bool result = xyz_rotation(2) < absolute_z_axis_tolerance_ + std::numeric_limits<double>::epsilon() &&
                 xyz_rotation(1) < absolute_y_axis_tolerance_ + std::numeric_limits<double>::epsilon() &&
@@ -1359,4 +1371,218 @@ bool KinematicConstraintSet::equal(const KinematicConstraintSet& other, double m
   return true;
 }
 
+CompiledConstraintSet::CompiledConstraintSet(const KinematicConstraintSet& set)
+{
+  for (const KinematicConstraintPtr& kinematic_constraint : set.getKinematicConstraints())
+  {
+    // disabled constraints are always satisfied with zero distance
+    if (!kinematic_constraint->enabled())
+      continue;
+
+    const moveit::core::RobotModelConstPtr& robot_model = kinematic_constraint->getRobotModel();
+    switch (kinematic_constraint->getType())
+    {
+      case JOINT_CONSTRAINT:
+      {
+        const JointConstraint& jc = static_cast<const JointConstraint&>(*kinematic_constraint);
+        const moveit::core::JointModel* joint_model = jc.getJointModel();
+        JointTerm term;
+        term.variable_index = jc.getJointVariableIndex();
+        term.continuous =
+            (joint_model->getType() == moveit::core::JointModel::REVOLUTE &&
+             static_cast<const moveit::core::RevoluteJointModel*>(joint_model)->isContinuous()) ||
+            (joint_model->getType() == moveit::core::JointModel::PLANAR && jc.getLocalVariableName() == "theta");
+        term.position = jc.getDesiredJointPosition();
+        term.tolerance_above = jc.getJointToleranceAbove();
+        term.tolerance_below = jc.getJointToleranceBelow();
+        term.weight = jc.getConstraintWeight();
+        joint_terms_.push_back(term);
+        continue;
+      }
+      case POSITION_CONSTRAINT:
+      {
+        const PositionConstraint& pc = static_cast<const PositionConstraint&>(*kinematic_constraint);
+        const moveit::core::LinkModel* frame_link = nullptr;
+        if (pc.mobileReferenceFrame())
+        {
+          // attached bodies and subframes can only be resolved through the state
+          if (!robot_model->hasLinkModel(pc.getReferenceFrame()))
+            break;
+          frame_link = robot_model->getLinkModel(pc.getReferenceFrame());
+        }
+        PositionTerm term;
+        term.link = pc.getLinkModel();
+        term.frame_link = frame_link;
+        term.offset = pc.getLinkOffset();
+        term.regions_begin = regions_.size();
+        regions_.insert(regions_.end(), pc.getConstraintRegions().begin(), pc.getConstraintRegions().end());
+        term.regions_end = regions_.size();
+        term.weight = pc.getConstraintWeight();
+        position_terms_.push_back(term);
+        continue;
+      }
+      case ORIENTATION_CONSTRAINT:
+      {
+        const OrientationConstraint& oc = static_cast<const OrientationConstraint&>(*kinematic_constraint);
+        const moveit::core::LinkModel* frame_link = nullptr;
+        if (oc.mobileReferenceFrame())
+        {
+          // attached bodies and subframes can only be resolved through the state
+          if (!robot_model->hasLinkModel(oc.getReferenceFrame()))
+            break;
+          frame_link = robot_model->getLinkModel(oc.getReferenceFrame());
+        }
+        OrientationTerm term;
+        term.link = oc.getLinkModel();
+        term.frame_link = frame_link;
+        term.desired_rotation = oc.getDesiredRotationMatrix();
+        term.desired_rotation_inv = term.desired_rotation.transpose();
+        term.parameterization_type = oc.getParameterizationType();
+        term.tolerance = Eigen::Vector3d(oc.getXAxisTolerance(), oc.getYAxisTolerance(), oc.getZAxisTolerance());
+        term.weight = oc.getConstraintWeight();
+        orientation_terms_.push_back(term);
+        continue;
+      }
+      default:
+        break;
+    }
+    fallback_.push_back(kinematic_constraint);
+  }
+}
+
+bool CompiledConstraintSet::decideJoint(const JointTerm& term, const moveit::core::RobotState& state,
+                                        double* distance) const
+{
+  const double dif =
+      computeJointDifference(state.getVariablePosition(term.variable_index), term.position, term.continuous);
+  if (distance)
+    *distance = term.weight * fabs(dif);
+  return dif <= (term.tolerance_above + 2.0 * std::numeric_limits<double>::epsilon()) &&
+         dif >= (-term.tolerance_below - 2.0 * std::numeric_limits<double>::epsilon());
+}
+
+bool CompiledConstraintSet::decidePosition(const PositionTerm& term, const moveit::core::RobotState& state,
+                                           double* distance) const
+{
+  const Eigen::Vector3d pt = state.getGlobalLinkTransform(term.link) * term.offset;
+  // for mobile frames, the point is moved into the frame the regions are expressed in, instead of moving the regions
+  const Eigen::Isometry3d* frame = term.frame_link ? &state.getGlobalLinkTransform(term.frame_link) : nullptr;
+  const Eigen::Vector3d local_pt = frame ? Eigen::Vector3d(frame->inverse() * pt) : pt;
+
+  for (std::size_t i = term.regions_begin; i < term.regions_end; ++i)
+  {
+    const bool result = regions_[i]->containsPoint(local_pt);
+    if (result || i + 1 == term.regions_end)
+    {
+      if (distance)
+        *distance = term.weight * (regions_[i]->getPose().translation() - local_pt).norm();
+      return result;
+    }
+  }
+  return false;
+}
+
+bool CompiledConstraintSet::decideOrientation(const OrientationTerm& term, const moveit::core::RobotState& state,
+                                              double* distance) const
+{
+  const Eigen::Matrix3d& link_rotation = state.getGlobalLinkTransform(term.link).linear();
+  Eigen::Matrix3d diff;
+  if (term.frame_link)
+  {
+    const Eigen::Matrix3d desired = state.getGlobalLinkTransform(term.frame_link).linear() * term.desired_rotation;
+    diff.noalias() = desired.transpose() * link_rotation;
+  }
+  else
+    diff.noalias() = term.desired_rotation_inv * link_rotation;
+
+  const Eigen::Vector3d xyz_rotation = computeOrientationError(diff, term.parameterization_type, term.tolerance.z());
+  if (distance)
+    *distance = term.weight * xyz_rotation.sum();
+  return (xyz_rotation.array() < term.tolerance.array() + std::numeric_limits<double>::epsilon()).all();
+}
+
+ConstraintEvaluationResult CompiledConstraintSet::decide(const moveit::core::RobotState& state) const
+{
+  ConstraintEvaluationResult res(true, 0.0);
+  double distance = 0.0;
+  for (const JointTerm& term : joint_terms_)
+  {
+    res.satisfied = decideJoint(term, state, &distance) && res.satisfied;
+    res.distance += distance;
+  }
+  for (const OrientationTerm& term : orientation_terms_)
+  {
+    res.satisfied = decideOrientation(term, state, &distance) && res.satisfied;
+    res.distance += distance;
+  }
+  for (const PositionTerm& term : position_terms_)
+  {
+    res.satisfied = decidePosition(term, state, &distance) && res.satisfied;
+    res.distance += distance;
+  }
+  for (const KinematicConstraintConstPtr& kinematic_constraint : fallback_)
+  {
+    ConstraintEvaluationResult r = kinematic_constraint->decide(state);
+    res.satisfied = r.satisfied && res.satisfied;
+    res.distance += r.distance;
+  }
+  return res;
+}
+
+bool CompiledConstraintSet::satisfied(const moveit::core::RobotState& state) const
+{
+  // cheapest checks first: joint constraints only need a variable lookup
+  for (const JointTerm& term : joint_terms_)
+  {
+    if (!decideJoint(term, state, nullptr))
+      return false;
+  }
+  for (const OrientationTerm& term : orientation_terms_)
+  {
+    if (!decideOrientation(term, state, nullptr))
+      return false;
+  }
+  for (const PositionTerm& term : position_terms_)
+  {
+    if (!decidePosition(term, state, nullptr))
+      return false;
+  }
+  for (const KinematicConstraintConstPtr& kinematic_constraint : fallback_)
+  {
+    if (!kinematic_constraint->decide(state).satisfied)
+      return false;
+  }
+  return true;
+}
+
+bool CompiledConstraintSet::satisfied(std::size_t state_count,
+                                      const std::function<const moveit::core::RobotState&(std::size_t)>& state_at,
+                                      std::vector<std::size_t>* invalid_index) const
+{
+  if (invalid_index)
+    invalid_index->clear();
+  if (empty())
+    return true;
+
+  bool result = true;
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    if (satisfied(state_at(i)))
+      continue;
+    if (!invalid_index)
+      return false;
+    invalid_index->push_back(i);
+    result = false;
+  }
+  return result;
+}
+
+bool CompiledConstraintSet::satisfied(const std::vector<moveit::core::RobotStatePtr>& states,
+                                      std::vector<std::size_t>* invalid_index) const
+{
+  return satisfied(
+      states.size(), [&states](std::size_t i) -> const moveit::core::RobotState& { return *states[i]; },
+      invalid_index);
+}
+
 }  // end of namespace kinematic_constraints
@@ -934,6 +934,112 @@ TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetEquality)
   EXPECT_TRUE(kcs2.equal(kcs, .1));
 }
 
+TEST_F(LoadPlanningModelsPr2, TestCompiledConstraintSet)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  moveit::core::Transforms tf(robot_model_->getModelFrame());
+
+  moveit_msgs::msg::Constraints constraints;
+
+  moveit_msgs::msg::JointConstraint jcm;
+  jcm.joint_name = "r_forearm_roll_joint";  // continuous
+  jcm.position = 3.0;
+  jcm.tolerance_above = 1.5;
+  jcm.tolerance_below = 1.5;
+  jcm.weight = 1.0;
+  constraints.joint_constraints.push_back(jcm);
+
+  moveit_msgs::msg::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.header.frame_id = "r_wrist_roll_link";  // mobile frame
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::msg::SolidPrimitive::BOX;
+  pcm.constraint_region.primitives[0].dimensions = { 1.0, 1.0, 1.0 };
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.y = 0.6;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  constraints.position_constraints.push_back(pcm);
+
+  pcm.link_name = "r_wrist_roll_link";
+  pcm.header.frame_id = robot_model_->getModelFrame();
+  pcm.target_point_offset.x = 0.1;
+  pcm.constraint_region.primitive_poses[0].position.x = 0.5;
+  pcm.constraint_region.primitive_poses[0].position.y = -0.2;
+  constraints.position_constraints.push_back(pcm);
+
+  moveit_msgs::msg::OrientationConstraint ocm;
+  ocm.link_name = "r_wrist_roll_link";
+  ocm.header.frame_id = robot_model_->getModelFrame();
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = 1.0;
+  ocm.absolute_y_axis_tolerance = 1.0;
+  ocm.absolute_z_axis_tolerance = 1.0;
+  ocm.weight = 1.0;
+  constraints.orientation_constraints.push_back(ocm);
+
+  ocm.link_name = "l_wrist_roll_link";
+  ocm.header.frame_id = "r_wrist_roll_link";
+  ocm.parameterization = moveit_msgs::msg::OrientationConstraint::ROTATION_VECTOR;
+  constraints.orientation_constraints.push_back(ocm);
+
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+  EXPECT_TRUE(kcs.add(constraints, tf));
+
+  kinematic_constraints::CompiledConstraintSet compiled(kcs);
+  EXPECT_FALSE(compiled.empty());
+  EXPECT_EQ(compiled.getFallbackCount(), 0u);
+
+  // the compiled set has to agree with the set it was compiled from
+  random_numbers::RandomNumberGenerator rng(42);
+  std::vector<moveit::core::RobotStatePtr> states;
+  std::size_t satisfied_count = 0;
+  for (int i = 0; i < 500; ++i)
+  {
+    auto state = std::make_shared<moveit::core::RobotState>(robot_model_);
+    state->setToDefaultValues();
+    state->setToRandomPositions(robot_model_->getJointModelGroup("arms"), rng);
+    state->update();
+    states.push_back(state);
+
+    const kinematic_constraints::ConstraintEvaluationResult expected = kcs.decide(*state);
+    const kinematic_constraints::ConstraintEvaluationResult result = compiled.decide(*state);
+    EXPECT_EQ(result.satisfied, expected.satisfied);
+    EXPECT_NEAR(result.distance, expected.distance, 1e-9);
+    EXPECT_EQ(compiled.satisfied(*state), expected.satisfied);
+    if (expected.satisfied)
+      ++satisfied_count;
+  }
+
+  // batch evaluation reports the same violations
+  std::vector<std::size_t> invalid_index;
+  EXPECT_EQ(compiled.satisfied(states, &invalid_index), satisfied_count == states.size());
+  EXPECT_EQ(invalid_index.size(), states.size() - satisfied_count);
+  for (std::size_t index : invalid_index)
+    EXPECT_FALSE(kcs.decide(*states[index]).satisfied);
+  EXPECT_EQ(compiled.satisfied(states), satisfied_count == states.size());
+
+  // visibility constraints are not compiled, but still evaluated
+  moveit_msgs::msg::VisibilityConstraint vcm;
+  vcm.target_radius = .05;
+  vcm.cone_sides = 10;
+  vcm.sensor_view_direction = moveit_msgs::msg::VisibilityConstraint::SENSOR_X;
+  vcm.target_pose.header.frame_id = "l_gripper_r_finger_tip_link";
+  vcm.target_pose.pose.position.y = .2;
+  vcm.target_pose.pose.orientation.w = 1.0;
+  vcm.sensor_pose.header.frame_id = "narrow_stereo_optical_frame";
+  vcm.sensor_pose.pose.position.z = -.1;
+  vcm.sensor_pose.pose.orientation.w = 1.0;
+  vcm.weight = 1.0;
+  kinematic_constraints::KinematicConstraintSet kcs_visibility(robot_model_);
+  EXPECT_TRUE(kcs_visibility.add(std::vector<moveit_msgs::msg::VisibilityConstraint>{ vcm }, tf));
+  kinematic_constraints::CompiledConstraintSet compiled_visibility(kcs_visibility);
+  EXPECT_EQ(compiled_visibility.getFallbackCount(), 1u);
+  EXPECT_EQ(compiled_visibility.satisfied(robot_state), kcs_visibility.decide(robot_state).satisfied);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
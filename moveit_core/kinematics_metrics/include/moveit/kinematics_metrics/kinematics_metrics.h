@@ -37,6 +37,7 @@
 #pragma once
 
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
 
 /** @brief Namespace for kinematics metrics */
 namespace kinematics_metrics
@@ -124,6 +125,23 @@ public:
   bool getManipulability(const moveit::core::RobotState& state, const moveit::core::JointModelGroup* joint_model_group,
                          double& condition_number, bool translation = false) const;
 
+  /**
+   * @brief Get the manipulability index and the manipulability (see getManipulabilityIndex() and
+   * getManipulability()) at every waypoint of a trajectory. Both are computed from one singular value decomposition of
+   * the Jacobian per waypoint, with the workspace of every thread allocated only once.
+   * @param trajectory The trajectory to evaluate
+   * @param joint_model_group A pointer to the desired joint model group
+   * @param manipulability_indices The manipulability index of every waypoint, as computed by getManipulabilityIndex()
+   * @param condition_numbers The manipulability = sigma_min/sigma_max of every waypoint
+   * @param translation Only use the translation part of the Jacobian
+   * @param num_threads Number of threads splitting the waypoints among them. 0 uses the number of hardware threads.
+   * @return False if the group is null or not a chain
+   */
+  bool getTrajectoryManipulability(const robot_trajectory::RobotTrajectory& trajectory,
+                                   const moveit::core::JointModelGroup* joint_model_group,
+                                   std::vector<double>& manipulability_indices, std::vector<double>& condition_numbers,
+                                   bool translation = false, unsigned int num_threads = 1) const;
+
   void setPenaltyMultiplier(double multiplier)
   {
     penalty_multiplier_ = fabs(multiplier);
@@ -36,12 +36,14 @@
 
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
+#include <algorithm>
 #include <limits>
 #include <math.h>
 #include <moveit/kinematics_metrics/kinematics_metrics.h>
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <moveit/utils/logger.hpp>
+#include <moveit/utils/parallel_for.h>
 
 namespace kinematics_metrics
 {
@@ -262,4 +264,63 @@ bool KinematicsMetrics::getManipulability(const moveit::core::RobotState& state,
   return true;
 }
 
+bool KinematicsMetrics::getTrajectoryManipulability(const robot_trajectory::RobotTrajectory& trajectory,
+                                                    const moveit::core::JointModelGroup* joint_model_group,
+                                                    std::vector<double>& manipulability_indices,
+                                                    std::vector<double>& condition_numbers, bool translation,
+                                                    unsigned int num_threads) const
+{
+  // state.getJacobian() only works for chain groups.
+  if (!joint_model_group || !joint_model_group->isChain())
+  {
+    return false;
+  }
+
+  const std::size_t num_waypoints = trajectory.getWayPointCount();
+  manipulability_indices.assign(num_waypoints, 0.0);
+  condition_numbers.assign(num_waypoints, 0.0);
+  if (num_waypoints == 0)
+  {
+    return true;
+  }
+
+  struct Workspace
+  {
+    moveit::core::RobotState state;
+    std::vector<double> positions;
+    Eigen::MatrixXd jacobian;
+    Eigen::JacobiSVD<Eigen::MatrixXd> svdsolver;
+  };
+  const moveit::core::LinkModel* tip = joint_model_group->getLinkModels().back();
+  moveit::core::parallelFor(
+      num_waypoints, num_threads,
+      [&] {
+        // The waypoints are copied into a state owned by this thread, since computing the Jacobian updates the
+        // transforms
+        return Workspace{ trajectory.getWayPoint(0), std::vector<double>(joint_model_group->getVariableCount()),
+                          Eigen::MatrixXd(), Eigen::JacobiSVD<Eigen::MatrixXd>() };
+      },
+      [&](Workspace& workspace, std::size_t i) {
+        trajectory.getWayPoint(i).copyJointGroupPositions(joint_model_group, workspace.positions);
+        workspace.state.setJointGroupPositions(joint_model_group, workspace.positions);
+        workspace.state.getJacobian(joint_model_group, tip, Eigen::Vector3d::Zero(), workspace.jacobian);
+        if (translation)
+        {
+          workspace.jacobian = workspace.jacobian.topRows(3).eval();
+        }
+        workspace.svdsolver.compute(workspace.jacobian);
+
+        // Same as getManipulabilityIndex(): the product of the singular values for groups with fewer than six joints,
+        // sqrt(det(JJ^T)) otherwise
+        const Eigen::VectorXd& singular_values = workspace.svdsolver.singularValues();
+        const double index = workspace.jacobian.cols() < 6 ?
+                                 singular_values.prod() :
+                                 std::sqrt((workspace.jacobian * workspace.jacobian.transpose()).determinant());
+        const double penalty = getJointLimitsPenalty(workspace.state, joint_model_group);
+        manipulability_indices[i] = penalty * index;
+        condition_numbers[i] = penalty * singular_values.minCoeff() / singular_values.maxCoeff();
+      });
+  return true;
+}
+
 }  // end of namespace kinematics_metrics
@@ -0,0 +1,131 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <moveit/kinematics_metrics/kinematics_metrics.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+robot_trajectory::RobotTrajectory createRandomTrajectory(const moveit::core::RobotModelConstPtr& robot_model,
+                                                         const moveit::core::JointModelGroup* group)
+{
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  random_numbers::RandomNumberGenerator rng(42);
+  for (std::size_t i = 0; i < 20; ++i)
+  {
+    state.setToRandomPositions(group, rng);
+    state.update();
+    trajectory.addSuffixWayPoint(state, 0.1);
+  }
+  return trajectory;
+}
+
+// The batch evaluation gives the same results as the per-state functions
+void expectTrajectoryManipulabilityMatchesStates(const moveit::core::RobotModelConstPtr& robot_model,
+                                                 const std::string& group_name)
+{
+  const moveit::core::JointModelGroup* group = robot_model->getJointModelGroup(group_name);
+  ASSERT_NE(group, nullptr);
+  kinematics_metrics::KinematicsMetrics metrics(robot_model);
+  metrics.setPenaltyMultiplier(1.0);
+  const robot_trajectory::RobotTrajectory trajectory = createRandomTrajectory(robot_model, group);
+
+  for (const bool translation : { false, true })
+  {
+    for (const unsigned int num_threads : { 1u, 0u, 3u })
+    {
+      std::vector<double> manipulability_indices, condition_numbers;
+      ASSERT_TRUE(metrics.getTrajectoryManipulability(trajectory, group, manipulability_indices, condition_numbers,
+                                                      translation, num_threads));
+      ASSERT_EQ(manipulability_indices.size(), trajectory.getWayPointCount());
+      ASSERT_EQ(condition_numbers.size(), trajectory.getWayPointCount());
+      for (std::size_t i = 0; i < trajectory.getWayPointCount(); ++i)
+      {
+        double manipulability_index, condition_number;
+        const moveit::core::RobotState& waypoint = trajectory.getWayPoint(i);
+        ASSERT_TRUE(metrics.getManipulabilityIndex(waypoint, group, manipulability_index, translation));
+        ASSERT_TRUE(metrics.getManipulability(waypoint, group, condition_number, translation));
+        EXPECT_NEAR(manipulability_indices[i], manipulability_index,
+                    1e-9 * std::max(1.0, std::abs(manipulability_index)))
+            << "waypoint " << i << ", translation " << translation;
+        EXPECT_NEAR(condition_numbers[i], condition_number, 1e-9)
+            << "waypoint " << i << ", translation " << translation;
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(KinematicsMetrics, TrajectoryManipulabilityMatchesStates)
+{
+  expectTrajectoryManipulabilityMatchesStates(moveit::core::loadTestingRobotModel("panda"), "panda_arm");
+}
+
+TEST(KinematicsMetrics, TrajectoryManipulabilityMatchesStatesForShortChain)
+{
+  // Fewer joints than rows of the Jacobian
+  moveit::core::RobotModelBuilder builder("planar", "a");
+  geometry_msgs::msg::Pose origin;
+  origin.position.x = 0.5;
+  origin.orientation.w = 1.0;
+  builder.addChain("a->b->c->d", "revolute", { origin, origin, origin }, urdf::Vector3(0.0, 0.0, 1.0));
+  builder.addGroupChain("a", "d", "arm");
+  ASSERT_TRUE(builder.isValid());
+  expectTrajectoryManipulabilityMatchesStates(builder.build(), "arm");
+}
+
+TEST(KinematicsMetrics, TrajectoryManipulabilityWithoutGroup)
+{
+  const moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  kinematics_metrics::KinematicsMetrics metrics(robot_model);
+  const robot_trajectory::RobotTrajectory trajectory =
+      createRandomTrajectory(robot_model, robot_model->getJointModelGroup("panda_arm"));
+  std::vector<double> manipulability_indices, condition_numbers;
+  EXPECT_FALSE(metrics.getTrajectoryManipulability(trajectory, nullptr, manipulability_indices, condition_numbers));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
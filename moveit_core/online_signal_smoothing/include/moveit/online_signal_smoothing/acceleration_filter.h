@@ -147,9 +147,12 @@ private:
   Eigen::VectorXd cur_acceleration_;
   Eigen::VectorXd positions_offset_;
   Eigen::VectorXd velocities_offset_;
+  Eigen::VectorXd upper_bound_;
+  Eigen::VectorXd lower_bound_;
   /** \brief Extracted joint limits from robot model */
   Eigen::VectorXd max_acceleration_limits_;
   Eigen::VectorXd min_acceleration_limits_;
+  moveit::core::JointBoundsVector joint_bounds_;
   /** \brief Pointer to robot model */
   moveit::core::RobotModelConstPtr robot_model_;
   /** \brief Constraint matrix for optimization problem */
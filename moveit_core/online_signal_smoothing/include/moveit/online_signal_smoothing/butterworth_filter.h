@@ -40,6 +40,7 @@
 #pragma once
 
 #include <cstddef>
+#include <optional>
 
 #include <moveit_butterworth_filter_parameters.hpp>
 #include <moveit/robot_model/robot_model.h>
@@ -87,6 +88,40 @@ private:
   double feedback_term_;
 };
 
+/**
+ * Class MultiJointButterworthFilter - The filter of ButterworthFilter, applied to all joints at once.
+ * The filter state of all joints is stored in contiguous arrays which are allocated in the constructor, so that
+ * filter() and reset() never allocate and vectorize over the joints.
+ */
+class MultiJointButterworthFilter
+{
+public:
+  /**
+   * Constructor.
+   * @param low_pass_filter_coeff See ButterworthFilter::ButterworthFilter()
+   * @param num_joints Number of joints that are filtered
+   */
+  MultiJointButterworthFilter(double low_pass_filter_coeff, std::size_t num_joints);
+  MultiJointButterworthFilter() = delete;
+
+  /** Filter the new measurements of all joints in place. Returns false if the size does not match. */
+  bool filter(Eigen::Ref<Eigen::VectorXd> new_measurements);
+
+  /** Reset all joints to the given data. Returns false if the size does not match. */
+  bool reset(const Eigen::Ref<const Eigen::VectorXd>& data);
+
+  std::size_t size() const
+  {
+    return previous_measurements_.size();
+  }
+
+private:
+  Eigen::ArrayXd previous_measurements_;
+  Eigen::ArrayXd previous_filtered_measurements_;
+  double scale_term_;
+  double feedback_term_;
+};
+
 // Plugin
 class ButterworthFilterPlugin : public SmoothingBaseClass
 {
@@ -122,7 +157,7 @@ public:
 
 private:
   rclcpp::Node::SharedPtr node_;
-  std::vector<ButterworthFilter> position_filters_;
+  std::optional<MultiJointButterworthFilter> position_filter_;
   size_t num_joints_;
 };
 }  // namespace online_signal_smoothing
@@ -0,0 +1,156 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: applies smoothing by limiting the velocity, acceleration and jerk of consecutive commands.
+The joints follow the commanded positions and velocities with the largest change that respects the jerk limits. Every
+update has a fixed amount of work and does not allocate, so the plugin is suited to servo loops at 1-2 kHz.
+
+Per joint, the position error is predicted for the moment the current acceleration has been ramped down to zero. The
+velocity towards the commands is limited to the velocity that can still be braked within that error, given the
+acceleration and jerk limits. The acceleration towards this velocity is limited in the same way with the jerk limit.
+The resulting jerk is applied for one update period.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include <moveit/online_signal_smoothing/butterworth_filter.h>
+#include <moveit/online_signal_smoothing/smoothing_base_class.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit_jerk_limited_filter_parameters.hpp>
+
+namespace online_signal_smoothing
+{
+/**
+ * Class JerkLimiter - Moves all joints towards their commands within velocity, acceleration and jerk limits.
+ * The state of all joints is stored in contiguous arrays which are allocated in the constructor, so that limit() and
+ * reset() never allocate and vectorize over the joints.
+ */
+class JerkLimiter
+{
+public:
+  /**
+   * Constructor.
+   * @param period Time in seconds between two calls to limit()
+   * @param max_velocity Velocity limit of every joint, may be infinite
+   * @param max_acceleration Acceleration limit of every joint, must be positive
+   * @param max_jerk Jerk limit of every joint, must be positive
+   */
+  JerkLimiter(double period, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+              const Eigen::VectorXd& max_jerk);
+  JerkLimiter() = delete;
+
+  /**
+   * Replace the commands by the next state of the joints. Returns false if the sizes do not match.
+   * @param positions commanded positions in, limited positions out
+   * @param velocities commanded velocities in, limited velocities out
+   * @param accelerations limited accelerations out
+   */
+  bool limit(Eigen::Ref<Eigen::VectorXd> positions, Eigen::Ref<Eigen::VectorXd> velocities,
+             Eigen::Ref<Eigen::VectorXd> accelerations);
+
+  /** Reset the state of all joints. Returns false if the sizes do not match. */
+  bool reset(const Eigen::Ref<const Eigen::VectorXd>& positions, const Eigen::Ref<const Eigen::VectorXd>& velocities,
+             const Eigen::Ref<const Eigen::VectorXd>& accelerations);
+
+  std::size_t size() const
+  {
+    return positions_.size();
+  }
+
+private:
+  double period_;
+  Eigen::ArrayXd max_velocity_;
+  Eigen::ArrayXd max_acceleration_;
+  Eigen::ArrayXd max_jerk_;
+  /** \brief Velocity offset of the braking curve, which accounts for the jerk limited ramps */
+  Eigen::ArrayXd braking_offset_;
+  /** \brief State of the joints */
+  Eigen::ArrayXd positions_;
+  Eigen::ArrayXd velocities_;
+  Eigen::ArrayXd accelerations_;
+  /** \brief Intermediate variables used in calculations */
+  Eigen::ArrayXd ramp_time_;
+  Eigen::ArrayXd position_error_;
+  Eigen::ArrayXd velocity_error_;
+  Eigen::ArrayXd next_accelerations_;
+};
+
+// Plugin
+class JerkLimitedPlugin : public SmoothingBaseClass
+{
+public:
+  /**
+   * Initialize the jerk limited smoothing plugin
+   * @param node ROS node, used for parameter retrieval
+   * @param robot_model used to retrieve the vel/accel/jerk limits
+   * @param num_joints number of actuated joints in the JointGroup Servo controls
+   * @return True if initialization was successful
+   */
+  bool initialize(rclcpp::Node::SharedPtr node, moveit::core::RobotModelConstPtr robot_model,
+                  size_t num_joints) override;
+
+  /**
+   * Smooth the command signals for all DOF. This function limits the velocity, acceleration and jerk using the limits
+   * specified in the robot model.
+   * @param positions array of joint position commands
+   * @param velocities array of joint velocity commands
+   * @param accelerations array of resulting joint accelerations
+   * @return True if smoothing was successful
+   */
+  bool doSmoothing(Eigen::VectorXd& positions, Eigen::VectorXd& velocities, Eigen::VectorXd& accelerations) override;
+
+  /**
+   * Reset to a given joint state. This method must be called before doSmoothing.
+   * @param positions reset the filters to the joint positions
+   * @param velocities reset the filters to the joint velocities
+   * @param accelerations reset the filters to the joint accelerations
+   * @return True if reset was successful
+   */
+  bool reset(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+             const Eigen::VectorXd& accelerations) override;
+
+private:
+  /** \brief Pointer to rclcpp node handle.  */
+  rclcpp::Node::SharedPtr node_;
+  /** \brief Parameters for plugin.  */
+  jerk_limited_filter::Params params_;
+  /** \brief Optional low-pass filters applied to the commands before limiting them */
+  std::optional<MultiJointButterworthFilter> position_filter_;
+  std::optional<MultiJointButterworthFilter> velocity_filter_;
+  std::optional<JerkLimiter> limiter_;
+};
+}  // namespace online_signal_smoothing
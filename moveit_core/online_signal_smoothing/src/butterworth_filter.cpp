@@ -48,22 +48,14 @@ namespace online_signal_smoothing
 namespace
 {
 constexpr double EPSILON = 1e-9;
-}
 
-ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
-  : previous_measurements_{ 0., 0. }
-  , previous_filtered_measurement_(0.)
-  , scale_term_(1. / (1. + low_pass_filter_coeff))
-  , feedback_term_(1. - low_pass_filter_coeff)
+// Throws std::length_error if the filter terms derived from low_pass_filter_coeff make the filter unstable
+void validateFilterTerms(double low_pass_filter_coeff, double scale_term, double feedback_term)
 {
-  // guarantee this doesn't change because the logic below depends on this length implicitly
-  static_assert(ButterworthFilter::FILTER_LENGTH == 2,
-                "online_signal_smoothing::ButterworthFilter::FILTER_LENGTH should be 2");
-
-  if (std::isinf(feedback_term_))
+  if (std::isinf(feedback_term))
     throw std::length_error("online_signal_smoothing::ButterworthFilter: infinite feedback_term_");
 
-  if (std::isinf(scale_term_))
+  if (std::isinf(scale_term))
     throw std::length_error("online_signal_smoothing::ButterworthFilter: infinite scale_term_");
 
   if (low_pass_filter_coeff < 1)
@@ -72,12 +64,26 @@ ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
         "online_signal_smoothing::ButterworthFilter: Filter coefficient < 1. makes the lowpass filter unstable");
   }
 
-  if (std::abs(feedback_term_) < EPSILON)
+  if (std::abs(feedback_term) < EPSILON)
   {
     throw std::length_error(
         "online_signal_smoothing::ButterworthFilter: Filter coefficient value resulted in feedback term of 0");
   }
 }
+}  // namespace
+
+ButterworthFilter::ButterworthFilter(double low_pass_filter_coeff)
+  : previous_measurements_{ 0., 0. }
+  , previous_filtered_measurement_(0.)
+  , scale_term_(1. / (1. + low_pass_filter_coeff))
+  , feedback_term_(1. - low_pass_filter_coeff)
+{
+  // guarantee this doesn't change because the logic below depends on this length implicitly
+  static_assert(ButterworthFilter::FILTER_LENGTH == 2,
+                "online_signal_smoothing::ButterworthFilter::FILTER_LENGTH should be 2");
+
+  validateFilterTerms(low_pass_filter_coeff, scale_term_, feedback_term_);
+}
 
 double ButterworthFilter::filter(double new_measurement)
 {
@@ -98,6 +104,37 @@ void ButterworthFilter::reset(const double data)
   previous_filtered_measurement_ = data;
 }
 
+MultiJointButterworthFilter::MultiJointButterworthFilter(double low_pass_filter_coeff, std::size_t num_joints)
+  : previous_measurements_(Eigen::ArrayXd::Zero(num_joints))
+  , previous_filtered_measurements_(Eigen::ArrayXd::Zero(num_joints))
+  , scale_term_(1. / (1. + low_pass_filter_coeff))
+  , feedback_term_(1. - low_pass_filter_coeff)
+{
+  validateFilterTerms(low_pass_filter_coeff, scale_term_, feedback_term_);
+}
+
+bool MultiJointButterworthFilter::filter(Eigen::Ref<Eigen::VectorXd> new_measurements)
+{
+  if (new_measurements.size() != previous_measurements_.size())
+    return false;
+
+  previous_filtered_measurements_ = scale_term_ * (new_measurements.array() + previous_measurements_ -
+                                                   feedback_term_ * previous_filtered_measurements_);
+  previous_measurements_ = new_measurements.array();
+  new_measurements = previous_filtered_measurements_.matrix();
+  return true;
+}
+
+bool MultiJointButterworthFilter::reset(const Eigen::Ref<const Eigen::VectorXd>& data)
+{
+  if (data.size() != previous_measurements_.size())
+    return false;
+
+  previous_measurements_ = data.array();
+  previous_filtered_measurements_ = data.array();
+  return true;
+}
+
 bool ButterworthFilterPlugin::initialize(rclcpp::Node::SharedPtr node, moveit::core::RobotModelConstPtr /* unused */,
                                          size_t num_joints)
 {
@@ -107,45 +144,32 @@ bool ButterworthFilterPlugin::initialize(rclcpp::Node::SharedPtr node, moveit::c
   online_signal_smoothing::ParamListener param_listener(node_);
   double filter_coeff = param_listener.get_params().butterworth_filter_coeff;
 
-  for (std::size_t i = 0; i < num_joints_; ++i)
-  {
-    position_filters_.emplace_back(filter_coeff);
-  }
+  position_filter_.emplace(filter_coeff, num_joints_);
   return true;
 };
 
 bool ButterworthFilterPlugin::doSmoothing(Eigen::VectorXd& positions, Eigen::VectorXd& /* unused */,
                                           Eigen::VectorXd& /* unused */)
 {
-  const size_t num_positions = positions.size();
-  if (num_positions != position_filters_.size())
+  // Lowpass filter the position command
+  if (!position_filter_ || !position_filter_->filter(positions))
   {
     RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000,
                           "Position vector to be smoothed does not have the right length.");
     return false;
   }
-  for (size_t i = 0; i < num_positions; ++i)
-  {
-    // Lowpass filter the position command
-    positions[i] = position_filters_.at(i).filter(positions[i]);
-  }
   return true;
 };
 
 bool ButterworthFilterPlugin::reset(const Eigen::VectorXd& positions, const Eigen::VectorXd& /* unused */,
                                     const Eigen::VectorXd& /* unused */)
 {
-  const size_t num_positions = positions.size();
-  if (num_positions != position_filters_.size())
+  if (!position_filter_ || !position_filter_->reset(positions))
   {
     RCLCPP_ERROR_THROTTLE(node_->get_logger(), *node_->get_clock(), 1000,
                           "Position vector to be reset does not have the right length.");
     return false;
   }
-  for (size_t joint_idx = 0; joint_idx < num_positions; ++joint_idx)
-  {
-    position_filters_.at(joint_idx).reset(positions[joint_idx]);
-  }
   return true;
 };
 
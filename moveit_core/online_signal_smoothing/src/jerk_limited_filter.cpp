@@ -0,0 +1,261 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/online_signal_smoothing/jerk_limited_filter.h>
+#include <moveit/utils/logger.hpp>
+#include <rclcpp/logging.hpp>
+
+#include <limits>
+#include <stdexcept>
+
+// Disable -Wold-style-cast because all _THROTTLE macros trigger this
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+
+namespace online_signal_smoothing
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.core.jerk_limited_plugin");
+}
+}  // namespace
+
+JerkLimiter::JerkLimiter(double period, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+                         const Eigen::VectorXd& max_jerk)
+  : period_(period)
+  , max_velocity_(max_velocity.array())
+  , max_acceleration_(max_acceleration.array())
+  , max_jerk_(max_jerk.array())
+  , positions_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , velocities_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , accelerations_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , ramp_time_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , position_error_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , velocity_error_(Eigen::ArrayXd::Zero(max_velocity.size()))
+  , next_accelerations_(Eigen::ArrayXd::Zero(max_velocity.size()))
+{
+  if (period_ <= 0.0)
+    throw std::invalid_argument("online_signal_smoothing::JerkLimiter: period must be greater than 0");
+  if (max_acceleration.size() != max_velocity.size() || max_jerk.size() != max_velocity.size())
+    throw std::invalid_argument("online_signal_smoothing::JerkLimiter: limits must have the same size");
+  if ((max_velocity_ <= 0.0).any() || (max_acceleration_ <= 0.0).any() || (max_jerk_ <= 0.0).any() ||
+      !max_acceleration_.allFinite() || !max_jerk_.allFinite())
+    throw std::invalid_argument("online_signal_smoothing::JerkLimiter: limits must be positive and finite");
+
+  // Braking from velocity w with ramps of the acceleration takes w^2 / (2 a) + w * braking_offset / a, where the offset
+  // accounts for the jerk limited ramps and for the discretization of one period
+  braking_offset_ = max_acceleration_.square() / (2.0 * max_jerk_) + max_acceleration_ * (0.5 * period_);
+}
+
+bool JerkLimiter::limit(Eigen::Ref<Eigen::VectorXd> positions, Eigen::Ref<Eigen::VectorXd> velocities,
+                        Eigen::Ref<Eigen::VectorXd> accelerations)
+{
+  const Eigen::Index num_joints = positions_.size();
+  if (positions.size() != num_joints || velocities.size() != num_joints || accelerations.size() != num_joints)
+    return false;
+
+  const double dt = period_;
+  const auto target_positions = positions.array();
+  const auto target_velocities = velocities.array();
+
+  // Position error relative to the commands once the current acceleration is ramped down to zero
+  ramp_time_ = accelerations_.abs() / max_jerk_;
+  position_error_ = target_positions - positions_ - target_velocities * dt -
+                    (velocities_ - target_velocities) * ramp_time_ - accelerations_ * ramp_time_.square() / 2.0 +
+                    accelerations_.sign() * max_jerk_ * ramp_time_.cube() / 6.0;
+
+  // Velocity that reaches the commands in one period, but not faster than the joint can still brake
+  velocity_error_ =
+      (target_velocities +
+       position_error_.sign() *
+           (position_error_.abs() / dt)
+               .min((braking_offset_.square() + 2.0 * max_acceleration_ * position_error_.abs()).sqrt() -
+                    braking_offset_))
+          .max(-max_velocity_)
+          .min(max_velocity_) -
+      velocities_ - accelerations_ * (dt / 2.0);
+
+  // Acceleration towards that velocity, limited in the same way so that the acceleration can be ramped down in time
+  const auto half_jerk_step = max_jerk_ * (dt / 2.0);
+  next_accelerations_ =
+      (velocity_error_.sign() *
+       (velocity_error_.abs() / dt)
+           .min((half_jerk_step.square() + 2.0 * max_jerk_ * velocity_error_.abs()).sqrt() - half_jerk_step))
+          .max(-max_acceleration_)
+          .min(max_acceleration_)
+          .max(accelerations_ - max_jerk_ * dt)
+          .min(accelerations_ + max_jerk_ * dt);
+
+  // Integrate with a constant jerk over the period
+  positions_ += velocities_ * dt + accelerations_ * (dt * dt / 2.0) +
+                (next_accelerations_ - accelerations_) * (dt * dt / 6.0);
+  velocities_ += (accelerations_ + next_accelerations_) * (dt / 2.0);
+  accelerations_ = next_accelerations_;
+
+  positions = positions_.matrix();
+  velocities = velocities_.matrix();
+  accelerations = accelerations_.matrix();
+  return true;
+}
+
+bool JerkLimiter::reset(const Eigen::Ref<const Eigen::VectorXd>& positions,
+                        const Eigen::Ref<const Eigen::VectorXd>& velocities,
+                        const Eigen::Ref<const Eigen::VectorXd>& accelerations)
+{
+  const Eigen::Index num_joints = positions_.size();
+  if (positions.size() != num_joints || velocities.size() != num_joints || accelerations.size() != num_joints)
+    return false;
+
+  positions_ = positions.array();
+  velocities_ = velocities.array();
+  accelerations_ = accelerations.array();
+  return true;
+}
+
+bool JerkLimitedPlugin::initialize(rclcpp::Node::SharedPtr node, moveit::core::RobotModelConstPtr robot_model,
+                                   size_t num_joints)
+{
+  node_ = node;
+  auto param_listener = jerk_limited_filter::ParamListener(node_);
+  params_ = param_listener.get_params();
+
+  // get robot joint limits
+  const moveit::core::JointModelGroup* joint_model_group =
+      robot_model->getJointModelGroup(params_.planning_group_name);
+  if (!joint_model_group)
+  {
+    RCLCPP_ERROR(getLogger(), "Planning group '%s' does not exist.", params_.planning_group_name.c_str());
+    return false;
+  }
+  if (joint_model_group->getActiveVariableCount() != num_joints)
+  {
+    RCLCPP_ERROR(getLogger(), "Planning group '%s' has %u active variables, expected %zu.",
+                 params_.planning_group_name.c_str(), joint_model_group->getActiveVariableCount(), num_joints);
+    return false;
+  }
+
+  Eigen::VectorXd max_velocity(num_joints);
+  Eigen::VectorXd max_acceleration(num_joints);
+  Eigen::VectorXd max_jerk(num_joints);
+  size_t ind = 0;
+  for (const auto& joint_bound : joint_model_group->getActiveJointModelsBounds())
+  {
+    for (const auto& variable_bound : *joint_bound)
+    {
+      if (!variable_bound.acceleration_bounded_ || !variable_bound.jerk_bounded_)
+      {
+        RCLCPP_ERROR(getLogger(), "The robot must have acceleration and jerk joint limits specified for all joints to "
+                                  "use JerkLimitedPlugin.");
+        return false;
+      }
+      max_velocity[ind] = std::numeric_limits<double>::infinity();
+      if (variable_bound.velocity_bounded_)
+      {
+        max_velocity[ind] =
+            std::min(std::fabs(variable_bound.min_velocity_), std::fabs(variable_bound.max_velocity_));
+      }
+      max_acceleration[ind] =
+          std::min(std::fabs(variable_bound.min_acceleration_), std::fabs(variable_bound.max_acceleration_));
+      max_jerk[ind] = std::min(std::fabs(variable_bound.min_jerk_), std::fabs(variable_bound.max_jerk_));
+      ++ind;
+    }
+  }
+
+  try
+  {
+    limiter_.emplace(params_.update_period, max_velocity, max_acceleration, max_jerk);
+    if (params_.butterworth_filter_coeff > 0.0)
+    {
+      position_filter_.emplace(params_.butterworth_filter_coeff, num_joints);
+      velocity_filter_.emplace(params_.butterworth_filter_coeff, num_joints);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    RCLCPP_ERROR(getLogger(), "Failed to initialize JerkLimitedPlugin: %s", e.what());
+    return false;
+  }
+  return true;
+}
+
+bool JerkLimitedPlugin::doSmoothing(Eigen::VectorXd& positions, Eigen::VectorXd& velocities,
+                                    Eigen::VectorXd& accelerations)
+{
+  if (!limiter_)
+  {
+    RCLCPP_ERROR_THROTTLE(getLogger(), *node_->get_clock(), 1000, "JerkLimitedPlugin was not initialized.");
+    return false;
+  }
+  const size_t num_joints = limiter_->size();
+  if (static_cast<size_t>(positions.size()) != num_joints || static_cast<size_t>(velocities.size()) != num_joints ||
+      static_cast<size_t>(accelerations.size()) != num_joints)
+  {
+    RCLCPP_ERROR_THROTTLE(getLogger(), *node_->get_clock(), 1000,
+                          "The length of the joint commands is not equal to the number of joints, expected %zu.",
+                          num_joints);
+    return false;
+  }
+
+  // The same linear filter for positions and velocities keeps them consistent
+  if (position_filter_)
+  {
+    position_filter_->filter(positions);
+    velocity_filter_->filter(velocities);
+  }
+  return limiter_->limit(positions, velocities, accelerations);
+}
+
+bool JerkLimitedPlugin::reset(const Eigen::VectorXd& positions, const Eigen::VectorXd& velocities,
+                              const Eigen::VectorXd& accelerations)
+{
+  if (!limiter_ || !limiter_->reset(positions, velocities, accelerations))
+  {
+    RCLCPP_ERROR(getLogger(), "Failed to reset JerkLimitedPlugin, make sure it was initialized with the number of "
+                              "joints of the state.");
+    return false;
+  }
+  if (position_filter_)
+  {
+    position_filter_->reset(positions);
+    velocity_filter_->reset(velocities);
+  }
+  return true;
+}
+
+}  // namespace online_signal_smoothing
+
+#include <pluginlib/class_list_macros.hpp>
+
+PLUGINLIB_EXPORT_CLASS(online_signal_smoothing::JerkLimitedPlugin, online_signal_smoothing::SmoothingBaseClass)
@@ -71,3 +71,30 @@ TEST(SMOOTHING_PLUGINS, FilterReset)
   // Then check that a different measurement changes the value
   EXPECT_NE(5.0, lpf.filter(100.0));
 }
+
+TEST(SMOOTHING_PLUGINS, MultiJointFilterMatchesSingleJointFilter)
+{
+  online_signal_smoothing::ButterworthFilter lpf(2.0);
+  online_signal_smoothing::MultiJointButterworthFilter multi_lpf(2.0, 3);
+  Eigen::VectorXd values(2);
+  EXPECT_FALSE(multi_lpf.filter(values));
+  EXPECT_FALSE(multi_lpf.reset(Eigen::VectorXd::Zero(4)));
+
+  lpf.reset(1.0);
+  EXPECT_TRUE(multi_lpf.reset(Eigen::VectorXd::Ones(3)));
+  values.resize(3);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    const double measurement = (i % 2 == 0) ? 5.0 : -2.0;
+    values.setConstant(measurement);
+    EXPECT_TRUE(multi_lpf.filter(values));
+    const double expected = lpf.filter(measurement);
+    for (Eigen::Index j = 0; j < values.size(); ++j)
+    {
+      EXPECT_DOUBLE_EQ(expected, values[j]);
+    }
+  }
+
+  // Invalid coefficients are rejected like for the single joint filter
+  EXPECT_THROW(online_signal_smoothing::MultiJointButterworthFilter(0.5, 3), std::length_error);
+}
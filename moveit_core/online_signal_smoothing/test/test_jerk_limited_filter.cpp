@@ -0,0 +1,194 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+#include <moveit/online_signal_smoothing/jerk_limited_filter.h>
+#include <moveit/utils/robot_model_test_utils.h>
+
+constexpr std::string_view PLANNING_GROUP_NAME = "panda_arm";
+constexpr size_t PANDA_NUM_JOINTS = 7u;
+constexpr std::string_view ROBOT_MODEL = "panda";
+
+class JerkLimitedFilterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel(ROBOT_MODEL.data());
+  };
+
+  void setLimits(double acceleration_limit, std::optional<double> jerk_limit)
+  {
+    auto joint_model_group = robot_model_->getJointModelGroup(PLANNING_GROUP_NAME.data());
+    for (auto& joint_model : robot_model_->getJointModels())
+    {
+      if (!joint_model_group->hasJointModel(joint_model->getName()))
+      {
+        continue;
+      }
+      std::vector<moveit_msgs::msg::JointLimits> joint_bounds_msg(joint_model->getVariableBoundsMsg());
+      for (auto& joint_bound : joint_bounds_msg)
+      {
+        joint_bound.has_acceleration_limits = true;
+        joint_bound.max_acceleration = acceleration_limit;
+        joint_bound.has_jerk_limits = jerk_limit.has_value();
+        joint_bound.max_jerk = jerk_limit.value_or(0.0);
+      }
+      joint_model->setVariableBounds(joint_bounds_msg);
+    }
+  }
+
+  rclcpp::Node::SharedPtr makeNode(double update_period)
+  {
+    auto node = std::make_shared<rclcpp::Node>("JerkLimitedFilterTest");
+    node->declare_parameter<std::string>("planning_group_name", PLANNING_GROUP_NAME.data());
+    node->declare_parameter<double>("update_period", update_period);
+    return node;
+  }
+
+protected:
+  moveit::core::RobotModelPtr robot_model_;
+};
+
+TEST_F(JerkLimitedFilterTest, FilterInitialize)
+{
+  online_signal_smoothing::JerkLimitedPlugin filter;
+  rclcpp::Node::SharedPtr node = std::make_shared<rclcpp::Node>("JerkLimitedFilterTest");
+
+  // fail because the update_period parameter is not set
+  EXPECT_THROW(filter.initialize(node, robot_model_, PANDA_NUM_JOINTS),
+               rclcpp::exceptions::ParameterUninitializedException);
+
+  node = makeNode(0.001);
+
+  // fail because the number of joints is wrong
+  setLimits(5.0, 50.0);
+  EXPECT_FALSE(filter.initialize(node, robot_model_, 3u));
+
+  // fail because the robot does not have jerk limits
+  setLimits(5.0, {});
+  EXPECT_FALSE(filter.initialize(node, robot_model_, PANDA_NUM_JOINTS));
+
+  // succeed with acceleration and jerk limits
+  setLimits(5.0, 50.0);
+  EXPECT_TRUE(filter.initialize(node, robot_model_, PANDA_NUM_JOINTS));
+}
+
+TEST_F(JerkLimitedFilterTest, FilterDoSmooth)
+{
+  const double update_period = 0.001;
+  const double acceleration_limit = 5.0;
+  const double jerk_limit = 50.0;
+  online_signal_smoothing::JerkLimitedPlugin filter;
+  rclcpp::Node::SharedPtr node = makeNode(update_period);
+  setLimits(acceleration_limit, jerk_limit);
+  ASSERT_TRUE(filter.initialize(node, robot_model_, PANDA_NUM_JOINTS));
+
+  // fail when called with the wrong number of joints
+  Eigen::VectorXd position = Eigen::VectorXd::Zero(5);
+  Eigen::VectorXd velocity = Eigen::VectorXd::Zero(5);
+  Eigen::VectorXd acceleration = Eigen::VectorXd::Zero(5);
+  EXPECT_FALSE(filter.doSmoothing(position, velocity, acceleration));
+  EXPECT_FALSE(filter.reset(position, velocity, acceleration));
+
+  // a step in the command is followed with limited jerk and acceleration
+  ASSERT_TRUE(filter.reset(Eigen::VectorXd::Zero(PANDA_NUM_JOINTS), Eigen::VectorXd::Zero(PANDA_NUM_JOINTS),
+                           Eigen::VectorXd::Zero(PANDA_NUM_JOINTS)));
+  const double target = 0.3;
+  Eigen::VectorXd previous_acceleration = Eigen::VectorXd::Zero(PANDA_NUM_JOINTS);
+  double max_position = 0.0;
+  for (size_t i = 0; i < 3000; ++i)
+  {
+    position = Eigen::VectorXd::Constant(PANDA_NUM_JOINTS, target);
+    velocity = Eigen::VectorXd::Zero(PANDA_NUM_JOINTS);
+    acceleration = Eigen::VectorXd::Zero(PANDA_NUM_JOINTS);
+    ASSERT_TRUE(filter.doSmoothing(position, velocity, acceleration));
+    EXPECT_LE(acceleration.cwiseAbs().maxCoeff(), acceleration_limit + 1e-9);
+    EXPECT_LE((acceleration - previous_acceleration).cwiseAbs().maxCoeff() / update_period, jerk_limit * (1 + 1e-9));
+    previous_acceleration = acceleration;
+    max_position = std::max(max_position, position.maxCoeff());
+  }
+  // the command is reached without overshoot
+  EXPECT_LT((position.array() - target).matrix().norm(), 1e-6);
+  EXPECT_LT(velocity.norm(), 1e-6);
+  EXPECT_LT(max_position, target + 1e-6);
+}
+
+TEST(JerkLimiterTest, LimitsAreRespected)
+{
+  const size_t num_joints = 3;
+  const double period = 0.001;
+  const Eigen::Vector3d max_velocity(1.0, 2.0, std::numeric_limits<double>::infinity());
+  const Eigen::Vector3d max_acceleration(2.0, 5.0, 10.0);
+  const Eigen::Vector3d max_jerk(20.0, 50.0, 100.0);
+  online_signal_smoothing::JerkLimiter limiter(period, max_velocity, max_acceleration, max_jerk);
+  ASSERT_TRUE(limiter.reset(Eigen::VectorXd::Zero(num_joints), Eigen::VectorXd::Zero(num_joints),
+                            Eigen::VectorXd::Zero(num_joints)));
+
+  // A command which jumps around, and moves with a commanded velocity in between
+  Eigen::VectorXd target_position = Eigen::VectorXd::Zero(num_joints);
+  Eigen::VectorXd target_velocity = Eigen::VectorXd::Zero(num_joints);
+  Eigen::VectorXd position(num_joints), velocity(num_joints), acceleration(num_joints);
+  Eigen::VectorXd previous_acceleration = Eigen::VectorXd::Zero(num_joints);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    if (i % 2000 == 0)
+    {
+      target_position = Eigen::VectorXd::Random(num_joints);
+      target_velocity = (i % 4000 == 0) ? Eigen::VectorXd::Random(num_joints) * 0.2 : Eigen::VectorXd::Zero(num_joints);
+    }
+    target_position += target_velocity * period;
+    position = target_position;
+    velocity = target_velocity;
+    ASSERT_TRUE(limiter.limit(position, velocity, acceleration));
+    for (size_t j = 0; j < num_joints; ++j)
+    {
+      EXPECT_LE(std::abs(velocity[j]), max_velocity[j] * (1 + 1e-3));
+      EXPECT_LE(std::abs(acceleration[j]), max_acceleration[j] + 1e-9);
+      EXPECT_LE(std::abs(acceleration[j] - previous_acceleration[j]) / period, max_jerk[j] * (1 + 1e-9));
+    }
+    previous_acceleration = acceleration;
+  }
+
+  // Invalid limits are rejected
+  EXPECT_THROW(online_signal_smoothing::JerkLimiter(period, max_velocity, Eigen::Vector3d::Zero(), max_jerk),
+               std::invalid_argument);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -44,6 +44,17 @@
 
 namespace planning_interface
 {
+/// \brief Time spent in one stage of a planning pipeline, e.g. a planning adapter or a planner
+struct PlanningStageTiming
+{
+  // Name of the stage
+  std::string stage;
+  // Wall clock time spent in the stage, in seconds
+  double wall_time = 0.0;
+  // CPU time the planning thread spent in the stage, in seconds. Work done by other threads is not included.
+  double cpu_time = 0.0;
+};
+
 /// \brief Response to a planning query
 struct MotionPlanResponse
 {
@@ -64,6 +75,8 @@ struct MotionPlanResponse
   /// The full starting state used for planning
   moveit_msgs::msg::RobotState start_state;
   std::string planner_id;
+  /// Time spent in each stage of the planning pipeline that produced this response, in the order of execution
+  std::vector<PlanningStageTiming> stage_timings;
 
   // \brief Enable checking of query success or failure, for example if(response) ...
   explicit operator bool() const
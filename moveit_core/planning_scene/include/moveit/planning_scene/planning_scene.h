@@ -85,6 +85,20 @@ using ObjectColorMap = std::map<std::string, std_msgs::msg::ColorRGBA>;
 /** \brief A map from object names (e.g., attached bodies, collision objects) to their types */
 using ObjectTypeMap = std::map<std::string, object_recognition_msgs::msg::ObjectType>;
 
+/** \brief Options for checking the motion between consecutive waypoints in PlanningScene::isPathValid().
+    The number of states checked on a segment is chosen so that both limits hold; if both are disabled, only the
+    waypoints are checked. */
+struct PathValidationOptions
+{
+  /** \brief Maximum joint-space distance (as in RobotState::distance()) between checked states. Disabled if <= 0. */
+  double max_joint_step = 0.0;
+
+  /** \brief Maximum displacement of any point on the robot's links between checked states, in meters. This is
+      estimated from the joint motion and the largest distance the link geometry below each moving joint can have from
+      it in any configuration, so it is conservative. Disabled if <= 0. */
+  double max_link_step = 0.0;
+};
+
 /** \brief This class maintains the representation of the
     environment as seen by a planning instance. The environment
     geometry, the robot geometry and state are maintained. */
@@ -300,6 +314,14 @@ public:
   /** \brief Set the allowed collision matrix */
   void setAllowedCollisionMatrix(const collision_detection::AllowedCollisionMatrix& acm);
 
+  /** \brief Get a fingerprint of the collision-relevant state of the scene: the world objects, the allowed collision
+      matrix, link padding and scale, the attached bodies of the current state and the version of the octomap.
+      Scenes with equal content have equal fingerprints; any change to one of these parts changes the fingerprint.
+      Joint values of the current state are not included. The world and the allowed collision matrix maintain their
+      fingerprints incrementally; padding, scale and attached bodies are folded in at call time, which is linear in
+      the number of links and attached bodies but does not depend on the size of the world or the shapes. */
+  uint64_t getFingerprint() const;
+
   /**@}*/
 
   /**
@@ -656,8 +678,12 @@ public:
   /** \brief Fill the message \e scene with the differences between this instance of PlanningScene with respect to the
      parent.
       If there is no parent, everything is considered to be a diff and the function behaves like getPlanningSceneMsg()
-     */
-  void getPlanningSceneDiffMsg(moveit_msgs::msg::PlanningScene& scene) const;
+     *
+      If \e moved_objects_without_geometry is true, objects that were only moved with respect to the parent are sent as
+      MOVE operations without their geometry. Such a diff can only be applied to a scene that already contains the
+      objects, so this is meant for publishers whose subscribers track the full sequence of diffs. */
+  void getPlanningSceneDiffMsg(moveit_msgs::msg::PlanningScene& scene,
+                               bool moved_objects_without_geometry = false) const;
 
   /** \brief Construct a message (\e scene) with all the necessary data so that the scene can be later reconstructed to
      be
@@ -902,6 +928,18 @@ public:
                    const std::vector<moveit_msgs::msg::Constraints>& goal_constraints, const std::string& group = "",
                    bool verbose = false, std::vector<std::size_t>* invalid_index = nullptr) const;
 
+  /** \brief Check if a given path is valid, including the motion between waypoints. Each waypoint is checked for
+   * validity (collision avoidance, feasibility and constraint satisfaction) and that the goal constraints are
+   * satisfied by the last state. Then states interpolated between waypoints are checked at the resolution given by
+   * \e options, coarse samples of all segments first, so that invalid paths are rejected early. If a segment is
+   * invalid, the index of the waypoint it ends at is added to \e invalid_index. Includes descendent links of \e group.
+   */
+  bool isPathValid(const robot_trajectory::RobotTrajectory& trajectory,
+                   const moveit_msgs::msg::Constraints& path_constraints,
+                   const std::vector<moveit_msgs::msg::Constraints>& goal_constraints,
+                   const PathValidationOptions& options, const std::string& group = "", bool verbose = false,
+                   std::vector<std::size_t>* invalid_index = nullptr) const;
+
   /** \brief Check if a given path is valid. Each state is checked for validity (collision avoidance, feasibility and
    * constraint satisfaction). It is also checked that the goal constraints are satisfied by the last state on the
    * passed in trajectory. Includes descendent links of \e group. */
@@ -1031,6 +1069,9 @@ private:
 
   std::optional<collision_detection::AllowedCollisionMatrix> acm_;  // if there is no value use parent's
 
+  // Changes whenever an octomap is processed, as octrees may be updated in place
+  uint64_t octomap_version_ = 0;
+
   StateFeasibilityFn state_feasibility_;
   MotionFeasibilityFn motion_feasibility_;
 
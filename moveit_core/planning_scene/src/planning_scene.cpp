@@ -40,6 +40,7 @@
 #include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
 #include <geometric_shapes/shape_operations.h>
 #include <moveit/collision_detection/collision_tools.h>
+#include <moveit/collision_detection/fingerprint.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/exceptions/exceptions.h>
@@ -49,6 +50,9 @@
 #include <rclcpp/logger.hpp>
 #include <rclcpp/logging.hpp>
 #include <tf2_eigen/tf2_eigen.hpp>
+#include <atomic>
+#include <cmath>
+#include <deque>
 #include <memory>
 #include <set>
 #include <moveit/utils/logger.hpp>
@@ -61,6 +65,151 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.planning_scene");
 }
+
+// Largest translation a joint can add between its parent and child link, according to its position bounds.
+// Unbounded translations are ignored, since they would make every estimate infinite.
+double computeMaxJointTranslation(const moveit::core::JointModel* joint)
+{
+  std::size_t translation_variables = 0;
+  if (joint->getType() == moveit::core::JointModel::PRISMATIC)
+    translation_variables = 1;
+  else if (joint->getType() == moveit::core::JointModel::PLANAR)
+    translation_variables = 2;
+  else if (joint->getType() == moveit::core::JointModel::FLOATING)
+    translation_variables = 3;
+
+  double squared_translation = 0.0;
+  for (std::size_t i = 0; i < translation_variables; ++i)
+  {
+    const moveit::core::VariableBounds& bounds = joint->getVariableBounds()[i];
+    const double max_abs = std::max(std::abs(bounds.min_position_), std::abs(bounds.max_position_));
+    if (std::isfinite(max_abs))
+      squared_translation += max_abs * max_abs;
+  }
+  return std::sqrt(squared_translation);
+}
+
+// For every link (by index), the largest distance from the link's origin of any point on its geometry, on the bodies
+// attached to it in the given state, or on any link below it, for all joint positions. The distances to the links
+// below follow the chain of joint origins, so they do not depend on the configuration.
+std::vector<double> computeLinkReach(const moveit::core::RobotState& state)
+{
+  const std::vector<const moveit::core::LinkModel*>& links = state.getRobotModel()->getLinkModels();
+  std::vector<double> reach(links.size(), 0.0);
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  // parent links come before their children, so the children are done first in reverse order
+  for (auto it = links.rbegin(); it != links.rend(); ++it)
+  {
+    const moveit::core::LinkModel* link = *it;
+    double radius = 0.0;
+    if (!link->getShapes().empty())
+      radius = link->getCenteredBoundingBoxOffset().norm() + 0.5 * link->getShapeExtentsAtOrigin().norm();
+
+    attached_bodies.clear();
+    state.getAttachedBodies(attached_bodies, link);
+    for (const moveit::core::AttachedBody* attached_body : attached_bodies)
+    {
+      const std::vector<shapes::ShapeConstPtr>& shapes = attached_body->getShapes();
+      const EigenSTL::vector_Isometry3d& poses = attached_body->getShapePosesInLinkFrame();
+      for (std::size_t i = 0; i < shapes.size(); ++i)
+      {
+        Eigen::Vector3d center;
+        double shape_radius;
+        shapes::computeShapeBoundingSphere(shapes[i].get(), center, shape_radius);
+        radius = std::max(radius, (poses[i] * center).norm() + shape_radius);
+      }
+    }
+
+    for (const moveit::core::JointModel* child_joint : link->getChildJointModels())
+    {
+      const moveit::core::LinkModel* child_link = child_joint->getChildLinkModel();
+      radius = std::max(radius, child_link->getJointOriginTransform().translation().norm() +
+                                    computeMaxJointTranslation(child_joint) + reach[child_link->getLinkIndex()]);
+    }
+    reach[link->getLinkIndex()] = radius;
+  }
+  return reach;
+}
+
+// Upper bound for the displacement of any point on the links moved by the given joints, between two states.
+// Each joint contributes its motion times the reach of its child link (see computeLinkReach()), as in conservative
+// advancement. The reach holds for all configurations, so it also bounds the lever arm between the two states.
+double estimateMaxLinkDisplacement(const moveit::core::RobotState& from, const moveit::core::RobotState& to,
+                                   const std::vector<const moveit::core::JointModel*>& joints,
+                                   const std::vector<double>& link_reach)
+{
+  double displacement = 0.0;
+  for (const moveit::core::JointModel* joint : joints)
+  {
+    const double joint_distance = from.distance(to, joint);
+    if (joint_distance <= 0.0)
+      continue;
+    if (joint->getType() == moveit::core::JointModel::PRISMATIC)
+    {
+      displacement += joint_distance;
+      continue;
+    }
+
+    const double radius = link_reach[joint->getChildLinkModel()->getLinkIndex()];
+    // the distance of planar and floating joints sums translation and rotation, so their lever arm is at least 1
+    displacement += (joint->getType() == moveit::core::JointModel::REVOLUTE ? radius : std::max(radius, 1.0)) *
+                    joint_distance;
+  }
+  return displacement;
+}
+
+// The order in which the samples 1..count inside a segment are checked: midpoints of ever smaller intervals, so that
+// the segment is covered coarsely first.
+void computeBisectionOrder(std::size_t count, std::vector<std::size_t>& order)
+{
+  order.clear();
+  order.reserve(count);
+  std::deque<std::pair<std::size_t, std::size_t>> intervals{ { 0, count + 1 } };
+  while (!intervals.empty())
+  {
+    const auto [low, high] = intervals.front();
+    intervals.pop_front();
+    if (high - low < 2)
+      continue;
+    const std::size_t mid = (low + high) / 2;
+    order.push_back(mid);
+    intervals.emplace_back(low, mid);
+    intervals.emplace_back(mid, high);
+  }
+}
+
+uint64_t nextOctomapVersion()
+{
+  // global, so versions never repeat between scenes that exchange octomaps through diffs
+  static std::atomic<uint64_t> version{ 0 };
+  return ++version;
+}
+
+bool isSameTransform(const Eigen::Isometry3d& a, const Eigen::Isometry3d& b)
+{
+  return a.matrix() == b.matrix();
+}
+
+// True if the object has the same geometry as the other one, i.e. the same shape instances at the same poses and the
+// same subframes, so that they can only differ in their pose. Shapes are compared by pointer, since they are immutable.
+bool hasSameGeometry(const collision_detection::World::Object& object, const collision_detection::World::Object& other)
+{
+  if (object.shapes_ != other.shapes_ || object.shape_poses_.size() != other.shape_poses_.size() ||
+      object.subframe_poses_.size() != other.subframe_poses_.size())
+    return false;
+  for (std::size_t i = 0; i < object.shape_poses_.size(); ++i)
+  {
+    if (!isSameTransform(object.shape_poses_[i], other.shape_poses_[i]))
+      return false;
+  }
+  for (const auto& [name, pose] : object.subframe_poses_)
+  {
+    const auto it = other.subframe_poses_.find(name);
+    if (it == other.subframe_poses_.end() || !isSameTransform(pose, it->second))
+      return false;
+  }
+  return true;
+}
 }  // namespace
 
 const std::string PlanningScene::OCTOMAP_NS = "<octomap>";
@@ -217,6 +366,7 @@ PlanningScene::PlanningScene(const PlanningSceneConstPtr& parent) : parent_(pare
 
   // record changes to the world
   world_diff_ = std::make_shared<collision_detection::WorldDiff>(world_);
+  octomap_version_ = parent_->octomap_version_;
 
   allocateCollisionDetector(parent_->collision_detector_->alloc_, parent_->collision_detector_);
   collision_detector_->copyPadding(*parent_->collision_detector_);
@@ -318,6 +468,7 @@ void PlanningScene::clearDiffs()
   world_ = std::make_shared<collision_detection::World>(*parent_->world_);
   world_const_ = world_;
   world_diff_ = std::make_shared<collision_detection::WorldDiff>(world_);
+  octomap_version_ = parent_->octomap_version_;
   if (current_world_object_update_callback_)
     current_world_object_update_observer_handle_ = world_->addObserver(current_world_object_update_callback_);
 
@@ -383,6 +534,8 @@ void PlanningScene::pushDiffs(const PlanningScenePtr& scene)
 
         scene->world_->setSubframesOfObject(obj.id_, obj.subframe_poses_);
       }
+      if (it.first == OCTOMAP_NS)
+        scene->octomap_version_ = octomap_version_;
     }
   }
 }
@@ -565,6 +718,38 @@ collision_detection::AllowedCollisionMatrix& PlanningScene::getAllowedCollisionM
   return acm_.value();
 }
 
+uint64_t PlanningScene::getFingerprint() const
+{
+  using collision_detection::combineFingerprint;
+  uint64_t fp = combineFingerprint(getWorld()->getFingerprint(), getAllowedCollisionMatrix().getFingerprint());
+  fp = combineFingerprint(fp, octomap_version_);
+
+  const collision_detection::CollisionEnvConstPtr& cenv = getCollisionEnv();
+  for (const auto& [link_name, padding] : cenv->getLinkPadding())
+    fp = combineFingerprint(combineFingerprint(fp, link_name), padding);
+  for (const auto& [link_name, scale] : cenv->getLinkScale())
+    fp = combineFingerprint(combineFingerprint(fp, link_name), scale);
+
+  // attached bodies are reported in order of their names
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  getCurrentState().getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* body : attached_bodies)
+  {
+    fp = combineFingerprint(combineFingerprint(fp, body->getName()), body->getAttachedLinkName());
+    fp = combineFingerprint(fp, body->getPose());
+    for (std::size_t i = 0; i < body->getShapes().size(); ++i)
+    {
+      fp = combineFingerprint(fp, collision_detection::getShapeFingerprint(body->getShapes()[i]));
+      fp = combineFingerprint(fp, body->getShapePoses()[i]);
+    }
+    for (const std::string& touch_link : body->getTouchLinks())
+      fp = combineFingerprint(fp, touch_link);
+    for (const auto& [subframe_name, subframe_pose] : body->getSubframes())
+      fp = combineFingerprint(combineFingerprint(fp, subframe_name), subframe_pose);
+  }
+  return fp;
+}
+
 void PlanningScene::setAllowedCollisionMatrix(const collision_detection::AllowedCollisionMatrix& acm)
 {
   getAllowedCollisionMatrixNonConst() = acm;
@@ -591,7 +776,8 @@ moveit::core::Transforms& PlanningScene::getTransformsNonConst()
   return *scene_transforms_.value();
 }
 
-void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::msg::PlanningScene& scene_msg) const
+void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::msg::PlanningScene& scene_msg,
+                                           bool moved_objects_without_geometry) const
 {
   scene_msg.name = name_;
   scene_msg.robot_model_name = getRobotModel()->getName();
@@ -671,8 +857,26 @@ void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::msg::PlanningScene& sce
       }
       else
       {
+        // If requested, objects that were only moved are sent as MOVE operations, without their geometry. This avoids
+        // serializing the meshes of objects again and again when they are repositioned.
+        const collision_detection::World::ObjectConstPtr obj = world_->getObject(it.first);
+        const collision_detection::World::ObjectConstPtr parent_obj =
+            parent_ ? parent_->getWorld()->getObject(it.first) : collision_detection::World::ObjectConstPtr();
         scene_msg.world.collision_objects.emplace_back();
-        getCollisionObjectMsg(scene_msg.world.collision_objects.back(), it.first);
+        if (moved_objects_without_geometry && obj && parent_obj && hasSameGeometry(*obj, *parent_obj) &&
+            hasObjectType(it.first) == parent_->hasObjectType(it.first) &&
+            (!hasObjectType(it.first) || getObjectType(it.first) == parent_->getObjectType(it.first)))
+        {
+          moveit_msgs::msg::CollisionObject& co = scene_msg.world.collision_objects.back();
+          co.header.frame_id = getPlanningFrame();
+          co.id = it.first;
+          co.pose = tf2::toMsg(obj->pose_);
+          co.operation = moveit_msgs::msg::CollisionObject::MOVE;
+        }
+        else
+        {
+          getCollisionObjectMsg(scene_msg.world.collision_objects.back(), it.first);
+        }
       }
     }
     if (do_omap)
@@ -1333,6 +1537,7 @@ void PlanningScene::processOctomapMsg(const octomap_msgs::msg::Octomap& map)
 {
   // each octomap replaces any previous one
   world_->removeObject(OCTOMAP_NS);
+  octomap_version_ = nextOctomapVersion();
 
   if (map.data.empty())
     return;
@@ -1373,6 +1578,7 @@ void PlanningScene::processOctomapMsg(const octomap_msgs::msg::OctomapWithPose&
 {
   // each octomap replaces any previous one
   world_->removeObject(OCTOMAP_NS);
+  octomap_version_ = nextOctomapVersion();
 
   if (map.octomap.data.empty())
     return;
@@ -1394,6 +1600,8 @@ void PlanningScene::processOctomapMsg(const octomap_msgs::msg::OctomapWithPose&
 
 void PlanningScene::processOctomapPtr(const std::shared_ptr<const octomap::OcTree>& octree, const Eigen::Isometry3d& t)
 {
+  // the same octree may have been modified in place
+  octomap_version_ = nextOctomapVersion();
   collision_detection::CollisionEnv::ObjectConstPtr map = world_->getObject(OCTOMAP_NS);
   if (map)
   {
@@ -2217,12 +2425,24 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
                                 const moveit_msgs::msg::Constraints& path_constraints,
                                 const std::vector<moveit_msgs::msg::Constraints>& goal_constraints,
                                 const std::string& group, bool verbose, std::vector<std::size_t>* invalid_index) const
+{
+  return isPathValid(trajectory, path_constraints, goal_constraints, PathValidationOptions(), group, verbose,
+                     invalid_index);
+}
+
+bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& trajectory,
+                                const moveit_msgs::msg::Constraints& path_constraints,
+                                const std::vector<moveit_msgs::msg::Constraints>& goal_constraints,
+                                const PathValidationOptions& options, const std::string& group, bool verbose,
+                                std::vector<std::size_t>* invalid_index) const
 {
   bool result = true;
   if (invalid_index)
     invalid_index->clear();
   kinematic_constraints::KinematicConstraintSet ks_p(getRobotModel());
   ks_p.add(path_constraints, getTransforms());
+  // the same path constraints are checked for every waypoint, so resolve them once
+  const kinematic_constraints::CompiledConstraintSet compiled_ks_p(ks_p);
   std::size_t n_wp = trajectory.getWayPointCount();
   for (std::size_t i = 0; i < n_wp; ++i)
   {
@@ -2233,8 +2453,12 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
       this_state_valid = false;
     if (!isStateFeasible(st, verbose))
       this_state_valid = false;
-    if (!ks_p.empty() && !ks_p.decide(st, verbose).satisfied)
+    if (!compiled_ks_p.empty() && !compiled_ks_p.satisfied(st))
+    {
+      if (verbose)
+        ks_p.decide(st, verbose);
       this_state_valid = false;
+    }
 
     if (!this_state_valid)
     {
@@ -2271,6 +2495,75 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
       }
     }
   }
+
+  if (n_wp < 2 || (options.max_joint_step <= 0.0 && options.max_link_step <= 0.0))
+    return result;
+
+  // Decide how many states to check inside each segment
+  const moveit::core::JointModelGroup* jmg = trajectory.getGroup();
+  const std::vector<const moveit::core::JointModel*>& joints =
+      jmg ? jmg->getActiveJointModels() : getRobotModel()->getActiveJointModels();
+  // The bodies attached in the first waypoint are assumed to stay attached along the path
+  const std::vector<double> link_reach =
+      options.max_link_step > 0.0 ? computeLinkReach(trajectory.getWayPoint(0)) : std::vector<double>();
+  std::vector<std::vector<std::size_t>> sample_order(n_wp - 1);
+  std::vector<std::size_t> sample_count(n_wp - 1, 0);
+  std::size_t rounds = 0;
+  for (std::size_t i = 0; i + 1 < n_wp; ++i)
+  {
+    const moveit::core::RobotState& from = trajectory.getWayPoint(i);
+    const moveit::core::RobotState& to = trajectory.getWayPoint(i + 1);
+    double steps = 1.0;
+    if (options.max_joint_step > 0.0)
+      steps = std::max(steps, std::ceil((jmg ? from.distance(to, jmg) : from.distance(to)) / options.max_joint_step));
+    if (options.max_link_step > 0.0)
+      steps = std::max(steps,
+                       std::ceil(estimateMaxLinkDisplacement(from, to, joints, link_reach) / options.max_link_step));
+    sample_count[i] = static_cast<std::size_t>(steps) - 1;
+    computeBisectionOrder(sample_count[i], sample_order[i]);
+    rounds = std::max(rounds, sample_order[i].size());
+  }
+
+  // Check the segments round-robin, so that the coarse samples of the whole path are checked before the fine ones.
+  // Each sample starts from a copy of the segment's first waypoint with up-to-date link transforms. Only the group's
+  // joints are interpolated, so forward kinematics is recomputed for the links below the group's root only.
+  std::vector<bool> segment_valid(n_wp - 1, true);
+  moveit::core::RobotState sample(trajectory.getWayPoint(0));
+  for (std::size_t round = 0; round < rounds; ++round)
+  {
+    for (std::size_t i = 0; i + 1 < n_wp; ++i)
+    {
+      if (round >= sample_order[i].size() || !segment_valid[i])
+        continue;
+
+      const moveit::core::RobotState& from = trajectory.getWayPoint(i);
+      const double t = static_cast<double>(sample_order[i][round]) / static_cast<double>(sample_count[i] + 1);
+      sample = from;
+      if (jmg)
+        from.interpolate(trajectory.getWayPoint(i + 1), t, sample, jmg);
+      else
+        from.interpolate(trajectory.getWayPoint(i + 1), t, sample);
+      sample.update();
+
+      bool sample_valid = !isStateColliding(sample, group, verbose) && isStateFeasible(sample, verbose);
+      if (sample_valid && !compiled_ks_p.empty() && !compiled_ks_p.satisfied(sample))
+      {
+        if (verbose)
+          ks_p.decide(sample, verbose);
+        sample_valid = false;
+      }
+      if (sample_valid)
+        continue;
+
+      if (verbose)
+        RCLCPP_INFO(getLogger(), "Motion between waypoints %zu and %zu is invalid at t = %f", i, i + 1, t);
+      if (!invalid_index)
+        return false;
+      invalid_index->push_back(i + 1);
+      segment_valid[i] = false;
+      result = false;
+    }
+  }
   return result;
 }
 
@@ -40,6 +40,7 @@
 #include <moveit/utils/message_checks.h>
 #include <moveit/utils/robot_model_test_utils.h>
 #include <urdf_parser/urdf_parser.h>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -180,6 +181,107 @@ TEST(PlanningScene, MakeAttachedDiff)
   ps->checkCollision(req, res);
 }
 
+TEST(PlanningScene, MovedObjectDiff)
+{
+  urdf::ModelInterfaceSharedPtr urdf_model = moveit::core::loadModelInterface("pr2");
+  srdf::ModelSharedPtr srdf_model = std::make_shared<srdf::Model>();
+  auto ps = std::make_shared<planning_scene::PlanningScene>(urdf_model, srdf_model);
+
+  Eigen::Isometry3d id = Eigen::Isometry3d::Identity();
+  ps->getWorldNonConst()->addToObject("box", id, std::make_shared<const shapes::Box>(0.1, 0.2, 0.3), id);
+
+  planning_scene::PlanningScenePtr next = ps->diff();
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().x() = 1.0;
+  next->getWorldNonConst()->setObjectPose("box", pose);
+
+  /* by default, a moved object is sent in full */
+  moveit_msgs::msg::PlanningScene diff_msg;
+  next->getPlanningSceneDiffMsg(diff_msg);
+  ASSERT_EQ(diff_msg.world.collision_objects.size(), 1u);
+  EXPECT_EQ(diff_msg.world.collision_objects[0].operation, moveit_msgs::msg::CollisionObject::ADD);
+  EXPECT_EQ(diff_msg.world.collision_objects[0].primitives.size(), 1u);
+
+  /* on request, an object that was only moved in the diff is sent without its geometry */
+  next->getPlanningSceneDiffMsg(diff_msg, true);
+  ASSERT_EQ(diff_msg.world.collision_objects.size(), 1u);
+  EXPECT_EQ(diff_msg.world.collision_objects[0].operation, moveit_msgs::msg::CollisionObject::MOVE);
+  EXPECT_TRUE(diff_msg.world.collision_objects[0].primitives.empty());
+
+  /* applying the diff moves the object */
+  planning_scene::PlanningScenePtr copy = planning_scene::PlanningScene::clone(ps);
+  EXPECT_TRUE(copy->setPlanningSceneDiffMsg(diff_msg));
+  EXPECT_TRUE(copy->getWorld()->getObject("box")->pose_.isApprox(pose));
+
+  /* an object whose geometry changed is sent in full */
+  next->getWorldNonConst()->addToObject("box", std::make_shared<const shapes::Sphere>(0.1), id);
+  next->getPlanningSceneDiffMsg(diff_msg, true);
+  ASSERT_EQ(diff_msg.world.collision_objects.size(), 1u);
+  EXPECT_EQ(diff_msg.world.collision_objects[0].operation, moveit_msgs::msg::CollisionObject::ADD);
+  EXPECT_EQ(diff_msg.world.collision_objects[0].primitives.size(), 2u);
+}
+
+TEST(PlanningScene, Fingerprint)
+{
+  urdf::ModelInterfaceSharedPtr urdf_model = moveit::core::loadModelInterface("pr2");
+  srdf::ModelSharedPtr srdf_model = std::make_shared<srdf::Model>();
+  auto ps = std::make_shared<planning_scene::PlanningScene>(urdf_model, srdf_model);
+  const uint64_t empty = ps->getFingerprint();
+
+  Eigen::Isometry3d id = Eigen::Isometry3d::Identity();
+  ps->getWorldNonConst()->addToObject("box", id, std::make_shared<const shapes::Box>(0.1, 0.2, 0.3), id);
+  ps->getWorldNonConst()->addToObject("sphere", id, std::make_shared<const shapes::Sphere>(0.4), id);
+  const uint64_t initial = ps->getFingerprint();
+  EXPECT_NE(initial, empty);
+
+  /* diffs and clones start out with the same content */
+  planning_scene::PlanningScenePtr next = ps->diff();
+  EXPECT_EQ(next->getFingerprint(), initial);
+  EXPECT_EQ(planning_scene::PlanningScene::clone(ps)->getFingerprint(), initial);
+
+  /* equal content yields equal fingerprints, regardless of order and shape instances */
+  auto other = std::make_shared<planning_scene::PlanningScene>(urdf_model, srdf_model);
+  other->getWorldNonConst()->addToObject("sphere", id, std::make_shared<const shapes::Sphere>(0.4), id);
+  other->getWorldNonConst()->addToObject("box", id, std::make_shared<const shapes::Box>(0.1, 0.2, 0.3), id);
+  EXPECT_EQ(other->getFingerprint(), initial);
+
+  /* every change is reflected, undoing it restores the fingerprint */
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation().x() = 1.0;
+  next->getWorldNonConst()->setObjectPose("box", pose);
+  EXPECT_NE(next->getFingerprint(), initial);
+  next->getWorldNonConst()->setObjectPose("box", id);
+  EXPECT_EQ(next->getFingerprint(), initial);
+
+  next->getWorldNonConst()->removeObject("sphere");
+  EXPECT_NE(next->getFingerprint(), initial);
+  next->getWorldNonConst()->addToObject("sphere", id, std::make_shared<const shapes::Sphere>(0.4), id);
+  EXPECT_EQ(next->getFingerprint(), initial);
+
+  next->getAllowedCollisionMatrixNonConst().setEntry("box", "r_wrist_roll_link", true);
+  EXPECT_NE(next->getFingerprint(), initial);
+  next->getAllowedCollisionMatrixNonConst().removeEntry("box", "r_wrist_roll_link");
+  EXPECT_EQ(next->getFingerprint(), initial);
+
+  const double padding = next->getCollisionEnv()->getLinkPadding("r_wrist_roll_link");
+  next->getCollisionEnvNonConst()->setLinkPadding("r_wrist_roll_link", padding + 0.1);
+  EXPECT_NE(next->getFingerprint(), initial);
+  next->getCollisionEnvNonConst()->setLinkPadding("r_wrist_roll_link", padding);
+  EXPECT_EQ(next->getFingerprint(), initial);
+
+  moveit_msgs::msg::AttachedCollisionObject att_obj;
+  att_obj.link_name = "r_wrist_roll_link";
+  att_obj.object.operation = moveit_msgs::msg::CollisionObject::ADD;
+  att_obj.object.id = "sphere";
+  EXPECT_TRUE(next->processAttachedCollisionObjectMsg(att_obj));
+  const uint64_t attached = next->getFingerprint();
+  EXPECT_NE(attached, initial);
+
+  /* pushing the diff makes the parent match */
+  next->pushDiffs(ps);
+  EXPECT_EQ(ps->getFingerprint(), attached);
+}
+
 TEST(PlanningScene, isStateValid)
 {
   moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
@@ -191,6 +293,151 @@ TEST(PlanningScene, isStateValid)
   }
 }
 
+TEST(PlanningScene, isPathValidBetweenWaypoints)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  // A thin wall in front of the robot, which the arm sweeps through when rotating from one side to the other
+  moveit_msgs::msg::CollisionObject co;
+  co.header.frame_id = "panda_link0";
+  co.id = "wall";
+  co.operation = moveit_msgs::msg::CollisionObject::ADD;
+  co.primitives.push_back([] {
+    shape_msgs::msg::SolidPrimitive primitive;
+    primitive.type = shape_msgs::msg::SolidPrimitive::BOX;
+    primitive.dimensions = { 1.0, 0.1, 1.2 };
+    return primitive;
+  }());
+  co.primitive_poses.push_back(tf2::toMsg(Eigen::Isometry3d(Eigen::Translation3d(0.7, 0.0, 0.9))));
+  ps->processCollisionObjectMsg(co);
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model, "panda_arm");
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.setVariablePosition("panda_joint1", -1.0);
+  state.update();
+  trajectory.addSuffixWayPoint(state, 0.0);
+  state.setVariablePosition("panda_joint1", 1.0);
+  state.update();
+  trajectory.addSuffixWayPoint(state, 1.0);
+
+  // Both waypoints are valid
+  const moveit_msgs::msg::Constraints path_constraints;
+  const std::vector<moveit_msgs::msg::Constraints> goal_constraints;
+  EXPECT_TRUE(ps->isPathValid(trajectory, path_constraints, goal_constraints, "panda_arm"));
+
+  // The motion between them is not
+  planning_scene::PathValidationOptions options;
+  options.max_joint_step = 0.05;
+  std::vector<std::size_t> invalid_index;
+  EXPECT_FALSE(ps->isPathValid(trajectory, path_constraints, goal_constraints, options, "panda_arm", false,
+                               &invalid_index));
+  EXPECT_EQ(invalid_index, std::vector<std::size_t>{ 1 });
+
+  options.max_joint_step = 0.0;
+  options.max_link_step = 0.05;
+  EXPECT_FALSE(ps->isPathValid(trajectory, path_constraints, goal_constraints, options, "panda_arm"));
+}
+
+TEST(PlanningScene, isPathValidBetweenWaypointsWithAttachedBody)
+{
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  // A small body held far away from the first joint, so it moves much further than any link of the robot
+  moveit_msgs::msg::AttachedCollisionObject aco;
+  aco.link_name = "panda_link1";
+  aco.object.header.frame_id = "panda_link1";
+  aco.object.id = "tip";
+  aco.object.operation = moveit_msgs::msg::CollisionObject::ADD;
+  shape_msgs::msg::SolidPrimitive sphere;
+  sphere.type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  sphere.dimensions = { 0.05 };
+  aco.object.primitives.push_back(sphere);
+  aco.object.primitive_poses.push_back(tf2::toMsg(Eigen::Isometry3d(Eigen::Translation3d(10.0, 0.0, 0.0))));
+  ASSERT_TRUE(ps->processAttachedCollisionObjectMsg(aco));
+
+  // An obstacle on the circle the attached body sweeps through
+  moveit::core::RobotState state = ps->getCurrentState();
+  state.setToDefaultValues();
+  state.update();
+  const Eigen::Vector3d link1_origin = state.getGlobalLinkTransform("panda_link1").translation();
+  moveit_msgs::msg::CollisionObject co;
+  co.header.frame_id = "panda_link0";
+  co.id = "obstacle";
+  co.operation = moveit_msgs::msg::CollisionObject::ADD;
+  sphere.dimensions = { 0.1 };
+  co.primitives.push_back(sphere);
+  co.primitive_poses.push_back(tf2::toMsg(Eigen::Isometry3d(
+      Eigen::Translation3d(link1_origin + 10.0 * Eigen::Vector3d(std::cos(0.3), std::sin(0.3), 0.0)))));
+  ps->processCollisionObjectMsg(co);
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model, "panda_arm");
+  state.setVariablePosition("panda_joint1", -1.0);
+  state.update();
+  trajectory.addSuffixWayPoint(state, 0.0);
+  state.setVariablePosition("panda_joint1", 1.0);
+  state.update();
+  trajectory.addSuffixWayPoint(state, 1.0);
+
+  const moveit_msgs::msg::Constraints path_constraints;
+  const std::vector<moveit_msgs::msg::Constraints> goal_constraints;
+  EXPECT_TRUE(ps->isPathValid(trajectory, path_constraints, goal_constraints, "panda_arm"));
+
+  // The step bound accounts for the attached body, so the collision between the waypoints is found
+  planning_scene::PathValidationOptions options;
+  options.max_link_step = 0.05;
+  EXPECT_FALSE(ps->isPathValid(trajectory, path_constraints, goal_constraints, options, "panda_arm"));
+}
+
+TEST(PlanningScene, isPathValidBetweenFoldedWaypoints)
+{
+  // A planar arm with two links of 1m and a small box at its tip
+  moveit::core::RobotModelBuilder builder("planar_arm", "base");
+  geometry_msgs::msg::Pose origin;
+  origin.orientation.w = 1.0;
+  geometry_msgs::msg::Pose tip_origin = origin;
+  tip_origin.position.x = 1.0;
+  builder.addChain("base->upper_arm->forearm", "revolute", { origin, tip_origin }, urdf::Vector3(0.0, 0.0, 1.0));
+  builder.addCollisionBox("forearm", { 0.02, 0.02, 0.02 }, tip_origin);
+  ASSERT_TRUE(builder.isValid());
+  moveit::core::RobotModelPtr robot_model = builder.build();
+  auto ps = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  // The arm is folded at both waypoints and fully extended halfway between them, where it touches a small obstacle
+  moveit_msgs::msg::CollisionObject co;
+  co.header.frame_id = "base";
+  co.id = "obstacle";
+  co.operation = moveit_msgs::msg::CollisionObject::ADD;
+  shape_msgs::msg::SolidPrimitive sphere;
+  sphere.type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  sphere.dimensions = { 0.06 };
+  co.primitives.push_back(sphere);
+  co.primitive_poses.push_back(tf2::toMsg(Eigen::Isometry3d(Eigen::Translation3d(2.0, 0.0, 0.0))));
+  ps->processCollisionObjectMsg(co);
+
+  robot_trajectory::RobotTrajectory trajectory(robot_model);
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.setVariablePositions({ -3.0, -3.0 });
+  state.update();
+  trajectory.addSuffixWayPoint(state, 0.0);
+  state.setVariablePositions({ 3.0, 3.0 });
+  state.update();
+  trajectory.addSuffixWayPoint(state, 1.0);
+
+  const moveit_msgs::msg::Constraints path_constraints;
+  const std::vector<moveit_msgs::msg::Constraints> goal_constraints;
+  EXPECT_TRUE(ps->isPathValid(trajectory, path_constraints, goal_constraints, ""));
+
+  // The step bound uses the lever arm of the extended arm, not the one at the folded waypoints. Otherwise, the tip
+  // would move about 0.25m between the states checked near the obstacle.
+  planning_scene::PathValidationOptions options;
+  options.max_link_step = 0.1;
+  EXPECT_FALSE(ps->isPathValid(trajectory, path_constraints, goal_constraints, options, ""));
+}
+
 TEST(PlanningScene, loadGoodSceneGeometryNewFormat)
 {
   moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("pr2");
@@ -40,8 +40,10 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit_msgs/msg/robot_trajectory.hpp>
 #include <moveit_msgs/msg/robot_state.hpp>
+#include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <optional>
 
 #include <rcl/error_handling.h>
@@ -59,6 +61,16 @@ MOVEIT_CLASS_FORWARD(RobotTrajectory);  // Defines RobotTrajectoryPtr, ConstPtr,
 class RobotTrajectory
 {
 public:
+  /** \brief How the waypoints of a trajectory are stored */
+  enum class StorageMode
+  {
+    /** \brief Every waypoint is a separately allocated RobotState (default) */
+    ROBOT_STATES,
+    /** \brief Positions, velocities and accelerations of the group variables (all variables if no group is set) are
+        stored in one contiguous array per quantity. RobotStates are only created when a waypoint is accessed. */
+    COMPACT
+  };
+
   /** @brief construct a trajectory for the whole robot */
   explicit RobotTrajectory(const moveit::core::RobotModelConstPtr& robot_model);
 
@@ -99,8 +111,49 @@ public:
 
   RobotTrajectory& setGroupName(const std::string& group_name)
   {
+    // the compact arrays are laid out for the variables of the group
+    const StorageMode mode = storage_mode_;
+    setStorageMode(StorageMode::ROBOT_STATES);
     group_ = robot_model_->getJointModelGroup(group_name);
-    return *this;
+    return setStorageMode(mode);
+  }
+
+  /** \brief Change how the waypoints are stored.
+   *
+   *  Switching to COMPACT keeps the positions, velocities and accelerations of the group variables of every waypoint.
+   *  All other variables and the efforts are taken from the first waypoint, so the efforts of the other waypoints are
+   *  lost. The RobotStates of the waypoints are released, which invalidates references returned by getWayPoint()
+   *  before. Switching back to ROBOT_STATES creates a RobotState for every waypoint. */
+  RobotTrajectory& setStorageMode(StorageMode mode);
+
+  StorageMode getStorageMode() const
+  {
+    return storage_mode_;
+  }
+
+  /** \brief Number of values per waypoint in the COMPACT arrays */
+  std::size_t getCompactVariableCount() const
+  {
+    return group_ ? group_->getVariableCount() : robot_model_->getVariableCount();
+  }
+
+  /** \brief In COMPACT mode, the positions of all waypoints, with one column per waypoint. Rows follow the order of
+      the group variables. Returns an empty matrix in ROBOT_STATES mode. */
+  Eigen::Map<const Eigen::MatrixXd> getCompactPositions() const
+  {
+    return compactMatrix(compact_positions_);
+  }
+
+  /** \brief In COMPACT mode, the velocities of all waypoints (zero if no waypoint had velocities) */
+  Eigen::Map<const Eigen::MatrixXd> getCompactVelocities() const
+  {
+    return compactMatrix(compact_velocities_);
+  }
+
+  /** \brief In COMPACT mode, the accelerations of all waypoints (zero if no waypoint had accelerations) */
+  Eigen::Map<const Eigen::MatrixXd> getCompactAccelerations() const
+  {
+    return compactMatrix(compact_accelerations_);
   }
 
   std::size_t getWayPointCount() const
@@ -114,33 +167,41 @@ public:
     return waypoints_.size();
   }
 
+  /** \brief Get a waypoint. In COMPACT mode, the RobotState is created on first access and kept, so the reference
+      stays valid as long as the waypoint is not removed and the storage mode is not changed. */
   const moveit::core::RobotState& getWayPoint(std::size_t index) const
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return *materializeWayPoint(index);
     return *waypoints_[index];
   }
 
   const moveit::core::RobotState& getLastWayPoint() const
   {
-    return *waypoints_.back();
+    return getWayPoint(waypoints_.size() - 1);
   }
 
   const moveit::core::RobotState& getFirstWayPoint() const
   {
-    return *waypoints_.front();
+    return getWayPoint(0);
   }
 
+  /** \brief Get a modifiable waypoint. This switches a COMPACT trajectory back to ROBOT_STATES storage. */
   moveit::core::RobotStatePtr& getWayPointPtr(std::size_t index)
   {
+    setStorageMode(StorageMode::ROBOT_STATES);
     return waypoints_[index];
   }
 
   moveit::core::RobotStatePtr& getLastWayPointPtr()
   {
+    setStorageMode(StorageMode::ROBOT_STATES);
     return waypoints_.back();
   }
 
   moveit::core::RobotStatePtr& getFirstWayPointPtr()
   {
+    setStorageMode(StorageMode::ROBOT_STATES);
     return waypoints_.front();
   }
 
@@ -180,6 +241,17 @@ public:
     return waypoints_.empty();
   }
 
+  /** \brief Replace waypoint \e index by a copy of \e state. Unlike modifying the state returned by getWayPointPtr(),
+      this keeps the storage mode. */
+  RobotTrajectory& setWayPoint(std::size_t index, const moveit::core::RobotState& state)
+  {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return setCompactWayPoint(index, state);
+    waypoints_[index] = std::make_shared<moveit::core::RobotState>(state);
+    waypoints_[index]->update();
+    return *this;
+  }
+
   /**
    * \brief Add a point to the trajectory
    * \param state - current robot state
@@ -187,6 +259,8 @@ public:
    */
   RobotTrajectory& addSuffixWayPoint(const moveit::core::RobotState& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(waypoints_.size(), state, dt);
     return addSuffixWayPoint(std::make_shared<moveit::core::RobotState>(state), dt);
   }
 
@@ -197,6 +271,8 @@ public:
    */
   RobotTrajectory& addSuffixWayPoint(const moveit::core::RobotStatePtr& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(waypoints_.size(), *state, dt);
     state->update();
     waypoints_.push_back(state);
     duration_from_previous_.push_back(dt);
@@ -205,11 +281,15 @@ public:
 
   RobotTrajectory& addPrefixWayPoint(const moveit::core::RobotState& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(0, state, dt);
     return addPrefixWayPoint(std::make_shared<moveit::core::RobotState>(state), dt);
   }
 
   RobotTrajectory& addPrefixWayPoint(const moveit::core::RobotStatePtr& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(0, *state, dt);
     state->update();
     waypoints_.push_front(state);
     duration_from_previous_.push_front(dt);
@@ -218,11 +298,15 @@ public:
 
   RobotTrajectory& insertWayPoint(std::size_t index, const moveit::core::RobotState& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(index, state, dt);
     return insertWayPoint(index, std::make_shared<moveit::core::RobotState>(state), dt);
   }
 
   RobotTrajectory& insertWayPoint(std::size_t index, const moveit::core::RobotStatePtr& state, double dt)
   {
+    if (storage_mode_ == StorageMode::COMPACT)
+      return insertCompactWayPoint(index, *state, dt);
     state->update();
     waypoints_.insert(waypoints_.begin() + index, state);
     duration_from_previous_.insert(duration_from_previous_.begin() + index, dt);
@@ -248,6 +332,7 @@ public:
   {
     waypoints_.clear();
     duration_from_previous_.clear();
+    clearCompactStorage();
     return *this;
   }
 
@@ -287,6 +372,20 @@ public:
                                          const moveit_msgs::msg::RobotState& state,
                                          const moveit_msgs::msg::RobotTrajectory& trajectory);
 
+  /** \brief Write the trajectory into a compact binary buffer, e.g. for logging or caching.
+   *
+   *  The buffer holds the group name, the names of the group variables (all variables if no group is set), the
+   *  durations and, for every waypoint, the positions, velocities and accelerations of these variables. Velocities and
+   *  accelerations are only stored if at least one waypoint has them. Values are stored in native byte order. */
+  void serialize(std::vector<std::uint8_t>& buffer) const;
+
+  /** \brief Replace the content of this trajectory by a buffer written with serialize(). The group of this trajectory
+      is set to the stored group and the storage mode is kept. Variables which are not stored in the buffer are taken
+      from \e reference_state. Returns false and leaves the trajectory unchanged if the buffer is malformed or its
+      variables do not match the robot model. */
+  [[nodiscard]] bool deserialize(const moveit::core::RobotState& reference_state,
+                                 const std::vector<std::uint8_t>& buffer);
+
   RobotTrajectory& reverse();
 
   RobotTrajectory& unwind();
@@ -357,11 +456,13 @@ public:
 
   RobotTrajectory::Iterator begin()
   {
+    setStorageMode(StorageMode::ROBOT_STATES);
     assert(waypoints_.size() == duration_from_previous_.size());
     return Iterator(waypoints_.begin(), duration_from_previous_.begin());
   }
   RobotTrajectory::Iterator end()
   {
+    setStorageMode(StorageMode::ROBOT_STATES);
     assert(waypoints_.size() == duration_from_previous_.size());
     return Iterator(waypoints_.end(), duration_from_previous_.end());
   }
@@ -381,10 +482,82 @@ public:
   void print(std::ostream& out, std::vector<int> variable_indexes = std::vector<int>()) const;
 
 private:
+  /** \brief Return the RobotState for a waypoint of a COMPACT trajectory, creating it if needed. Safe to call from
+      multiple threads concurrently. */
+  moveit::core::RobotStatePtr materializeWayPoint(std::size_t index) const;
+
+  /** \brief Write the COMPACT values of waypoint \e index into \e state */
+  void copyCompactValues(std::size_t index, moveit::core::RobotState& state) const;
+
+  /** \brief Insert a waypoint into the COMPACT arrays */
+  RobotTrajectory& insertCompactWayPoint(std::size_t index, const moveit::core::RobotState& state, double dt);
+
+  /** \brief Overwrite the COMPACT values of waypoint \e index, updating its RobotState if it was created already */
+  RobotTrajectory& setCompactWayPoint(std::size_t index, const moveit::core::RobotState& state);
+
+  /** \brief Insert the values of \e state into the COMPACT arrays, without touching waypoints_ or durations */
+  void insertCompactValues(std::size_t index, const moveit::core::RobotState& state);
+
+  /** \brief Write the values of \e state into the existing COMPACT values of waypoint \e index */
+  void writeCompactValues(std::size_t index, const moveit::core::RobotState& state);
+
+  /** \brief Fill the COMPACT arrays directly from the points of \e trajectory, without creating RobotStates. Returns
+      false without modifying the trajectory if the message cannot be stored this way, e.g. because it contains
+      joints outside of the group, efforts, or the group contains mimic joints. Expects an empty trajectory. */
+  bool setCompactJointTrajectory(const moveit::core::RobotState& reference_state,
+                                 const trajectory_msgs::msg::JointTrajectory& trajectory);
+
+  /** \brief Drop all values stored in the COMPACT arrays */
+  void clearCompactStorage();
+
+  /** \brief Index of the compact array row holding the (first) variable of \e joint */
+  int getCompactVariableIndex(const moveit::core::JointModel* joint) const;
+
+  /** \brief Update the RobotStates created from the COMPACT arrays so far after the arrays were modified. The states
+      are updated in place, so that references returned by getWayPoint() stay valid. */
+  void updateMaterializedWayPoints();
+
+  Eigen::Map<const Eigen::MatrixXd> compactMatrix(const std::vector<double>& values) const
+  {
+    const std::size_t rows = getCompactVariableCount();
+    return Eigen::Map<const Eigen::MatrixXd>(values.data(), rows, rows > 0 ? values.size() / rows : 0);
+  }
+
   moveit::core::RobotModelConstPtr robot_model_;
   const moveit::core::JointModelGroup* group_;
-  std::deque<moveit::core::RobotStatePtr> waypoints_;
+  StorageMode storage_mode_;
+
+  /** \brief A mutex that is not copied along with the trajectory, since copies have their own waypoints_ */
+  struct MaterializeMutex
+  {
+    MaterializeMutex() = default;
+    MaterializeMutex(const MaterializeMutex& /*other*/)
+    {
+    }
+    MaterializeMutex& operator=(const MaterializeMutex& /*other*/)
+    {
+      return *this;
+    }
+    std::mutex mutex;
+  };
+
+  /** \brief The waypoints. In COMPACT mode, entries are null until the waypoint is first accessed. */
+  mutable std::deque<moveit::core::RobotStatePtr> waypoints_;
+
+  /** \brief Protects the creation of waypoints in COMPACT mode, which can happen in const member functions */
+  mutable MaterializeMutex materialize_mutex_;
   std::deque<double> duration_from_previous_;
+
+  /** \brief COMPACT storage: getCompactVariableCount() values per waypoint, waypoints stored one after another */
+  std::vector<double> compact_positions_;
+  std::vector<double> compact_velocities_;
+  std::vector<double> compact_accelerations_;
+  bool compact_has_velocities_;
+  bool compact_has_accelerations_;
+
+  /** \brief COMPACT storage: values of all variables outside the group. Never modified once set, so it can be shared
+      between shallow copies. */
+  moveit::core::RobotStateConstPtr compact_reference_;
 };
 
 /** @brief Operator overload for printing trajectory to a stream */
@@ -42,6 +42,8 @@
 #include <rclcpp/logging.hpp>
 #include <rclcpp/time.hpp>
 #include <tf2_eigen/tf2_eigen.hpp>
+#include <algorithm>
+#include <cstring>
 #include <numeric>
 #include <optional>
 #include <moveit/utils/logger.hpp>
@@ -54,21 +56,126 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.robot_trajectory");
 }
+
+// Resolve the variable index of every joint of a message once, instead of looking up the names for every point
+std::vector<int> getVariableIndices(const moveit::core::RobotModel& robot_model, const std::vector<std::string>& names)
+{
+  std::vector<int> indices;
+  indices.reserve(names.size());
+  for (const std::string& name : names)
+    indices.push_back(static_cast<int>(robot_model.getVariableIndex(name)));
+  return indices;
+}
+
+void setJointTrajectoryPoint(moveit::core::RobotState& state, const std::vector<int>& indices,
+                             const trajectory_msgs::msg::JointTrajectoryPoint& point)
+{
+  for (std::size_t j = 0; j < indices.size(); ++j)
+    state.setVariablePosition(indices[j], point.positions[j]);
+  if (!point.velocities.empty())
+  {
+    for (std::size_t j = 0; j < indices.size(); ++j)
+      state.setVariableVelocity(indices[j], point.velocities[j]);
+  }
+  if (!point.accelerations.empty())
+  {
+    for (std::size_t j = 0; j < indices.size(); ++j)
+      state.setVariableAcceleration(indices[j], point.accelerations[j]);
+  }
+  if (!point.effort.empty())
+  {
+    for (std::size_t j = 0; j < indices.size(); ++j)
+      state.setVariableEffort(indices[j], point.effort[j]);
+  }
+}
+
+// Layout of serialized trajectories, see RobotTrajectory::serialize()
+constexpr std::uint32_t SERIALIZATION_MAGIC = 0x5254564d;  // "MVTR"
+constexpr std::uint32_t SERIALIZATION_VERSION = 1;
+constexpr std::uint32_t SERIALIZED_VELOCITIES = 1;
+constexpr std::uint32_t SERIALIZED_ACCELERATIONS = 2;
+
+template <typename T>
+void appendValues(std::vector<std::uint8_t>& buffer, const T* values, std::size_t count)
+{
+  const auto* bytes = reinterpret_cast<const std::uint8_t*>(values);
+  buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+}
+
+template <typename T>
+void appendValue(std::vector<std::uint8_t>& buffer, const T& value)
+{
+  appendValues(buffer, &value, 1);
+}
+
+void appendString(std::vector<std::uint8_t>& buffer, const std::string& value)
+{
+  appendValue(buffer, static_cast<std::uint32_t>(value.size()));
+  appendValues(buffer, value.data(), value.size());
+}
+
+/** \brief Reads values from a serialized trajectory, failing instead of reading past the end of the buffer */
+class BufferReader
+{
+public:
+  explicit BufferReader(const std::vector<std::uint8_t>& buffer) : buffer_(buffer), offset_(0)
+  {
+  }
+
+  std::size_t remaining() const
+  {
+    return buffer_.size() - offset_;
+  }
+
+  template <typename T>
+  bool readValues(T* values, std::size_t count)
+  {
+    if (count > remaining() / sizeof(T))
+      return false;
+    std::memcpy(values, buffer_.data() + offset_, count * sizeof(T));
+    offset_ += count * sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool readValue(T& value)
+  {
+    return readValues(&value, 1);
+  }
+
+  bool readString(std::string& value)
+  {
+    std::uint32_t size;
+    if (!readValue(size) || size > remaining())
+      return false;
+    value.assign(reinterpret_cast<const char*>(buffer_.data() + offset_), size);
+    offset_ += size;
+    return true;
+  }
+
+private:
+  const std::vector<std::uint8_t>& buffer_;
+  std::size_t offset_;
+};
 }  // namespace
 
 RobotTrajectory::RobotTrajectory(const moveit::core::RobotModelConstPtr& robot_model)
-  : robot_model_(robot_model), group_(nullptr)
+  : RobotTrajectory(robot_model, static_cast<const moveit::core::JointModelGroup*>(nullptr))
 {
 }
 
 RobotTrajectory::RobotTrajectory(const moveit::core::RobotModelConstPtr& robot_model, const std::string& group)
-  : robot_model_(robot_model), group_(group.empty() ? nullptr : robot_model->getJointModelGroup(group))
+  : RobotTrajectory(robot_model, group.empty() ? nullptr : robot_model->getJointModelGroup(group))
 {
 }
 
 RobotTrajectory::RobotTrajectory(const moveit::core::RobotModelConstPtr& robot_model,
                                  const moveit::core::JointModelGroup* group)
-  : robot_model_(robot_model), group_(group)
+  : robot_model_(robot_model)
+  , group_(group)
+  , storage_mode_(StorageMode::ROBOT_STATES)
+  , compact_has_velocities_(false)
+  , compact_has_accelerations_(false)
 {
 }
 
@@ -80,7 +187,8 @@ RobotTrajectory::RobotTrajectory(const RobotTrajectory& other, bool deepcopy)
     waypoints_.clear();
     for (const auto& waypoint : other.waypoints_)
     {
-      waypoints_.emplace_back(std::make_shared<moveit::core::RobotState>(*waypoint));
+      // COMPACT trajectories only hold the waypoints that were accessed so far
+      waypoints_.emplace_back(waypoint ? std::make_shared<moveit::core::RobotState>(*waypoint) : nullptr);
     }
   }
 }
@@ -93,6 +201,155 @@ const std::string& RobotTrajectory::getGroupName() const
   return EMPTY;
 }
 
+RobotTrajectory& RobotTrajectory::setStorageMode(StorageMode mode)
+{
+  if (mode == storage_mode_)
+    return *this;
+
+  if (mode == StorageMode::ROBOT_STATES)
+  {
+    for (std::size_t i = 0; i < waypoints_.size(); ++i)
+      waypoints_[i] = materializeWayPoint(i);
+    storage_mode_ = mode;
+    clearCompactStorage();
+    return *this;
+  }
+
+  const std::size_t count = getCompactVariableCount() * waypoints_.size();
+  compact_positions_.reserve(count);
+  compact_velocities_.reserve(count);
+  compact_accelerations_.reserve(count);
+  for (std::size_t i = 0; i < waypoints_.size(); ++i)
+    insertCompactValues(i, *waypoints_[i]);
+  storage_mode_ = mode;
+  // the RobotStates are recreated from the arrays when they are accessed again
+  std::fill(waypoints_.begin(), waypoints_.end(), nullptr);
+  return *this;
+}
+
+void RobotTrajectory::clearCompactStorage()
+{
+  compact_positions_.clear();
+  compact_velocities_.clear();
+  compact_accelerations_.clear();
+  compact_reference_.reset();
+  compact_has_velocities_ = false;
+  compact_has_accelerations_ = false;
+}
+
+moveit::core::RobotStatePtr RobotTrajectory::materializeWayPoint(std::size_t index) const
+{
+  {
+    std::lock_guard<std::mutex> lock(materialize_mutex_.mutex);
+    if (waypoints_[index])
+      return waypoints_[index];
+  }
+
+  // the state is created without holding the lock, so that different waypoints can be created concurrently
+  auto new_state = std::make_shared<moveit::core::RobotState>(*compact_reference_);
+  copyCompactValues(index, *new_state);
+
+  // another thread may have created the same waypoint in the meantime; in that case, its state is returned
+  std::lock_guard<std::mutex> lock(materialize_mutex_.mutex);
+  if (!waypoints_[index])
+    waypoints_[index] = new_state;
+  return waypoints_[index];
+}
+
+void RobotTrajectory::copyCompactValues(std::size_t index, moveit::core::RobotState& state) const
+{
+  const std::size_t offset = index * getCompactVariableCount();
+  if (group_)
+  {
+    state.setJointGroupPositions(group_, &compact_positions_[offset]);
+    if (compact_has_velocities_)
+      state.setJointGroupVelocities(group_, &compact_velocities_[offset]);
+    if (compact_has_accelerations_)
+      state.setJointGroupAccelerations(group_, &compact_accelerations_[offset]);
+  }
+  else
+  {
+    state.setVariablePositions(&compact_positions_[offset]);
+    if (compact_has_velocities_)
+      state.setVariableVelocities(&compact_velocities_[offset]);
+    if (compact_has_accelerations_)
+      state.setVariableAccelerations(&compact_accelerations_[offset]);
+  }
+  state.update();
+}
+
+RobotTrajectory& RobotTrajectory::insertCompactWayPoint(std::size_t index, const moveit::core::RobotState& state,
+                                                        double dt)
+{
+  insertCompactValues(index, state);
+  waypoints_.insert(waypoints_.begin() + index, nullptr);
+  duration_from_previous_.insert(duration_from_previous_.begin() + index, dt);
+  return *this;
+}
+
+void RobotTrajectory::insertCompactValues(std::size_t index, const moveit::core::RobotState& state)
+{
+  if (!compact_reference_)
+    compact_reference_ = std::make_shared<const moveit::core::RobotState>(state);
+
+  const std::size_t n = getCompactVariableCount();
+  const std::size_t offset = index * n;
+  compact_positions_.insert(compact_positions_.begin() + offset, n, 0.0);
+  compact_velocities_.insert(compact_velocities_.begin() + offset, n, 0.0);
+  compact_accelerations_.insert(compact_accelerations_.begin() + offset, n, 0.0);
+  writeCompactValues(index, state);
+}
+
+RobotTrajectory& RobotTrajectory::setCompactWayPoint(std::size_t index, const moveit::core::RobotState& state)
+{
+  writeCompactValues(index, state);
+  // the state is updated in place, so that references returned by getWayPoint() stay valid
+  if (waypoints_[index])
+    copyCompactValues(index, *waypoints_[index]);
+  return *this;
+}
+
+void RobotTrajectory::writeCompactValues(std::size_t index, const moveit::core::RobotState& state)
+{
+  const std::size_t n = getCompactVariableCount();
+  const std::size_t offset = index * n;
+  // values the state does not have are stored as zero
+  std::fill_n(compact_velocities_.begin() + offset, n, 0.0);
+  std::fill_n(compact_accelerations_.begin() + offset, n, 0.0);
+  if (group_)
+  {
+    state.copyJointGroupPositions(group_, &compact_positions_[offset]);
+    if (state.hasVelocities())
+      state.copyJointGroupVelocities(group_, &compact_velocities_[offset]);
+    if (state.hasAccelerations())
+      state.copyJointGroupAccelerations(group_, &compact_accelerations_[offset]);
+  }
+  else
+  {
+    std::copy_n(state.getVariablePositions(), n, &compact_positions_[offset]);
+    if (state.hasVelocities())
+      std::copy_n(state.getVariableVelocities(), n, &compact_velocities_[offset]);
+    if (state.hasAccelerations())
+      std::copy_n(state.getVariableAccelerations(), n, &compact_accelerations_[offset]);
+  }
+  compact_has_velocities_ |= state.hasVelocities();
+  compact_has_accelerations_ |= state.hasAccelerations();
+}
+
+int RobotTrajectory::getCompactVariableIndex(const moveit::core::JointModel* joint) const
+{
+  return group_ ? group_->getVariableGroupIndex(joint->getVariableNames()[0]) : joint->getFirstVariableIndex();
+}
+
+void RobotTrajectory::updateMaterializedWayPoints()
+{
+  for (std::size_t i = 0; i < waypoints_.size(); ++i)
+  {
+    if (waypoints_[i])
+      copyCompactValues(i, *waypoints_[i]);
+  }
+}
+
 double RobotTrajectory::getDuration() const
 {
   return std::accumulate(duration_from_previous_.begin(), duration_from_previous_.end(), 0.0);
@@ -125,8 +382,15 @@ void RobotTrajectory::swap(RobotTrajectory& other) noexcept
 {
   robot_model_.swap(other.robot_model_);
   std::swap(group_, other.group_);
+  std::swap(storage_mode_, other.storage_mode_);
   waypoints_.swap(other.waypoints_);
   duration_from_previous_.swap(other.duration_from_previous_);
+  compact_positions_.swap(other.compact_positions_);
+  compact_velocities_.swap(other.compact_velocities_);
+  compact_accelerations_.swap(other.compact_accelerations_);
+  std::swap(compact_has_velocities_, other.compact_has_velocities_);
+  std::swap(compact_has_accelerations_, other.compact_has_accelerations_);
+  compact_reference_.swap(other.compact_reference_);
 }
 
 RobotTrajectory& RobotTrajectory::append(const RobotTrajectory& source, double dt, size_t start_index, size_t end_index)
@@ -134,8 +398,42 @@ RobotTrajectory& RobotTrajectory::append(const RobotTrajectory& source, double d
   end_index = std::min(end_index, source.waypoints_.size());
   if (start_index >= end_index)
     return *this;
-  waypoints_.insert(waypoints_.end(), std::next(source.waypoints_.begin(), start_index),
-                    std::next(source.waypoints_.begin(), end_index));
+  if (storage_mode_ == StorageMode::COMPACT && source.storage_mode_ == StorageMode::COMPACT &&
+      robot_model_ == source.robot_model_ && group_ == source.group_)
+  {
+    // same layout, copy the arrays directly
+    const std::size_t n = getCompactVariableCount();
+    const auto append_values = [n, start_index, end_index](std::vector<double>& values,
+                                                           const std::vector<double>& source_values) {
+      values.insert(values.end(), source_values.begin() + start_index * n, source_values.begin() + end_index * n);
+    };
+    append_values(compact_positions_, source.compact_positions_);
+    append_values(compact_velocities_, source.compact_velocities_);
+    append_values(compact_accelerations_, source.compact_accelerations_);
+    compact_has_velocities_ |= source.compact_has_velocities_;
+    compact_has_accelerations_ |= source.compact_has_accelerations_;
+    if (!compact_reference_)
+      compact_reference_ = source.compact_reference_;
+    waypoints_.resize(waypoints_.size() + end_index - start_index);
+  }
+  else if (storage_mode_ == StorageMode::COMPACT)
+  {
+    for (std::size_t i = start_index; i < end_index; ++i)
+    {
+      insertCompactValues(waypoints_.size(), source.getWayPoint(i));
+      waypoints_.push_back(nullptr);
+    }
+  }
+  else if (source.storage_mode_ == StorageMode::COMPACT)
+  {
+    for (std::size_t i = start_index; i < end_index; ++i)
+      waypoints_.push_back(source.materializeWayPoint(i));
+  }
+  else
+  {
+    waypoints_.insert(waypoints_.end(), std::next(source.waypoints_.begin(), start_index),
+                      std::next(source.waypoints_.begin(), end_index));
+  }
   std::size_t index = duration_from_previous_.size();
   duration_from_previous_.insert(duration_from_previous_.end(),
                                  std::next(source.duration_from_previous_.begin(), start_index),
@@ -148,11 +446,31 @@ RobotTrajectory& RobotTrajectory::append(const RobotTrajectory& source, double d
 
 RobotTrajectory& RobotTrajectory::reverse()
 {
+  if (storage_mode_ == StorageMode::COMPACT)
+  {
+    const std::size_t n = getCompactVariableCount();
+    const std::size_t count = waypoints_.size();
+    for (std::vector<double>* values : { &compact_positions_, &compact_velocities_, &compact_accelerations_ })
+    {
+      for (std::size_t i = 0; i < count / 2; ++i)
+        std::swap_ranges(values->begin() + i * n, values->begin() + (i + 1) * n, values->end() - (i + 1) * n);
+    }
+    // reversing the trajectory implies inverting the velocity profile
+    for (double& velocity : compact_velocities_)
+      velocity = -velocity;
+    if (compact_reference_ && compact_reference_->hasVelocities())
+    {
+      auto reference = std::make_shared<moveit::core::RobotState>(*compact_reference_);
+      reference->invertVelocity();
+      compact_reference_ = reference;
+    }
+  }
   std::reverse(waypoints_.begin(), waypoints_.end());
   for (moveit::core::RobotStatePtr& waypoint : waypoints_)
   {
-    // reversing the trajectory implies inverting the velocity profile
-    waypoint->invertVelocity();
+    // reversing the trajectory implies inverting the velocity profile (in COMPACT mode, of the states created so far)
+    if (waypoint)
+      waypoint->invertVelocity();
   }
   if (!duration_from_previous_.empty())
   {
@@ -174,15 +492,27 @@ RobotTrajectory& RobotTrajectory::unwind()
 
   for (const moveit::core::JointModel* cont_joint : cont_joints)
   {
+    // in COMPACT mode, positions are modified directly in the arrays
+    const std::size_t stride = getCompactVariableCount();
+    const int column = storage_mode_ == StorageMode::COMPACT ? getCompactVariableIndex(cont_joint) : -1;
+    const auto get_position = [&](std::size_t j) {
+      return column >= 0 ? compact_positions_[j * stride + column] : waypoints_[j]->getJointPositions(cont_joint)[0];
+    };
+    const auto set_position = [&](std::size_t j, double value) {
+      if (column >= 0)
+        compact_positions_[j * stride + column] = value;
+      else
+        waypoints_[j]->setJointPositions(cont_joint, &value);
+    };
     // unwrap continuous joints
     double running_offset = 0.0;
-    double last_value = waypoints_[0]->getJointPositions(cont_joint)[0];
+    double last_value = get_position(0);
     cont_joint->enforcePositionBounds(&last_value);
-    waypoints_[0]->setJointPositions(cont_joint, &last_value);
+    set_position(0, last_value);
 
     for (std::size_t j = 1; j < waypoints_.size(); ++j)
     {
-      double current_value = waypoints_[j]->getJointPositions(cont_joint)[0];
+      double current_value = get_position(j);
       cont_joint->enforcePositionBounds(&current_value);
       if (last_value > current_value + M_PI)
       {
@@ -195,12 +525,19 @@ RobotTrajectory& RobotTrajectory::unwind()
 
       last_value = current_value;
       current_value += running_offset;
-      waypoints_[j]->setJointPositions(cont_joint, &current_value);
+      set_position(j, current_value);
     }
   }
-  for (moveit::core::RobotStatePtr& waypoint : waypoints_)
+  if (storage_mode_ == StorageMode::COMPACT)
   {
-    waypoint->update();
+    updateMaterializedWayPoints();
+  }
+  else
+  {
+    for (moveit::core::RobotStatePtr& waypoint : waypoints_)
+    {
+      waypoint->update();
+    }
   }
 
   return *this;
@@ -216,6 +553,18 @@ RobotTrajectory& RobotTrajectory::unwind(const moveit::core::RobotState& state)
 
   for (const moveit::core::JointModel* cont_joint : cont_joints)
   {
+    // in COMPACT mode, positions are modified directly in the arrays
+    const std::size_t stride = getCompactVariableCount();
+    const int column = storage_mode_ == StorageMode::COMPACT ? getCompactVariableIndex(cont_joint) : -1;
+    const auto get_position = [&](std::size_t j) {
+      return column >= 0 ? compact_positions_[j * stride + column] : waypoints_[j]->getJointPositions(cont_joint)[0];
+    };
+    const auto set_position = [&](std::size_t j, double value) {
+      if (column >= 0)
+        compact_positions_[j * stride + column] = value;
+      else
+        waypoints_[j]->setJointPositions(cont_joint, &value);
+    };
     double reference_value0 = state.getJointPositions(cont_joint)[0];
     double reference_value = reference_value0;
     cont_joint->enforcePositionBounds(&reference_value);
@@ -223,7 +572,7 @@ RobotTrajectory& RobotTrajectory::unwind(const moveit::core::RobotState& state)
     // unwrap continuous joints
     double running_offset = reference_value0 - reference_value;
 
-    double last_value = waypoints_[0]->getJointPositions(cont_joint)[0];
+    double last_value = get_position(0);
     cont_joint->enforcePositionBounds(&last_value);
     if (last_value > reference_value + M_PI)
     {
@@ -234,11 +583,11 @@ RobotTrajectory& RobotTrajectory::unwind(const moveit::core::RobotState& state)
       running_offset += 2.0 * M_PI;
     }
     double current_start_value = last_value + running_offset;
-    waypoints_[0]->setJointPositions(cont_joint, &current_start_value);
+    set_position(0, current_start_value);
 
     for (std::size_t j = 1; j < waypoints_.size(); ++j)
     {
-      double current_value = waypoints_[j]->getJointPositions(cont_joint)[0];
+      double current_value = get_position(j);
       cont_joint->enforcePositionBounds(&current_value);
       if (last_value > current_value + M_PI)
       {
@@ -251,12 +600,19 @@ RobotTrajectory& RobotTrajectory::unwind(const moveit::core::RobotState& state)
 
       last_value = current_value;
       current_value += running_offset;
-      waypoints_[j]->setJointPositions(cont_joint, &current_value);
+      set_position(j, current_value);
     }
   }
-  for (moveit::core::RobotStatePtr& waypoint : waypoints_)
+  if (storage_mode_ == StorageMode::COMPACT)
   {
-    waypoint->update();
+    updateMaterializedWayPoints();
+  }
+  else
+  {
+    for (moveit::core::RobotStatePtr& waypoint : waypoints_)
+    {
+      waypoint->update();
+    }
   }
 
   return *this;
@@ -309,6 +665,20 @@ void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::msg::RobotTrajectory& t
     trajectory.multi_dof_joint_trajectory.points.resize(waypoints_.size());
   }
 
+  // resolve where the values of every single-variable joint are stored once, so that each point is filled by plain
+  // indexed copies; in COMPACT mode, the values are read directly from the arrays
+  const bool compact = storage_mode_ == StorageMode::COMPACT;
+  const std::size_t stride = getCompactVariableCount();
+  std::vector<int> onedof_indices;
+  onedof_indices.reserve(onedof.size());
+  for (const moveit::core::JointModel* joint : onedof)
+    onedof_indices.push_back(compact ? getCompactVariableIndex(joint) : joint->getFirstVariableIndex());
+  const auto copy_values = [&onedof_indices](const double* values, std::vector<double>& target) {
+    target.resize(onedof_indices.size());
+    for (std::size_t j = 0; j < onedof_indices.size(); ++j)
+      target[j] = values[onedof_indices[j]];
+  };
+
   static const auto ZERO_DURATION = rclcpp::Duration::from_seconds(0);
   double total_time = 0.0;
   for (std::size_t i = 0; i < waypoints_.size(); ++i)
@@ -318,62 +688,45 @@ void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::msg::RobotTrajectory& t
 
     if (!onedof.empty())
     {
-      trajectory.joint_trajectory.points[i].positions.resize(onedof.size());
-      trajectory.joint_trajectory.points[i].velocities.reserve(onedof.size());
-
-      for (std::size_t j = 0; j < onedof.size(); ++j)
+      trajectory_msgs::msg::JointTrajectoryPoint& point = trajectory.joint_trajectory.points[i];
+      if (compact)
       {
-        trajectory.joint_trajectory.points[i].positions[j] =
-            waypoints_[i]->getVariablePosition(onedof[j]->getFirstVariableIndex());
-        // if we have velocities/accelerations/effort, copy those too
-        if (waypoints_[i]->hasVelocities())
-        {
-          trajectory.joint_trajectory.points[i].velocities.push_back(
-              waypoints_[i]->getVariableVelocity(onedof[j]->getFirstVariableIndex()));
-        }
-        if (waypoints_[i]->hasAccelerations())
-        {
-          trajectory.joint_trajectory.points[i].accelerations.push_back(
-              waypoints_[i]->getVariableAcceleration(onedof[j]->getFirstVariableIndex()));
-        }
-        if (waypoints_[i]->hasEffort())
-        {
-          trajectory.joint_trajectory.points[i].effort.push_back(
-              waypoints_[i]->getVariableEffort(onedof[j]->getFirstVariableIndex()));
-        }
-      }
-      // clear velocities if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].velocities.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].velocities.clear();
-      // clear accelerations if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].accelerations.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].accelerations.clear();
-      // clear effort if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].effort.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].effort.clear();
-
-      if (duration_from_previous_.size() > i)
-      {
-        trajectory.joint_trajectory.points[i].time_from_start = rclcpp::Duration::from_seconds(total_time);
+        const std::size_t offset = i * stride;
+        copy_values(&compact_positions_[offset], point.positions);
+        if (compact_has_velocities_)
+          copy_values(&compact_velocities_[offset], point.velocities);
+        if (compact_has_accelerations_)
+          copy_values(&compact_accelerations_[offset], point.accelerations);
       }
       else
       {
-        trajectory.joint_trajectory.points[i].time_from_start = ZERO_DURATION;
+        // if we have velocities/accelerations/effort, copy those too
+        const moveit::core::RobotState& waypoint = *waypoints_[i];
+        copy_values(waypoint.getVariablePositions(), point.positions);
+        if (waypoint.hasVelocities())
+          copy_values(waypoint.getVariableVelocities(), point.velocities);
+        if (waypoint.hasAccelerations())
+          copy_values(waypoint.getVariableAccelerations(), point.accelerations);
+        if (waypoint.hasEffort())
+          copy_values(waypoint.getVariableEffort(), point.effort);
       }
+      point.time_from_start =
+          duration_from_previous_.size() > i ? rclcpp::Duration::from_seconds(total_time) : ZERO_DURATION;
     }
     if (!mdof.empty())
     {
+      const moveit::core::RobotState& waypoint = getWayPoint(i);
       trajectory.multi_dof_joint_trajectory.points[i].transforms.resize(mdof.size());
       for (std::size_t j = 0; j < mdof.size(); ++j)
       {
-        geometry_msgs::msg::TransformStamped ts = tf2::eigenToTransform(waypoints_[i]->getJointTransform(mdof[j]));
+        geometry_msgs::msg::TransformStamped ts = tf2::eigenToTransform(waypoint.getJointTransform(mdof[j]));
         trajectory.multi_dof_joint_trajectory.points[i].transforms[j] = ts.transform;
         // TODO: currently only checking for planar multi DOF joints / need to add check for floating
-        if (waypoints_[i]->hasVelocities() && (mdof[j]->getType() == moveit::core::JointModel::JointType::PLANAR))
+        if (waypoint.hasVelocities() && (mdof[j]->getType() == moveit::core::JointModel::JointType::PLANAR))
         {
           const std::vector<std::string> names = mdof[j]->getVariableNames();
-          const double* velocities = waypoints_[i]->getJointVelocities(mdof[j]);
-          const double* accelerations = waypoints_[i]->getJointAccelerations(mdof[j]);
+          const double* velocities = waypoint.getJointVelocities(mdof[j]);
+          const double* accelerations = waypoint.getJointAccelerations(mdof[j]);
 
           geometry_msgs::msg::Twist point_velocity;
           geometry_msgs::msg::Twist point_acceleration;
@@ -423,6 +776,10 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   // make a copy just in case the next clear() removes the memory for the reference passed in
   const moveit::core::RobotState copy(reference_state);  // NOLINT(performance-unnecessary-copy-initialization)
   clear();
+  if (storage_mode_ == StorageMode::COMPACT && setCompactJointTrajectory(copy, trajectory))
+    return *this;
+
+  const std::vector<int> indices = getVariableIndices(*robot_model_, trajectory.joint_names);
   std::size_t state_count = trajectory.points.size();
   rclcpp::Time last_time_stamp = trajectory.header.stamp;
   rclcpp::Time this_time_stamp = last_time_stamp;
@@ -431,13 +788,7 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   {
     this_time_stamp = rclcpp::Time(trajectory.header.stamp) + trajectory.points[i].time_from_start;
     auto st = std::make_shared<moveit::core::RobotState>(copy);
-    st->setVariablePositions(trajectory.joint_names, trajectory.points[i].positions);
-    if (!trajectory.points[i].velocities.empty())
-      st->setVariableVelocities(trajectory.joint_names, trajectory.points[i].velocities);
-    if (!trajectory.points[i].accelerations.empty())
-      st->setVariableAccelerations(trajectory.joint_names, trajectory.points[i].accelerations);
-    if (!trajectory.points[i].effort.empty())
-      st->setVariableEffort(trajectory.joint_names, trajectory.points[i].effort);
+    setJointTrajectoryPoint(*st, indices, trajectory.points[i]);
     addSuffixWayPoint(st, (this_time_stamp - last_time_stamp).seconds());
     last_time_stamp = this_time_stamp;
   }
@@ -451,7 +802,11 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   // make a copy just in case the next clear() removes the memory for the reference passed in
   const moveit::core::RobotState& copy = reference_state;
   clear();
+  if (storage_mode_ == StorageMode::COMPACT && trajectory.multi_dof_joint_trajectory.points.empty() &&
+      setCompactJointTrajectory(copy, trajectory.joint_trajectory))
+    return *this;
 
+  const std::vector<int> indices = getVariableIndices(*robot_model_, trajectory.joint_trajectory.joint_names);
   std::size_t state_count =
       std::max(trajectory.joint_trajectory.points.size(), trajectory.multi_dof_joint_trajectory.points.size());
   rclcpp::Time last_time_stamp = trajectory.joint_trajectory.points.empty() ?
@@ -464,19 +819,7 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
     auto st = std::make_shared<moveit::core::RobotState>(copy);
     if (trajectory.joint_trajectory.points.size() > i)
     {
-      st->setVariablePositions(trajectory.joint_trajectory.joint_names, trajectory.joint_trajectory.points[i].positions);
-      if (!trajectory.joint_trajectory.points[i].velocities.empty())
-      {
-        st->setVariableVelocities(trajectory.joint_trajectory.joint_names,
-                                  trajectory.joint_trajectory.points[i].velocities);
-      }
-      if (!trajectory.joint_trajectory.points[i].accelerations.empty())
-      {
-        st->setVariableAccelerations(trajectory.joint_trajectory.joint_names,
-                                     trajectory.joint_trajectory.points[i].accelerations);
-      }
-      if (!trajectory.joint_trajectory.points[i].effort.empty())
-        st->setVariableEffort(trajectory.joint_trajectory.joint_names, trajectory.joint_trajectory.points[i].effort);
+      setJointTrajectoryPoint(*st, indices, trajectory.joint_trajectory.points[i]);
       this_time_stamp = rclcpp::Time(trajectory.joint_trajectory.header.stamp) +
                         trajectory.joint_trajectory.points[i].time_from_start;
     }
@@ -506,6 +849,270 @@ RobotTrajectory& RobotTrajectory::setRobotTrajectoryMsg(const moveit::core::Robo
   return setRobotTrajectoryMsg(st, trajectory);
 }
 
+bool RobotTrajectory::setCompactJointTrajectory(const moveit::core::RobotState& reference_state,
+                                                const trajectory_msgs::msg::JointTrajectory& trajectory)
+{
+  // mimic joints would have to be updated for every point, so those groups take the path through RobotStates
+  if (!(group_ ? group_->getMimicJointModels() : robot_model_->getMimicJointModels()).empty())
+    return false;
+
+  std::vector<int> columns;
+  columns.reserve(trajectory.joint_names.size());
+  for (const std::string& name : trajectory.joint_names)
+  {
+    if (!robot_model_->hasJointModel(name) || (group_ && !group_->hasJointModel(name)))
+      return false;
+    const moveit::core::JointModel* joint = robot_model_->getJointModel(name);
+    if (joint->getVariableCount() != 1)
+      return false;
+    columns.push_back(getCompactVariableIndex(joint));
+  }
+
+  bool has_velocities = reference_state.hasVelocities();
+  bool has_accelerations = reference_state.hasAccelerations();
+  for (const trajectory_msgs::msg::JointTrajectoryPoint& point : trajectory.points)
+  {
+    if (point.positions.size() != columns.size() || !point.effort.empty() ||
+        (!point.velocities.empty() && point.velocities.size() != columns.size()) ||
+        (!point.accelerations.empty() && point.accelerations.size() != columns.size()))
+      return false;
+    has_velocities |= !point.velocities.empty();
+    has_accelerations |= !point.accelerations.empty();
+  }
+
+  // every point starts from the values of the reference state, like the RobotStates created otherwise
+  const std::size_t n = getCompactVariableCount();
+  std::vector<double> reference_positions(n);
+  std::vector<double> reference_velocities(n, 0.0);
+  std::vector<double> reference_accelerations(n, 0.0);
+  if (group_)
+  {
+    reference_state.copyJointGroupPositions(group_, reference_positions.data());
+    if (reference_state.hasVelocities())
+      reference_state.copyJointGroupVelocities(group_, reference_velocities.data());
+    if (reference_state.hasAccelerations())
+      reference_state.copyJointGroupAccelerations(group_, reference_accelerations.data());
+  }
+  else
+  {
+    std::copy_n(reference_state.getVariablePositions(), n, reference_positions.begin());
+    if (reference_state.hasVelocities())
+      std::copy_n(reference_state.getVariableVelocities(), n, reference_velocities.begin());
+    if (reference_state.hasAccelerations())
+      std::copy_n(reference_state.getVariableAccelerations(), n, reference_accelerations.begin());
+  }
+
+  const auto fill_block = [&columns](const std::vector<double>& reference, const std::vector<double>& values,
+                                     double* block) {
+    std::copy(reference.begin(), reference.end(), block);
+    for (std::size_t j = 0; j < values.size(); ++j)
+      block[columns[j]] = values[j];
+  };
+
+  const std::size_t state_count = trajectory.points.size();
+  compact_reference_ = std::make_shared<const moveit::core::RobotState>(reference_state);
+  compact_positions_.resize(state_count * n);
+  compact_velocities_.resize(state_count * n);
+  compact_accelerations_.resize(state_count * n);
+  compact_has_velocities_ = has_velocities;
+  compact_has_accelerations_ = has_accelerations;
+
+  rclcpp::Time last_time_stamp = trajectory.header.stamp;
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    const trajectory_msgs::msg::JointTrajectoryPoint& point = trajectory.points[i];
+    fill_block(reference_positions, point.positions, &compact_positions_[i * n]);
+    fill_block(reference_velocities, point.velocities, &compact_velocities_[i * n]);
+    fill_block(reference_accelerations, point.accelerations, &compact_accelerations_[i * n]);
+
+    const rclcpp::Time this_time_stamp = rclcpp::Time(trajectory.header.stamp) + point.time_from_start;
+    duration_from_previous_.push_back((this_time_stamp - last_time_stamp).seconds());
+    last_time_stamp = this_time_stamp;
+  }
+  waypoints_.resize(state_count);
+  return true;
+}
+
+void RobotTrajectory::serialize(std::vector<std::uint8_t>& buffer) const
+{
+  const std::size_t n = getCompactVariableCount();
+  const std::size_t state_count = waypoints_.size();
+  const bool compact = storage_mode_ == StorageMode::COMPACT;
+  const bool has_velocities =
+      compact ? compact_has_velocities_ :
+                std::any_of(waypoints_.begin(), waypoints_.end(),
+                            [](const moveit::core::RobotStatePtr& waypoint) { return waypoint->hasVelocities(); });
+  const bool has_accelerations =
+      compact ? compact_has_accelerations_ :
+                std::any_of(waypoints_.begin(), waypoints_.end(),
+                            [](const moveit::core::RobotStatePtr& waypoint) { return waypoint->hasAccelerations(); });
+  const std::vector<std::string>& names = group_ ? group_->getVariableNames() : robot_model_->getVariableNames();
+
+  buffer.clear();
+  buffer.reserve(64 + n * 32 + state_count * sizeof(double) * (1 + 3 * n));
+  appendValue(buffer, SERIALIZATION_MAGIC);
+  appendValue(buffer, SERIALIZATION_VERSION);
+  const std::uint32_t flags =
+      (has_velocities ? SERIALIZED_VELOCITIES : 0u) | (has_accelerations ? SERIALIZED_ACCELERATIONS : 0u);
+  appendValue(buffer, flags);
+  appendString(buffer, getGroupName());
+  appendValue(buffer, static_cast<std::uint32_t>(n));
+  for (const std::string& name : names)
+    appendString(buffer, name);
+  appendValue(buffer, static_cast<std::uint64_t>(state_count));
+  for (std::size_t i = 0; i < state_count; ++i)
+    appendValue(buffer, getWayPointDurationFromPrevious(i));
+
+  if (compact)
+  {
+    appendValues(buffer, compact_positions_.data(), compact_positions_.size());
+    if (has_velocities)
+      appendValues(buffer, compact_velocities_.data(), compact_velocities_.size());
+    if (has_accelerations)
+      appendValues(buffer, compact_accelerations_.data(), compact_accelerations_.size());
+    return;
+  }
+
+  // waypoints without velocities or accelerations are stored with zeros
+  const std::vector<double> zeros(robot_model_->getVariableCount(), 0.0);
+  std::vector<double> values(n);
+  const auto append_block = [&](const double* state_values) {
+    if (group_)
+    {
+      const std::vector<int>& indices = group_->getVariableIndexList();
+      for (std::size_t k = 0; k < n; ++k)
+        values[k] = state_values[indices[k]];
+    }
+    else
+      std::copy_n(state_values, n, values.begin());
+    appendValues(buffer, values.data(), n);
+  };
+  for (std::size_t i = 0; i < state_count; ++i)
+    append_block(getWayPoint(i).getVariablePositions());
+  if (has_velocities)
+  {
+    for (std::size_t i = 0; i < state_count; ++i)
+    {
+      const moveit::core::RobotState& waypoint = getWayPoint(i);
+      append_block(waypoint.hasVelocities() ? waypoint.getVariableVelocities() : zeros.data());
+    }
+  }
+  if (has_accelerations)
+  {
+    for (std::size_t i = 0; i < state_count; ++i)
+    {
+      const moveit::core::RobotState& waypoint = getWayPoint(i);
+      append_block(waypoint.hasAccelerations() ? waypoint.getVariableAccelerations() : zeros.data());
+    }
+  }
+}
+
+bool RobotTrajectory::deserialize(const moveit::core::RobotState& reference_state,
+                                  const std::vector<std::uint8_t>& buffer)
+{
+  BufferReader reader(buffer);
+  std::uint32_t magic = 0;
+  std::uint32_t version = 0;
+  std::uint32_t flags = 0;
+  if (!reader.readValue(magic) || magic != SERIALIZATION_MAGIC || !reader.readValue(version) ||
+      version != SERIALIZATION_VERSION || !reader.readValue(flags))
+  {
+    RCLCPP_ERROR(getLogger(), "Buffer does not contain a serialized trajectory of version %u", SERIALIZATION_VERSION);
+    return false;
+  }
+
+  std::string group_name;
+  std::uint32_t variable_count = 0;
+  if (!reader.readString(group_name) || !reader.readValue(variable_count))
+  {
+    RCLCPP_ERROR(getLogger(), "Serialized trajectory is truncated");
+    return false;
+  }
+  if (!group_name.empty() && !robot_model_->hasJointModelGroup(group_name))
+  {
+    RCLCPP_ERROR(getLogger(), "Serialized trajectory refers to unknown group '%s'", group_name.c_str());
+    return false;
+  }
+  const moveit::core::JointModelGroup* group =
+      group_name.empty() ? nullptr : robot_model_->getJointModelGroup(group_name);
+  const std::vector<std::string>& names = group ? group->getVariableNames() : robot_model_->getVariableNames();
+  bool names_match = variable_count == names.size();
+  std::string name;
+  for (std::size_t k = 0; names_match && k < names.size(); ++k)
+    names_match = reader.readString(name) && name == names[k];
+  if (!names_match)
+  {
+    RCLCPP_ERROR(getLogger(), "Variables of the serialized trajectory do not match robot model '%s'",
+                 robot_model_->getName().c_str());
+    return false;
+  }
+
+  // check the size of the remaining data before allocating anything for it
+  std::uint64_t state_count = 0;
+  const std::size_t blocks =
+      1 + ((flags & SERIALIZED_VELOCITIES) ? 1 : 0) + ((flags & SERIALIZED_ACCELERATIONS) ? 1 : 0);
+  const std::size_t values_per_state = 1 + blocks * variable_count;
+  if (!reader.readValue(state_count) || state_count > reader.remaining() / (sizeof(double) * values_per_state) ||
+      reader.remaining() != state_count * sizeof(double) * values_per_state)
+  {
+    RCLCPP_ERROR(getLogger(), "Serialized trajectory has an unexpected size");
+    return false;
+  }
+
+  const std::size_t n = variable_count;
+  std::vector<double> durations(state_count);
+  std::vector<double> positions(state_count * n);
+  std::vector<double> velocities((flags & SERIALIZED_VELOCITIES) ? state_count * n : 0);
+  std::vector<double> accelerations((flags & SERIALIZED_ACCELERATIONS) ? state_count * n : 0);
+  reader.readValues(durations.data(), durations.size());
+  reader.readValues(positions.data(), positions.size());
+  reader.readValues(velocities.data(), velocities.size());
+  reader.readValues(accelerations.data(), accelerations.size());
+
+  // the reference state may be a waypoint of this trajectory
+  const moveit::core::RobotState reference(reference_state);
+  clear();
+  group_ = group;
+
+  if (storage_mode_ == StorageMode::COMPACT)
+  {
+    compact_reference_ = std::make_shared<const moveit::core::RobotState>(reference);
+    compact_positions_ = std::move(positions);
+    compact_has_velocities_ = !velocities.empty();
+    compact_has_accelerations_ = !accelerations.empty();
+    compact_velocities_ = compact_has_velocities_ ? std::move(velocities) : std::vector<double>(state_count * n, 0.0);
+    compact_accelerations_ =
+        compact_has_accelerations_ ? std::move(accelerations) : std::vector<double>(state_count * n, 0.0);
+    waypoints_.resize(state_count);
+    duration_from_previous_.assign(durations.begin(), durations.end());
+    return true;
+  }
+
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    auto state = std::make_shared<moveit::core::RobotState>(reference);
+    const std::size_t offset = i * n;
+    if (group_)
+    {
+      state->setJointGroupPositions(group_, &positions[offset]);
+      if (!velocities.empty())
+        state->setJointGroupVelocities(group_, &velocities[offset]);
+      if (!accelerations.empty())
+        state->setJointGroupAccelerations(group_, &accelerations[offset]);
+    }
+    else
+    {
+      state->setVariablePositions(&positions[offset]);
+      if (!velocities.empty())
+        state->setVariableVelocities(&velocities[offset]);
+      if (!accelerations.empty())
+        state->setVariableAccelerations(&accelerations[offset]);
+    }
+    addSuffixWayPoint(state, durations[i]);
+  }
+  return true;
+}
+
 void RobotTrajectory::findWayPointIndicesForDurationAfterStart(double duration, int& before, int& after,
                                                                double& blend) const
 {
@@ -566,7 +1173,7 @@ bool RobotTrajectory::getStateAtDurationFromStart(const double request_duration,
   findWayPointIndicesForDurationAfterStart(request_duration, before, after, blend);
   // ROS_DEBUG_NAMED("robot_trajectory", "Interpolating %.3f of the way between index %d and %d.", blend, before,
   // after);
-  waypoints_[before]->interpolate(*waypoints_[after], blend, *output_state);
+  getWayPoint(before).interpolate(getWayPoint(after), blend, *output_state);
   return true;
 }
 
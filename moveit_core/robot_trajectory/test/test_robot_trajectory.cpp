@@ -429,6 +429,186 @@ TEST_F(RobotTrajectoryTestFixture, Append)
   EXPECT_EQ(initial_trajectory->getWayPointDurationFromPrevious(6), expected_duration);
 }
 
+TEST_F(RobotTrajectoryTestFixture, CompactStorage)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  // make the waypoints distinguishable
+  for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    moveit::core::RobotStatePtr& waypoint = trajectory->getWayPointPtr(i);
+    waypoint->setVariablePosition("panda_joint1", 0.1 * i);
+    waypoint->setVariableVelocity("panda_joint2", -0.2 * i);
+    waypoint->update();
+  }
+
+  robot_trajectory::RobotTrajectory compact(*trajectory, true);
+  compact.setStorageMode(robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  EXPECT_EQ(compact.getStorageMode(), robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  EXPECT_EQ(compact.getWayPointCount(), trajectory->getWayPointCount());
+  EXPECT_EQ(compact.getDuration(), trajectory->getDuration());
+
+  const Eigen::Map<const Eigen::MatrixXd> positions = compact.getCompactPositions();
+  ASSERT_EQ(static_cast<std::size_t>(positions.rows()), compact.getCompactVariableCount());
+  ASSERT_EQ(static_cast<std::size_t>(positions.cols()), compact.getWayPointCount());
+  for (std::size_t i = 0; i < compact.getWayPointCount(); ++i)
+  {
+    EXPECT_EQ(positions(0, i), trajectory->getWayPoint(i).getVariablePosition("panda_joint1"));
+    EXPECT_EQ(compact.getWayPoint(i).getVariablePosition("panda_joint1"), 0.1 * i);
+    EXPECT_EQ(compact.getWayPoint(i).getVariableVelocity("panda_joint2"), -0.2 * i);
+  }
+
+  // messages, edits and appends produce the same results in both modes
+  const auto expect_same_msg = [&] {
+    moveit_msgs::msg::RobotTrajectory expected_msg, compact_msg;
+    trajectory->getRobotTrajectoryMsg(expected_msg);
+    compact.getRobotTrajectoryMsg(compact_msg);
+    EXPECT_EQ(expected_msg, compact_msg);
+  };
+  expect_same_msg();
+
+  trajectory->reverse();
+  compact.reverse();
+  expect_same_msg();
+
+  robot_trajectory::RobotTrajectory other(*trajectory, true);
+  trajectory->append(other, 0.1, 1, 3).addPrefixWayPoint(*robot_state_, 0.2).insertWayPoint(2, *robot_state_, 0.3);
+  compact.append(other, 0.1, 1, 3).addPrefixWayPoint(*robot_state_, 0.2).insertWayPoint(2, *robot_state_, 0.3);
+  expect_same_msg();
+
+  // modifiable access switches back to full robot states
+  compact.getWayPointPtr(0)->setVariablePosition("panda_joint1", 0.5);
+  EXPECT_EQ(compact.getStorageMode(), robot_trajectory::RobotTrajectory::StorageMode::ROBOT_STATES);
+  EXPECT_EQ(compact.getWayPoint(0).getVariablePosition("panda_joint1"), 0.5);
+  EXPECT_EQ(compact.getCompactPositions().size(), 0);
+}
+
+TEST_F(RobotTrajectoryTestFixture, CompactWayPointReferences)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    moveit::core::RobotStatePtr& waypoint = trajectory->getWayPointPtr(i);
+    waypoint->setVariablePosition("panda_joint1", 0.1 * i);
+    waypoint->setVariableVelocity("panda_joint2", -0.2 * i);
+    waypoint->update();
+  }
+  robot_trajectory::RobotTrajectory compact(*trajectory, true);
+  compact.setStorageMode(robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  const std::size_t last = compact.getWayPointCount() - 1;
+
+  // GIVEN references to created waypoints of a COMPACT trajectory
+  const moveit::core::RobotState& first = compact.getWayPoint(0);
+  const moveit::core::RobotState& second = compact.getWayPoint(1);
+
+  // WHEN the trajectory is reversed
+  compact.reverse();
+  // THEN the states move along with their waypoints, like in ROBOT_STATES mode
+  EXPECT_EQ(&compact.getWayPoint(last), &first);
+  EXPECT_EQ(first.getVariablePosition("panda_joint1"), 0.0);
+  EXPECT_EQ(second.getVariableVelocity("panda_joint2"), 0.2);
+  compact.reverse();
+
+  // WHEN the trajectory is unwound
+  compact.unwind();
+  // THEN the states are updated in place
+  EXPECT_EQ(&compact.getWayPoint(1), &second);
+  EXPECT_EQ(second.getVariablePosition("panda_joint1"), 0.1);
+
+  // WHEN a waypoint is replaced
+  moveit::core::RobotState replacement(second);
+  replacement.setVariablePosition("panda_joint1", 0.7);
+  compact.setWayPoint(1, replacement);
+  // THEN the trajectory stays COMPACT and the existing state holds the new values
+  EXPECT_EQ(compact.getStorageMode(), robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  EXPECT_EQ(&compact.getWayPoint(1), &second);
+  EXPECT_EQ(second.getVariablePosition("panda_joint1"), 0.7);
+  EXPECT_EQ(compact.getCompactPositions()(0, 1), 0.7);
+}
+
+TEST_F(RobotTrajectoryTestFixture, CompactMessageConversion)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    moveit::core::RobotStatePtr& waypoint = trajectory->getWayPointPtr(i);
+    waypoint->setVariablePosition("panda_joint1", 0.1 * i);
+    waypoint->setVariableVelocity("panda_joint2", -0.2 * i);
+    waypoint->update();
+  }
+  moveit_msgs::msg::RobotTrajectory msg;
+  trajectory->getRobotTrajectoryMsg(msg);
+
+  // a COMPACT trajectory is filled from the message without leaving COMPACT mode
+  robot_trajectory::RobotTrajectory states(robot_model_, arm_jmg_name_);
+  robot_trajectory::RobotTrajectory compact(robot_model_, arm_jmg_name_);
+  compact.setStorageMode(robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  states.setRobotTrajectoryMsg(*robot_state_, msg);
+  compact.setRobotTrajectoryMsg(*robot_state_, msg);
+  EXPECT_EQ(compact.getStorageMode(), robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  ASSERT_EQ(compact.getWayPointCount(), states.getWayPointCount());
+  for (std::size_t i = 0; i < compact.getWayPointCount(); ++i)
+  {
+    EXPECT_EQ(compact.getWayPointDurationFromPrevious(i), states.getWayPointDurationFromPrevious(i));
+    EXPECT_EQ(compact.getWayPoint(i).getVariablePosition("panda_joint1"), 0.1 * i);
+    EXPECT_EQ(compact.getWayPoint(i).getVariableVelocity("panda_joint2"), -0.2 * i);
+  }
+
+  moveit_msgs::msg::RobotTrajectory states_msg, compact_msg;
+  states.getRobotTrajectoryMsg(states_msg);
+  compact.getRobotTrajectoryMsg(compact_msg);
+  EXPECT_EQ(states_msg, compact_msg);
+}
+
+TEST_F(RobotTrajectoryTestFixture, Serialization)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  initTestTrajectory(trajectory);
+  for (std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    moveit::core::RobotStatePtr& waypoint = trajectory->getWayPointPtr(i);
+    waypoint->setVariablePosition("panda_joint1", 0.1 * i);
+    waypoint->setVariableVelocity("panda_joint2", -0.2 * i);
+    waypoint->update();
+    trajectory->setWayPointDurationFromPrevious(i, 0.1 + 0.01 * i);
+  }
+  moveit_msgs::msg::RobotTrajectory expected_msg;
+  trajectory->getRobotTrajectoryMsg(expected_msg);
+
+  std::vector<std::uint8_t> buffer;
+  trajectory->serialize(buffer);
+
+  // both storage modes read the same buffer, and write the same buffer again
+  using StorageMode = robot_trajectory::RobotTrajectory::StorageMode;
+  for (const StorageMode mode : { StorageMode::ROBOT_STATES, StorageMode::COMPACT })
+  {
+    robot_trajectory::RobotTrajectory restored(robot_model_);
+    restored.setStorageMode(mode);
+    ASSERT_TRUE(restored.deserialize(*robot_state_, buffer));
+    EXPECT_EQ(restored.getStorageMode(), mode);
+    EXPECT_EQ(restored.getGroupName(), arm_jmg_name_);
+    EXPECT_EQ(restored.getWayPointDurations(), trajectory->getWayPointDurations());
+    moveit_msgs::msg::RobotTrajectory restored_msg;
+    restored.getRobotTrajectoryMsg(restored_msg);
+    EXPECT_EQ(restored_msg, expected_msg);
+
+    std::vector<std::uint8_t> restored_buffer;
+    restored.serialize(restored_buffer);
+    EXPECT_EQ(restored_buffer, buffer);
+  }
+
+  // malformed buffers are rejected without modifying the trajectory
+  robot_trajectory::RobotTrajectory other(*trajectory, true);
+  std::vector<std::uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+  EXPECT_FALSE(other.deserialize(*robot_state_, truncated));
+  std::vector<std::uint8_t> corrupted = buffer;
+  corrupted[0] ^= 0xff;
+  EXPECT_FALSE(other.deserialize(*robot_state_, corrupted));
+  EXPECT_EQ(other.getWayPointCount(), trajectory->getWayPointCount());
+}
+
 TEST_F(RobotTrajectoryTestFixture, RobotTrajectoryShallowCopy)
 {
   bool deepcopy = false;
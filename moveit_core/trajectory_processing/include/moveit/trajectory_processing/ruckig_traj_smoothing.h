@@ -93,6 +93,8 @@ public:
                              const double max_acceleration_scaling_factor = 1.0);
 
 private:
+  friend class RuckigStreamingSmoother;
+
   /**
    * \brief A utility function to check if the group is defined.
    * \param trajectory      Trajectory to smooth.
@@ -111,18 +113,6 @@ private:
                                                 const moveit::core::JointModelGroup* const group,
                                                 ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
 
-  /**
-   * \brief Feed previous output back as input for next iteration. Get next target state from the next waypoint.
-   * \param current_waypoint    The nominal current state
-   * \param next_waypoint       The nominal, desired state at the next waypoint
-   * \param joint_group         The MoveIt JointModelGroup of interest
-   * \param[out] ruckig_input   The Rucking parameters for the next iteration
-   */
-  static void getNextRuckigInput(const moveit::core::RobotStateConstPtr& current_waypoint,
-                                 const moveit::core::RobotStateConstPtr& next_waypoint,
-                                 const moveit::core::JointModelGroup* joint_group,
-                                 ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
-
   /**
    * \brief Initialize Ruckig position/vel/accel. This initializes ruckig_input and ruckig_output to the same values
    * \param first_waypoint  The Ruckig input/output parameters are initialized to the values at this waypoint
@@ -134,7 +124,8 @@ private:
                                     ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input);
 
   /**
-   * \brief A utility function to instantiate and run Ruckig for a series of waypoints.
+   * \brief A utility function to run Ruckig for a series of waypoints, passing them through a
+   * RuckigStreamingSmoother one at a time.
    * \param[in, out] trajectory      Trajectory to smooth.
    * \param[in, out] ruckig_input    Necessary input for Ruckig smoothing. Contains kinematic limits (vel, accel, jerk)
    * \param mitigate_overshoot If true, overshoot is mitigated by extending trajectory duration.
@@ -144,23 +135,96 @@ private:
                                       ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
                                       const bool mitigate_overshoot = false, const double overshoot_threshold = 0.01);
 
-  /**
-   * \brief Extend the duration of every trajectory segment
-   * \param[in] duration_extension_factor A number greater than 1. Extend every timestep by this much.
-   * \param[in] num_waypoints Number of waypoints in the trajectory.
-   * \param[in] num_dof Degrees of freedom in the manipulator.
-   * \param[in] move_group_idx For accessing the joints of interest out of the full RobotState.
-   * \param[in] original_trajectory Durations are extended based on the data in this original trajectory.
-   * \param[in, out] trajectory This trajectory will be returned with modified waypoint durations.
-   */
-  static void extendTrajectoryDuration(const double duration_extension_factor, size_t num_waypoints,
-                                       const size_t num_dof, const std::vector<int>& move_group_idx,
-                                       const robot_trajectory::RobotTrajectory& original_trajectory,
-                                       robot_trajectory::RobotTrajectory& trajectory);
-
   /** \brief Check if a trajectory out of Ruckig overshoots the target state */
   static bool checkOvershoot(ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector>& ruckig_trajectory,
                              const size_t num_dof, ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
                              const double overshoot_threshold);
 };
+
+/**
+ * \brief Jerk-limited smoothing of waypoints that arrive one at a time, e.g. from servo, a local planner or teleop.
+ *
+ * Each added waypoint is connected to the previous one by a Ruckig trajectory. If that segment is not feasible within
+ * the limits (or overshoots, if enabled), the waypoint's duration is extended and its velocity and acceleration are
+ * reduced accordingly, with a bounded number of retries. The cost of adding a waypoint therefore does not depend on
+ * the number of waypoints added before. RuckigSmoothing::applySmoothing() runs all waypoints through this class.
+ */
+class RuckigStreamingSmoother
+{
+public:
+  /**
+   * \brief Create a smoother using the group's kinematic limits from the RobotModel.
+   * \param group The joint group of the streamed waypoints.
+   * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the motion.
+   * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the motion.
+   * \param control_period The cycle time of the consumer of the setpoints in seconds.
+   * \param mitigate_overshoot If true, overshoot is mitigated by extending segment durations.
+   * \param overshoot_threshold If an overshoot is greater than this, duration is extended (radians, for a single joint)
+   */
+  RuckigStreamingSmoother(const moveit::core::JointModelGroup* group, const double max_velocity_scaling_factor,
+                          const double max_acceleration_scaling_factor, const double control_period,
+                          const bool mitigate_overshoot = false, const double overshoot_threshold = 0.01);
+
+  /**
+   * \brief Create a smoother with the given kinematic limits.
+   * \param group The joint group of the streamed waypoints.
+   * \param limits Velocity, acceleration and jerk limits of the group's variables.
+   * \param control_period The cycle time of the consumer of the setpoints in seconds.
+   * \param mitigate_overshoot If true, overshoot is mitigated by extending segment durations.
+   * \param overshoot_threshold If an overshoot is greater than this, duration is extended (radians, for a single joint)
+   */
+  RuckigStreamingSmoother(const moveit::core::JointModelGroup* group,
+                          const ruckig::InputParameter<ruckig::DynamicDOFs>& limits, const double control_period,
+                          const bool mitigate_overshoot = false, const double overshoot_threshold = 0.01);
+
+  /**
+   * \brief Start a new stream at the given state. Must be called before adding waypoints.
+   * \param first_waypoint Positions, velocities and accelerations of the group are the initial state.
+   */
+  void reset(const moveit::core::RobotState& first_waypoint);
+
+  /**
+   * \brief Add the next waypoint of the stream.
+   * \param[in,out] waypoint The next waypoint. If the segment duration is extended, the group's velocities and
+   * accelerations are reduced accordingly.
+   * \param[in,out] duration_from_previous The requested duration of the segment, extended if needed.
+   * \return false if no feasible segment was found. The smoother state, \p waypoint and \p duration_from_previous
+   * are not changed in that case.
+   */
+  [[nodiscard]] bool addWaypoint(moveit::core::RobotState& waypoint, double& duration_from_previous);
+
+  /** \brief Duration of the jerk-limited motion from the previous to the last added waypoint */
+  double getLastSegmentDuration() const;
+
+  /**
+   * \brief Sample the jerk-limited motion from the previous to the last added waypoint, e.g. to emit setpoints at
+   * the control rate. The output vectors are resized to the number of group variables.
+   * \param time Time since the previous waypoint, in the range [0, getLastSegmentDuration()]
+   */
+  void sampleLastSegment(const double time, std::vector<double>& positions, std::vector<double>& velocities,
+                         std::vector<double>& accelerations) const;
+
+private:
+  /** \brief Set the Ruckig target from the waypoint, clamping velocities and accelerations to the limits */
+  void setTarget(const moveit::core::RobotState& waypoint, ruckig::InputParameter<ruckig::DynamicDOFs>& input) const;
+
+  const moveit::core::JointModelGroup* group_;
+  const size_t num_dof_;
+  const bool mitigate_overshoot_;
+  const double overshoot_threshold_;
+  bool initialized_ = false;
+
+  ruckig::Ruckig<ruckig::DynamicDOFs> ruckig_;
+  ruckig::InputParameter<ruckig::DynamicDOFs> ruckig_input_;
+  ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector> ruckig_output_;
+
+  // Segment being computed by addWaypoint(), swapped with ruckig_input_/ruckig_output_ only on success
+  ruckig::InputParameter<ruckig::DynamicDOFs> candidate_input_;
+  ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector> candidate_output_;
+
+  // Unclamped velocities of the previous waypoint and the requested velocities and accelerations of the current one
+  std::vector<double> previous_velocity_;
+  std::vector<double> requested_velocity_;
+  std::vector<double> requested_acceleration_;
+};
 }  // namespace trajectory_processing
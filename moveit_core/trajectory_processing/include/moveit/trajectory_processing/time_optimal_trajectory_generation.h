@@ -39,10 +39,16 @@
 #pragma once
 
 #include <Eigen/Core>
-#include <list>
+#include <memory>
+#include <vector>
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/trajectory_processing/time_parameterization.h>
 
+namespace dynamics_solver
+{
+class DynamicsSolver;
+}
+
 namespace trajectory_processing
 {
 
@@ -75,7 +81,7 @@ public:
   virtual Eigen::VectorXd getConfig(double s) const = 0;
   virtual Eigen::VectorXd getTangent(double s) const = 0;
   virtual Eigen::VectorXd getCurvature(double s) const = 0;
-  virtual std::list<double> getSwitchingPoints() const = 0;
+  virtual std::vector<double> getSwitchingPoints() const = 0;
   virtual PathSegment* clone() const = 0;
 
   double position_;
@@ -94,12 +100,20 @@ public:
 
   // Copy constructor.
   Path(const Path& path);
+  Path(Path&& path) = default;
 
   double getLength() const;
   Eigen::VectorXd getConfig(double s) const;
   Eigen::VectorXd getTangent(double s) const;
   Eigen::VectorXd getCurvature(double s) const;
 
+  /** @brief Same as the functions above, but the path segment search starts at \p segment_hint, which is updated to
+   *  the segment containing \p s. This avoids searching all segments when evaluating nearby arc lengths in sequence.
+   **/
+  Eigen::VectorXd getConfig(double s, std::size_t& segment_hint) const;
+  Eigen::VectorXd getTangent(double s, std::size_t& segment_hint) const;
+  Eigen::VectorXd getCurvature(double s, std::size_t& segment_hint) const;
+
   /** @brief Get the next switching point.
    *  @param[in] s Arc length traveled so far
    *  @param[out] discontinuity True if this switching point is a discontinuity
@@ -107,18 +121,37 @@ public:
    **/
   double getNextSwitchingPoint(double s, bool& discontinuity) const;
 
-  /// @brief Return a list of all switching points as a pair (arc length to switching point, discontinuity)
-  std::list<std::pair<double, bool>> getSwitchingPoints() const;
+  /// @brief Return all switching points, sorted by arc length, as a pair (arc length to switching point, discontinuity)
+  const std::vector<std::pair<double, bool>>& getSwitchingPoints() const;
 
 private:
   // Default constructor private to prevent misuse. Use `create` instead to create a Path object.
   Path() = default;
 
-  PathSegment* getPathSegment(double& s) const;
+  /// @brief Index of the segment containing arc length s, found by binary search
+  std::size_t findPathSegment(double s) const;
+  PathSegment* getPathSegment(double& s, std::size_t& segment_hint) const;
 
   double length_ = 0.0;
-  std::list<std::pair<double, bool>> switching_points_;
-  std::list<std::unique_ptr<PathSegment>> path_segments_;
+  std::vector<std::pair<double, bool>> switching_points_;
+  std::vector<std::unique_ptr<PathSegment>> path_segments_;
+};
+
+/// @brief Inverse dynamics along a Path, sampled at equally spaced path positions. The joint torques for a path
+/// acceleration s_dd and path velocity s_d are M(q) * (q' * s_dd + q'' * s_d^2) + h(q, q') * s_d^2 + g(q), with the
+/// values between two samples interpolated linearly.
+struct PathDynamics
+{
+  /// Distance between two samples along the path; sample i is at path position i * sample_spacing
+  double sample_spacing = 0.0;
+  /// Joint space inertia matrix M(q) at every sample
+  std::vector<Eigen::MatrixXd> mass_matrices;
+  /// Coriolis and centrifugal torques h(q, q') for a path velocity of 1 at every sample
+  std::vector<Eigen::VectorXd> velocity_torques;
+  /// Gravity torques g(q) at every sample
+  std::vector<Eigen::VectorXd> gravity_torques;
+  /// Torque limit of every joint; use infinity for joints without a limit
+  Eigen::VectorXd max_torque;
 };
 
 class Trajectory
@@ -126,9 +159,18 @@ class Trajectory
 public:
   /// @brief Generates a time-optimal trajectory.
   /// @returns std::nullopt if the trajectory couldn't be parameterized.
-  static std::optional<Trajectory> create(const Path& path, const Eigen::VectorXd& max_velocity,
+  /// The path is stored in the trajectory; pass an rvalue to avoid copying it.
+  static std::optional<Trajectory> create(Path path, const Eigen::VectorXd& max_velocity,
                                           const Eigen::VectorXd& max_acceleration, double time_step = 0.001);
 
+  /// @brief Generates a time-optimal trajectory which also keeps the joint torques given by \e dynamics within their
+  /// limits.
+  /// @returns std::nullopt if the trajectory couldn't be parameterized, e.g. because a joint cannot hold the path
+  /// against gravity.
+  static std::optional<Trajectory> create(Path path, const Eigen::VectorXd& max_velocity,
+                                          const Eigen::VectorXd& max_acceleration, PathDynamics dynamics,
+                                          double time_step = 0.001);
+
   /// @brief Returns the optimal duration of the trajectory
   double getDuration() const;
 
@@ -141,8 +183,10 @@ public:
   Eigen::VectorXd getAcceleration(double time) const;
 
 private:
-  Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
-             double time_step);
+  Trajectory(Path path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+             std::shared_ptr<const PathDynamics> dynamics, double time_step);
+
+  static std::optional<Trajectory> integrate(Trajectory output);
 
   struct TrajectoryStep
   {
@@ -163,8 +207,8 @@ private:
                                          double& before_acceleration, double& after_acceleration);
   bool getNextVelocitySwitchingPoint(double path_pos, TrajectoryStep& next_switching_point, double& before_acceleration,
                                      double& after_acceleration);
-  bool integrateForward(std::list<TrajectoryStep>& trajectory, double acceleration);
-  void integrateBackward(std::list<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
+  bool integrateForward(std::vector<TrajectoryStep>& trajectory, double acceleration);
+  void integrateBackward(std::vector<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
                          double acceleration);
   double getMinMaxPathAcceleration(double path_position, double path_velocity, bool max);
   double getMinMaxPhaseSlope(double path_position, double path_velocity, bool max);
@@ -172,21 +216,29 @@ private:
   double getVelocityMaxPathVelocity(double path_pos) const;
   double getAccelerationMaxPathVelocityDeriv(double path_pos);
   double getVelocityMaxPathVelocityDeriv(double path_pos);
+  // Coefficients of the joint torques a * s_dd + b * s_d^2 + c at path_pos, for the given path derivatives
+  void getTorqueCoefficients(double path_pos, const Eigen::VectorXd& config_deriv, const Eigen::VectorXd& config_deriv2,
+                             Eigen::VectorXd& a, Eigen::VectorXd& b, Eigen::VectorXd& c) const;
 
-  std::list<TrajectoryStep>::const_iterator getTrajectorySegment(double time) const;
+  std::vector<TrajectoryStep>::const_iterator getTrajectorySegment(double time) const;
 
   Path path_;
   Eigen::VectorXd max_velocity_;
   Eigen::VectorXd max_acceleration_;
+  // Only set if the joint torques are limited as well
+  std::shared_ptr<const PathDynamics> dynamics_;
   unsigned int joint_num_ = 0.0;
   bool valid_ = true;
-  std::list<TrajectoryStep> trajectory_;
-  std::list<TrajectoryStep> end_trajectory_;  // non-empty only if the trajectory generation failed.
+  std::vector<TrajectoryStep> trajectory_;
+  std::vector<TrajectoryStep> end_trajectory_;  // non-empty only if the trajectory generation failed.
 
   double time_step_ = 0.0;
 
   mutable double cached_time_ = std::numeric_limits<double>::max();
-  mutable std::list<TrajectoryStep>::const_iterator cached_trajectory_segment_;
+  mutable std::size_t cached_trajectory_segment_ = 0;
+  // Path segment of the last path evaluation. Integration and sampling move along the path in small steps, so the
+  // next evaluation is usually in the same or a neighboring segment.
+  mutable std::size_t path_segment_hint_ = 0;
 };
 
 MOVEIT_CLASS_FORWARD(TimeOptimalTrajectoryGeneration);
@@ -255,10 +307,34 @@ public:
                          const double max_velocity_scaling_factor = 1.0,
                          const double max_acceleration_scaling_factor = 1.0) const override;
 
+  // clang-format off
+/**
+  * \brief Compute a trajectory like computeTimeStamps(), which additionally keeps the joint torques within the effort
+  * limits of the URDF. Joints without an effort limit are not torque limited.
+  * The inverse dynamics of the group are evaluated in one batch along the path before the integration. The samples are
+  * computed in parallel, so that the torque limits can be enforced on every plan.
+  * \param[in,out] trajectory A path which needs time-parameterization.
+  * \param dynamics_solver Dynamics solver constructed for the group of the trajectory.
+  * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+  * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the trajectory.
+  * \param num_threads Number of threads computing the dynamics. 0 uses the number of hardware threads.
+  */
+  // clang-format on
+  bool computeTimeStampsWithTorqueLimits(robot_trajectory::RobotTrajectory& trajectory,
+                                         const dynamics_solver::DynamicsSolver& dynamics_solver,
+                                         const double max_velocity_scaling_factor = 1.0,
+                                         const double max_acceleration_scaling_factor = 1.0,
+                                         const unsigned int num_threads = 0) const;
+
 private:
+  bool getJointLimits(const moveit::core::JointModelGroup* group, const double max_velocity_scaling_factor,
+                      const double max_acceleration_scaling_factor, Eigen::VectorXd& max_velocity,
+                      Eigen::VectorXd& max_acceleration) const;
+
   bool doTimeParameterizationCalculations(robot_trajectory::RobotTrajectory& trajectory,
-                                          const Eigen::VectorXd& max_velocity,
-                                          const Eigen::VectorXd& max_acceleration) const;
+                                          const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+                                          const dynamics_solver::DynamicsSolver* dynamics_solver = nullptr,
+                                          const unsigned int num_threads = 0) const;
 
   /**
    * @brief Check if a combination of revolute and prismatic joints is used. path_tolerance_ is not valid, if so.
@@ -2,8 +2,22 @@
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include <functional>
+
 namespace trajectory_processing
 {
+/**
+ * \brief Runs a function on each trajectory of a batch, distributing the trajectories over several threads.
+ * \param [in,out] trajectories The trajectories to process. Each entry must be a distinct object.
+ * \param [in] process Called once per trajectory, concurrently from several threads.
+ * \param [in] num_threads The number of threads to use, 0 uses one thread per hardware core (default: 0).
+ * \return For each trajectory, the result of \p process. Null trajectories are reported as failed.
+ * \throws The first exception thrown by \p process, rethrown on the calling thread once all threads have stopped.
+ */
+std::vector<bool> processTrajectoryBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                         const std::function<bool(robot_trajectory::RobotTrajectory&)>& process,
+                                         std::size_t num_threads = 0);
+
 /**
  * @brief Base class for trajectory parameterization algorithms
  */
@@ -56,5 +70,35 @@ public:
                                  const std::vector<moveit_msgs::msg::JointLimits>& joint_limits,
                                  const double max_velocity_scaling_factor = 1.0,
                                  const double max_acceleration_scaling_factor = 1.0) const = 0;
+
+  /**
+   * \brief Compute time stamps for several independent trajectories concurrently
+   * \param[in,out] trajectories Paths which need time-parameterization. Each entry must be a distinct object.
+   * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the trajectories.
+   * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the trajectories.
+   * \param num_threads Number of threads to use. 0 uses one thread per hardware core.
+   * \return For each trajectory, whether its time-parameterization succeeded
+   */
+  virtual std::vector<bool>
+  computeTimeStampsBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                         const double max_velocity_scaling_factor = 1.0,
+                         const double max_acceleration_scaling_factor = 1.0, const std::size_t num_threads = 0) const;
+
+  /**
+   * \brief Compute time stamps for several independent trajectories concurrently
+   * \param[in,out] trajectories Paths which need time-parameterization. Each entry must be a distinct object.
+   * \param velocity_limits Joint names and velocity limits in rad/s
+   * \param acceleration_limits Joint names and acceleration limits in rad/s^2
+   * \param max_velocity_scaling_factor A factor in the range [0,1] which can slow down the trajectories.
+   * \param max_acceleration_scaling_factor A factor in the range [0,1] which can slow down the trajectories.
+   * \param num_threads Number of threads to use. 0 uses one thread per hardware core.
+   * \return For each trajectory, whether its time-parameterization succeeded
+   */
+  virtual std::vector<bool>
+  computeTimeStampsBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                         const std::unordered_map<std::string, double>& velocity_limits,
+                         const std::unordered_map<std::string, double>& acceleration_limits,
+                         const double max_velocity_scaling_factor = 1.0,
+                         const double max_acceleration_scaling_factor = 1.0, const std::size_t num_threads = 0) const;
 };
 }  // namespace trajectory_processing
@@ -81,6 +81,37 @@ bool applyRuckigSmoothing(robot_trajectory::RobotTrajectory& trajectory, double
                           double acceleration_scaling_factor, bool mitigate_overshoot = false,
                           double overshoot_threshold = 0.01);
 
+/**
+ * \brief Applies TOTG time parameterization to many independent robot trajectories concurrently.
+ * \param [in,out] trajectories The robot trajectories to be time parameterized. Each entry must be a distinct object.
+ * \param [in] velocity_scaling_factor The factor by which to scale the maximum velocity of the trajectories.
+ * \param [in] acceleration_scaling_factor The factor by which to scale the maximum acceleration of the trajectories.
+ * \param [in] path_tolerance The path tolerance to use for time parameterization (default: 0.1).
+ * \param [in] resample_dt The time step to use for time parameterization (default: 0.1).
+ * \param [in] min_angle_change The minimum angle change to use for time parameterization (default: 0.001).
+ * \param [in] num_threads The number of threads to use, 0 uses one thread per hardware core (default: 0).
+ * \return For each trajectory, whether time parameterization was successful.
+ */
+std::vector<bool>
+applyTOTGTimeParameterizationBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                   double velocity_scaling_factor, double acceleration_scaling_factor,
+                                   double path_tolerance = 0.1, double resample_dt = 0.1,
+                                   double min_angle_change = 0.001, std::size_t num_threads = 0);
+/**
+ * \brief Applies Ruckig smoothing to many independent robot trajectories concurrently.
+ * \param [in,out] trajectories The robot trajectories to be smoothed. Each entry must be a distinct object.
+ * \param [in] velocity_scaling_factor The factor by which to scale the maximum velocity of the trajectories.
+ * \param [in] acceleration_scaling_factor The factor by which to scale the maximum acceleration of the trajectories.
+ * \param [in] mitigate_overshoot Whether to mitigate overshoot during smoothing (default: false).
+ * \param [in] overshoot_threshold The maximum allowed overshoot during smoothing (default: 0.01).
+ * \param [in] num_threads The number of threads to use, 0 uses one thread per hardware core (default: 0).
+ * \return For each trajectory, whether smoothing was successful.
+ */
+std::vector<bool> applyRuckigSmoothingBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                            double velocity_scaling_factor, double acceleration_scaling_factor,
+                                            bool mitigate_overshoot = false, double overshoot_threshold = 0.01,
+                                            std::size_t num_threads = 0);
+
 /**
  * @brief Converts a `trajectory_processing::Trajectory` into a `JointTrajectory` message with a given sampling rate.
  */
@@ -250,116 +250,33 @@ bool RuckigSmoothing::runRuckig(robot_trajectory::RobotTrajectory& trajectory,
 {
   const size_t num_waypoints = trajectory.getWayPointCount();
   const moveit::core::JointModelGroup* const group = trajectory.getGroup();
-  const size_t num_dof = group->getVariableCount();
-  ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector> ruckig_output(num_dof);
 
   // This lib does not work properly when angles wrap, so we need to unwind the path first
   trajectory.unwind();
 
-  // Initialize the smoother
-  ruckig::Ruckig<ruckig::DynamicDOFs> ruckig(num_dof, trajectory.getAverageSegmentDuration());
-  initializeRuckigState(*trajectory.getFirstWayPointPtr(), group, ruckig_input);
-
-  // Cache the trajectory in case we need to reset it
-  robot_trajectory::RobotTrajectory original_trajectory =
-      robot_trajectory::RobotTrajectory(trajectory, true /* deep copy */);
-
-  ruckig::Result ruckig_result;
-  double duration_extension_factor = 1;
-  bool smoothing_complete = false;
-  size_t waypoint_idx = 0;
-  while ((duration_extension_factor <= MAX_DURATION_EXTENSION_FACTOR) && !smoothing_complete)
+  // Smooth one segment at a time, as if the waypoints were streamed
+  RuckigStreamingSmoother smoother(group, ruckig_input, trajectory.getAverageSegmentDuration(), mitigate_overshoot,
+                                   overshoot_threshold);
+  smoother.reset(trajectory.getWayPoint(0));
+  // The waypoints are smoothed on a copy and written back, which keeps the storage mode of the trajectory
+  moveit::core::RobotState waypoint(trajectory.getWayPoint(0));
+  for (size_t waypoint_idx = 1; waypoint_idx < num_waypoints; ++waypoint_idx)
   {
-    while (waypoint_idx < num_waypoints - 1)
+    waypoint = trajectory.getWayPoint(waypoint_idx);
+    double duration_from_previous = trajectory.getWayPointDurationFromPrevious(waypoint_idx);
+    if (!smoother.addWaypoint(waypoint, duration_from_previous))
     {
-      moveit::core::RobotStatePtr curr_waypoint = trajectory.getWayPointPtr(waypoint_idx);
-      moveit::core::RobotStatePtr next_waypoint = trajectory.getWayPointPtr(waypoint_idx + 1);
-
-      getNextRuckigInput(curr_waypoint, next_waypoint, group, ruckig_input);
-
-      // Run Ruckig
-      ruckig_result = ruckig.calculate(ruckig_input, ruckig_output);
-
-      // Step through the trajectory at the given OVERSHOOT_CHECK_PERIOD and check for overshoot.
-      // We will extend the duration to mitigate it.
-      bool overshoots = false;
-      if (mitigate_overshoot)
-      {
-        overshoots = checkOvershoot(ruckig_output, num_dof, ruckig_input, overshoot_threshold);
-      }
-
-      // The difference between Result::Working and Result::Finished is that Finished can be reached in one
-      // Ruckig timestep (constructor parameter). Both are acceptable for trajectories.
-      // (The difference is only relevant for streaming mode.)
-
-      // If successful and at the last trajectory segment
-      if (!overshoots && (waypoint_idx == num_waypoints - 2) &&
-          (ruckig_result == ruckig::Result::Working || ruckig_result == ruckig::Result::Finished))
-      {
-        trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1, ruckig_output.get_duration());
-        smoothing_complete = true;
-        break;
-      }
-
-      // Extend the trajectory duration if Ruckig could not reach the waypoint successfully
-      if (overshoots || (ruckig_result != ruckig::Result::Working && ruckig_result != ruckig::Result::Finished))
-      {
-        duration_extension_factor *= DURATION_EXTENSION_FRACTION;
-        // Reset the trajectory
-        trajectory = robot_trajectory::RobotTrajectory(original_trajectory, true /* deep copy */);
-
-        const std::vector<int>& move_group_idx = group->getVariableIndexList();
-        extendTrajectoryDuration(duration_extension_factor, waypoint_idx, num_dof, move_group_idx, original_trajectory,
-                                 trajectory);
-
-        initializeRuckigState(*trajectory.getFirstWayPointPtr(), group, ruckig_input);
-        // Begin the for() loop again
-        break;
-      }
-      ++waypoint_idx;
+      return false;
     }
+    trajectory.setWayPoint(waypoint_idx, waypoint);
+    trajectory.setWayPointDurationFromPrevious(waypoint_idx, duration_from_previous);
   }
 
-  if (duration_extension_factor > MAX_DURATION_EXTENSION_FACTOR)
-  {
-    RCLCPP_ERROR_STREAM(getLogger(),
-                        "Ruckig extended the trajectory duration to its maximum and still did not find a solution");
-  }
-
-  if (ruckig_result != ruckig::Result::Working && ruckig_result != ruckig::Result::Finished)
-  {
-    RCLCPP_ERROR_STREAM(getLogger(), "Ruckig trajectory smoothing failed. Ruckig error: " << ruckig_result);
-    return false;
-  }
-
+  // The last segment takes the duration of the jerk-limited motion into the final waypoint
+  trajectory.setWayPointDurationFromPrevious(num_waypoints - 1, smoother.getLastSegmentDuration());
   return true;
 }
 
-void RuckigSmoothing::extendTrajectoryDuration(const double duration_extension_factor, size_t waypoint_idx,
-                                               const size_t num_dof, const std::vector<int>& move_group_idx,
-                                               const robot_trajectory::RobotTrajectory& original_trajectory,
-                                               robot_trajectory::RobotTrajectory& trajectory)
-{
-  trajectory.setWayPointDurationFromPrevious(waypoint_idx + 1,
-                                             duration_extension_factor *
-                                                 original_trajectory.getWayPointDurationFromPrevious(waypoint_idx + 1));
-  // re-calculate waypoint velocity and acceleration
-  auto target_state = trajectory.getWayPointPtr(waypoint_idx + 1);
-  const auto prev_state = trajectory.getWayPointPtr(waypoint_idx);
-
-  double timestep = trajectory.getWayPointDurationFromPrevious(waypoint_idx + 1);
-
-  for (size_t joint = 0; joint < num_dof; ++joint)
-  {
-    target_state->setVariableVelocity(move_group_idx.at(joint),
-                                      (1 / duration_extension_factor) *
-                                          target_state->getVariableVelocity(move_group_idx.at(joint)));
-    double prev_velocity = prev_state->getVariableVelocity(move_group_idx.at(joint));
-    double curr_velocity = target_state->getVariableVelocity(move_group_idx.at(joint));
-    target_state->setVariableAcceleration(move_group_idx.at(joint), (curr_velocity - prev_velocity) / timestep);
-  }
-}
-
 void RuckigSmoothing::initializeRuckigState(const moveit::core::RobotState& first_waypoint,
                                             const moveit::core::JointModelGroup* joint_group,
                                             ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input)
@@ -387,41 +304,6 @@ void RuckigSmoothing::initializeRuckigState(const moveit::core::RobotState& firs
   std::copy_n(current_accelerations_vector.begin(), num_dof, ruckig_input.current_acceleration.begin());
 }
 
-void RuckigSmoothing::getNextRuckigInput(const moveit::core::RobotStateConstPtr& current_waypoint,
-                                         const moveit::core::RobotStateConstPtr& next_waypoint,
-                                         const moveit::core::JointModelGroup* joint_group,
-                                         ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input)
-{
-  const size_t num_dof = joint_group->getVariableCount();
-  const std::vector<int>& idx = joint_group->getVariableIndexList();
-
-  for (size_t joint = 0; joint < num_dof; ++joint)
-  {
-    ruckig_input.current_position.at(joint) = current_waypoint->getVariablePosition(idx.at(joint));
-    ruckig_input.current_velocity.at(joint) = current_waypoint->getVariableVelocity(idx.at(joint));
-    ruckig_input.current_acceleration.at(joint) = current_waypoint->getVariableAcceleration(idx.at(joint));
-
-    // Target state is the next waypoint
-    ruckig_input.target_position.at(joint) = next_waypoint->getVariablePosition(idx.at(joint));
-    ruckig_input.target_velocity.at(joint) = next_waypoint->getVariableVelocity(idx.at(joint));
-    ruckig_input.target_acceleration.at(joint) = next_waypoint->getVariableAcceleration(idx.at(joint));
-
-    // Clamp velocities/accelerations in case they exceed the limit due to small numerical errors
-    ruckig_input.current_velocity.at(joint) =
-        std::clamp(ruckig_input.current_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
-                   ruckig_input.max_velocity.at(joint));
-    ruckig_input.current_acceleration.at(joint) =
-        std::clamp(ruckig_input.current_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
-                   ruckig_input.max_acceleration.at(joint));
-    ruckig_input.target_velocity.at(joint) =
-        std::clamp(ruckig_input.target_velocity.at(joint), -ruckig_input.max_velocity.at(joint),
-                   ruckig_input.max_velocity.at(joint));
-    ruckig_input.target_acceleration.at(joint) =
-        std::clamp(ruckig_input.target_acceleration.at(joint), -ruckig_input.max_acceleration.at(joint),
-                   ruckig_input.max_acceleration.at(joint));
-  }
-}
-
 bool RuckigSmoothing::checkOvershoot(ruckig::Trajectory<ruckig::DynamicDOFs, ruckig::StandardVector>& ruckig_trajectory,
                                      const size_t num_dof, ruckig::InputParameter<ruckig::DynamicDOFs>& ruckig_input,
                                      const double overshoot_threshold)
@@ -448,4 +330,164 @@ bool RuckigSmoothing::checkOvershoot(ruckig::Trajectory<ruckig::DynamicDOFs, ruc
   }
   return false;
 }
+
+RuckigStreamingSmoother::RuckigStreamingSmoother(const moveit::core::JointModelGroup* group,
+                                                 const double max_velocity_scaling_factor,
+                                                 const double max_acceleration_scaling_factor,
+                                                 const double control_period, const bool mitigate_overshoot,
+                                                 const double overshoot_threshold)
+  : RuckigStreamingSmoother(group, ruckig::InputParameter<ruckig::DynamicDOFs>(group->getVariableCount()),
+                            control_period, mitigate_overshoot, overshoot_threshold)
+{
+  if (!RuckigSmoothing::getRobotModelBounds(max_velocity_scaling_factor, max_acceleration_scaling_factor, group,
+                                            ruckig_input_))
+  {
+    RCLCPP_ERROR(getLogger(), "Error while retrieving kinematic limits (vel/accel/jerk) from RobotModel.");
+  }
+}
+
+RuckigStreamingSmoother::RuckigStreamingSmoother(const moveit::core::JointModelGroup* group,
+                                                 const ruckig::InputParameter<ruckig::DynamicDOFs>& limits,
+                                                 const double control_period, const bool mitigate_overshoot,
+                                                 const double overshoot_threshold)
+  : group_(group)
+  , num_dof_(group->getVariableCount())
+  , mitigate_overshoot_(mitigate_overshoot)
+  , overshoot_threshold_(overshoot_threshold)
+  , ruckig_(num_dof_, control_period)
+  , ruckig_input_(limits)
+  , ruckig_output_(num_dof_)
+  , candidate_input_(limits)
+  , candidate_output_(num_dof_)
+  , previous_velocity_(num_dof_, 0.0)
+  , requested_velocity_(num_dof_, 0.0)
+  , requested_acceleration_(num_dof_, 0.0)
+{
+}
+
+void RuckigStreamingSmoother::reset(const moveit::core::RobotState& first_waypoint)
+{
+  RuckigSmoothing::initializeRuckigState(first_waypoint, group_, ruckig_input_);
+  const std::vector<int>& idx = group_->getVariableIndexList();
+  for (size_t joint = 0; joint < num_dof_; ++joint)
+  {
+    previous_velocity_[joint] = first_waypoint.getVariableVelocity(idx[joint]);
+  }
+  initialized_ = true;
+}
+
+bool RuckigStreamingSmoother::addWaypoint(moveit::core::RobotState& waypoint, double& duration_from_previous)
+{
+  if (!initialized_)
+  {
+    RCLCPP_ERROR(getLogger(), "The streaming smoother has no initial state. Call reset() before adding waypoints.");
+    return false;
+  }
+
+  const std::vector<int>& idx = group_->getVariableIndexList();
+  for (size_t joint = 0; joint < num_dof_; ++joint)
+  {
+    requested_velocity_[joint] = waypoint.getVariableVelocity(idx[joint]);
+    requested_acceleration_[joint] = waypoint.getVariableAcceleration(idx[joint]);
+  }
+  const double requested_duration = duration_from_previous;
+
+  // The segment is computed on a copy of the Ruckig input, so a failure leaves the previous segment intact.
+  // Assigning into the existing member reuses its storage.
+  candidate_input_ = ruckig_input_;
+
+  // Retry with a longer segment until Ruckig finds a solution. Only this segment is recomputed, so the number of
+  // Ruckig calls per waypoint is bounded by the maximum extension factor.
+  ruckig::Result ruckig_result;
+  double duration_extension_factor = 1.0;
+  while (true)
+  {
+    setTarget(waypoint, candidate_input_);
+    ruckig_result = ruckig_.calculate(candidate_input_, candidate_output_);
+
+    // The difference between Result::Working and Result::Finished is that Finished can be reached in one
+    // Ruckig timestep (constructor parameter). Both are acceptable for a segment.
+    const bool success = ruckig_result == ruckig::Result::Working || ruckig_result == ruckig::Result::Finished;
+    const bool overshoots =
+        success && mitigate_overshoot_ &&
+        RuckigSmoothing::checkOvershoot(candidate_output_, num_dof_, candidate_input_, overshoot_threshold_);
+    if (success && !overshoots)
+    {
+      break;
+    }
+
+    duration_extension_factor *= DURATION_EXTENSION_FRACTION;
+    if (duration_extension_factor > MAX_DURATION_EXTENSION_FACTOR)
+    {
+      RCLCPP_ERROR_STREAM(getLogger(),
+                          "Ruckig extended the trajectory duration to its maximum and still did not find a solution");
+      if (!success)
+      {
+        RCLCPP_ERROR_STREAM(getLogger(), "Ruckig trajectory smoothing failed. Ruckig error: " << ruckig_result);
+        // Undo the slow-down so the caller gets the waypoint back as it was passed in
+        duration_from_previous = requested_duration;
+        for (size_t joint = 0; joint < num_dof_; ++joint)
+        {
+          waypoint.setVariableVelocity(idx[joint], requested_velocity_[joint]);
+          waypoint.setVariableAcceleration(idx[joint], requested_acceleration_[joint]);
+        }
+        return false;
+      }
+      break;
+    }
+
+    // Slow down at the waypoint and re-calculate its acceleration for the longer segment
+    duration_from_previous = duration_extension_factor * requested_duration;
+    for (size_t joint = 0; joint < num_dof_; ++joint)
+    {
+      const double velocity = requested_velocity_[joint] / duration_extension_factor;
+      waypoint.setVariableVelocity(idx[joint], velocity);
+      waypoint.setVariableAcceleration(idx[joint], (velocity - previous_velocity_[joint]) / duration_from_previous);
+    }
+  }
+
+  // Commit the segment. The waypoint is the start of the next segment.
+  std::swap(ruckig_input_, candidate_input_);
+  std::swap(ruckig_output_, candidate_output_);
+  for (size_t joint = 0; joint < num_dof_; ++joint)
+  {
+    ruckig_input_.current_position.at(joint) = ruckig_input_.target_position.at(joint);
+    ruckig_input_.current_velocity.at(joint) = ruckig_input_.target_velocity.at(joint);
+    ruckig_input_.current_acceleration.at(joint) = ruckig_input_.target_acceleration.at(joint);
+    previous_velocity_[joint] = waypoint.getVariableVelocity(idx[joint]);
+  }
+  return true;
+}
+
+double RuckigStreamingSmoother::getLastSegmentDuration() const
+{
+  return ruckig_output_.get_duration();
+}
+
+void RuckigStreamingSmoother::sampleLastSegment(const double time, std::vector<double>& positions,
+                                                std::vector<double>& velocities,
+                                                std::vector<double>& accelerations) const
+{
+  positions.resize(num_dof_);
+  velocities.resize(num_dof_);
+  accelerations.resize(num_dof_);
+  ruckig_output_.at_time(time, positions, velocities, accelerations);
+}
+
+void RuckigStreamingSmoother::setTarget(const moveit::core::RobotState& waypoint,
+                                        ruckig::InputParameter<ruckig::DynamicDOFs>& input) const
+{
+  const std::vector<int>& idx = group_->getVariableIndexList();
+  for (size_t joint = 0; joint < num_dof_; ++joint)
+  {
+    // Clamp velocities/accelerations in case they exceed the limit due to small numerical errors
+    input.target_position.at(joint) = waypoint.getVariablePosition(idx[joint]);
+    input.target_velocity.at(joint) =
+        std::clamp(waypoint.getVariableVelocity(idx[joint]), -input.max_velocity.at(joint),
+                   input.max_velocity.at(joint));
+    input.target_acceleration.at(joint) =
+        std::clamp(waypoint.getVariableAcceleration(idx[joint]), -input.max_acceleration.at(joint),
+                   input.max_acceleration.at(joint));
+  }
+}
 }  // namespace trajectory_processing
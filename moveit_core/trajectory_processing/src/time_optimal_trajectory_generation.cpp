@@ -44,6 +44,7 @@
 #include <cmath>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 #include <vector>
+#include <moveit/dynamics_solver/dynamics_solver.h>
 #include <moveit/utils/logger.hpp>
 
 namespace trajectory_processing
@@ -53,11 +54,73 @@ namespace
 constexpr double DEFAULT_TIMESTEP = 1e-3;
 constexpr double EPS = 1e-6;
 constexpr double DEFAULT_SCALING_FACTOR = 1.0;
+// Path distance between two inverse dynamics samples, and the bounds of the sample count
+constexpr double DYNAMICS_SAMPLE_SPACING = 0.01;
+constexpr std::size_t MIN_DYNAMICS_SAMPLES = 2;
+constexpr std::size_t MAX_DYNAMICS_SAMPLES = 10000;
 
 rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.core.time_optimal_trajectory_generation");
 }
+
+// Samples the inverse dynamics along the path. Every sample takes n + 2 inverse dynamics evaluations for n joints:
+// the gravity torques g(q), the velocity torques g(q) + h(q, q') and each column k of the mass matrix g(q) + M(q) e_k.
+// All of them are computed in one batch so that the dynamics solver can split them among its threads.
+std::optional<PathDynamics> computePathDynamics(const Path& path, const dynamics_solver::DynamicsSolver& solver,
+                                                unsigned int num_threads)
+{
+  const Eigen::Index num_joints = path.getConfig(0.0).size();
+  const std::vector<double>& max_torques = solver.getMaxTorques();
+  if (max_torques.size() != static_cast<std::size_t>(num_joints))
+  {
+    RCLCPP_ERROR(getLogger(), "The dynamics solver has %zu joints, but the trajectory has %ld.", max_torques.size(),
+                 static_cast<long>(num_joints));
+    return std::nullopt;
+  }
+
+  const std::size_t sample_count =
+      std::clamp(static_cast<std::size_t>(std::ceil(path.getLength() / DYNAMICS_SAMPLE_SPACING)) + 1,
+                 MIN_DYNAMICS_SAMPLES, MAX_DYNAMICS_SAMPLES);
+  const Eigen::Index columns = num_joints + 2;
+  PathDynamics dynamics;
+  dynamics.sample_spacing = path.getLength() / (sample_count - 1);
+
+  Eigen::MatrixXd positions(num_joints, sample_count * columns);
+  Eigen::MatrixXd velocities = Eigen::MatrixXd::Zero(num_joints, sample_count * columns);
+  Eigen::MatrixXd accelerations = Eigen::MatrixXd::Zero(num_joints, sample_count * columns);
+  std::size_t segment_hint = 0;
+  for (std::size_t i = 0; i < sample_count; ++i)
+  {
+    const double path_pos = std::min(i * dynamics.sample_spacing, path.getLength());
+    const Eigen::Index first = i * columns;
+    positions.middleCols(first, columns).colwise() = path.getConfig(path_pos, segment_hint);
+    velocities.col(first + 1) = path.getTangent(path_pos, segment_hint);
+    accelerations.block(0, first + 2, num_joints, num_joints).setIdentity();
+  }
+
+  Eigen::MatrixXd torques;
+  if (!solver.getTorquesBatch(positions, velocities, accelerations, torques, num_threads))
+    return std::nullopt;
+
+  dynamics.mass_matrices.reserve(sample_count);
+  dynamics.velocity_torques.reserve(sample_count);
+  dynamics.gravity_torques.reserve(sample_count);
+  for (std::size_t i = 0; i < sample_count; ++i)
+  {
+    const Eigen::Index first = i * columns;
+    const Eigen::VectorXd gravity_torques = torques.col(first);
+    dynamics.gravity_torques.push_back(gravity_torques);
+    dynamics.velocity_torques.push_back(torques.col(first + 1) - gravity_torques);
+    dynamics.mass_matrices.push_back(torques.middleCols(first + 2, num_joints).colwise() - gravity_torques);
+  }
+
+  // Joints without an effort limit in the URDF are not torque limited
+  dynamics.max_torque.resize(num_joints);
+  for (Eigen::Index j = 0; j < num_joints; ++j)
+    dynamics.max_torque[j] = max_torques[j] > 0.0 ? max_torques[j] : std::numeric_limits<double>::infinity();
+  return dynamics;
+}
 }  // namespace
 
 class LinearPathSegment : public PathSegment
@@ -85,9 +148,9 @@ public:
     return Eigen::VectorXd::Zero(start_.size());
   }
 
-  std::list<double> getSwitchingPoints() const override
+  std::vector<double> getSwitchingPoints() const override
   {
-    return std::list<double>();
+    return std::vector<double>();
   }
 
   LinearPathSegment* clone() const override
@@ -165,9 +228,9 @@ public:
     return -1.0 / radius_ * (x_ * cos(angle) + y_ * sin(angle));
   }
 
-  std::list<double> getSwitchingPoints() const override
+  std::vector<double> getSwitchingPoints() const override
   {
-    std::list<double> switching_points;
+    std::vector<double> switching_points;
     const double dim = x_.size();
     for (unsigned int i = 0; i < dim; ++i)
     {
@@ -182,7 +245,7 @@ public:
         switching_points.push_back(switching_point);
       }
     }
-    switching_points.sort();
+    std::sort(switching_points.begin(), switching_points.end());
     return switching_points;
   }
 
@@ -271,14 +334,13 @@ std::optional<Path> Path::create(const std::vector<Eigen::VectorXd>& waypoints,
 
   // Create list of switching point candidates, calculate total path length and
   // absolute positions of path segments
+  path.switching_points_.reserve(path.path_segments_.size());
   for (std::unique_ptr<PathSegment>& path_segment : path.path_segments_)
   {
     path_segment->position_ = path.length_;
-    std::list<double> local_switching_points = path_segment->getSwitchingPoints();
-    for (std::list<double>::const_iterator point = local_switching_points.begin();
-         point != local_switching_points.end(); ++point)
+    for (const double point : path_segment->getSwitchingPoints())
     {
-      path.switching_points_.push_back(std::make_pair(path.length_ + *point, false));
+      path.switching_points_.push_back(std::make_pair(path.length_ + point, false));
     }
     path.length_ += path_segment->getLength();
     while (!path.switching_points_.empty() && path.switching_points_.back().first >= path.length_)
@@ -291,6 +353,7 @@ std::optional<Path> Path::create(const std::vector<Eigen::VectorXd>& waypoints,
 
 Path::Path(const Path& path) : length_(path.length_), switching_points_(path.switching_points_)
 {
+  path_segments_.reserve(path.path_segments_.size());
   for (const std::unique_ptr<PathSegment>& path_segment : path.path_segments_)
   {
     path_segments_.emplace_back(path_segment->clone());
@@ -302,45 +365,81 @@ double Path::getLength() const
   return length_;
 }
 
-PathSegment* Path::getPathSegment(double& s) const
+std::size_t Path::findPathSegment(double s) const
 {
-  std::list<std::unique_ptr<PathSegment>>::const_iterator it = path_segments_.begin();
-  std::list<std::unique_ptr<PathSegment>>::const_iterator next = it;
-  ++next;
-  while (next != path_segments_.end() && s >= (*next)->position_)
+  // The last segment starting at or before s. The first segment is also used for s < 0.
+  const auto next = std::upper_bound(
+      path_segments_.begin() + 1, path_segments_.end(), s,
+      [](double value, const std::unique_ptr<PathSegment>& segment) { return value < segment->position_; });
+  return static_cast<std::size_t>(next - path_segments_.begin()) - 1;
+}
+
+PathSegment* Path::getPathSegment(double& s, std::size_t& segment_hint) const
+{
+  const auto contains = [this, s](std::size_t index) {
+    return index < path_segments_.size() && (index == 0 || path_segments_[index]->position_ <= s) &&
+           (index + 1 == path_segments_.size() || s < path_segments_[index + 1]->position_);
+  };
+  if (!contains(segment_hint))
   {
-    it = next;
-    ++next;
+    if (contains(segment_hint + 1))
+    {
+      ++segment_hint;
+    }
+    else if (segment_hint > 0 && contains(segment_hint - 1))
+    {
+      --segment_hint;
+    }
+    else
+    {
+      segment_hint = findPathSegment(s);
+    }
   }
-  s -= (*it)->position_;
-  return (*it).get();
+  s -= path_segments_[segment_hint]->position_;
+  return path_segments_[segment_hint].get();
 }
 
 Eigen::VectorXd Path::getConfig(double s) const
 {
-  const PathSegment* path_segment = getPathSegment(s);
-  return path_segment->getConfig(s);
+  std::size_t segment = findPathSegment(s);
+  return getConfig(s, segment);
 }
 
 Eigen::VectorXd Path::getTangent(double s) const
 {
-  const PathSegment* path_segment = getPathSegment(s);
-  return path_segment->getTangent(s);
+  std::size_t segment = findPathSegment(s);
+  return getTangent(s, segment);
 }
 
 Eigen::VectorXd Path::getCurvature(double s) const
 {
-  const PathSegment* path_segment = getPathSegment(s);
+  std::size_t segment = findPathSegment(s);
+  return getCurvature(s, segment);
+}
+
+Eigen::VectorXd Path::getConfig(double s, std::size_t& segment_hint) const
+{
+  const PathSegment* path_segment = getPathSegment(s, segment_hint);
+  return path_segment->getConfig(s);
+}
+
+Eigen::VectorXd Path::getTangent(double s, std::size_t& segment_hint) const
+{
+  const PathSegment* path_segment = getPathSegment(s, segment_hint);
+  return path_segment->getTangent(s);
+}
+
+Eigen::VectorXd Path::getCurvature(double s, std::size_t& segment_hint) const
+{
+  const PathSegment* path_segment = getPathSegment(s, segment_hint);
   return path_segment->getCurvature(s);
 }
 
 double Path::getNextSwitchingPoint(double s, bool& discontinuity) const
 {
-  std::list<std::pair<double, bool>>::const_iterator it = switching_points_.begin();
-  while (it != switching_points_.end() && it->first <= s)
-  {
-    ++it;
-  }
+  const auto it =
+      std::upper_bound(switching_points_.begin(), switching_points_.end(), s,
+                       [](double value, const std::pair<double, bool>& point) { return value < point.first; });
   if (it == switching_points_.end())
   {
     discontinuity = true;
@@ -350,21 +449,58 @@ double Path::getNextSwitchingPoint(double s, bool& discontinuity) const
   return it->first;
 }
 
-std::list<std::pair<double, bool>> Path::getSwitchingPoints() const
+const std::vector<std::pair<double, bool>>& Path::getSwitchingPoints() const
 {
   return switching_points_;
 }
 
-std::optional<Trajectory> Trajectory::create(const Path& path, const Eigen::VectorXd& max_velocity,
+std::optional<Trajectory> Trajectory::create(Path path, const Eigen::VectorXd& max_velocity,
                                              const Eigen::VectorXd& max_acceleration, double time_step)
 {
-  if (time_step <= 0)
+  return integrate(Trajectory(std::move(path), max_velocity, max_acceleration, nullptr, time_step));
+}
+
+std::optional<Trajectory> Trajectory::create(Path path, const Eigen::VectorXd& max_velocity,
+                                             const Eigen::VectorXd& max_acceleration, PathDynamics dynamics,
+                                             double time_step)
+{
+  const std::size_t sample_count = dynamics.mass_matrices.size();
+  if (dynamics.sample_spacing <= 0.0 || sample_count == 0 || dynamics.velocity_torques.size() != sample_count ||
+      dynamics.gravity_torques.size() != sample_count || dynamics.max_torque.size() != max_velocity.size())
+  {
+    RCLCPP_ERROR(getLogger(), "The trajectory is invalid because the path dynamics are inconsistent.");
+    return std::nullopt;
+  }
+  // The path velocity can only be increased from rest if every joint can hold the path against gravity
+  for (std::size_t i = 0; i < sample_count; ++i)
+  {
+    for (Eigen::Index j = 0; j < dynamics.max_torque.size(); ++j)
+    {
+      if (std::abs(dynamics.gravity_torques[i][j]) > dynamics.max_torque[j])
+      {
+        RCLCPP_ERROR(getLogger(),
+                     "The trajectory is invalid because the gravity torque of joint %ld exceeds its limit at path "
+                     "position %f.",
+                     static_cast<long>(j), i * dynamics.sample_spacing);
+        return std::nullopt;
+      }
+    }
+  }
+
+  return integrate(Trajectory(std::move(path), max_velocity, max_acceleration,
+                              std::make_shared<const PathDynamics>(std::move(dynamics)), time_step));
+}
+
+std::optional<Trajectory> Trajectory::integrate(Trajectory output)
+{
+  if (output.time_step_ <= 0)
   {
     RCLCPP_ERROR(getLogger(), "The trajectory is invalid because the time step is <= 0.0.");
     return std::nullopt;
   }
 
-  Trajectory output(path, max_velocity, max_acceleration, time_step);
+  // Roughly one step per time step at nominal speed; the buffer grows if needed.
+  output.trajectory_.reserve(std::max<std::size_t>(16, output.path_.getLength() / output.time_step_));
   output.trajectory_.push_back(TrajectoryStep(0.0, 0.0));
   double after_acceleration = output.getMinMaxPathAcceleration(0.0, 0.0, true);
   while (output.valid_ && !output.integrateForward(output.trajectory_, after_acceleration) && output.valid_)
@@ -396,8 +532,8 @@ std::optional<Trajectory> Trajectory::create(const Path& path, const Eigen::Vect
   }
 
   // Calculate timing.
-  std::list<TrajectoryStep>::iterator previous = output.trajectory_.begin();
-  std::list<TrajectoryStep>::iterator it = previous;
+  std::vector<TrajectoryStep>::iterator previous = output.trajectory_.begin();
+  std::vector<TrajectoryStep>::iterator it = previous;
   it->time_ = 0.0;
   ++it;
   while (it != output.trajectory_.end())
@@ -410,9 +546,13 @@ std::optional<Trajectory> Trajectory::create(const Path& path, const Eigen::Vect
   return output;
 }
 
-Trajectory::Trajectory(const Path& path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
-                       double time_step)
-  : path_(path), max_velocity_(max_velocity), max_acceleration_(max_acceleration), time_step_(time_step)
+Trajectory::Trajectory(Path path, const Eigen::VectorXd& max_velocity, const Eigen::VectorXd& max_acceleration,
+                       std::shared_ptr<const PathDynamics> dynamics, double time_step)
+  : path_(std::move(path))
+  , max_velocity_(max_velocity)
+  , max_acceleration_(max_acceleration)
+  , dynamics_(std::move(dynamics))
+  , time_step_(time_step)
 {
   joint_num_ = max_velocity.size();
 }
@@ -561,13 +701,16 @@ bool Trajectory::getNextVelocitySwitchingPoint(double path_pos, TrajectoryStep&
 }
 
 // Returns true if end of path is reached
-bool Trajectory::integrateForward(std::list<TrajectoryStep>& trajectory, double acceleration)
+bool Trajectory::integrateForward(std::vector<TrajectoryStep>& trajectory, double acceleration)
 {
   double path_pos = trajectory.back().path_pos_;
   double path_vel = trajectory.back().path_vel_;
 
-  std::list<std::pair<double, bool>> switching_points = path_.getSwitchingPoints();
-  std::list<std::pair<double, bool>>::iterator next_discontinuity = switching_points.begin();
+  // Switching points at or before the start position are skipped anyway, so start the search right after it
+  const std::vector<std::pair<double, bool>>& switching_points = path_.getSwitchingPoints();
+  std::vector<std::pair<double, bool>>::const_iterator next_discontinuity =
+      std::upper_bound(switching_points.begin(), switching_points.end(), path_pos,
+                       [](double value, const std::pair<double, bool>& point) { return value < point.first; });
 
   while (true)
   {
@@ -687,14 +830,17 @@ bool Trajectory::integrateForward(std::list<TrajectoryStep>& trajectory, double
   }
 }
 
-void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
+void Trajectory::integrateBackward(std::vector<TrajectoryStep>& start_trajectory, double path_pos, double path_vel,
                                    double acceleration)
 {
-  std::list<TrajectoryStep>::iterator start2 = start_trajectory.end();
+  std::vector<TrajectoryStep>::iterator start2 = start_trajectory.end();
   --start2;
-  std::list<TrajectoryStep>::iterator start1 = start2;
+  std::vector<TrajectoryStep>::iterator start1 = start2;
   --start1;
-  std::list<TrajectoryStep> trajectory;
+  // The backward trajectory is built in reverse order (last step first), so that steps can be appended. The buffer is
+  // kept per thread to reuse its capacity across backward passes and trajectories.
+  thread_local std::vector<TrajectoryStep> trajectory;
+  trajectory.clear();
   double slope;
   assert(start1->path_pos_ <= path_pos);
 
@@ -702,17 +848,17 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
   {
     if (start1->path_pos_ <= path_pos)
     {
-      trajectory.push_front(TrajectoryStep(path_pos, path_vel));
+      trajectory.push_back(TrajectoryStep(path_pos, path_vel));
       path_vel -= time_step_ * acceleration;
-      path_pos -= time_step_ * 0.5 * (path_vel + trajectory.front().path_vel_);
+      path_pos -= time_step_ * 0.5 * (path_vel + trajectory.back().path_vel_);
       acceleration = getMinMaxPathAcceleration(path_pos, path_vel, false);
-      slope = (trajectory.front().path_vel_ - path_vel) / (trajectory.front().path_pos_ - path_pos);
+      slope = (trajectory.back().path_vel_ - path_vel) / (trajectory.back().path_pos_ - path_pos);
 
       if (path_vel < 0.0)
       {
         valid_ = false;
         RCLCPP_ERROR(getLogger(), "Error while integrating backward: Negative path velocity");
-        end_trajectory_ = trajectory;
+        end_trajectory_.assign(trajectory.rbegin(), trajectory.rend());
         return;
       }
     }
@@ -728,26 +874,26 @@ void Trajectory::integrateBackward(std::list<TrajectoryStep>& start_trajectory,
     const double intersection_path_pos =
         (start1->path_vel_ - path_vel + slope * path_pos - start_slope * start1->path_pos_) / (slope - start_slope);
     if (std::max(start1->path_pos_, path_pos) - EPS <= intersection_path_pos &&
-        intersection_path_pos <= EPS + std::min(start2->path_pos_, trajectory.front().path_pos_))
+        intersection_path_pos <= EPS + std::min(start2->path_pos_, trajectory.back().path_pos_))
     {
       const double intersection_path_vel =
           start1->path_vel_ + start_slope * (intersection_path_pos - start1->path_pos_);
       start_trajectory.erase(start2, start_trajectory.end());
       start_trajectory.push_back(TrajectoryStep(intersection_path_pos, intersection_path_vel));
-      start_trajectory.splice(start_trajectory.end(), trajectory);
+      start_trajectory.insert(start_trajectory.end(), trajectory.rbegin(), trajectory.rend());
       return;
     }
   }
 
   valid_ = false;
   RCLCPP_ERROR(getLogger(), "Error while integrating backward: Did not hit start trajectory");
-  end_trajectory_ = trajectory;
+  end_trajectory_.assign(trajectory.rbegin(), trajectory.rend());
 }
 
 double Trajectory::getMinMaxPathAcceleration(double path_pos, double path_vel, bool max)
 {
-  Eigen::VectorXd config_deriv = path_.getTangent(path_pos);
-  Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos);
+  Eigen::VectorXd config_deriv = path_.getTangent(path_pos, path_segment_hint_);
+  Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos, path_segment_hint_);
   double factor = max ? 1.0 : -1.0;
   double max_path_acceleration = std::numeric_limits<double>::max();
   for (unsigned int i = 0; i < joint_num_; ++i)
@@ -759,6 +905,21 @@ double Trajectory::getMinMaxPathAcceleration(double path_pos, double path_vel, b
                                               factor * config_deriv2[i] * path_vel * path_vel / config_deriv[i]);
     }
   }
+  if (dynamics_)
+  {
+    // The torque limits bound the path acceleration like the acceleration limits, with the gravity torque as offset
+    Eigen::VectorXd a, b, c;
+    getTorqueCoefficients(path_pos, config_deriv, config_deriv2, a, b, c);
+    for (unsigned int i = 0; i < joint_num_; ++i)
+    {
+      if (a[i] != 0.0)
+      {
+        max_path_acceleration =
+            std::min(max_path_acceleration, dynamics_->max_torque[i] / std::abs(a[i]) -
+                                                factor * (c[i] + b[i] * path_vel * path_vel) / a[i]);
+      }
+    }
+  }
   return factor * max_path_acceleration;
 }
 
@@ -770,8 +931,8 @@ double Trajectory::getMinMaxPhaseSlope(double path_pos, double path_vel, bool ma
 double Trajectory::getAccelerationMaxPathVelocity(double path_pos) const
 {
   double max_path_velocity = std::numeric_limits<double>::infinity();
-  const Eigen::VectorXd config_deriv = path_.getTangent(path_pos);
-  const Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos);
+  const Eigen::VectorXd config_deriv = path_.getTangent(path_pos, path_segment_hint_);
+  const Eigen::VectorXd config_deriv2 = path_.getCurvature(path_pos, path_segment_hint_);
   for (unsigned int i = 0; i < joint_num_; ++i)
   {
     if (config_deriv[i] != 0.0)
@@ -795,12 +956,75 @@ double Trajectory::getAccelerationMaxPathVelocity(double path_pos) const
       max_path_velocity = std::min(max_path_velocity, sqrt(max_acceleration_[i] / std::abs(config_deriv2[i])));
     }
   }
+
+  if (dynamics_)
+  {
+    // Every constraint limits the path acceleration to [(-limit - c - b * s_d^2) / |a|, (limit - c - b * s_d^2) / |a|]
+    // (for positive a). The path velocity is limited where the lower bound of one constraint exceeds the upper bound of
+    // another one, which is checked for all pairs of constraints that include a torque constraint.
+    Eigen::VectorXd a, b, c;
+    getTorqueCoefficients(path_pos, config_deriv, config_deriv2, a, b, c);
+    const auto limit_pair = [&max_path_velocity](double a_k, double b_k, double c_k, double limit_k, double a_l,
+                                                 double b_l, double c_l, double limit_l) {
+      const double slope_difference = b_l / a_l - b_k / a_k;
+      if (slope_difference == 0.0)
+        return;
+      const double offset = slope_difference > 0.0 ? c_k / a_k - c_l / a_l : c_l / a_l - c_k / a_k;
+      const double range = limit_k / std::abs(a_k) + limit_l / std::abs(a_l) + offset;
+      max_path_velocity = std::min(max_path_velocity, sqrt(std::max(0.0, range) / std::abs(slope_difference)));
+    };
+
+    const Eigen::VectorXd& max_torque = dynamics_->max_torque;
+    for (unsigned int i = 0; i < joint_num_; ++i)
+    {
+      if (a[i] == 0.0)
+      {
+        if (b[i] != 0.0)
+        {
+          // |b * s_d^2 + c| <= limit bounds s_d^2 by (limit - c) / b for positive b and (limit + c) / -b otherwise
+          const double range = max_torque[i] - (b[i] > 0.0 ? c[i] : -c[i]);
+          max_path_velocity = std::min(max_path_velocity, sqrt(std::max(0.0, range) / std::abs(b[i])));
+        }
+        continue;
+      }
+      for (unsigned int j = 0; j < joint_num_; ++j)
+      {
+        if (config_deriv[j] != 0.0)
+          limit_pair(config_deriv[j], config_deriv2[j], 0.0, max_acceleration_[j], a[i], b[i], c[i], max_torque[i]);
+      }
+      for (unsigned int j = i + 1; j < joint_num_; ++j)
+      {
+        if (a[j] != 0.0)
+          limit_pair(a[j], b[j], c[j], max_torque[j], a[i], b[i], c[i], max_torque[i]);
+      }
+    }
+  }
   return max_path_velocity;
 }
 
+void Trajectory::getTorqueCoefficients(double path_pos, const Eigen::VectorXd& config_deriv,
+                                       const Eigen::VectorXd& config_deriv2, Eigen::VectorXd& a, Eigen::VectorXd& b,
+                                       Eigen::VectorXd& c) const
+{
+  // Linear interpolation between the two samples around path_pos
+  const std::size_t last = dynamics_->mass_matrices.size() - 1;
+  const double sample = std::clamp(path_pos / dynamics_->sample_spacing, 0.0, static_cast<double>(last));
+  const std::size_t before = std::min(static_cast<std::size_t>(sample), last > 0 ? last - 1 : 0);
+  const std::size_t after = std::min(before + 1, last);
+  const double weight = std::min(sample - before, 1.0);
+
+  // joint accelerations are q' * s_dd + q'' * s_d^2
+  const Eigen::MatrixXd& mass_before = dynamics_->mass_matrices[before];
+  const Eigen::MatrixXd& mass_after = dynamics_->mass_matrices[after];
+  a = (1.0 - weight) * (mass_before * config_deriv) + weight * (mass_after * config_deriv);
+  b = (1.0 - weight) * (mass_before * config_deriv2 + dynamics_->velocity_torques[before]) +
+      weight * (mass_after * config_deriv2 + dynamics_->velocity_torques[after]);
+  c = (1.0 - weight) * dynamics_->gravity_torques[before] + weight * dynamics_->gravity_torques[after];
+}
+
 double Trajectory::getVelocityMaxPathVelocity(double path_pos) const
 {
-  const Eigen::VectorXd tangent = path_.getTangent(path_pos);
+  const Eigen::VectorXd tangent = path_.getTangent(path_pos, path_segment_hint_);
   double max_path_velocity = std::numeric_limits<double>::max();
   for (unsigned int i = 0; i < joint_num_; ++i)
   {
@@ -817,7 +1041,7 @@ double Trajectory::getAccelerationMaxPathVelocityDeriv(double path_pos)
 
 double Trajectory::getVelocityMaxPathVelocityDeriv(double path_pos)
 {
-  const Eigen::VectorXd tangent = path_.getTangent(path_pos);
+  const Eigen::VectorXd tangent = path_.getTangent(path_pos, path_segment_hint_);
   double max_path_velocity = std::numeric_limits<double>::max();
   unsigned int active_constraint;
   for (unsigned int i = 0; i < joint_num_; ++i)
@@ -829,7 +1053,8 @@ double Trajectory::getVelocityMaxPathVelocityDeriv(double path_pos)
       active_constraint = i;
     }
   }
-  return -(max_velocity_[active_constraint] * path_.getCurvature(path_pos)[active_constraint]) /
+  const Eigen::VectorXd curvature = path_.getCurvature(path_pos, path_segment_hint_);
+  return -(max_velocity_[active_constraint] * curvature[active_constraint]) /
          (tangent[active_constraint] * std::abs(tangent[active_constraint]));
 }
 
@@ -838,33 +1063,36 @@ double Trajectory::getDuration() const
   return trajectory_.back().time_;
 }
 
-std::list<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectorySegment(double time) const
+std::vector<Trajectory::TrajectoryStep>::const_iterator Trajectory::getTrajectorySegment(double time) const
 {
   if (time >= trajectory_.back().time_)
   {
-    std::list<TrajectoryStep>::const_iterator last = trajectory_.end();
+    std::vector<TrajectoryStep>::const_iterator last = trajectory_.end();
     last--;
     return last;
   }
   else
   {
-    if (time < cached_time_)
-    {
-      cached_trajectory_segment_ = trajectory_.begin();
-    }
-    while (time >= cached_trajectory_segment_->time_)
+    // First step after the given time. Samples are usually requested in increasing time order, so the search can
+    // start at the previous result.
+    std::vector<TrajectoryStep>::const_iterator first = trajectory_.begin();
+    if (time >= cached_time_)
     {
-      ++cached_trajectory_segment_;
+      first += cached_trajectory_segment_;
     }
+    const std::vector<TrajectoryStep>::const_iterator segment =
+        std::upper_bound(first, trajectory_.end(), time,
+                         [](double value, const TrajectoryStep& step) { return value < step.time_; });
+    cached_trajectory_segment_ = segment - trajectory_.begin();
     cached_time_ = time;
-    return cached_trajectory_segment_;
+    return segment;
   }
 }
 
 Eigen::VectorXd Trajectory::getPosition(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -875,13 +1103,13 @@ Eigen::VectorXd Trajectory::getPosition(double time) const
   const double path_pos =
       previous->path_pos_ + time_step * previous->path_vel_ + 0.5 * time_step * time_step * acceleration;
 
-  return path_.getConfig(path_pos);
+  return path_.getConfig(path_pos, path_segment_hint_);
 }
 
 Eigen::VectorXd Trajectory::getVelocity(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -892,13 +1120,13 @@ Eigen::VectorXd Trajectory::getVelocity(double time) const
       previous->path_pos_ + time_step * previous->path_vel_ + 0.5 * time_step * time_step * acceleration;
   const double path_vel = previous->path_vel_ + time_step * acceleration;
 
-  return path_.getTangent(path_pos) * path_vel;
+  return path_.getTangent(path_pos, path_segment_hint_) * path_vel;
 }
 
 Eigen::VectorXd Trajectory::getAcceleration(double time) const
 {
-  std::list<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
-  std::list<TrajectoryStep>::const_iterator previous = it;
+  std::vector<TrajectoryStep>::const_iterator it = getTrajectorySegment(time);
+  std::vector<TrajectoryStep>::const_iterator previous = it;
   previous--;
 
   double time_step = it->time_ - previous->time_;
@@ -909,7 +1137,8 @@ Eigen::VectorXd Trajectory::getAcceleration(double time) const
       previous->path_pos_ + time_step * previous->path_vel_ + 0.5 * time_step * time_step * acceleration;
   const double path_vel = previous->path_vel_ + time_step * acceleration;
   Eigen::VectorXd path_acc =
-      (path_.getTangent(path_pos) * path_vel - path_.getTangent(previous->path_pos_) * previous->path_vel_);
+      (path_.getTangent(path_pos, path_segment_hint_) * path_vel -
+       path_.getTangent(previous->path_pos_, path_segment_hint_) * previous->path_vel_);
   if (time_step > 0.0)
     path_acc /= time_step;
   return path_acc;
@@ -935,6 +1164,50 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
     return false;
   }
 
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  if (!getJointLimits(group, max_velocity_scaling_factor, max_acceleration_scaling_factor, max_velocity,
+                      max_acceleration))
+    return false;
+
+  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration);
+}
+
+bool TimeOptimalTrajectoryGeneration::computeTimeStampsWithTorqueLimits(
+    robot_trajectory::RobotTrajectory& trajectory, const dynamics_solver::DynamicsSolver& dynamics_solver,
+    const double max_velocity_scaling_factor, const double max_acceleration_scaling_factor,
+    const unsigned int num_threads) const
+{
+  if (trajectory.empty())
+    return true;
+
+  const moveit::core::JointModelGroup* group = trajectory.getGroup();
+  if (!group)
+  {
+    RCLCPP_ERROR(getLogger(), "It looks like the planner did not set the group the plan was computed for");
+    return false;
+  }
+  if (dynamics_solver.getGroup() != group)
+  {
+    RCLCPP_ERROR(getLogger(), "The dynamics solver was not constructed for group '%s'", group->getName().c_str());
+    return false;
+  }
+
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  if (!getJointLimits(group, max_velocity_scaling_factor, max_acceleration_scaling_factor, max_velocity,
+                      max_acceleration))
+    return false;
+
+  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration, &dynamics_solver, num_threads);
+}
+
+bool TimeOptimalTrajectoryGeneration::getJointLimits(const moveit::core::JointModelGroup* group,
+                                                     const double max_velocity_scaling_factor,
+                                                     const double max_acceleration_scaling_factor,
+                                                     Eigen::VectorXd& max_velocity,
+                                                     Eigen::VectorXd& max_acceleration) const
+{
   // Validate scaling
   double velocity_scaling_factor = verifyScalingFactor(max_velocity_scaling_factor, VELOCITY);
   double acceleration_scaling_factor = verifyScalingFactor(max_acceleration_scaling_factor, ACCELERATION);
@@ -949,8 +1222,8 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
   }
 
   const size_t num_active_joints = active_joint_indices.size();
-  Eigen::VectorXd max_velocity(num_active_joints);
-  Eigen::VectorXd max_acceleration(num_active_joints);
+  max_velocity.resize(num_active_joints);
+  max_acceleration.resize(num_active_joints);
   for (size_t idx = 0; idx < num_active_joints; ++idx)
   {
     // For active joints only (skip mimic joints and other types)
@@ -1000,7 +1273,7 @@ bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotT
     }
   }
 
-  return doTimeParameterizationCalculations(trajectory, max_velocity, max_acceleration);
+  return true;
 }
 
 bool TimeOptimalTrajectoryGeneration::computeTimeStamps(robot_trajectory::RobotTrajectory& trajectory,
@@ -1159,9 +1432,10 @@ bool totgComputeTimeStamps(const size_t num_waypoints, robot_trajectory::RobotTr
   return true;
 }
 
-bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_trajectory::RobotTrajectory& trajectory,
-                                                                         const Eigen::VectorXd& max_velocity,
-                                                                         const Eigen::VectorXd& max_acceleration) const
+bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(
+    robot_trajectory::RobotTrajectory& trajectory, const Eigen::VectorXd& max_velocity,
+    const Eigen::VectorXd& max_acceleration, const dynamics_solver::DynamicsSolver* dynamics_solver,
+    const unsigned int num_threads) const
 {
   // This lib does not actually work properly when angles wrap around, so we need to unwind the path first
   trajectory.unwind();
@@ -1186,16 +1460,18 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
   // Have to convert into Eigen data structs and remove repeated points
   //  (https://github.com/tobiaskunz/trajectories/issues/3)
   std::vector<Eigen::VectorXd> points;
+  points.reserve(num_points);
   for (size_t p = 0; p < num_points; ++p)
   {
-    moveit::core::RobotStatePtr waypoint = trajectory.getWayPointPtr(p);
+    // Read-only access, so that trajectories in compact storage are not converted to robot states
+    const moveit::core::RobotState& waypoint = trajectory.getWayPoint(p);
     Eigen::VectorXd new_point(num_joints);
     // The first point should always be kept
     bool diverse_point = (p == 0);
 
     for (size_t j = 0; j < num_joints; ++j)
     {
-      new_point[j] = waypoint->getVariablePosition(idx[j]);
+      new_point[j] = waypoint.getVariablePosition(idx[j]);
       // If any joint angle is different, it's a unique waypoint
       if (p > 0 && std::fabs(new_point[j] - points.back()[j]) > min_angle_change_)
       {
@@ -1205,7 +1481,7 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
 
     if (diverse_point)
     {
-      points.push_back(new_point);
+      points.push_back(std::move(new_point));
       // If the last point is not a diverse_point we replace the last added point with it to make sure to always have
       // the input end point as the last point
     }
@@ -1234,7 +1510,22 @@ bool TimeOptimalTrajectoryGeneration::doTimeParameterizationCalculations(robot_t
     return false;
   }
 
-  std::optional<Trajectory> parameterized = Trajectory::create(*path, max_velocity, max_acceleration, DEFAULT_TIMESTEP);
+  std::optional<Trajectory> parameterized;
+  if (dynamics_solver)
+  {
+    std::optional<PathDynamics> dynamics = computePathDynamics(*path, *dynamics_solver, num_threads);
+    if (!dynamics)
+    {
+      RCLCPP_ERROR(getLogger(), "Couldn't compute the dynamics along the path");
+      return false;
+    }
+    parameterized =
+        Trajectory::create(std::move(*path), max_velocity, max_acceleration, std::move(*dynamics), DEFAULT_TIMESTEP);
+  }
+  else
+  {
+    parameterized = Trajectory::create(std::move(*path), max_velocity, max_acceleration, DEFAULT_TIMESTEP);
+  }
   if (!parameterized)
   {
     RCLCPP_ERROR(getLogger(), "Couldn't create trajectory");
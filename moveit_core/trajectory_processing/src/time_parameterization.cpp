@@ -0,0 +1,103 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/trajectory_processing/time_parameterization.h>
+#include <moveit/utils/logger.hpp>
+#include <moveit/utils/parallel_for.h>
+
+#include <rclcpp/logger.hpp>
+#include <rclcpp/logging.hpp>
+
+namespace trajectory_processing
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.trajectory_processing.time_parameterization");
+}
+}  // namespace
+
+std::vector<bool> processTrajectoryBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                         const std::function<bool(robot_trajectory::RobotTrajectory&)>& process,
+                                         std::size_t num_threads)
+{
+  // std::vector<bool> cannot be written concurrently, so collect the results per element first
+  std::vector<char> success(trajectories.size(), 0);
+  moveit::core::parallelFor(trajectories.size(), num_threads, [&](std::size_t i) {
+    if (trajectories[i])
+    {
+      success[i] = process(*trajectories[i]);
+    }
+    else
+    {
+      RCLCPP_ERROR(getLogger(), "Trajectory %zu of the batch is null.", i);
+    }
+  });
+  return std::vector<bool>(success.begin(), success.end());
+}
+
+// Each call of computeTimeStamps() is const and only touches the given trajectory, so the batch is processed by
+// running it on multiple threads. Per-thread scratch buffers are kept by the implementations themselves.
+std::vector<bool>
+TimeParameterization::computeTimeStampsBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                             const double max_velocity_scaling_factor,
+                                             const double max_acceleration_scaling_factor,
+                                             const std::size_t num_threads) const
+{
+  return processTrajectoryBatch(
+      trajectories,
+      [&](robot_trajectory::RobotTrajectory& trajectory) {
+        return computeTimeStamps(trajectory, max_velocity_scaling_factor, max_acceleration_scaling_factor);
+      },
+      num_threads);
+}
+
+std::vector<bool>
+TimeParameterization::computeTimeStampsBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                             const std::unordered_map<std::string, double>& velocity_limits,
+                                             const std::unordered_map<std::string, double>& acceleration_limits,
+                                             const double max_velocity_scaling_factor,
+                                             const double max_acceleration_scaling_factor,
+                                             const std::size_t num_threads) const
+{
+  return processTrajectoryBatch(
+      trajectories,
+      [&](robot_trajectory::RobotTrajectory& trajectory) {
+        return computeTimeStamps(trajectory, velocity_limits, acceleration_limits, max_velocity_scaling_factor,
+                                 max_acceleration_scaling_factor);
+      },
+      num_threads);
+}
+}  // namespace trajectory_processing
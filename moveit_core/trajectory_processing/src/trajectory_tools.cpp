@@ -75,6 +75,31 @@ bool applyRuckigSmoothing(robot_trajectory::RobotTrajectory& trajectory, double
                                    overshoot_threshold);
 }
 
+std::vector<bool>
+applyTOTGTimeParameterizationBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                   double velocity_scaling_factor, double acceleration_scaling_factor,
+                                   double path_tolerance, double resample_dt, double min_angle_change,
+                                   std::size_t num_threads)
+{
+  TimeOptimalTrajectoryGeneration totg(path_tolerance, resample_dt, min_angle_change);
+  return totg.computeTimeStampsBatch(trajectories, velocity_scaling_factor, acceleration_scaling_factor, num_threads);
+}
+
+std::vector<bool> applyRuckigSmoothingBatch(const std::vector<robot_trajectory::RobotTrajectoryPtr>& trajectories,
+                                            double velocity_scaling_factor, double acceleration_scaling_factor,
+                                            bool mitigate_overshoot, double overshoot_threshold,
+                                            std::size_t num_threads)
+{
+  // Ruckig smoothing keeps all of its state on the stack, so every thread uses its own Ruckig instances
+  return processTrajectoryBatch(
+      trajectories,
+      [&](robot_trajectory::RobotTrajectory& trajectory) {
+        return RuckigSmoothing::applySmoothing(trajectory, velocity_scaling_factor, acceleration_scaling_factor,
+                                               mitigate_overshoot, overshoot_threshold);
+      },
+      num_threads);
+}
+
 trajectory_msgs::msg::JointTrajectory createTrajectoryMessage(const std::vector<std::string>& joint_names,
                                                               const trajectory_processing::Trajectory& trajectory,
                                                               const int sampling_rate)
@@ -131,5 +131,98 @@ static void robotTrajectoryTiming(benchmark::State& st)
   }
 }
 
+// Benchmark the TOTG path and trajectory integration alone, on a long path with a blend at every waypoint.
+static void totgPathIntegration(benchmark::State& st)
+{
+  const int n_waypoints = st.range(0);
+  constexpr int N_JOINTS = 7;
+
+  // A wavy path where each joint follows a sinusoid with a different frequency, so no waypoints are collinear.
+  std::vector<Eigen::VectorXd> waypoints;
+  waypoints.reserve(n_waypoints);
+  for (int i = 0; i < n_waypoints; ++i)
+  {
+    Eigen::VectorXd waypoint(N_JOINTS);
+    for (int j = 0; j < N_JOINTS; ++j)
+    {
+      waypoint[j] = std::sin(0.002 * (j + 1) * i);
+    }
+    waypoints.push_back(waypoint);
+  }
+  const Eigen::VectorXd max_velocity = Eigen::VectorXd::Constant(N_JOINTS, 1.0);
+  const Eigen::VectorXd max_acceleration = Eigen::VectorXd::Constant(N_JOINTS, 2.0);
+
+  for (auto _ : st)
+  {
+    std::optional<trajectory_processing::Path> path =
+        trajectory_processing::Path::create(waypoints, /*max_deviation=*/0.001);
+    if (!path)
+    {
+      st.SkipWithError("Path creation failed.");
+      return;
+    }
+    std::optional<trajectory_processing::Trajectory> trajectory =
+        trajectory_processing::Trajectory::create(std::move(*path), max_velocity, max_acceleration);
+    if (!trajectory)
+    {
+      st.SkipWithError("Trajectory integration failed.");
+      return;
+    }
+    benchmark::DoNotOptimize(trajectory->getDuration());
+  }
+}
+
+// Benchmark repeated TOTG calls on fresh copies of the same long trajectory, as done when re-timing plans.
+static void robotTrajectoryRepeatedTiming(benchmark::State& st)
+{
+  const int n_states = st.range(0);
+  const moveit::core::RobotModelPtr& robot_model = moveit::core::loadTestingRobotModel(TEST_ROBOT);
+
+  // Make sure the group exists, otherwise exit early with an error.
+  if (!robot_model->hasJointModelGroup(TEST_GROUP))
+  {
+    st.SkipWithError("The planning group doesn't exist.");
+    return;
+  }
+  auto* group = robot_model->getJointModelGroup(TEST_GROUP);
+
+  moveit::core::RobotState robot_state(robot_model);
+  robot_state.setToDefaultValues();
+
+  robot_trajectory::RobotTrajectory input(robot_model, group);
+  Eigen::VectorXd joint_values(group->getActiveVariableCount());
+  for (int i = 0; i < n_states; ++i)
+  {
+    for (Eigen::Index j = 0; j < joint_values.size(); ++j)
+    {
+      joint_values[j] = 0.5 * std::sin(0.001 * (j + 1) * i);
+    }
+    robot_state.setJointGroupActivePositions(group, joint_values);
+    input.addSuffixWayPoint(robot_state, 0.0);
+  }
+
+  std::unordered_map<std::string, double> velocity_limits, acceleration_limits;
+  for (const auto& joint_name : group->getActiveJointModelNames())
+  {
+    velocity_limits[joint_name] = 1.0;
+    acceleration_limits[joint_name] = 2.0;
+  }
+
+  const trajectory_processing::TimeOptimalTrajectoryGeneration totg(/*path_tolerance=*/0.01);
+  for (auto _ : st)
+  {
+    st.PauseTiming();
+    robot_trajectory::RobotTrajectory trajectory(input, /*deepcopy=*/true);
+    st.ResumeTiming();
+    if (!totg.computeTimeStamps(trajectory, velocity_limits, acceleration_limits))
+    {
+      st.SkipWithError("Time parameterization failed.");
+      return;
+    }
+  }
+}
+
 BENCHMARK(robotTrajectoryCreate)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMillisecond);
 BENCHMARK(robotTrajectoryTiming)->RangeMultiplier(10)->Range(10, 20000)->Unit(benchmark::kMillisecond);
+BENCHMARK(totgPathIntegration)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(robotTrajectoryRepeatedTiming)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
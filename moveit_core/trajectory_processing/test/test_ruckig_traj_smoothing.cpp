@@ -35,9 +35,13 @@
 
 #include <gtest/gtest.h>
 #include <moveit/trajectory_processing/ruckig_traj_smoothing.h>
+#include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
+#include <limits>
+#include <stdexcept>
+
 namespace
 {
 constexpr double DEFAULT_TIMESTEP = 0.1;  // sec
@@ -105,6 +109,36 @@ TEST_F(RuckigTests, basic_trajectory_with_custom_limits)
   EXPECT_TRUE(smoother_.applySmoothing(*trajectory_, vel_limits, accel_limits, jerk_limits));
 }
 
+TEST_F(RuckigTests, compact_trajectory)
+{
+  // GIVEN a trajectory that passes its middle waypoint with a velocity
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  robot_state.setVariablePosition("panda_joint1", 0.05);
+  robot_state.setVariableVelocity("panda_joint1", 0.5);
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+  robot_state.setVariablePosition("panda_joint1", 0.1);
+  robot_state.zeroVelocities();
+  trajectory_->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+
+  robot_trajectory::RobotTrajectory compact(*trajectory_, true);
+  compact.setStorageMode(robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+
+  // WHEN both storage modes are smoothed
+  ASSERT_TRUE(smoother_.applySmoothing(*trajectory_, 1.0, 1.0));
+  ASSERT_TRUE(smoother_.applySmoothing(compact, 1.0, 1.0));
+
+  // THEN the COMPACT trajectory keeps its storage mode and gets the same result
+  EXPECT_EQ(compact.getStorageMode(), robot_trajectory::RobotTrajectory::StorageMode::COMPACT);
+  moveit_msgs::msg::RobotTrajectory expected_msg, compact_msg;
+  trajectory_->getRobotTrajectoryMsg(expected_msg);
+  compact.getRobotTrajectoryMsg(compact_msg);
+  EXPECT_EQ(expected_msg, compact_msg);
+}
+
 TEST_F(RuckigTests, trajectory_duration)
 {
   // Compare against the OJET online trajectory generator: https://www.trajectorygenerator.com/ojet-online/
@@ -139,6 +173,47 @@ TEST_F(RuckigTests, trajectory_duration)
   EXPECT_LT(trajectory_->getWayPointDurationFromStart(trajectory_->getWayPointCount() - 1), 1.11 * ideal_duration);
 }
 
+TEST_F(RuckigTests, batch_smoothing)
+{
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+
+  // Independent trajectories with different goals, plus a null entry which must be reported as failed
+  std::vector<robot_trajectory::RobotTrajectoryPtr> batch;
+  std::vector<robot_trajectory::RobotTrajectory> expected;
+  for (size_t i = 0; i < 6; ++i)
+  {
+    auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, JOINT_GROUP);
+    robot_state.setVariablePosition("panda_joint1", 0.0);
+    trajectory->addSuffixWayPoint(robot_state, 0.0);
+    robot_state.setVariablePosition("panda_joint1", 0.05 * (i + 1));
+    trajectory->addSuffixWayPoint(robot_state, DEFAULT_TIMESTEP);
+
+    expected.emplace_back(*trajectory, true /* deep copy */);
+    ASSERT_TRUE(smoother_.applySmoothing(expected.back(), 1.0, 1.0));
+    batch.push_back(trajectory);
+  }
+  batch.push_back(nullptr);
+
+  const std::vector<bool> success =
+      trajectory_processing::applyRuckigSmoothingBatch(batch, 1.0, 1.0, false, 0.01, 3 /* threads */);
+  ASSERT_EQ(success.size(), batch.size());
+  EXPECT_FALSE(success.back());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_TRUE(success[i]);
+    ASSERT_EQ(batch[i]->getWayPointCount(), expected[i].getWayPointCount());
+    EXPECT_DOUBLE_EQ(batch[i]->getDuration(), expected[i].getDuration());
+  }
+
+  // Exceptions thrown while processing a trajectory reach the calling thread
+  EXPECT_THROW(trajectory_processing::processTrajectoryBatch(
+                   batch, [](robot_trajectory::RobotTrajectory&) -> bool { throw std::runtime_error("failed"); }, 3),
+               std::runtime_error);
+}
+
 TEST_F(RuckigTests, single_waypoint)
 {
   // With only one waypoint, Ruckig cannot smooth the trajectory.
@@ -167,6 +242,83 @@ TEST_F(RuckigTests, single_waypoint)
   }
 }
 
+TEST_F(RuckigTests, streaming_waypoints)
+{
+  // Waypoints are added one at a time, and each segment can be sampled right after its waypoint was added
+  const moveit::core::JointModelGroup* group = robot_model_->getJointModelGroup(JOINT_GROUP);
+  trajectory_processing::RuckigStreamingSmoother streaming_smoother(group, 1.0 /* max vel scaling factor */,
+                                                                    1.0 /* max accel scaling factor */,
+                                                                    0.001 /* control period */);
+
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+  moveit::core::RobotState waypoint(robot_state);
+  // A waypoint without an initial state is rejected
+  double duration_from_previous = DEFAULT_TIMESTEP;
+  EXPECT_FALSE(streaming_smoother.addWaypoint(waypoint, duration_from_previous));
+
+  streaming_smoother.reset(robot_state);
+  std::vector<double> positions, velocities, accelerations;
+  for (size_t i = 1; i <= 20; ++i)
+  {
+    robot_state.setVariablePosition("panda_joint1", 0.01 * i);
+    waypoint = robot_state;
+    duration_from_previous = DEFAULT_TIMESTEP;
+    ASSERT_TRUE(streaming_smoother.addWaypoint(waypoint, duration_from_previous));
+    EXPECT_GE(duration_from_previous, DEFAULT_TIMESTEP);
+    EXPECT_GT(streaming_smoother.getLastSegmentDuration(), 0.0);
+
+    // The end of the segment is the added waypoint
+    streaming_smoother.sampleLastSegment(streaming_smoother.getLastSegmentDuration(), positions, velocities,
+                                         accelerations);
+    ASSERT_EQ(positions.size(), group->getVariableCount());
+    EXPECT_NEAR(positions.at(0), 0.01 * i, 1e-6);
+  }
+}
+
+TEST_F(RuckigTests, streaming_failed_waypoint)
+{
+  // A waypoint without a feasible segment leaves the smoother, the waypoint and the duration unchanged
+  const moveit::core::JointModelGroup* group = robot_model_->getJointModelGroup(JOINT_GROUP);
+  trajectory_processing::RuckigStreamingSmoother streaming_smoother(group, 1.0 /* max vel scaling factor */,
+                                                                    1.0 /* max accel scaling factor */,
+                                                                    0.001 /* control period */);
+
+  moveit::core::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.zeroVelocities();
+  robot_state.zeroAccelerations();
+  streaming_smoother.reset(robot_state);
+
+  robot_state.setVariablePosition("panda_joint1", 0.01);
+  moveit::core::RobotState waypoint(robot_state);
+  double duration_from_previous = DEFAULT_TIMESTEP;
+  ASSERT_TRUE(streaming_smoother.addWaypoint(waypoint, duration_from_previous));
+  const double last_segment_duration = streaming_smoother.getLastSegmentDuration();
+
+  // Ruckig rejects a non-finite target
+  waypoint = robot_state;
+  waypoint.setVariablePosition("panda_joint2", std::numeric_limits<double>::quiet_NaN());
+  waypoint.setVariableVelocity("panda_joint1", 0.05);
+  duration_from_previous = DEFAULT_TIMESTEP;
+  EXPECT_FALSE(streaming_smoother.addWaypoint(waypoint, duration_from_previous));
+  EXPECT_EQ(duration_from_previous, DEFAULT_TIMESTEP);
+  EXPECT_EQ(waypoint.getVariableVelocity("panda_joint1"), 0.05);
+  EXPECT_EQ(waypoint.getVariableAcceleration("panda_joint1"), 0.0);
+  EXPECT_EQ(streaming_smoother.getLastSegmentDuration(), last_segment_duration);
+
+  // The next segment starts at the last accepted waypoint
+  robot_state.setVariablePosition("panda_joint1", 0.02);
+  waypoint = robot_state;
+  duration_from_previous = DEFAULT_TIMESTEP;
+  ASSERT_TRUE(streaming_smoother.addWaypoint(waypoint, duration_from_previous));
+  std::vector<double> positions, velocities, accelerations;
+  streaming_smoother.sampleLastSegment(0.0, positions, velocities, accelerations);
+  EXPECT_NEAR(positions.at(0), 0.01, 1e-6);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -36,11 +36,15 @@
  *   POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <gtest/gtest.h>
+#include <moveit/dynamics_solver/dynamics_solver.h>
 #include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
 using trajectory_processing::Path;
+using trajectory_processing::PathDynamics;
 using trajectory_processing::TimeOptimalTrajectoryGeneration;
 using trajectory_processing::Trajectory;
 
@@ -637,6 +641,188 @@ TEST(time_optimal_trajectory_generation, testTimeStepZeroMakesTrajectoryInvalid)
                                   /*time_step=*/0));
 }
 
+TEST(time_optimal_trajectory_generation, testComputeTimeStampsBatch)
+{
+  constexpr auto robot_name{ "panda" };
+  constexpr auto group_name{ "panda_arm" };
+
+  auto robot_model = moveit::core::loadTestingRobotModel(robot_name);
+  ASSERT_TRUE(robot_model) << "Failed to load robot model" << robot_name;
+  setAccelerationLimits(robot_model);
+  auto group = robot_model->getJointModelGroup(group_name);
+  ASSERT_TRUE(group) << "Failed to load joint model group " << group_name;
+  moveit::core::RobotState waypoint_state(robot_model);
+  waypoint_state.setToDefaultValues();
+
+  // Independent trajectories with different goals, plus a null entry which must be reported as failed
+  std::vector<robot_trajectory::RobotTrajectoryPtr> batch;
+  std::vector<robot_trajectory::RobotTrajectory> expected;
+  const TimeOptimalTrajectoryGeneration totg;
+  for (size_t i = 0; i < 8; ++i)
+  {
+    auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, group);
+    waypoint_state.setJointGroupPositions(group, std::vector<double>{ -0.5, -3.52, 1.35, -2.51, -0.88, 0.63, 0.0 });
+    trajectory->addSuffixWayPoint(waypoint_state, 0.0);
+    waypoint_state.setJointGroupPositions(group,
+                                          std::vector<double>{ 0.1 * i, -3.0, 1.2, -2.0, -0.5 - 0.05 * i, 0.2, 0.0 });
+    trajectory->addSuffixWayPoint(waypoint_state, 0.0);
+
+    expected.emplace_back(*trajectory, true /* deep copy */);
+    ASSERT_TRUE(totg.computeTimeStamps(expected.back()));
+    batch.push_back(trajectory);
+  }
+  batch.push_back(nullptr);
+
+  const std::vector<bool> success = totg.computeTimeStampsBatch(batch, 1.0, 1.0, 4 /* threads */);
+  ASSERT_EQ(success.size(), batch.size());
+  EXPECT_FALSE(success.back());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_TRUE(success[i]);
+    ASSERT_EQ(batch[i]->getWayPointCount(), expected[i].getWayPointCount());
+    EXPECT_DOUBLE_EQ(batch[i]->getDuration(), expected[i].getDuration());
+  }
+}
+
+TEST(time_optimal_trajectory_generation, testPathSegmentHintMatchesLookup)
+{
+  std::vector<Eigen::VectorXd> waypoints;
+  for (int i = 0; i < 50; ++i)
+  {
+    waypoints.push_back(Eigen::Vector3d(std::sin(0.3 * i), std::cos(0.2 * i), 0.1 * i));
+  }
+  const Path path = *Path::create(waypoints, /*max_deviation=*/0.05);
+
+  // The hint must give the same result for sequential, backward and arbitrary jumps along the path
+  std::vector<double> positions;
+  for (double s = 0.0; s <= path.getLength(); s += 0.01)
+  {
+    positions.push_back(s);
+  }
+  for (double s = path.getLength(); s >= 0.0; s -= 0.013)
+  {
+    positions.push_back(s);
+  }
+  for (int i = 0; i < 100; ++i)
+  {
+    positions.push_back(std::fmod(i * 7.31, path.getLength()));
+  }
+
+  std::size_t segment_hint = 0;
+  for (const double s : positions)
+  {
+    EXPECT_EQ(path.getConfig(s), path.getConfig(s, segment_hint));
+    EXPECT_EQ(path.getTangent(s), path.getTangent(s, segment_hint));
+    EXPECT_EQ(path.getCurvature(s), path.getCurvature(s, segment_hint));
+  }
+
+  // Switching points are sorted by arc length
+  const auto& switching_points = path.getSwitchingPoints();
+  EXPECT_TRUE(std::is_sorted(switching_points.begin(), switching_points.end()));
+}
+
+TEST(time_optimal_trajectory_generation, testTorqueLimitsAreRespected)
+{
+  const Path path = *Path::create({ Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(1.0, 0.5), Eigen::Vector2d(0.5, 1.5),
+                                    Eigen::Vector2d(2.0, 2.0) },
+                                  /*max_deviation=*/0.1);
+  const Eigen::Vector2d max_velocity(2.0, 2.0);
+  const Eigen::Vector2d max_acceleration(100.0, 100.0);
+
+  // Constant dynamics with gravity acting on the first joint only
+  PathDynamics dynamics;
+  dynamics.sample_spacing = path.getLength();
+  const Eigen::Matrix2d mass_matrix = Eigen::Vector2d(2.0, 1.0).asDiagonal();
+  const Eigen::Vector2d gravity_torques(5.0, 0.0);
+  dynamics.mass_matrices.assign(2, mass_matrix);
+  dynamics.velocity_torques.assign(2, Eigen::Vector2d::Zero());
+  dynamics.gravity_torques.assign(2, gravity_torques);
+  dynamics.max_torque = Eigen::Vector2d(10.0, 3.0);
+
+  const auto unlimited = Trajectory::create(path, max_velocity, max_acceleration);
+  const auto limited = Trajectory::create(path, max_velocity, max_acceleration, dynamics);
+  ASSERT_TRUE(unlimited.has_value());
+  ASSERT_TRUE(limited.has_value());
+  EXPECT_GT(limited->getDuration(), unlimited->getDuration());
+
+  for (double t = 0.0; t < limited->getDuration(); t += 0.001)
+  {
+    const Eigen::VectorXd torques = mass_matrix * limited->getAcceleration(t) + gravity_torques;
+    for (Eigen::Index j = 0; j < torques.size(); ++j)
+    {
+      // Allow for the discretization of the integration along the limit curve
+      EXPECT_LE(std::abs(torques[j]), 1.01 * dynamics.max_torque[j]) << "Joint " << j << " at time " << t;
+    }
+  }
+
+  // A joint that cannot hold the path against gravity makes the trajectory infeasible
+  dynamics.max_torque = Eigen::Vector2d(4.0, 3.0);
+  EXPECT_FALSE(Trajectory::create(path, max_velocity, max_acceleration, dynamics));
+}
+
+TEST(time_optimal_trajectory_generation, testVelocityDependentTorqueLimitsAreRespected)
+{
+  // Only the first joint moves, so the torque of the second joint depends on the path velocity alone
+  const Path path = *Path::create({ Eigen::Vector2d(0.0, 0.0), Eigen::Vector2d(2.0, 0.0) }, /*max_deviation=*/0.1);
+  const Eigen::Vector2d max_velocity(10.0, 10.0);
+  const Eigen::Vector2d max_acceleration(100.0, 100.0);
+
+  // Velocity and gravity torques of the second joint are both negative, which allows a path velocity of 1
+  PathDynamics dynamics;
+  dynamics.sample_spacing = path.getLength();
+  const Eigen::Matrix2d mass_matrix = Eigen::Vector2d(1.0, 1.0).asDiagonal();
+  const Eigen::Vector2d velocity_torques(0.0, -2.0);
+  const Eigen::Vector2d gravity_torques(0.0, -1.0);
+  dynamics.mass_matrices.assign(2, mass_matrix);
+  dynamics.velocity_torques.assign(2, velocity_torques);
+  dynamics.gravity_torques.assign(2, gravity_torques);
+  dynamics.max_torque = Eigen::Vector2d(100.0, 3.0);
+
+  const auto trajectory = Trajectory::create(path, max_velocity, max_acceleration, dynamics);
+  ASSERT_TRUE(trajectory.has_value());
+
+  double max_path_velocity = 0.0;
+  for (double t = 0.0; t < trajectory->getDuration(); t += 0.001)
+  {
+    const double path_velocity = trajectory->getVelocity(t).norm();
+    max_path_velocity = std::max(max_path_velocity, path_velocity);
+    const double torque = velocity_torques[1] * path_velocity * path_velocity + gravity_torques[1];
+    EXPECT_LE(std::abs(torque), 1.01 * dynamics.max_torque[1]) << "At time " << t;
+  }
+  EXPECT_GT(max_path_velocity, 0.9);
+}
+
+TEST(time_optimal_trajectory_generation, testComputeTimeStampsWithTorqueLimits)
+{
+  constexpr auto robot_name{ "panda" };
+  constexpr auto group_name{ "panda_arm" };
+
+  auto robot_model = moveit::core::loadTestingRobotModel(robot_name);
+  ASSERT_TRUE(robot_model) << "Failed to load robot model" << robot_name;
+  setAccelerationLimits(robot_model);
+  auto group = robot_model->getJointModelGroup(group_name);
+  ASSERT_TRUE(group) << "Failed to load joint model group " << group_name;
+
+  geometry_msgs::msg::Vector3 gravity;
+  gravity.z = -9.81;
+  const dynamics_solver::DynamicsSolver solver(robot_model, group_name, gravity);
+
+  moveit::core::RobotState waypoint_state(robot_model);
+  waypoint_state.setToDefaultValues();
+  robot_trajectory::RobotTrajectory trajectory(robot_model, group);
+  waypoint_state.setJointGroupPositions(group, std::vector<double>{ -0.5, -1.2, 1.35, -2.51, -0.88, 0.63, 0.0 });
+  trajectory.addSuffixWayPoint(waypoint_state, 0.0);
+  waypoint_state.setJointGroupPositions(group, std::vector<double>{ 0.5, -0.3, 1.2, -2.0, -0.5, 1.2, 0.5 });
+  trajectory.addSuffixWayPoint(waypoint_state, 0.0);
+  robot_trajectory::RobotTrajectory unlimited(trajectory, true /* deep copy */);
+
+  const TimeOptimalTrajectoryGeneration totg;
+  ASSERT_TRUE(totg.computeTimeStamps(unlimited));
+  ASSERT_TRUE(totg.computeTimeStampsWithTorqueLimits(trajectory, solver, 1.0, 1.0, 2 /* threads */));
+  // The torque limits can only slow the trajectory down
+  EXPECT_GE(trajectory.getDuration(), unlimited.getDuration() - 1e-3);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,128 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+/** \file parallel_for.h
+ *  \brief Run independent jobs over an index range on several threads
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+/** \brief Get the number of threads to use for \e count independent jobs.
+ *
+ *  A \e requested value of 0 selects one thread per hardware thread. The result is never larger than \e count and at
+ *  least 1. */
+inline std::size_t getParallelThreadCount(std::size_t requested, std::size_t count)
+{
+  if (requested == 0)
+    requested = std::max(1u, std::thread::hardware_concurrency());
+  return std::max<std::size_t>(1, std::min(requested, count));
+}
+
+/** \brief Call \e job(workspace, index) for every index in [0, \e count) on up to \e num_threads threads.
+ *
+ *  The calling thread takes part in the work, and indices are handed out one at a time so that jobs of different
+ *  duration are balanced. Every thread creates its own workspace with \e make_workspace(), e.g. a RobotState or a
+ *  solver that must not be shared. If a job throws, no further jobs are started, all threads are joined and the first
+ *  exception is rethrown on the calling thread. */
+template <typename MakeWorkspace, typename Job>
+void parallelFor(std::size_t count, std::size_t num_threads, const MakeWorkspace& make_workspace, const Job& job)
+{
+  if (count == 0)
+    return;
+  num_threads = getParallelThreadCount(num_threads, count);
+
+  std::atomic<std::size_t> next_index{ 0 };
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  const auto worker = [&] {
+    try
+    {
+      auto workspace = make_workspace();
+      for (std::size_t i = next_index++; i < count; i = next_index++)
+        job(workspace, i);
+    }
+    catch (...)
+    {
+      next_index = count;
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (std::size_t i = 1; i < num_threads; ++i)
+  {
+    try
+    {
+      threads.emplace_back(worker);
+    }
+    catch (const std::system_error&)
+    {
+      // continue with the threads that could be started
+      break;
+    }
+  }
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+/** \brief Call \e job(index) for every index in [0, \e count) on up to \e num_threads threads.
+ *
+ *  See the overload with per-thread workspaces for the scheduling and exception behavior. */
+template <typename Job>
+void parallelFor(std::size_t count, std::size_t num_threads, const Job& job)
+{
+  parallelFor(
+      count, num_threads, [] { return nullptr; }, [&job](std::nullptr_t, std::size_t i) { job(i); });
+}
+}  // namespace core
+}  // namespace moveit
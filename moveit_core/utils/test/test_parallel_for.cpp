@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/utils/parallel_for.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+TEST(ParallelFor, VisitsEveryIndexOnce)
+{
+  for (std::size_t num_threads : { 0, 1, 4, 64 })
+  {
+    std::vector<std::atomic<int>> visits(1000);
+    moveit::core::parallelFor(visits.size(), num_threads, [&visits](std::size_t i) { ++visits[i]; });
+    for (const std::atomic<int>& count : visits)
+      EXPECT_EQ(count, 1);
+  }
+  moveit::core::parallelFor(0, 4, [](std::size_t) { FAIL() << "no job expected"; });
+}
+
+TEST(ParallelFor, UsesOneWorkspacePerThread)
+{
+  std::atomic<int> workspaces{ 0 };
+  std::vector<int> owner(1000, -1);
+  moveit::core::parallelFor(
+      owner.size(), 4, [&workspaces] { return workspaces++; },
+      [&owner](int& workspace, std::size_t i) { owner[i] = workspace; });
+  EXPECT_GE(workspaces, 1);
+  EXPECT_LE(workspaces, 4);
+  const std::set<int> owners(owner.begin(), owner.end());
+  EXPECT_EQ(owners.count(-1), 0u);
+  EXPECT_LE(owners.size(), static_cast<std::size_t>(workspaces));
+}
+
+TEST(ParallelFor, RethrowsOnCallingThread)
+{
+  std::atomic<std::size_t> jobs{ 0 };
+  EXPECT_THROW(moveit::core::parallelFor(10000, 4,
+                                         [&jobs](std::size_t i) {
+                                           ++jobs;
+                                           if (i == 10)
+                                             throw std::runtime_error("job failed");
+                                         }),
+               std::runtime_error);
+  // no new jobs are started once one has failed
+  EXPECT_LT(jobs, 10000u);
+}
+
+TEST(ParallelFor, ThreadCount)
+{
+  EXPECT_EQ(moveit::core::getParallelThreadCount(8, 3), 3u);
+  EXPECT_EQ(moveit::core::getParallelThreadCount(2, 100), 2u);
+  EXPECT_EQ(moveit::core::getParallelThreadCount(4, 0), 1u);
+  EXPECT_GE(moveit::core::getParallelThreadCount(0, 100), 1u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -43,33 +43,77 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_model/joint_model_group.h>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace ompl_interface
 {
 class ModelBasedPlanningContext;
 
 /** @class ConstrainedGoalSampler
- *  An interface to the OMPL goal lazy sampler*/
+ *  An interface to the OMPL goal lazy sampler
+ *
+ *  Goal states are sampled in the background while the planner runs. If the planning context requests more than one
+ *  goal sampling thread, additional workers with their own constraint sampler and kinematics solver instances fill the
+ *  goal region concurrently, so that planners only need to take goals that have already been IK-solved and
+ *  validity-checked. The workers are owned by the sampling thread of GoalLazySamples, so stopping sampling also
+ *  waits for them. */
 class ConstrainedGoalSampler : public ompl::base::GoalLazySamples
 {
 public:
   ConstrainedGoalSampler(const ModelBasedPlanningContext* pc, kinematic_constraints::KinematicConstraintSetPtr ks,
                          constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr());
 
+  ~ConstrainedGoalSampler() override;
+
+  void clear() override;
+
+  /** \brief Get the number of additional goal sampling threads */
+  std::size_t getWorkerCount() const
+  {
+    return workers_.size();
+  }
+
 private:
+  /** \brief State owned by an additional goal sampling thread */
+  struct SamplingWorker
+  {
+    SamplingWorker(constraint_samplers::ConstraintSamplerPtr sampler, const moveit::core::RobotState& state);
+
+    constraint_samplers::ConstraintSamplerPtr constraint_sampler;
+    moveit::core::RobotState work_state;
+    ompl::base::State* goal_state;
+    std::thread thread;
+  };
+
   bool sampleUsingConstraintSampler(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+  bool sampleGoal(constraint_samplers::ConstraintSampler& constraint_sampler, moveit::core::RobotState& work_state,
+                  ompl::base::State* new_goal, unsigned int attempts_so_far, bool verbose);
   bool stateValidityCallback(ompl::base::State* new_goal, const moveit::core::RobotState* state,
                              const moveit::core::JointModelGroup* /*jmg*/, const double* /*jpos*/,
                              bool verbose = false) const;
   bool checkStateValidity(ompl::base::State* new_goal, const moveit::core::RobotState& state,
                           bool verbose = false) const;
+  bool shouldStopSampling(unsigned int attempts_so_far) const;
+
+  /** \brief Sample on the calling thread and on all additional workers until sampling is over */
+  bool sampleInParallel(ompl::base::State* new_goal);
+  void sampleLoop(constraint_samplers::ConstraintSampler& constraint_sampler, moveit::core::RobotState& work_state,
+                  ompl::base::State* goal_state);
 
   const ModelBasedPlanningContext* planning_context_;
   kinematic_constraints::KinematicConstraintSetPtr kinematic_constraint_set_;
   constraint_samplers::ConstraintSamplerPtr constraint_sampler_;
   ompl::base::StateSamplerPtr default_sampler_;
   moveit::core::RobotState work_state_;
-  unsigned int invalid_sampled_constraints_;
-  bool warned_invalid_samples_;
+  std::atomic<unsigned int> invalid_sampled_constraints_;
+  std::atomic<bool> warned_invalid_samples_;
   unsigned int verbose_display_;
+
+  std::vector<std::unique_ptr<SamplingWorker>> workers_;
+  std::atomic<unsigned int> worker_attempts_;
+  std::atomic<bool> stop_workers_;
 };
 }  // namespace ompl_interface
@@ -135,6 +135,7 @@ struct ConstraintApproximationConstructionOptions
     , explicit_motions(false)
     , explicit_points_resolution(0.0)
     , max_explicit_points(0)
+    , threads(1)
   {
   }
 
@@ -145,6 +146,9 @@ struct ConstraintApproximationConstructionOptions
   bool explicit_motions;
   double explicit_points_resolution;
   unsigned int max_explicit_points;
+  /** \brief Number of threads used for sampling states and validating edges. Values of 0 and 1 both mean that the
+      database is constructed on the calling thread only. Each thread uses its own constraint sampler instance. */
+  unsigned int threads;
 };
 
 struct ConstraintApproximationConstructionResults
@@ -167,7 +171,10 @@ public:
 
   void loadConstraintApproximations(const std::string& path);
 
-  void saveConstraintApproximations(const std::string& path);
+  /** \brief Save all constraint approximations to the folder \e path. If \e binary is true, the state storages are
+      written in a compact binary format instead of the OMPL state storage format. Both formats are recognized by
+      loadConstraintApproximations(). */
+  void saveConstraintApproximations(const std::string& path, bool binary = false);
 
   ConstraintApproximationConstructionResults
   addConstraintApproximation(const moveit_msgs::msg::Constraints& constr_sampling,
@@ -180,6 +187,20 @@ public:
                              const planning_scene::PlanningSceneConstPtr& scene,
                              const ConstraintApproximationConstructionOptions& options);
 
+  /** \brief Add \e options.samples new states to the existing constraint approximation named like \e constr_hard and
+      connect them to the existing graph. Edges between previously stored states are kept as they are. If no
+      approximation with that name exists, a new one is constructed as in addConstraintApproximation(). */
+  ConstraintApproximationConstructionResults
+  augmentConstraintApproximation(const moveit_msgs::msg::Constraints& constr_sampling,
+                                 const moveit_msgs::msg::Constraints& constr_hard, const std::string& group,
+                                 const planning_scene::PlanningSceneConstPtr& scene,
+                                 const ConstraintApproximationConstructionOptions& options);
+
+  ConstraintApproximationConstructionResults
+  augmentConstraintApproximation(const moveit_msgs::msg::Constraints& constr, const std::string& group,
+                                 const planning_scene::PlanningSceneConstPtr& scene,
+                                 const ConstraintApproximationConstructionOptions& options);
+
   void printConstraintApproximations(std::ostream& out = std::cout) const;
   void clearConstraintApproximations();
 
@@ -191,11 +212,22 @@ public:
   const ConstraintApproximationPtr& getConstraintApproximation(const moveit_msgs::msg::Constraints& msg) const;
 
 private:
-  ompl::base::StateStoragePtr constructConstraintApproximation(ModelBasedPlanningContext* pcontext,
-                                                               const moveit_msgs::msg::Constraints& constr_sampling,
-                                                               const moveit_msgs::msg::Constraints& constr_hard,
-                                                               const ConstraintApproximationConstructionOptions& options,
-                                                               ConstraintApproximationConstructionResults& result);
+  ConstraintApproximationConstructionResults
+  buildConstraintApproximation(const moveit_msgs::msg::Constraints& constr_sampling,
+                               const moveit_msgs::msg::Constraints& constr_hard, const std::string& group,
+                               const planning_scene::PlanningSceneConstPtr& scene,
+                               const ConstraintApproximationConstructionOptions& options,
+                               const ConstraintApproximationPtr& existing);
+
+  /** \brief Construct the state storage of an approximation. If \e existing is set, its states and connections are
+      copied first and only the new milestones are connected. */
+  ompl::base::StateStoragePtr
+  constructConstraintApproximation(ModelBasedPlanningContext* pcontext,
+                                   const moveit_msgs::msg::Constraints& constr_sampling,
+                                   const moveit_msgs::msg::Constraints& constr_hard,
+                                   const ConstraintApproximationConstructionOptions& options,
+                                   ConstraintApproximationConstructionResults& result,
+                                   const ConstraintApproximationPtr& existing);
 
   ModelBasedPlanningContext* context_;
   std::map<std::string, ConstraintApproximationPtr> constraint_approximations_;
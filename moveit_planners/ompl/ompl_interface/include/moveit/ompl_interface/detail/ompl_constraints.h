@@ -36,6 +36,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <ostream>
 
 #include <ompl/base/Constraint.h>
@@ -90,6 +91,12 @@ public:
    * **/
   Eigen::VectorXd derivative(const Eigen::Ref<const Eigen::VectorXd>& x) const;
 
+  /** \brief Penalty function, written into a preallocated vector of the same size as x **/
+  void penalty(const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::Ref<Eigen::VectorXd> out) const;
+
+  /** \brief Derivative of the penalty function, written into a preallocated vector of the same size as x **/
+  void derivative(const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::Ref<Eigen::VectorXd> out) const;
+
   std::size_t size() const;
 
 private:
@@ -117,6 +124,12 @@ std::ostream& operator<<(std::ostream& os, const ompl_interface::Bounds& bounds)
  * The 'scalar value' can be the difference between the position or orientation of a link and a target position or
  * orientation, or any other error metric that can be calculated using the `moveit::core::RobotModel` and
  * `moveit::core::JointModelGroup`.
+ *
+ * Implementations provide the error and its Jacobian as a function of the link's kinematics through `computeError` and
+ * `computeErrorJacobian`. OMPL's projection evaluates `function` and `jacobian` many times, mostly for the same joint
+ * values in a row, so forward kinematics, the robot Jacobian and the error are computed once per joint values (and
+ * thread) and reused, using preallocated buffers. Projections themselves are not cached, since their inputs are
+ * random samples that are practically never projected twice.
  * */
 class BaseConstraint : public ompl::base::Constraint
 {
@@ -148,17 +161,13 @@ public:
 
   /** \brief Wrapper for forward kinematics calculated by MoveIt's Robot State.
    *
-   * TODO(jeroendm) Are these actually const, as the robot state is modified? How come it works?
-   * Also, output arguments could be significantly more performant,
-   * but MoveIt's robot state does not support passing Eigen::Ref objects at the moment.
+   * The robot state used is specific to the calling thread, and the result is cached for the given joint values.
    * */
   Eigen::Isometry3d forwardKinematics(const Eigen::Ref<const Eigen::VectorXd>& joint_values) const;
 
   /** \brief Calculate the robot's geometric Jacobian using MoveIt's Robot State.
    *
-   * Ideally I would pass the output argument from OMPL's jacobian function directly,
-   * but I cannot pass an object of type , Eigen::Ref<Eigen::MatrixXd> to MoveIt's
-   * Jacobian method.
+   * The result is cached for the given joint values, together with the forward kinematics.
    * */
   Eigen::MatrixXd robotGeometricJacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_values) const;
 
@@ -176,8 +185,10 @@ public:
    *
    * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::function directly and ignore
    * the bounds calculation.
+   *
+   * The error itself is defined by `computeError`.
    * */
-  virtual Eigen::VectorXd calcError(const Eigen::Ref<const Eigen::VectorXd>& /*x*/) const;
+  virtual Eigen::VectorXd calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const;
 
   /** \brief For inequality constraints: calculate the Jacobian for the current parameters that are being constrained.
    *   *
@@ -188,10 +199,9 @@ public:
    * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::jacobian directly and ignore
    * the bounds calculation.
    *
-   * TODO(jeroendm), Maybe also use an output argument as in `ompl::base::Constraint::jacobian(x, out)` for better
-   * performance?
+   * The error Jacobian itself is defined by `computeErrorJacobian`.
    * */
-  virtual Eigen::MatrixXd calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& /*x*/) const;
+  virtual Eigen::MatrixXd calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const;
 
   // the methods below are specifically for debugging and testing
 
@@ -211,6 +221,52 @@ public:
   }
 
 protected:
+  /** \brief Kinematics of the constrained link for the joint values that were last evaluated in a thread.
+   *
+   * Every thread keeps a few of these in thread-local storage, one per constraint it recently evaluated. All buffers
+   * are allocated when a constraint takes over an entry and reused afterwards.
+   * */
+  struct KinematicsCache
+  {
+    std::uint64_t constraint_id{ 0 }; /**< \brief id_ of the constraint this entry belongs to, 0 if unused */
+    moveit::core::RobotState* robot_state{ nullptr };
+    Eigen::VectorXd joint_values;
+    Eigen::Isometry3d link_transform;
+    Eigen::MatrixXd robot_jacobian;
+    Eigen::VectorXd error;
+    Eigen::VectorXd error_derivative;
+    bool valid{ false };          /**< \brief Whether joint_values and link_transform are set */
+    bool jacobian_valid{ false }; /**< \brief Whether robot_jacobian matches joint_values */
+    bool error_valid{ false };    /**< \brief Whether error matches joint_values */
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Get the kinematics cache of the calling thread, updated for the given joint values.
+   *
+   * Forward kinematics are only recomputed if the joint values differ from the previous call in the same thread.
+   * If `with_jacobian` is true, the robot's geometric Jacobian is computed as well (once per joint values).
+   * */
+  KinematicsCache& updateKinematics(const Eigen::Ref<const Eigen::VectorXd>& joint_values, bool with_jacobian) const;
+
+  /** \brief Compute the constraint error for the cached kinematics, unless it is already known. **/
+  const Eigen::VectorXd& updateError(KinematicsCache& cache) const;
+
+  /** \brief Calculate the error from the pose of the constrained link.
+   *
+   * `error` has `getCoDimension()` elements. Override this to implement an inequality constraint.
+   * */
+  virtual void computeError(const Eigen::Isometry3d& link_transform, Eigen::Ref<Eigen::VectorXd> error) const;
+
+  /** \brief Calculate the Jacobian of the error from the pose of the constrained link and the robot's geometric
+   * Jacobian for that link.
+   *
+   * `out` has `getCoDimension()` rows and one column for every joint of the group.
+   * Override this to implement an inequality constraint.
+   * */
+  virtual void computeErrorJacobian(const Eigen::Isometry3d& link_transform, const Eigen::MatrixXd& robot_jacobian,
+                                    Eigen::Ref<Eigen::MatrixXd> out) const;
+
   /** \brief Thread-safe storage of the robot state.
    *
    * The robot state is modified for kinematic calculations. As an instance of this class is possibly used in multiple
@@ -227,6 +283,9 @@ protected:
   /** \brief Robot link the constraints are applied to. */
   std::string link_name_;
 
+  /** \brief Link model for link_name_, resolved in init(). */
+  const moveit::core::LinkModel* link_model_{ nullptr };
+
   /** \brief Upper and lower bounds on constrained variables. */
   Bounds bounds_;
 
@@ -236,6 +295,12 @@ protected:
   /** \brief target for equality constraints, nominal value for inequality constraints. */
   Eigen::Quaterniond target_orientation_;
 
+  /** \brief Identifies the kinematics cache entries of this constraint, unique for the lifetime of the process.
+   *
+   * The address is not used, because a new constraint can be allocated where a destroyed one was.
+   * */
+  const std::uint64_t id_;
+
 public:
   // Macro for classes containing fixed size eigen vectors that are dynamically allocated when used.
   // https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
@@ -266,30 +331,13 @@ public:
    * */
   void parseConstraintMsg(const moveit_msgs::msg::Constraints& constraints) override;
 
-  /** \brief For inequality constraints: calculate the value of the parameter that is being constrained by the bounds.
-   *
-   * In this Position constraints case, it calculates the x, y and z position
-   * of the end-effector. This error is then converted in generic equality constraints in the implementation of
-   * `ompl_interface::BaseConstraint::function`.
-   *
-   * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::function directly and ignore
-   * the bounds calculation.
-   * */
-  Eigen::VectorXd calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const override;
+protected:
+  /** \brief Position of the link expressed in the frame of the box. **/
+  void computeError(const Eigen::Isometry3d& link_transform, Eigen::Ref<Eigen::VectorXd> error) const override;
 
-  /** \brief For inequality constraints: calculate the Jacobian for the current parameters that are being constrained.
-   *   *
-   * This error jacobian, as the name suggests, is only the jacobian of the position / orientation / ... error.
-   * It does not take into account the derivative of the penalty functions defined in the Bounds class.
-   * This correction is added in the implementation of of BaseConstraint::jacobian.
-   *
-   * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::jacobian directly and ignore
-   * the bounds calculation.
-   *
-   * TODO(jeroendm), Maybe also use an output argument as in `ompl::base::Constraint::jacobian(x, out)` for better
-   * performance?
-   * */
-  Eigen::MatrixXd calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const override;
+  /** \brief Translational part of the robot Jacobian, rotated into the frame of the box. **/
+  void computeErrorJacobian(const Eigen::Isometry3d& link_transform, const Eigen::MatrixXd& robot_jacobian,
+                            Eigen::Ref<Eigen::MatrixXd> out) const override;
 };
 
 /******************************************
@@ -389,30 +437,13 @@ public:
    * */
   void parseConstraintMsg(const moveit_msgs::msg::Constraints& constraints) override;
 
-  /** \brief For inequality constraints: calculate the value of the parameter that is being constrained by the bounds.
-   *
-   * In this orientation constraints case, it calculates the orientation
-   * of the end-effector. This error is then converted in generic equality constraints in the implementation of
-   * `ompl_interface::BaseConstraint::function`.
-   *
-   * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::function directly and ignore
-   * the bounds calculation.
-   * */
-  Eigen::VectorXd calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const override;
+protected:
+  /** \brief Orientation error in exponential coordinates. **/
+  void computeError(const Eigen::Isometry3d& link_transform, Eigen::Ref<Eigen::VectorXd> error) const override;
 
-  /** \brief For inequality constraints: calculate the Jacobian for the current parameters that are being constrained.
-   *   *
-   * This error jacobian, as the name suggests, is only the jacobian of the position / orientation / ... error.
-   * It does not take into account the derivative of the penalty functions defined in the Bounds class.
-   * This correction is added in the implementation of of BaseConstraint::jacobian.
-   *
-   * This method can be bypassed if you want to override `ompl_interface::BaseConstraint::jacobian directly and ignore
-   * the bounds calculation.
-   *
-   * TODO(jeroendm), Maybe also use an output argument as in `ompl::base::Constraint::jacobian(x, out)` for better
-   * performance?
-   * */
-  Eigen::MatrixXd calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const override;
+  /** \brief Rotational part of the robot Jacobian, mapped to the derivative of the exponential coordinates. **/
+  void computeErrorJacobian(const Eigen::Isometry3d& link_transform, const Eigen::MatrixXd& robot_jacobian,
+                            Eigen::Ref<Eigen::MatrixXd> out) const override;
 };
 
 /** \brief Extract position constraints from the MoveIt message.
@@ -453,6 +484,11 @@ inline Eigen::Matrix3d angularVelocityToAngleAxis(double angle, const Eigen::Ref
   r_skew << 0, -axis[2], axis[1], axis[2], 0, -axis[0], -axis[1], axis[0], 0;
   r_skew *= angle;
 
+  // For small angles the expression below loses precision (and is 0/0 at zero), use its Taylor expansion instead:
+  // c / t^2 = 1 / 12 + t^2 / 720 + O(t^4)
+  if (t < 1e-3)
+    return Eigen::Matrix3d::Identity() - 0.5 * r_skew + r_skew * r_skew / 12.0;
+
   double c;
   c = (1 - 0.5 * t * std::sin(t) / (1 - std::cos(t)));
 
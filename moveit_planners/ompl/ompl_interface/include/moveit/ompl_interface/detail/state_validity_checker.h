@@ -87,6 +87,9 @@ public:
   void setVerbose(bool flag);
 
 protected:
+  /** \brief Check the path constraints of the planning context, using their compiled form unless \e verbose is set */
+  bool satisfiesPathConstraints(const moveit::core::RobotState& robot_state, bool verbose) const;
+
   const ModelBasedPlanningContext* planning_context_;
   std::string group_name_;
   TSStateStorage tss_;
@@ -159,6 +159,12 @@ public:
     return path_constraints_;
   }
 
+  /* \brief Get the path constraints compiled for repeated evaluation; nullptr if no path constraints are set */
+  const kinematic_constraints::CompiledConstraintSetPtr& getCompiledPathConstraints() const
+  {
+    return compiled_path_constraints_;
+  }
+
   /* \brief Get the maximum number of sampling attempts allowed when sampling states is needed */
   unsigned int getMaximumStateSamplingAttempts() const
   {
@@ -195,6 +201,18 @@ public:
     max_goal_samples_ = max_goal_samples;
   }
 
+  /* \brief Get the number of threads used to sample goal states in the background */
+  unsigned int getGoalSamplingThreads() const
+  {
+    return goal_sampling_threads_;
+  }
+
+  /* \brief Set the number of threads used to sample goal states in the background */
+  void setGoalSamplingThreads(unsigned int goal_sampling_threads)
+  {
+    goal_sampling_threads_ = goal_sampling_threads;
+  }
+
   /* \brief Get the maximum number of planning threads allowed */
   unsigned int getMaximumPlanningThreads() const
   {
@@ -257,6 +275,7 @@ public:
   void setConstraintsApproximations(const ConstraintsLibraryPtr& constraints_library)
   {
     constraints_library_ = constraints_library;
+    loaded_constraint_approximations_path_.clear();
   }
 
   ConstraintsLibraryPtr getConstraintsLibraryNonConst()
@@ -338,6 +357,8 @@ public:
   /** \brief Configure ompl_simple_setup_ and optionally the constraints_library_.
    *
    * ompl_simple_setup_ gets a start state, state sampler, and state validity checker.
+   * The planner configuration is only applied if it changed since the last call, so that a context that is reused
+   * for another request keeps its planner instance and the planner's data structures.
    *
    * \param node ROS node used to load the constraint approximations.
    * \param use_constraints_approximations Set to true if we want to load the constraint approximation.
@@ -406,6 +427,7 @@ protected:
   std::vector<int> space_signature_;
 
   kinematic_constraints::KinematicConstraintSetPtr path_constraints_;
+  kinematic_constraints::CompiledConstraintSetPtr compiled_path_constraints_;
   moveit_msgs::msg::Constraints path_constraints_msg_;
   std::vector<kinematic_constraints::KinematicConstraintSetPtr> goal_constraints_;
 
@@ -429,6 +451,9 @@ protected:
   /// maximum number of attempts to be made at sampling a goal states
   unsigned int max_goal_sampling_attempts_;
 
+  /// number of threads filling the goal region with valid samples while the planner runs
+  unsigned int goal_sampling_threads_;
+
   /// when planning in parallel, this is the maximum number of threads to use at one time
   unsigned int max_planning_threads_;
 
@@ -452,5 +477,14 @@ protected:
 
   // if false parallel plan returns the first solution found
   bool hybridize_;
+
+  // The planner configuration, maximum solution segment length and state space extent useConfig() was last applied with
+  bool config_applied_;
+  std::map<std::string, std::string> applied_config_;
+  double applied_max_solution_segment_length_;
+  double applied_max_extent_;
+
+  // Path the constraint approximations in constraints_library_ were loaded from, empty if none were loaded
+  std::string loaded_constraint_approximations_path_;
 };
 }  // namespace ompl_interface
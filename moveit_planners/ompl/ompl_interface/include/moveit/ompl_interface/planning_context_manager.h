@@ -129,6 +129,19 @@ public:
     max_goal_samples_ = max_goal_samples;
   }
 
+  /* \brief Get the default number of threads used to sample goal states in the background */
+  unsigned int getGoalSamplingThreads() const
+  {
+    return goal_sampling_threads_;
+  }
+
+  /* \brief Set the default number of threads used to sample goal states in the background. Planner configurations
+     can override this with the 'goal_sampling_threads' parameter */
+  void setGoalSamplingThreads(unsigned int goal_sampling_threads)
+  {
+    goal_sampling_threads_ = goal_sampling_threads;
+  }
+
   /* \brief Get the maximum number of planning threads allowed */
   unsigned int getMaximumPlanningThreads() const
   {
@@ -184,6 +197,15 @@ public:
                                                   const rclcpp::Node::SharedPtr& node,
                                                   bool use_constraints_approximations) const;
 
+  /** \brief Create \e count planning contexts for every planner configuration up front, so that requests do not pay
+   * for constructing state spaces and OMPL setups.
+   *
+   * Planning contexts are pooled per planner configuration (group and planner) and state space parameterization.
+   * Contexts that are not in use are reset and reconfigured for new requests, keeping their planner instances. The
+   * pool is warmed for the joint space parameterization, which is used by requests without path constraints.
+   * */
+  void warmContextPool(unsigned int count) const;
+
   void registerPlannerAllocator(const std::string& planner_id, const ConfiguredPlannerAllocator& pa)
   {
     known_planners_[planner_id] = pa;
@@ -249,6 +271,9 @@ protected:
   /// maximum number of attempts to be made at sampling goals
   unsigned int max_goal_sampling_attempts_;
 
+  /// number of threads filling the goal region with valid samples while the planner runs
+  unsigned int goal_sampling_threads_;
+
   /// when planning in parallel, this is the maximum number of threads to use at one time
   unsigned int max_planning_threads_;
 
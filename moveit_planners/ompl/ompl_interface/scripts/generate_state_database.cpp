@@ -54,15 +54,16 @@ static const std::string ROBOT_DESCRIPTION = "robot_description";
 
 static const std::string CONSTRAINT_PARAMETER = "constraints";
 
-static bool getUintParameterOr(const rclcpp::Node::SharedPtr& node, const std::string& param_name,
-                               size_t&& result_value, const size_t default_value)
+template <typename T>
+static bool getUintParameterOr(const rclcpp::Node::SharedPtr& node, const std::string& param_name, T& result_value,
+                               const T default_value)
 {
   int param_value;
   if (node->get_parameter(param_name, param_value))
   {
     if (param_value >= 0)
     {
-      result_value = static_cast<size_t>(param_value);
+      result_value = static_cast<T>(param_value);
       return true;
     }
 
@@ -83,17 +84,20 @@ struct GenerateStateDatabaseParameters
     node->get_parameter_or("use_current_scene", use_current_scene, false);
 
     // number of states in joint space approximation
-    getUintParameterOr(node, "state_cnt", construction_opts.samples, 10000);
+    getUintParameterOr(node, "state_cnt", construction_opts.samples, 10000u);
 
     // generate edges together with states?
-    getUintParameterOr(node, "edges_per_sample", construction_opts.edges_per_sample, 0);
+    getUintParameterOr(node, "edges_per_sample", construction_opts.edges_per_sample, 0u);
 
     node->get_parameter_or("max_edge_length", construction_opts.max_edge_length, 0.2);
 
     // verify constraint validity on edges
     node->get_parameter_or("explicit_motions", construction_opts.explicit_motions, true);
     node->get_parameter_or("explicit_points_resolution", construction_opts.explicit_points_resolution, 0.05);
-    getUintParameterOr(node, "max_explicit_points", construction_opts.max_explicit_points, 200);
+    getUintParameterOr(node, "max_explicit_points", construction_opts.max_explicit_points, 200u);
+
+    // number of threads for sampling states and validating edges
+    getUintParameterOr(node, "threads", construction_opts.threads, 1u);
 
     // local planning in JointModel state space
     node->get_parameter_or("state_space_parameterization", construction_opts.state_space_parameterization,
@@ -101,6 +105,12 @@ struct GenerateStateDatabaseParameters
 
     node->get_parameter_or("output_folder", output_folder, std::string("constraint_approximation_database"));
 
+    // add states to the database in output_folder instead of replacing it
+    node->get_parameter_or("augment", augment, false);
+
+    // store the states in the compact binary format
+    node->get_parameter_or("binary_storage", binary_storage, false);
+
     if (!node->get_parameter("planning_group", planning_group))
     {
       RCLCPP_FATAL(LOGGER, "~planning_group parameter has to be specified.");
@@ -125,6 +135,12 @@ struct GenerateStateDatabaseParameters
   // path to folder for generated database
   std::string output_folder;
 
+  // extend the database found in output_folder
+  bool augment;
+
+  // write the database in the binary format
+  bool binary_storage;
+
   // request the current scene via get_planning_scene service
   bool use_current_scene;
 
@@ -154,16 +170,26 @@ void computeDB(const rclcpp::Node::SharedPtr& node, const planning_scene::Planni
   RCLCPP_INFO_STREAM(LOGGER, "Generating Joint Space Constraint Approximation Database for constraint:\n"
                                  << params.constraints.name);
 
-  ompl_interface::ConstraintApproximationConstructionResults result =
-      context->getConstraintsLibraryNonConst()->addConstraintApproximation(params.constraints, params.planning_group,
-                                                                           scene, params.construction_opts);
+  ompl_interface::ConstraintsLibraryPtr constraints_library = context->getConstraintsLibraryNonConst();
+  ompl_interface::ConstraintApproximationConstructionResults result;
+  if (params.augment)
+  {
+    constraints_library->loadConstraintApproximations(params.output_folder);
+    result = constraints_library->augmentConstraintApproximation(params.constraints, params.planning_group, scene,
+                                                                 params.construction_opts);
+  }
+  else
+  {
+    result = constraints_library->addConstraintApproximation(params.constraints, params.planning_group, scene,
+                                                             params.construction_opts);
+  }
 
   if (!result.approx)
   {
     RCLCPP_FATAL(LOGGER, "Failed to generate approximation.");
     return;
   }
-  context->getConstraintsLibraryNonConst()->saveConstraintApproximations(params.output_folder);
+  constraints_library->saveConstraintApproximations(params.output_folder, params.binary_storage);
   RCLCPP_INFO_STREAM(LOGGER, "Successfully generated Joint Space Constraint Approximation Database for constraint:\n"
                                  << params.constraints.name);
   RCLCPP_INFO_STREAM(LOGGER, "The database has been saved in your local folder '" << params.output_folder << '\'');
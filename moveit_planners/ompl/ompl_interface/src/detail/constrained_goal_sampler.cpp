@@ -37,6 +37,7 @@
 #include <moveit/ompl_interface/detail/constrained_goal_sampler.h>
 #include <moveit/ompl_interface/model_based_planning_context.h>
 #include <moveit/ompl_interface/detail/state_validity_checker.h>
+#include <moveit/constraint_samplers/constraint_sampler_tools.h>
 #include <moveit/utils/logger.hpp>
 
 #include <utility>
@@ -51,6 +52,12 @@ rclcpp::Logger getLogger()
 }
 }  // namespace
 
+ConstrainedGoalSampler::SamplingWorker::SamplingWorker(constraint_samplers::ConstraintSamplerPtr sampler,
+                                                       const moveit::core::RobotState& state)
+  : constraint_sampler(std::move(sampler)), work_state(state), goal_state(nullptr)
+{
+}
+
 ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext* pc,
                                                kinematic_constraints::KinematicConstraintSetPtr ks,
                                                constraint_samplers::ConstraintSamplerPtr cs)
@@ -67,13 +74,101 @@ ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext*
   , invalid_sampled_constraints_(0)
   , warned_invalid_samples_(false)
   , verbose_display_(0)
+  , worker_attempts_(0)
+  , stop_workers_(false)
 {
   if (!constraint_sampler_)
+  {
     default_sampler_ = si_->allocStateSampler();
+  }
+  else if (pc->getGoalSamplingThreads() > 1 && pc->getSpecification().constraint_sampler_manager_)
+  {
+    // constraint samplers and kinematics solvers are stateful, so every worker gets its own instances
+    for (unsigned int i = 1; i < pc->getGoalSamplingThreads(); ++i)
+    {
+      constraint_samplers::ConstraintSamplerPtr sampler =
+          pc->getSpecification().constraint_sampler_manager_->selectSampler(
+              pc->getPlanningScene(), pc->getGroupName(), kinematic_constraint_set_->getAllConstraints());
+      if (!sampler || !constraint_samplers::allocateKinematicsSolvers(sampler))
+      {
+        RCLCPP_DEBUG(getLogger(), "Unable to set up more than %zu additional goal sampling threads", workers_.size());
+        break;
+      }
+      auto worker = std::make_unique<SamplingWorker>(std::move(sampler), work_state_);
+      worker->goal_state = si_->allocState();
+      workers_.push_back(std::move(worker));
+    }
+    RCLCPP_DEBUG(getLogger(), "Using %zu additional goal sampling threads", workers_.size());
+  }
   RCLCPP_DEBUG(getLogger(), "Constructed a ConstrainedGoalSampler instance at address %p", this);
   startSampling();
 }
 
+ConstrainedGoalSampler::~ConstrainedGoalSampler()
+{
+  // the workers are joined by the sampling thread, which needs to stop before the members it uses are destroyed
+  stopSampling();
+  for (std::unique_ptr<SamplingWorker>& worker : workers_)
+    si_->freeState(worker->goal_state);
+}
+
+void ConstrainedGoalSampler::clear()
+{
+  GoalLazySamples::clear();
+  worker_attempts_ = 0;
+}
+
+bool ConstrainedGoalSampler::sampleInParallel(ob::State* new_goal)
+{
+  // the workers add goals to the region themselves, and this thread only returns once sampling is over, so that
+  // GoalLazySamples::stopSampling() also waits for all workers
+  stop_workers_ = false;
+  for (std::unique_ptr<SamplingWorker>& worker : workers_)
+  {
+    worker->thread = std::thread([this, &worker = *worker] {
+      sampleLoop(*worker.constraint_sampler, worker.work_state, worker.goal_state);
+    });
+  }
+  sampleLoop(*constraint_sampler_, work_state_, new_goal);
+  stop_workers_ = true;
+  for (std::unique_ptr<SamplingWorker>& worker : workers_)
+    worker->thread.join();
+  return false;
+}
+
+void ConstrainedGoalSampler::sampleLoop(constraint_samplers::ConstraintSampler& constraint_sampler,
+                                        moveit::core::RobotState& work_state, ob::State* goal_state)
+{
+  while (!stop_workers_ && isSampling())
+  {
+    const unsigned int attempts_so_far = samplingAttemptsCount() + worker_attempts_++;
+    if (shouldStopSampling(attempts_so_far))
+      break;
+
+    if (sampleGoal(constraint_sampler, work_state, goal_state, attempts_so_far, false) &&
+        si_->satisfiesBounds(goal_state))
+    {
+      addStateIfDifferent(goal_state, getMinNewSampleDistance());
+    }
+  }
+  // one thread running out of attempts or finding enough goals ends sampling for all of them
+  stop_workers_ = true;
+}
+
+bool ConstrainedGoalSampler::shouldStopSampling(unsigned int attempts_so_far) const
+{
+  // terminate after too many attempts
+  if (attempts_so_far >= planning_context_->getMaximumGoalSamplingAttempts())
+    return true;
+
+  // terminate after a maximum number of samples
+  if (getStateCount() >= planning_context_->getMaximumGoalSamples())
+    return true;
+
+  // terminate the sampling thread when a solution has been found
+  return planning_context_->getOMPLSimpleSetup()->getProblemDefinition()->hasSolution();
+}
+
 bool ConstrainedGoalSampler::checkStateValidity(ob::State* new_goal, const moveit::core::RobotState& state,
                                                 bool verbose) const
 {
@@ -92,25 +187,59 @@ bool ConstrainedGoalSampler::stateValidityCallback(ob::State* new_goal, const mo
   return checkStateValidity(new_goal, solution_state, verbose);
 }
 
+bool ConstrainedGoalSampler::sampleGoal(constraint_samplers::ConstraintSampler& constraint_sampler,
+                                        moveit::core::RobotState& work_state, ob::State* new_goal,
+                                        unsigned int attempts_so_far, bool verbose)
+{
+  // makes the constraint sampler also perform a validity callback
+  moveit::core::GroupStateValidityCallbackFn gsvcf = [this, new_goal,
+                                                      verbose](moveit::core::RobotState* robot_state,
+                                                               const moveit::core::JointModelGroup* joint_group,
+                                                               const double* joint_group_variable_values) {
+    return stateValidityCallback(new_goal, robot_state, joint_group, joint_group_variable_values, verbose);
+  };
+  constraint_sampler.setGroupStateValidityCallback(gsvcf);
+
+  if (constraint_sampler.sample(work_state, planning_context_->getMaximumStateSamplingAttempts()))
+  {
+    work_state.update();
+    if (kinematic_constraint_set_->decide(work_state, verbose).satisfied)
+    {
+      if (checkStateValidity(new_goal, work_state, verbose))
+        return true;
+    }
+    else
+    {
+      invalid_sampled_constraints_++;
+      if (!warned_invalid_samples_ && invalid_sampled_constraints_ >= (attempts_so_far * 8) / 10)
+      {
+        warned_invalid_samples_ = true;
+        RCLCPP_WARN(getLogger(), "More than 80%% of the sampled goal states "
+                                 "fail to satisfy the constraints imposed on the goal sampler. "
+                                 "Is the constrained sampler working correctly?");
+      }
+    }
+  }
+  return false;
+}
+
 bool ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamples* gls, ob::State* new_goal)
 {
+  if (!workers_.empty())
+  {
+    // every call starts a new sampling run, since sampleInParallel() only returns when sampling is over
+    worker_attempts_ = 0;
+    return sampleInParallel(new_goal);
+  }
+
   unsigned int max_attempts = planning_context_->getMaximumGoalSamplingAttempts();
   unsigned int attempts_so_far = gls->samplingAttemptsCount();
 
-  // terminate after too many attempts
-  if (attempts_so_far >= max_attempts)
-    return false;
-
-  // terminate after a maximum number of samples
-  if (gls->getStateCount() >= planning_context_->getMaximumGoalSamples())
-    return false;
-
-  // terminate the sampling thread when a solution has been found
-  if (planning_context_->getOMPLSimpleSetup()->getProblemDefinition()->hasSolution())
+  if (shouldStopSampling(attempts_so_far))
     return false;
 
   unsigned int max_attempts_div2 = max_attempts / 2;
-  for (unsigned int a = gls->samplingAttemptsCount(); a < max_attempts && gls->isSampling(); ++a)
+  for (unsigned int a = attempts_so_far; a < max_attempts && gls->isSampling(); ++a)
   {
     bool verbose = false;
     if (gls->getStateCount() == 0 && a >= max_attempts_div2)
@@ -124,35 +253,8 @@ bool ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamp
 
     if (constraint_sampler_)
     {
-      // makes the constraint sampler also perform a validity callback
-      moveit::core::GroupStateValidityCallbackFn gsvcf = [this, new_goal,
-                                                          verbose](moveit::core::RobotState* robot_state,
-                                                                   const moveit::core::JointModelGroup* joint_group,
-                                                                   const double* joint_group_variable_values) {
-        return stateValidityCallback(new_goal, robot_state, joint_group, joint_group_variable_values, verbose);
-      };
-      constraint_sampler_->setGroupStateValidityCallback(gsvcf);
-
-      if (constraint_sampler_->sample(work_state_, planning_context_->getMaximumStateSamplingAttempts()))
-      {
-        work_state_.update();
-        if (kinematic_constraint_set_->decide(work_state_, verbose).satisfied)
-        {
-          if (checkStateValidity(new_goal, work_state_, verbose))
-            return true;
-        }
-        else
-        {
-          invalid_sampled_constraints_++;
-          if (!warned_invalid_samples_ && invalid_sampled_constraints_ >= (attempts_so_far * 8) / 10)
-          {
-            warned_invalid_samples_ = true;
-            RCLCPP_WARN(getLogger(), "More than 80%% of the sampled goal states "
-                                     "fail to satisfy the constraints imposed on the goal sampler. "
-                                     "Is the constrained sampler working correctly?");
-          }
-        }
-      }
+      if (sampleGoal(*constraint_sampler_, work_state_, new_goal, attempts_so_far, verbose))
+        return true;
     }
     else
     {
@@ -35,10 +35,15 @@
 /* Author: Ioan Sucan */
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 #include <moveit/ompl_interface/detail/constrained_sampler.h>
 #include <moveit/ompl_interface/detail/constraints_library.h>
+#include <moveit/constraint_samplers/constraint_sampler_tools.h>
 #include <moveit/utils/logger.hpp>
 
 #include <ompl/tools/config/SelfConfig.h>
@@ -274,6 +279,189 @@ ConstraintApproximation::getStateSamplerAllocator(const moveit_msgs::msg::Constr
   };
 }
 
+namespace
+{
+// Compact binary storage: a fixed header, the serialized states as one contiguous block and the metadata
+// flattened into 64 bit integers. All values are written in native byte order.
+const char BINARY_STORAGE_MAGIC[8] = { 'M', 'V', 'I', 'T', 'C', 'A', 'D', 'B' };
+const std::uint32_t BINARY_STORAGE_VERSION = 1;
+
+bool isBinaryStateStorage(const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  char magic[sizeof(BINARY_STORAGE_MAGIC)];
+  return in.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), BINARY_STORAGE_MAGIC);
+}
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// number of bytes left to read from a file stream
+std::uint64_t remainingBytes(std::istream& in)
+{
+  const std::istream::pos_type current = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::istream::pos_type end = in.tellg();
+  in.seekg(current);
+  if (!in || current == std::istream::pos_type(-1) || end < current)
+    return 0;
+  return static_cast<std::uint64_t>(end - current);
+}
+
+bool storeBinaryStateStorage(const ConstraintApproximationStateStorage& storage, const std::string& filename)
+{
+  std::ofstream out(filename, std::ios::binary);
+  if (!out.good())
+    return false;
+
+  const ob::StateSpacePtr& space = storage.getStateSpace();
+  std::vector<int> signature;
+  space->computeSignature(signature);
+  const std::uint32_t state_size = space->getSerializationLength();
+  const std::uint64_t state_count = storage.size();
+
+  out.write(BINARY_STORAGE_MAGIC, sizeof(BINARY_STORAGE_MAGIC));
+  writeValue(out, BINARY_STORAGE_VERSION);
+  writeValue(out, static_cast<std::uint32_t>(signature.size()));
+  for (int s : signature)
+    writeValue(out, static_cast<std::int32_t>(s));
+  writeValue(out, state_size);
+  writeValue(out, state_count);
+
+  std::vector<char> states(state_size * state_count);
+  for (std::size_t i = 0; i < state_count; ++i)
+    space->serialize(states.data() + i * state_size, storage.getState(i));
+  out.write(states.data(), states.size());
+
+  std::vector<std::uint64_t> metadata;
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    const ConstrainedStateMetadata& md = storage.getMetadata(i);
+    metadata.push_back(md.first.size());
+    metadata.insert(metadata.end(), md.first.begin(), md.first.end());
+    metadata.push_back(md.second.size());
+    for (const auto& [neighbor, range] : md.second)
+    {
+      metadata.push_back(neighbor);
+      metadata.push_back(range.first);
+      metadata.push_back(range.second);
+    }
+  }
+  writeValue(out, static_cast<std::uint64_t>(metadata.size()));
+  out.write(reinterpret_cast<const char*>(metadata.data()), metadata.size() * sizeof(std::uint64_t));
+  return out.good();
+}
+
+bool loadBinaryStateStorage(ConstraintApproximationStateStorage& storage, const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  char magic[sizeof(BINARY_STORAGE_MAGIC)];
+  std::uint32_t version, signature_size;
+  if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), BINARY_STORAGE_MAGIC) ||
+      !readValue(in, version) || version != BINARY_STORAGE_VERSION || !readValue(in, signature_size))
+  {
+    RCLCPP_ERROR(getLogger(), "'%s' is not a binary constraint approximation file of version %u", filename.c_str(),
+                 BINARY_STORAGE_VERSION);
+    return false;
+  }
+
+  // sizes read from the file are checked against the remaining file length before anything is allocated, so that a
+  // corrupt file is rejected instead of causing a huge allocation
+  if (signature_size > remainingBytes(in) / sizeof(std::int32_t))
+  {
+    RCLCPP_ERROR(getLogger(), "'%s' is truncated", filename.c_str());
+    return false;
+  }
+  const ob::StateSpacePtr& space = storage.getStateSpace();
+  std::vector<int> expected_signature, signature(signature_size);
+  space->computeSignature(expected_signature);
+  for (int& s : signature)
+  {
+    std::int32_t value;
+    if (!readValue(in, value))
+      return false;
+    s = value;
+  }
+  std::uint32_t state_size;
+  std::uint64_t state_count;
+  if (!readValue(in, state_size) || !readValue(in, state_count))
+    return false;
+  if (signature != expected_signature || state_size != space->getSerializationLength())
+  {
+    RCLCPP_ERROR(getLogger(), "State space of '%s' does not match the planning context", filename.c_str());
+    return false;
+  }
+
+  if (state_size == 0 || state_count > remainingBytes(in) / state_size)
+  {
+    RCLCPP_ERROR(getLogger(), "'%s' is truncated", filename.c_str());
+    return false;
+  }
+  std::vector<char> states(state_size * state_count);
+  if (!in.read(states.data(), states.size()))
+    return false;
+  std::uint64_t metadata_size;
+  if (!readValue(in, metadata_size))
+    return false;
+  if (metadata_size > remainingBytes(in) / sizeof(std::uint64_t))
+  {
+    RCLCPP_ERROR(getLogger(), "'%s' is truncated", filename.c_str());
+    return false;
+  }
+  std::vector<std::uint64_t> metadata(metadata_size);
+  if (!in.read(reinterpret_cast<char*>(metadata.data()), metadata_size * sizeof(std::uint64_t)))
+    return false;
+
+  ob::State* state = space->allocState();
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    space->deserialize(state, states.data() + i * state_size);
+    storage.addState(state);
+  }
+  space->freeState(state);
+
+  std::size_t pos = 0;
+  const auto next = [&metadata, &pos](std::uint64_t& value) {
+    if (pos >= metadata.size())
+      return false;
+    value = metadata[pos++];
+    return true;
+  };
+  for (std::size_t i = 0; i < state_count; ++i)
+  {
+    ConstrainedStateMetadata& md = storage.getMetadata(i);
+    std::uint64_t count, value, first, second;
+    if (!next(count))
+      return false;
+    md.first.reserve(count);
+    for (std::size_t k = 0; k < count; ++k)
+    {
+      if (!next(value))
+        return false;
+      md.first.push_back(value);
+    }
+    if (!next(count))
+      return false;
+    for (std::size_t k = 0; k < count; ++k)
+    {
+      if (!next(value) || !next(first) || !next(second))
+        return false;
+      md.second[value] = std::make_pair(first, second);
+    }
+  }
+  return true;
+}
+}  // namespace
+
 void ConstraintsLibrary::loadConstraintApproximations(const std::string& path)
 {
   constraint_approximations_.clear();
@@ -324,9 +512,19 @@ void ConstraintsLibrary::loadConstraintApproximations(const std::string& path)
     moveit_msgs::msg::Constraints msg;
     hexToMsg(serialization, msg);
     auto* cass = new ConstraintApproximationStateStorage(context_->getOMPLSimpleSetup()->getStateSpace());
-    cass->load((std::string{ path }.append("/").append(filename)).c_str());
+    ompl::base::StateStoragePtr storage(cass);
+    const std::string storage_filename = std::string{ path }.append("/").append(filename);
+    if (!isBinaryStateStorage(storage_filename))
+    {
+      cass->load(storage_filename.c_str());
+    }
+    else if (!loadBinaryStateStorage(*cass, storage_filename))
+    {
+      RCLCPP_ERROR(getLogger(), "Unable to load constraint approximation from '%s'", storage_filename.c_str());
+      continue;
+    }
     auto cap = std::make_shared<ConstraintApproximation>(group, state_space_parameterization, explicit_motions, msg,
-                                                         filename, ompl::base::StateStoragePtr(cass), milestones);
+                                                         filename, storage, milestones);
     if (constraint_approximations_.find(cap->getName()) != constraint_approximations_.end())
       RCLCPP_WARN(getLogger(), "Overwriting constraint approximation named '%s'", cap->getName().c_str());
     constraint_approximations_[cap->getName()] = cap;
@@ -343,7 +541,7 @@ void ConstraintsLibrary::loadConstraintApproximations(const std::string& path)
   RCLCPP_INFO(getLogger(), "Done loading constrained space approximations.");
 }
 
-void ConstraintsLibrary::saveConstraintApproximations(const std::string& path)
+void ConstraintsLibrary::saveConstraintApproximations(const std::string& path, bool binary)
 {
   RCLCPP_INFO(getLogger(), "Saving %u constrained space approximations to '%s'",
               static_cast<unsigned int>(constraint_approximations_.size()), path.c_str());
@@ -370,7 +568,19 @@ void ConstraintsLibrary::saveConstraintApproximations(const std::string& path)
       fout << serialization << '\n';
       fout << it->second->getFilename() << '\n';
       if (it->second->getStateStorage())
-        it->second->getStateStorage()->store((path + "/" + it->second->getFilename()).c_str());
+      {
+        const std::string storage_filename = path + "/" + it->second->getFilename();
+        if (!binary)
+        {
+          it->second->getStateStorage()->store(storage_filename.c_str());
+        }
+        else if (!storeBinaryStateStorage(
+                     static_cast<const ConstraintApproximationStateStorage&>(*it->second->getStateStorage()),
+                     storage_filename))
+        {
+          RCLCPP_ERROR(getLogger(), "Unable to save constraint approximation to '%s'", storage_filename.c_str());
+        }
+      }
     }
   }
   else
@@ -423,6 +633,49 @@ ConstraintApproximationConstructionResults ConstraintsLibrary::addConstraintAppr
     const moveit_msgs::msg::Constraints& constr_sampling, const moveit_msgs::msg::Constraints& constr_hard,
     const std::string& group, const planning_scene::PlanningSceneConstPtr& scene,
     const ConstraintApproximationConstructionOptions& options)
+{
+  return buildConstraintApproximation(constr_sampling, constr_hard, group, scene, options,
+                                      ConstraintApproximationPtr());
+}
+
+ConstraintApproximationConstructionResults ConstraintsLibrary::augmentConstraintApproximation(
+    const moveit_msgs::msg::Constraints& constr, const std::string& group,
+    const planning_scene::PlanningSceneConstPtr& scene, const ConstraintApproximationConstructionOptions& options)
+{
+  return augmentConstraintApproximation(constr, constr, group, scene, options);
+}
+
+ConstraintApproximationConstructionResults ConstraintsLibrary::augmentConstraintApproximation(
+    const moveit_msgs::msg::Constraints& constr_sampling, const moveit_msgs::msg::Constraints& constr_hard,
+    const std::string& group, const planning_scene::PlanningSceneConstPtr& scene,
+    const ConstraintApproximationConstructionOptions& options)
+{
+  const ConstraintApproximationPtr existing = getConstraintApproximation(constr_hard);
+  if (!existing)
+  {
+    RCLCPP_INFO(getLogger(), "No constraint approximation named '%s' to augment. Constructing a new one.",
+                constr_hard.name.c_str());
+    return addConstraintApproximation(constr_sampling, constr_hard, group, scene, options);
+  }
+
+  if (existing->getGroup() != group ||
+      existing->getStateSpaceParameterization() != options.state_space_parameterization ||
+      existing->hasExplicitMotions() != options.explicit_motions)
+  {
+    RCLCPP_ERROR(getLogger(),
+                 "Constraint approximation named '%s' was constructed for group '%s' with state space '%s' and "
+                 "cannot be augmented with different settings",
+                 constr_hard.name.c_str(), existing->getGroup().c_str(),
+                 existing->getStateSpaceParameterization().c_str());
+    return ConstraintApproximationConstructionResults();
+  }
+  return buildConstraintApproximation(constr_sampling, constr_hard, group, scene, options, existing);
+}
+
+ConstraintApproximationConstructionResults ConstraintsLibrary::buildConstraintApproximation(
+    const moveit_msgs::msg::Constraints& constr_sampling, const moveit_msgs::msg::Constraints& constr_hard,
+    const std::string& group, const planning_scene::PlanningSceneConstPtr& scene,
+    const ConstraintApproximationConstructionOptions& options, const ConstraintApproximationPtr& existing)
 {
   ConstraintApproximationConstructionResults res;
   if (context_->getGroupName() != group &&
@@ -440,16 +693,18 @@ ConstraintApproximationConstructionResults ConstraintsLibrary::addConstraintAppr
   rclcpp::Clock clock;
   auto start = clock.now();
   ompl::base::StateStoragePtr state_storage =
-      constructConstraintApproximation(context_, constr_sampling, constr_hard, options, res);
+      constructConstraintApproximation(context_, constr_sampling, constr_hard, options, res, existing);
   RCLCPP_INFO(getLogger(), "Spent %lf seconds constructing the database", (clock.now() - start).seconds());
   if (state_storage)
   {
     auto constraint_approx = std::make_shared<ConstraintApproximation>(
         group, options.state_space_parameterization, options.explicit_motions, constr_hard,
-        group + "_" + boost::posix_time::to_iso_extended_string(boost::posix_time::microsec_clock::universal_time()) +
-            ".ompldb",
+        existing ? existing->getFilename() :
+                   group + "_" +
+                       boost::posix_time::to_iso_extended_string(boost::posix_time::microsec_clock::universal_time()) +
+                       ".ompldb",
         state_storage, res.milestones);
-    if (constraint_approximations_.find(constraint_approx->getName()) != constraint_approximations_.end())
+    if (!existing && constraint_approximations_.find(constraint_approx->getName()) != constraint_approximations_.end())
       RCLCPP_WARN(getLogger(), "Overwriting constraint approximation named '%s'", constraint_approx->getName().c_str());
     constraint_approximations_[constraint_approx->getName()] = constraint_approx;
     res.approx = constraint_approx;
@@ -459,10 +714,56 @@ ConstraintApproximationConstructionResults ConstraintsLibrary::addConstraintAppr
   return res;
 }
 
+namespace
+{
+// Runs fn(thread_index) on thread_count threads, using the calling thread for the first one
+template <typename Fn>
+void runOnThreads(unsigned int thread_count, const Fn& fn)
+{
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < thread_count; ++t)
+    threads.emplace_back(fn, t);
+  fn(0);
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+// Interpolates the motion from -> to into int_states and checks the intermediate states against the constraints,
+// if any are given
+bool checkConstrainedMotion(const ModelBasedStateSpace& space, const ob::State* from, const ob::State* to,
+                            unsigned int isteps, const kinematic_constraints::CompiledConstraintSet* constraints,
+                            moveit::core::RobotState& robot_state, std::vector<ob::State*>& int_states)
+{
+  // motions shorter than the explicit points resolution have no intermediate states to check
+  if (isteps == 0)
+    return true;
+  double step = 1.0 / static_cast<double>(isteps);
+  space.interpolate(from, to, step, int_states[0]);
+  for (unsigned int k = 1; k < isteps; ++k)
+  {
+    double this_step = step / (1.0 - (k - 1) * step);
+    space.interpolate(int_states[k - 1], to, this_step, int_states[k]);
+    if (!constraints)
+      continue;
+    space.copyToRobotState(robot_state, int_states[k]);
+    if (!constraints->satisfied(robot_state))
+      return false;
+  }
+  return true;
+}
+
+// Motions checked ahead of the sequential connection pass, for one milestone
+struct CandidateEdges
+{
+  std::vector<std::pair<std::size_t, bool>> checked;  // candidate index and whether the motion is valid
+  std::size_t resume_index = 0;                       // first candidate index that was not checked
+};
+}  // namespace
+
 ompl::base::StateStoragePtr ConstraintsLibrary::constructConstraintApproximation(
     ModelBasedPlanningContext* pcontext, const moveit_msgs::msg::Constraints& constr_sampling,
     const moveit_msgs::msg::Constraints& constr_hard, const ConstraintApproximationConstructionOptions& options,
-    ConstraintApproximationConstructionResults& result)
+    ConstraintApproximationConstructionResults& result, const ConstraintApproximationPtr& existing)
 {
   // state storage structure
   ConstraintApproximationStateStorage* cass = new ConstraintApproximationStateStorage(pcontext->getOMPLStateSpace());
@@ -472,95 +773,216 @@ ompl::base::StateStoragePtr ConstraintsLibrary::constructConstraintApproximation
   kinematic_constraints::KinematicConstraintSet kset(pcontext->getRobotModel());
   moveit::core::Transforms no_transforms(pcontext->getRobotModel()->getModelFrame());
   kset.add(constr_hard, no_transforms);
+  const kinematic_constraints::CompiledConstraintSet constraints(kset);
 
   const moveit::core::RobotState& default_state = pcontext->getCompleteInitialRobotState();
-
-  unsigned int attempts = 0;
+  const ModelBasedStateSpacePtr& space = pcontext->getOMPLStateSpace();
+  const unsigned int thread_count = std::max(1u, options.threads);
 
   double bounds_val = std::numeric_limits<double>::max() / 2.0 - 1.0;
-  pcontext->getOMPLStateSpace()->setPlanningVolume(-bounds_val, bounds_val, -bounds_val, bounds_val, -bounds_val,
-                                                   bounds_val);
-  pcontext->getOMPLStateSpace()->setup();
-
-  // construct the constrained states
-
-  moveit::core::RobotState robot_state(default_state);
-  const constraint_samplers::ConstraintSamplerManagerPtr& csmng = pcontext->getConstraintSamplerManager();
-  ConstrainedSampler* constrained_sampler = nullptr;
-  if (csmng)
-  {
-    constraint_samplers::ConstraintSamplerPtr constraint_sampler =
-        csmng->selectSampler(pcontext->getPlanningScene(), pcontext->getJointModelGroup()->getName(), constr_sampling);
-    if (constraint_sampler)
-      constrained_sampler = new ConstrainedSampler(pcontext, constraint_sampler);
-  }
-
-  ob::StateSamplerPtr ss(constrained_sampler ? ob::StateSamplerPtr(constrained_sampler) :
-                                               pcontext->getOMPLStateSpace()->allocDefaultStateSampler());
-
-  ompl::base::ScopedState<> temp(pcontext->getOMPLStateSpace());
-  int done = -1;
-  bool slow_warn = false;
-  ompl::time::point start = ompl::time::now();
-  while (state_storage->size() < options.samples)
+  space->setPlanningVolume(-bounds_val, bounds_val, -bounds_val, bounds_val, -bounds_val, bounds_val);
+  space->setup();
+
+  // copy the milestones of the approximation that is augmented; its explicit motion states are appended once the new
+  // milestones are known, so that all milestones remain at the front of the storage
+  const ConstraintApproximationStateStorage* existing_storage = nullptr;
+  std::size_t existing_milestones = 0;
+  if (existing)
   {
-    ++attempts;
-    int done_now = 100 * state_storage->size() / options.samples;
-    if (done != done_now)
+    std::vector<int> signature;
+    space->computeSignature(signature);
+    if (existing->getSpaceSignature() != signature)
     {
-      done = done_now;
-      RCLCPP_INFO(getLogger(), "%d%% complete (kept %0.1lf%% sampled states)", done,
-                  100.0 * static_cast<double>(state_storage->size()) / static_cast<double>(attempts));
+      RCLCPP_ERROR(getLogger(), "State space of constraint approximation '%s' does not match the planning context",
+                   existing->getName().c_str());
+      return ob::StateStoragePtr();
     }
-
-    if (!slow_warn && attempts > 10 && attempts > state_storage->size() * 100)
+    existing_storage = static_cast<const ConstraintApproximationStateStorage*>(existing->getStateStorage().get());
+    existing_milestones = existing->getMilestoneCount();
+    for (std::size_t i = 0; i < existing_milestones; ++i)
     {
-      slow_warn = true;
-      RCLCPP_WARN(getLogger(), "Computation of valid state database is very slow...");
+      cass->addState(existing_storage->getState(i));
+      cass->getMetadata(i).first = existing_storage->getMetadata(i).first;
     }
+    RCLCPP_INFO(getLogger(), "Augmenting %zu existing milestones", existing_milestones);
+  }
 
-    if (attempts > options.samples && state_storage->size() == 0)
+  // construct the constrained states; every thread uses its own sampler, kinematics solver and robot state
+  const constraint_samplers::ConstraintSamplerManagerPtr& csmng = pcontext->getConstraintSamplerManager();
+  std::vector<ConstrainedSampler*> constrained_samplers;
+  std::vector<ob::StateSamplerPtr> samplers;
+  for (unsigned int t = 0; t < thread_count; ++t)
+  {
+    constraint_samplers::ConstraintSamplerPtr constraint_sampler;
+    if (csmng)
     {
-      RCLCPP_ERROR(getLogger(), "Unable to generate any samples");
+      constraint_sampler = csmng->selectSampler(pcontext->getPlanningScene(),
+                                                pcontext->getJointModelGroup()->getName(), constr_sampling);
+    }
+    // the first thread uses the solver instance of the group, all others need their own
+    if (t > 0 && constraint_sampler && !constraint_samplers::allocateKinematicsSolvers(constraint_sampler))
+    {
+      RCLCPP_WARN(getLogger(), "Unable to allocate separate kinematics solvers, sampling states on %u threads", t);
       break;
     }
+    constrained_samplers.push_back(constraint_sampler ? new ConstrainedSampler(pcontext, constraint_sampler) : nullptr);
+    samplers.push_back(constrained_samplers.back() ? ob::StateSamplerPtr(constrained_samplers.back()) :
+                                                     space->allocDefaultStateSampler());
+  }
 
-    ss->sampleUniform(temp.get());
-    pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, temp.get());
-    if (kset.decide(robot_state).satisfied)
+  std::vector<ob::State*> samples(options.samples, nullptr);
+  pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(samples);
+  std::atomic<unsigned int> kept(0);
+  std::atomic<unsigned int> attempts(0);
+  std::atomic<bool> slow_warn(false);
+  std::atomic<bool> failed(false);
+  ompl::time::point start = ompl::time::now();
+  runOnThreads(samplers.size(), [&](unsigned int t) {
+    moveit::core::RobotState robot_state(default_state);
+    ompl::base::ScopedState<> temp(space);
+    int done = -1;
+    while (kept < options.samples && !failed)
     {
-      if (state_storage->size() < options.samples)
+      const unsigned int attempts_now = ++attempts;
+      const unsigned int kept_now = std::min<unsigned int>(kept, options.samples);
+      int done_now = 100 * kept_now / options.samples;
+      if (t == 0 && done != done_now)
       {
-        temp->as<ModelBasedStateSpace::StateType>()->tag = state_storage->size();
-        state_storage->addState(temp.get());
+        done = done_now;
+        RCLCPP_INFO(getLogger(), "%d%% complete (kept %0.1lf%% sampled states)", done,
+                    100.0 * static_cast<double>(kept_now) / static_cast<double>(attempts_now));
+      }
+
+      if (attempts_now > 10 && attempts_now > kept_now * 100 && !slow_warn.exchange(true))
+        RCLCPP_WARN(getLogger(), "Computation of valid state database is very slow...");
+
+      if (attempts_now > options.samples && kept_now == 0)
+      {
+        if (!failed.exchange(true))
+          RCLCPP_ERROR(getLogger(), "Unable to generate any samples");
+        break;
+      }
+
+      samplers[t]->sampleUniform(temp.get());
+      space->copyToRobotState(robot_state, temp.get());
+      if (constraints.satisfied(robot_state))
+      {
+        const unsigned int slot = kept++;
+        if (slot < options.samples)
+          space->copyState(samples[slot], temp.get());
       }
     }
+  });
+
+  const std::size_t new_milestones = std::min<unsigned int>(kept, options.samples);
+  for (std::size_t i = 0; i < new_milestones; ++i)
+  {
+    samples[i]->as<ModelBasedStateSpace::StateType>()->tag = state_storage->size();
+    state_storage->addState(samples[i]);
   }
+  pcontext->getOMPLSimpleSetup()->getSpaceInformation()->freeStates(samples);
 
   result.state_sampling_time = ompl::time::seconds(ompl::time::now() - start);
-  RCLCPP_INFO(getLogger(), "Generated %u states in %lf seconds", static_cast<unsigned int>(state_storage->size()),
+  RCLCPP_INFO(getLogger(), "Generated %u states in %lf seconds", static_cast<unsigned int>(new_milestones),
               result.state_sampling_time);
-  if (constrained_sampler)
+  std::size_t constrained_sampler_count = 0;
+  double sampling_rate_sum = 0.0;
+  for (const ConstrainedSampler* constrained_sampler : constrained_samplers)
+  {
+    if (constrained_sampler)
+    {
+      sampling_rate_sum += constrained_sampler->getConstrainedSamplingRate();
+      ++constrained_sampler_count;
+    }
+  }
+  if (constrained_sampler_count > 0)
   {
-    result.sampling_success_rate = constrained_sampler->getConstrainedSamplingRate();
+    result.sampling_success_rate = sampling_rate_sum / constrained_sampler_count;
     RCLCPP_INFO(getLogger(), "Constrained sampling rate: %lf", result.sampling_success_rate);
   }
 
   result.milestones = state_storage->size();
+  if (existing_storage)
+  {
+    // append the explicit motions of the augmented approximation behind the new milestones
+    const std::size_t offset = result.milestones - existing_milestones;
+    for (std::size_t i = existing_milestones; i < existing_storage->size(); ++i)
+      state_storage->addState(existing_storage->getState(i));
+    for (std::size_t i = 0; i < existing_milestones; ++i)
+    {
+      for (const auto& [neighbor, range] : existing_storage->getMetadata(i).second)
+        cass->getMetadata(i).second[neighbor] = std::make_pair(range.first + offset, range.second + offset);
+    }
+  }
+
   if (options.edges_per_sample > 0)
   {
     RCLCPP_INFO(getLogger(), "Computing graph connections (max %u edges per sample) ...", options.edges_per_sample);
 
-    // construct connections
-    const ob::StateSpacePtr& space = pcontext->getOMPLSimpleSetup()->getStateSpace();
-    unsigned int milestones = state_storage->size();
-    std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
-    pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
+    // construct connections; only pairs that involve at least one new milestone are considered
+    const std::size_t milestones = result.milestones;
+    const auto motion_steps = [&options](double d) {
+      return std::min<unsigned int>(options.max_explicit_points, d / options.explicit_points_resolution);
+    };
 
     ompl::time::point start = ompl::time::now();
+
+    // Check candidate motions in parallel first. For every milestone j, candidates i > j are checked in order until
+    // edges_per_sample valid motions are found, which is the most the sequential pass below can use. The sequential
+    // pass then applies the edge limits exactly as if all motions were checked in order, and only checks further
+    // candidates itself when some of the precomputed ones were rejected because of the limit of the other milestone.
+    std::vector<CandidateEdges> candidates(milestones);
+    std::atomic<std::size_t> next_row(0);
+    runOnThreads(thread_count, [&](unsigned int /*t*/) {
+      moveit::core::RobotState robot_state(default_state);
+      std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
+      pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
+      for (std::size_t j = next_row++; j < milestones; j = next_row++)
+      {
+        CandidateEdges& row = candidates[j];
+        std::size_t valid = cass->getMetadata(j).first.size();
+        std::size_t i = std::max(j + 1, existing_milestones);
+        const ob::State* sj = state_storage->getState(j);
+        for (; i < milestones && valid < options.edges_per_sample; ++i)
+        {
+          double d = space->distance(state_storage->getState(i), sj);
+          if (d >= options.max_edge_length)
+            continue;
+          bool ok = checkConstrainedMotion(*space, state_storage->getState(i), sj, motion_steps(d), &constraints,
+                                           robot_state, int_states);
+          row.checked.emplace_back(i, ok);
+          if (ok)
+            ++valid;
+        }
+        row.resume_index = i;
+      }
+      pcontext->getOMPLSimpleSetup()->getSpaceInformation()->freeStates(int_states);
+    });
+
+    moveit::core::RobotState robot_state(default_state);
+    std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
+    pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
     int good = 0;
     int done = -1;
 
+    const auto connect = [&](std::size_t i, std::size_t j, unsigned int isteps) {
+      cass->getMetadata(i).first.push_back(j);
+      cass->getMetadata(j).first.push_back(i);
+
+      if (options.explicit_motions)
+      {
+        cass->getMetadata(i).second[j].first = state_storage->size();
+        for (unsigned int k = 0; k < isteps; ++k)
+        {
+          int_states[k]->as<ModelBasedStateSpace::StateType>()->tag = -1;
+          state_storage->addState(int_states[k]);
+        }
+        cass->getMetadata(i).second[j].second = state_storage->size();
+        cass->getMetadata(j).second[i] = cass->getMetadata(i).second[j];
+      }
+      good++;
+    };
+
     for (std::size_t j = 0; j < milestones; ++j)
     {
       int done_now = 100 * j / milestones;
@@ -574,51 +996,31 @@ ompl::base::StateStoragePtr ConstraintsLibrary::constructConstraintApproximation
 
       const ob::State* sj = state_storage->getState(j);
 
-      for (std::size_t i = j + 1; i < milestones; ++i)
+      for (const auto& [i, ok] : candidates[j].checked)
+      {
+        if (!ok || cass->getMetadata(i).first.size() >= options.edges_per_sample)
+          continue;
+        // the motion is known to be valid; the intermediate states are only needed when they are stored
+        const double d = space->distance(state_storage->getState(i), sj);
+        if (options.explicit_motions)
+          checkConstrainedMotion(*space, state_storage->getState(i), sj, motion_steps(d), nullptr, robot_state,
+                                 int_states);
+        connect(i, j, motion_steps(d));
+        if (cass->getMetadata(j).first.size() >= options.edges_per_sample)
+          break;
+      }
+
+      for (std::size_t i = candidates[j].resume_index;
+           i < milestones && cass->getMetadata(j).first.size() < options.edges_per_sample; ++i)
       {
         if (cass->getMetadata(i).first.size() >= options.edges_per_sample)
           continue;
         double d = space->distance(state_storage->getState(i), sj);
         if (d >= options.max_edge_length)
           continue;
-        unsigned int isteps =
-            std::min<unsigned int>(options.max_explicit_points, d / options.explicit_points_resolution);
-        double step = 1.0 / static_cast<double>(isteps);
-        bool ok = true;
-        space->interpolate(state_storage->getState(i), sj, step, int_states[0]);
-        for (unsigned int k = 1; k < isteps; ++k)
-        {
-          double this_step = step / (1.0 - (k - 1) * step);
-          space->interpolate(int_states[k - 1], sj, this_step, int_states[k]);
-          pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, int_states[k]);
-          if (!kset.decide(robot_state).satisfied)
-          {
-            ok = false;
-            break;
-          }
-        }
-
-        if (ok)
-        {
-          cass->getMetadata(i).first.push_back(j);
-          cass->getMetadata(j).first.push_back(i);
-
-          if (options.explicit_motions)
-          {
-            cass->getMetadata(i).second[j].first = state_storage->size();
-            for (unsigned int k = 0; k < isteps; ++k)
-            {
-              int_states[k]->as<ModelBasedStateSpace::StateType>()->tag = -1;
-              state_storage->addState(int_states[k]);
-            }
-            cass->getMetadata(i).second[j].second = state_storage->size();
-            cass->getMetadata(j).second[i] = cass->getMetadata(i).second[j];
-          }
-
-          good++;
-          if (cass->getMetadata(j).first.size() >= options.edges_per_sample)
-            break;
-        }
+        if (checkConstrainedMotion(*space, state_storage->getState(i), sj, motion_steps(d), &constraints, robot_state,
+                                   int_states))
+          connect(i, j, motion_steps(d));
       }
     }
 
@@ -35,6 +35,8 @@
 /* Author: Jeroen De Maeyer, Boston Cleek */
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <iterator>
 
 #include <moveit/ompl_interface/detail/ompl_constraints.h>
@@ -50,6 +52,13 @@ rclcpp::Logger getLogger()
 {
   return moveit::getLogger("moveit.planners.ompl.constraints");
 }
+
+// Id of the next constraint that is created, 0 marks unused kinematics cache entries
+std::atomic<std::uint64_t> next_constraint_id{ 1 };
+
+// Number of constraints whose kinematics every thread keeps, enough for a position and an orientation constraint
+// that are evaluated alternately
+constexpr std::size_t KINEMATICS_CACHE_SIZE = 4;
 }  // namespace
 
 Bounds::Bounds() : size_(0)
@@ -65,48 +74,60 @@ Bounds::Bounds(const std::vector<double>& lower, const std::vector<double>& uppe
 
 Eigen::VectorXd Bounds::penalty(const Eigen::Ref<const Eigen::VectorXd>& x) const
 {
-  assert(static_cast<long>(lower_.size()) == x.size());
   Eigen::VectorXd penalty(x.size());
+  this->penalty(x, penalty);
+  return penalty;
+}
+
+void Bounds::penalty(const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::Ref<Eigen::VectorXd> out) const
+{
+  assert(static_cast<long>(lower_.size()) == x.size());
+  assert(out.size() == x.size());
 
   for (unsigned int i = 0; i < x.size(); ++i)
   {
-    if (x[i] < lower_.at(i))
+    if (x[i] < lower_[i])
     {
-      penalty[i] = lower_.at(i) - x[i];
+      out[i] = lower_[i] - x[i];
     }
-    else if (x[i] > upper_.at(i))
+    else if (x[i] > upper_[i])
     {
-      penalty[i] = x[i] - upper_.at(i);
+      out[i] = x[i] - upper_[i];
     }
     else
     {
-      penalty[i] = 0.0;
+      out[i] = 0.0;
     }
   }
-  return penalty;
 }
 
 Eigen::VectorXd Bounds::derivative(const Eigen::Ref<const Eigen::VectorXd>& x) const
 {
-  assert(static_cast<long>(lower_.size()) == x.size());
   Eigen::VectorXd derivative(x.size());
+  this->derivative(x, derivative);
+  return derivative;
+}
+
+void Bounds::derivative(const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::Ref<Eigen::VectorXd> out) const
+{
+  assert(static_cast<long>(lower_.size()) == x.size());
+  assert(out.size() == x.size());
 
   for (unsigned int i = 0; i < x.size(); ++i)
   {
-    if (x[i] < lower_.at(i))
+    if (x[i] < lower_[i])
     {
-      derivative[i] = -1.0;
+      out[i] = -1.0;
     }
-    else if (x[i] > upper_.at(i))
+    else if (x[i] > upper_[i])
     {
-      derivative[i] = 1.0;
+      out[i] = 1.0;
     }
     else
     {
-      derivative[i] = 0.0;
+      out[i] = 0.0;
     }
   }
-  return derivative;
 }
 
 std::size_t Bounds::size() const
@@ -132,64 +153,131 @@ BaseConstraint::BaseConstraint(const moveit::core::RobotModelConstPtr& robot_mod
   : ompl::base::Constraint(num_dofs, num_cons_)
   , state_storage_(robot_model)
   , joint_model_group_(robot_model->getJointModelGroup(group))
-
+  , id_(next_constraint_id++)
 {
 }
 
 void BaseConstraint::init(const moveit_msgs::msg::Constraints& constraints)
 {
   parseConstraintMsg(constraints);
+  link_model_ = joint_model_group_->getParentModel().getLinkModel(link_name_);
 }
 
 void BaseConstraint::function(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
                               Eigen::Ref<Eigen::VectorXd> out) const
 {
-  const Eigen::VectorXd current_values = calcError(joint_values);
-  out = bounds_.penalty(current_values);
+  KinematicsCache& cache = updateKinematics(joint_values, false);
+  bounds_.penalty(updateError(cache), out);
 }
 
 void BaseConstraint::jacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
                               Eigen::Ref<Eigen::MatrixXd> out) const
 {
-  const Eigen::VectorXd constraint_error = calcError(joint_values);
-  const Eigen::VectorXd constraint_derivative = bounds_.derivative(constraint_error);
-  const Eigen::MatrixXd robot_jacobian = calcErrorJacobian(joint_values);
+  // OMPL's projection evaluates the function right before the jacobian, so the kinematics and error are reused here
+  KinematicsCache& cache = updateKinematics(joint_values, true);
+  bounds_.derivative(updateError(cache), cache.error_derivative);
+  computeErrorJacobian(cache.link_transform, cache.robot_jacobian, out);
   for (std::size_t i = 0; i < bounds_.size(); ++i)
   {
-    out.row(i) = constraint_derivative[i] * robot_jacobian.row(i);
+    out.row(i) *= cache.error_derivative[i];
+  }
+}
+
+BaseConstraint::KinematicsCache& BaseConstraint::updateKinematics(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
+                                                                  bool with_jacobian) const
+{
+  // The entries are never locked and do not grow with the number of constraints or threads
+  thread_local std::array<KinematicsCache, KINEMATICS_CACHE_SIZE> thread_caches;
+  thread_local std::size_t next_replaced_entry = 0;
+
+  auto it = std::find_if(thread_caches.begin(), thread_caches.end(),
+                         [this](const KinematicsCache& entry) { return entry.constraint_id == id_; });
+  if (it == thread_caches.end())
+  {
+    // Take over the oldest entry. The robot state of a destroyed constraint is never used, since no constraint can
+    // have its id anymore.
+    it = thread_caches.begin() + next_replaced_entry;
+    next_replaced_entry = (next_replaced_entry + 1) % KINEMATICS_CACHE_SIZE;
+    it->constraint_id = id_;
+    it->robot_state = state_storage_.getStateStorage();
+    it->joint_values.resize(joint_values.size());
+    it->error.resize(getCoDimension());
+    it->error_derivative.resize(getCoDimension());
+    it->valid = false;
+    it->jacobian_valid = false;
+    it->error_valid = false;
+  }
+  KinematicsCache* cache = &*it;
+
+  if (!cache->valid || cache->joint_values != joint_values)
+  {
+    cache->joint_values = joint_values;
+    cache->robot_state->setJointGroupPositions(joint_model_group_, cache->joint_values.data());
+    cache->robot_state->updateLinkTransforms();
+    cache->link_transform = cache->robot_state->getGlobalLinkTransform(link_model_);
+    cache->valid = true;
+    cache->jacobian_valid = false;
+    cache->error_valid = false;
   }
+
+  if (with_jacobian && !cache->jacobian_valid)
+  {
+    // return value (success) not used, could return a garbage jacobian.
+    cache->robot_state->getJacobian(joint_model_group_, link_model_, Eigen::Vector3d(0.0, 0.0, 0.0),
+                                    cache->robot_jacobian);
+    cache->jacobian_valid = true;
+  }
+  return *cache;
+}
+
+const Eigen::VectorXd& BaseConstraint::updateError(KinematicsCache& cache) const
+{
+  if (!cache.error_valid)
+  {
+    computeError(cache.link_transform, cache.error);
+    cache.error_valid = true;
+  }
+  return cache.error;
 }
 
 Eigen::Isometry3d BaseConstraint::forwardKinematics(const Eigen::Ref<const Eigen::VectorXd>& joint_values) const
 {
-  moveit::core::RobotState* robot_state = state_storage_.getStateStorage();
-  robot_state->setJointGroupPositions(joint_model_group_, joint_values);
-  return robot_state->getGlobalLinkTransform(link_name_);
+  return updateKinematics(joint_values, false).link_transform;
 }
 
 Eigen::MatrixXd BaseConstraint::robotGeometricJacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_values) const
 {
-  moveit::core::RobotState* robot_state = state_storage_.getStateStorage();
-  robot_state->setJointGroupPositions(joint_model_group_, joint_values);
-  Eigen::MatrixXd jacobian;
-  // return value (success) not used, could return a garbage jacobian.
-  robot_state->getJacobian(joint_model_group_, joint_model_group_->getLinkModel(link_name_),
-                           Eigen::Vector3d(0.0, 0.0, 0.0), jacobian);
+  return updateKinematics(joint_values, true).robot_jacobian;
+}
+
+Eigen::VectorXd BaseConstraint::calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const
+{
+  return updateError(updateKinematics(x, false));
+}
+
+Eigen::MatrixXd BaseConstraint::calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const
+{
+  const KinematicsCache& cache = updateKinematics(x, true);
+  Eigen::MatrixXd jacobian(getCoDimension(), n_);
+  computeErrorJacobian(cache.link_transform, cache.robot_jacobian, jacobian);
   return jacobian;
 }
 
-Eigen::VectorXd BaseConstraint::calcError(const Eigen::Ref<const Eigen::VectorXd>& /*x*/) const
+void BaseConstraint::computeError(const Eigen::Isometry3d& /*link_transform*/, Eigen::Ref<Eigen::VectorXd> error) const
 {
   RCLCPP_WARN_STREAM(getLogger(),
-                     "BaseConstraint: Constraint method calcError was not overridden, so it should not be used.");
-  return Eigen::VectorXd::Zero(getCoDimension());
+                     "BaseConstraint: Constraint method computeError was not overridden, so it should not be used.");
+  error.setZero();
 }
 
-Eigen::MatrixXd BaseConstraint::calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& /*x*/) const
+void BaseConstraint::computeErrorJacobian(const Eigen::Isometry3d& /*link_transform*/,
+                                          const Eigen::MatrixXd& /*robot_jacobian*/,
+                                          Eigen::Ref<Eigen::MatrixXd> out) const
 {
   RCLCPP_WARN_STREAM(
-      getLogger(), "BaseConstraint: Constraint method calcErrorJacobian was not overridden, so it should not be used.");
-  return Eigen::MatrixXd::Zero(getCoDimension(), n_);
+      getLogger(),
+      "BaseConstraint: Constraint method computeErrorJacobian was not overridden, so it should not be used.");
+  out.setZero();
 }
 
 /******************************************
@@ -218,14 +306,15 @@ void BoxConstraint::parseConstraintMsg(const moveit_msgs::msg::Constraints& cons
   link_name_ = constraints.position_constraints.at(0).link_name;
 }
 
-Eigen::VectorXd BoxConstraint::calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const
+void BoxConstraint::computeError(const Eigen::Isometry3d& link_transform, Eigen::Ref<Eigen::VectorXd> error) const
 {
-  return target_orientation_.matrix().transpose() * (forwardKinematics(x).translation() - target_position_);
+  error.noalias() = target_orientation_.matrix().transpose() * (link_transform.translation() - target_position_);
 }
 
-Eigen::MatrixXd BoxConstraint::calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const
+void BoxConstraint::computeErrorJacobian(const Eigen::Isometry3d& /*link_transform*/,
+                                         const Eigen::MatrixXd& robot_jacobian, Eigen::Ref<Eigen::MatrixXd> out) const
 {
-  return target_orientation_.matrix().transpose() * robotGeometricJacobian(x).topRows(3);
+  out.noalias() = target_orientation_.matrix().transpose() * robot_jacobian.topRows<3>();
 }
 
 /******************************************
@@ -275,8 +364,9 @@ void EqualityPositionConstraint::parseConstraintMsg(const moveit_msgs::msg::Cons
 void EqualityPositionConstraint::function(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
                                           Eigen::Ref<Eigen::VectorXd> out) const
 {
-  Eigen::Vector3d error =
-      target_orientation_.matrix().transpose() * (forwardKinematics(joint_values).translation() - target_position_);
+  const KinematicsCache& cache = updateKinematics(joint_values, false);
+  const Eigen::Vector3d error =
+      target_orientation_.matrix().transpose() * (cache.link_transform.translation() - target_position_);
   for (std::size_t dim = 0; dim < 3; ++dim)
   {
     if (is_dim_constrained_.at(dim))
@@ -293,13 +383,15 @@ void EqualityPositionConstraint::function(const Eigen::Ref<const Eigen::VectorXd
 void EqualityPositionConstraint::jacobian(const Eigen::Ref<const Eigen::VectorXd>& joint_values,
                                           Eigen::Ref<Eigen::MatrixXd> out) const
 {
+  const KinematicsCache& cache = updateKinematics(joint_values, true);
+  const Eigen::Matrix3d rotation = target_orientation_.matrix().transpose();
   out.setZero();
-  Eigen::MatrixXd jac = target_orientation_.matrix().transpose() * robotGeometricJacobian(joint_values).topRows(3);
   for (std::size_t dim = 0; dim < 3; ++dim)
   {
     if (is_dim_constrained_.at(dim))
     {
-      out.row(dim) = jac.row(dim);  // equality constraint dimension
+      // equality constraint dimension
+      out.row(dim).noalias() = rotation.row(dim) * cache.robot_jacobian.topRows<3>();
     }
   }
 }
@@ -316,18 +408,21 @@ void OrientationConstraint::parseConstraintMsg(const moveit_msgs::msg::Constrain
   link_name_ = constraints.orientation_constraints.at(0).link_name;
 }
 
-Eigen::VectorXd OrientationConstraint::calcError(const Eigen::Ref<const Eigen::VectorXd>& x) const
+void OrientationConstraint::computeError(const Eigen::Isometry3d& link_transform,
+                                         Eigen::Ref<Eigen::VectorXd> error) const
 {
-  Eigen::Matrix3d orientation_difference = forwardKinematics(x).linear().transpose() * target_orientation_;
+  Eigen::Matrix3d orientation_difference = link_transform.linear().transpose() * target_orientation_;
   Eigen::AngleAxisd aa(orientation_difference);
-  return aa.axis() * aa.angle();
+  error = aa.axis() * aa.angle();
 }
 
-Eigen::MatrixXd OrientationConstraint::calcErrorJacobian(const Eigen::Ref<const Eigen::VectorXd>& x) const
+void OrientationConstraint::computeErrorJacobian(const Eigen::Isometry3d& link_transform,
+                                                 const Eigen::MatrixXd& robot_jacobian,
+                                                 Eigen::Ref<Eigen::MatrixXd> out) const
 {
-  Eigen::Matrix3d orientation_difference = forwardKinematics(x).linear().transpose() * target_orientation_;
+  Eigen::Matrix3d orientation_difference = link_transform.linear().transpose() * target_orientation_;
   Eigen::AngleAxisd aa{ orientation_difference };
-  return -angularVelocityToAngleAxis(aa.angle(), aa.axis()) * robotGeometricJacobian(x).bottomRows(3);
+  out.noalias() = -angularVelocityToAngleAxis(aa.angle(), aa.axis()) * robot_jacobian.bottomRows<3>();
 }
 
 /************************************
@@ -80,6 +80,19 @@ void ompl_interface::StateValidityChecker::setVerbose(bool flag)
   verbose_ = flag;
 }
 
+bool StateValidityChecker::satisfiesPathConstraints(const moveit::core::RobotState& robot_state, bool verbose) const
+{
+  const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
+  if (!kset)
+    return true;
+  // the verbose evaluation reports each constraint, the compiled one stops at the first violation
+  const kinematic_constraints::CompiledConstraintSetPtr& compiled_kset =
+      planning_context_->getCompiledPathConstraints();
+  if (verbose || !compiled_kset)
+    return kset->decide(robot_state, verbose).satisfied;
+  return compiled_kset->satisfied(robot_state);
+}
+
 bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose) const
 {
   assert(state != nullptr);
@@ -103,8 +116,7 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, bool verbose)
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, state);
 
   // check path constraints
-  const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (!satisfiesPathConstraints(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
@@ -160,7 +172,10 @@ bool StateValidityChecker::isValid(const ompl::base::State* state, double& dist,
   const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
   if (kset)
   {
-    kinematic_constraints::ConstraintEvaluationResult cer = kset->decide(*robot_state, verbose);
+    const kinematic_constraints::CompiledConstraintSetPtr& compiled_kset =
+        planning_context_->getCompiledPathConstraints();
+    kinematic_constraints::ConstraintEvaluationResult cer =
+        verbose || !compiled_kset ? kset->decide(*robot_state, verbose) : compiled_kset->decide(*robot_state);
     if (!cer.satisfied)
     {
       dist = cer.distance;
@@ -243,8 +258,7 @@ bool ConstrainedPlanningStateValidityChecker::isValid(const ompl::base::State* w
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, wrapped_state);
 
   // check path constraints
-  const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (!satisfiesPathConstraints(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
@@ -301,8 +315,7 @@ bool ConstrainedPlanningStateValidityChecker::isValid(const ompl::base::State* w
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, wrapped_state);
 
   // check path constraints
-  const kinematic_constraints::KinematicConstraintSetPtr& kset = planning_context_->getPathConstraints();
-  if (kset && !kset->decide(*robot_state, verbose).satisfied)
+  if (!satisfiesPathConstraints(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
     return false;
@@ -92,6 +92,7 @@ ModelBasedPlanningContext::ModelBasedPlanningContext(const std::string& name,
   , max_goal_samples_(0)
   , max_state_sampling_attempts_(0)
   , max_goal_sampling_attempts_(0)
+  , goal_sampling_threads_(1)
   , max_planning_threads_(0)
   , max_solution_segment_length_(0.0)
   , minimum_waypoint_count_(0)
@@ -99,6 +100,9 @@ ModelBasedPlanningContext::ModelBasedPlanningContext(const std::string& name,
   , simplify_solutions_(true)
   , interpolate_(true)
   , hybridize_(true)
+  , config_applied_(false)
+  , applied_max_solution_segment_length_(0.0)
+  , applied_max_extent_(0.0)
 {
   complete_initial_robot_state_.setToDefaultValues();  // avoid uninitialized memory
   complete_initial_robot_state_.update();
@@ -146,7 +150,19 @@ void ModelBasedPlanningContext::configure(const rclcpp::Node::SharedPtr& node, b
     }
   }
 
-  useConfig();
+  // Applying the configuration allocates a new planner. Skip it if nothing changed, so that the planner and its data
+  // structures are reset by clear() instead of being rebuilt for every request. Planners derive parameters like their
+  // default range from the extent of the state space, which changes with the planning volume.
+  const double max_extent = spec_.state_space_->getMaximumExtent();
+  if (!config_applied_ || applied_config_ != spec_.config_ ||
+      applied_max_solution_segment_length_ != max_solution_segment_length_ || applied_max_extent_ != max_extent)
+  {
+    useConfig();
+    config_applied_ = true;
+    applied_config_ = spec_.config_;
+    applied_max_solution_segment_length_ = max_solution_segment_length_;
+    applied_max_extent_ = max_extent;
+  }
   if (ompl_simple_setup_->getGoal())
     ompl_simple_setup_->setup();
 }
@@ -394,6 +410,11 @@ void ModelBasedPlanningContext::useConfig()
     cfg.erase(it);
   }
 
+  // the number of goal sampling threads is applied when the goal is constructed (see PlanningContextManager)
+  it = cfg.find("goal_sampling_threads");
+  if (it != cfg.end())
+    cfg.erase(it);
+
   // check whether solution paths from parallel planning should be hybridized
   it = cfg.find("hybridize");
   if (it != cfg.end())
@@ -646,6 +667,7 @@ void ModelBasedPlanningContext::clear()
   ompl_simple_setup_->setGoal(ob::GoalPtr());
   ompl_simple_setup_->setStateValidityChecker(ob::StateValidityCheckerPtr());
   path_constraints_.reset();
+  compiled_path_constraints_.reset();
   goal_constraints_.clear();
   getOMPLStateSpace()->setInterpolationFunction(InterpolationFunction());
 }
@@ -656,6 +678,7 @@ bool ModelBasedPlanningContext::setPathConstraints(const moveit_msgs::msg::Const
   // ******************* set the path constraints to use
   path_constraints_ = std::make_shared<kinematic_constraints::KinematicConstraintSet>(getRobotModel());
   path_constraints_->add(path_constraints, getPlanningScene()->getTransforms());
+  compiled_path_constraints_ = std::make_shared<kinematic_constraints::CompiledConstraintSet>(*path_constraints_);
   path_constraints_msg_ = path_constraints;
 
   return true;
@@ -1057,7 +1080,11 @@ bool ModelBasedPlanningContext::loadConstraintApproximations(const rclcpp::Node:
   std::string constraint_path;
   if (node->get_parameter("constraint_approximations_path", constraint_path))
   {
+    // Reading the approximations from disk is expensive, reused contexts keep the ones loaded before
+    if (constraint_path == loaded_constraint_approximations_path_)
+      return true;
     constraints_library_->loadConstraintApproximations(constraint_path);
+    loaded_constraint_approximations_path_ = constraint_path;
     std::stringstream ss;
     constraints_library_->printConstraintApproximations(ss);
     RCLCPP_INFO_STREAM(getLogger(), ss.str());
@@ -63,6 +63,22 @@ OMPLInterface::OMPLInterface(const moveit::core::RobotModelConstPtr& robot_model
   RCLCPP_DEBUG(getLogger(), "Initializing OMPL interface using ROS parameters");
   loadPlannerConfigurations();
   loadConstraintSamplers();
+
+  // optionally create planning contexts up front, so that requests reuse them instead of constructing new ones
+  const std::string warm_contexts_param = parameter_namespace_ + ".warm_planning_contexts";
+  if (node_->has_parameter(warm_contexts_param))
+  {
+    const rclcpp::Parameter parameter = node_->get_parameter(warm_contexts_param);
+    if (parameter.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER)
+    {
+      RCLCPP_WARN(getLogger(), "Ignoring parameter '%s', it must be an integer but is of type '%s'",
+                  warm_contexts_param.c_str(), rclcpp::to_string(parameter.get_type()).c_str());
+    }
+    else if (parameter.as_int() > 0)
+    {
+      context_manager_.warmContextPool(static_cast<unsigned int>(parameter.as_int()));
+    }
+  }
 }
 
 OMPLInterface::OMPLInterface(const moveit::core::RobotModelConstPtr& robot_model,
@@ -123,6 +139,29 @@ void OMPLInterface::loadConstraintSamplers()
   constraint_sampler_manager_loader_ =
       std::make_shared<constraint_sampler_manager_loader::ConstraintSamplerManagerLoader>(node_,
                                                                                           constraint_sampler_manager_);
+
+  // load precomputed reachability maps that guide IK-based goal sampling
+  const std::string reachability_maps_param = parameter_namespace_ + ".reachability_maps";
+  if (node_->has_parameter(reachability_maps_param))
+  {
+    const rclcpp::Parameter parameter = node_->get_parameter(reachability_maps_param);
+    if (parameter.get_type() != rclcpp::ParameterType::PARAMETER_STRING_ARRAY)
+    {
+      RCLCPP_ERROR(getLogger(), "Parameter '%s' must be a list of file names", reachability_maps_param.c_str());
+      return;
+    }
+    for (const std::string& filename : parameter.as_string_array())
+    {
+      constraint_samplers::ReachabilityMapPtr map =
+          constraint_samplers::ReachabilityMap::loadFromFile(robot_model_, filename);
+      if (map)
+      {
+        constraint_sampler_manager_->registerReachabilityMap(map);
+        RCLCPP_INFO(getLogger(), "Loaded reachability map for group '%s' with %zu cells from '%s'",
+                    map->getJointModelGroup()->getName().c_str(), map->getCellCount(), filename.c_str());
+      }
+    }
+  }
 }
 
 bool OMPLInterface::loadPlannerConfiguration(const std::string& group_name, const std::string& planner_id,
@@ -258,6 +258,7 @@ PlanningContextManager::PlanningContextManager(moveit::core::RobotModelConstPtr
   , max_goal_samples_(10)
   , max_state_sampling_attempts_(4)
   , max_goal_sampling_attempts_(1000)
+  , goal_sampling_threads_(1)
   , max_planning_threads_(4)
   , max_solution_segment_length_(0.0)
   , minimum_waypoint_count_(2)
@@ -338,6 +339,33 @@ void PlanningContextManager::setPlannerConfigurations(const planning_interface::
   planner_configs_ = pconfig;
 }
 
+void PlanningContextManager::warmContextPool(unsigned int count) const
+{
+  const ModelBasedStateSpaceFactoryPtr& factory = getStateSpaceFactory(JointModelStateSpace::PARAMETERIZATION_TYPE);
+  if (!factory)
+  {
+    return;
+  }
+
+  const moveit_msgs::msg::MotionPlanRequest req;
+  for (const auto& [name, config] : planner_configs_)
+  {
+    // Hold on to the contexts, otherwise the first one would be handed out again
+    std::vector<ModelBasedPlanningContextPtr> contexts;
+    while (contexts.size() < count)
+    {
+      ModelBasedPlanningContextPtr context = getPlanningContext(config, factory, req);
+      if (!context)
+      {
+        RCLCPP_WARN(getLogger(), "Could not create planning context for configuration '%s'", name.c_str());
+        break;
+      }
+      contexts.push_back(std::move(context));
+    }
+    RCLCPP_DEBUG(getLogger(), "Created %zu planning contexts for configuration '%s'", contexts.size(), name.c_str());
+  }
+}
+
 ModelBasedPlanningContextPtr
 PlanningContextManager::getPlanningContext(const planning_interface::PlannerConfigurationSettings& config,
                                            const ModelBasedStateSpaceFactoryPtr& factory,
@@ -423,6 +451,16 @@ PlanningContextManager::getPlanningContext(const planning_interface::PlannerConf
   context->setMaximumStateSamplingAttempts(max_state_sampling_attempts_);
   context->setMaximumGoalSamplingAttempts(max_goal_sampling_attempts_);
 
+  auto goal_sampling_threads = config.config.find("goal_sampling_threads");
+  if (goal_sampling_threads != config.config.end())
+  {
+    context->setGoalSamplingThreads(std::max(1, boost::lexical_cast<int>(goal_sampling_threads->second)));
+  }
+  else
+  {
+    context->setGoalSamplingThreads(goal_sampling_threads_);
+  }
+
   if (max_solution_segment_length_ > std::numeric_limits<double>::epsilon())
   {
     context->setMaximumSolutionSegmentLength(max_solution_segment_length_);
@@ -0,0 +1,264 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/** Test the construction, augmentation and binary storage of constraint approximations.
+ *
+ * The constraints are a box around the Panda "ready" state in joint space. The box is convex, so every motion between
+ * two sampled milestones satisfies the constraints, and the graph of a database only depends on the milestones, the
+ * edge length and the number of edges per sample. This makes it possible to compare the graph against the order in
+ * which a single thread connects the milestones.
+ **/
+
+#include "load_test_robot.h"
+
+#include <gtest/gtest.h>
+
+#include <moveit/ompl_interface/planning_context_manager.h>
+#include <moveit/ompl_interface/detail/constraints_library.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/kinematic_constraints/utils.h>
+#include <moveit/constraint_samplers/constraint_sampler_manager.h>
+#include <moveit/utils/logger.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <set>
+
+class PandaConstraintsLibrary : public ompl_interface_testing::LoadTestRobot, public testing::Test
+{
+protected:
+  PandaConstraintsLibrary()
+    : LoadTestRobot("panda", "panda_arm"), node_(std::make_shared<rclcpp::Node>("constraints_library_test"))
+  {
+    moveit::setNodeLoggerName(node_->get_name());
+  }
+
+  void SetUp() override
+  {
+    planning_scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    moveit::core::RobotState& ready_state = planning_scene_->getCurrentStateNonConst();
+    ready_state.setToDefaultValues();
+    ready_state.setJointGroupPositions(joint_model_group_, { 0., -0.785, 0., -2.356, 0., 1.571, 0.785 });
+    ready_state.update();
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "1" } };
+    pcm_ = std::make_unique<ompl_interface::PlanningContextManager>(
+        robot_model_, std::make_shared<constraint_samplers::ConstraintSamplerManager>());
+    pcm_->setPlannerConfigurations({ { pconfig_settings.name, pconfig_settings } });
+
+    planning_interface::MotionPlanRequest request;
+    request.group_name = group_name_;
+    moveit::core::robotStateToRobotStateMsg(ready_state, request.start_state);
+    request.goal_constraints.push_back(
+        kinematic_constraints::constructGoalConstraints(ready_state, joint_model_group_));
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+    context_ = pcm_->getPlanningContext(planning_scene_, request, error_code, node_, false);
+    ASSERT_NE(context_, nullptr);
+
+    constraints_ = kinematic_constraints::constructGoalConstraints(ready_state, joint_model_group_, 0.3);
+    constraints_.name = "panda_arm_box";
+
+    options_.state_space_parameterization = context_->getOMPLStateSpace()->getParameterizationType();
+    options_.samples = 40;
+    options_.edges_per_sample = 5;
+    options_.max_edge_length = 0.6;
+    options_.explicit_points_resolution = 0.05;
+    options_.max_explicit_points = 10;
+  }
+
+  static const ompl_interface::ConstraintApproximationStateStorage& getStorage(
+      const ompl_interface::ConstraintApproximationPtr& approx)
+  {
+    return static_cast<const ompl_interface::ConstraintApproximationStateStorage&>(*approx->getStateStorage());
+  }
+
+  static std::vector<std::set<std::size_t>> getEdges(const ompl_interface::ConstraintApproximationPtr& approx)
+  {
+    const ompl_interface::ConstraintApproximationStateStorage& storage = getStorage(approx);
+    std::vector<std::set<std::size_t>> edges(approx->getMilestoneCount());
+    for (std::size_t i = 0; i < edges.size(); ++i)
+    {
+      const std::vector<std::size_t>& neighbors = storage.getMetadata(i).first;
+      edges[i].insert(neighbors.begin(), neighbors.end());
+      EXPECT_EQ(edges[i].size(), neighbors.size()) << "duplicate edges of milestone " << i;
+    }
+    return edges;
+  }
+
+  /** \brief Connect the milestones of \e approx in index order, as a single thread does */
+  std::vector<std::set<std::size_t>> getSequentialEdges(const ompl_interface::ConstraintApproximationPtr& approx) const
+  {
+    const ompl_interface::ConstraintApproximationStateStorage& storage = getStorage(approx);
+    const ompl_interface::ModelBasedStateSpacePtr& space = context_->getOMPLStateSpace();
+    std::vector<std::set<std::size_t>> edges(approx->getMilestoneCount());
+    for (std::size_t j = 0; j < edges.size(); ++j)
+    {
+      for (std::size_t i = j + 1; i < edges.size() && edges[j].size() < options_.edges_per_sample; ++i)
+      {
+        if (edges[i].size() >= options_.edges_per_sample ||
+            space->distance(storage.getState(i), storage.getState(j)) >= options_.max_edge_length)
+          continue;
+        edges[i].insert(j);
+        edges[j].insert(i);
+      }
+    }
+    return edges;
+  }
+
+  void expectMilestonesSatisfyConstraints(const ompl_interface::ConstraintApproximationPtr& approx) const
+  {
+    kinematic_constraints::KinematicConstraintSet kset(robot_model_);
+    kset.add(constraints_, planning_scene_->getTransforms());
+    moveit::core::RobotState state(planning_scene_->getCurrentState());
+    const ompl_interface::ConstraintApproximationStateStorage& storage = getStorage(approx);
+    for (std::size_t i = 0; i < approx->getMilestoneCount(); ++i)
+    {
+      context_->getOMPLStateSpace()->copyToRobotState(state, storage.getState(i));
+      EXPECT_TRUE(kset.decide(state).satisfied) << "milestone " << i;
+    }
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  planning_scene::PlanningScenePtr planning_scene_;
+  std::unique_ptr<ompl_interface::PlanningContextManager> pcm_;
+  ompl_interface::ModelBasedPlanningContextPtr context_;
+  moveit_msgs::msg::Constraints constraints_;
+  ompl_interface::ConstraintApproximationConstructionOptions options_;
+};
+
+TEST_F(PandaConstraintsLibrary, ThreadCountDoesNotChangeGraph)
+{
+  for (unsigned int threads : { 1u, 4u })
+  {
+    SCOPED_TRACE("threads: " + std::to_string(threads));
+    options_.threads = threads;
+    ompl_interface::ConstraintsLibrary library(context_.get());
+    ompl_interface::ConstraintApproximationConstructionResults result =
+        library.addConstraintApproximation(constraints_, group_name_, planning_scene_, options_);
+    ASSERT_TRUE(result.approx);
+    EXPECT_EQ(result.milestones, options_.samples);
+    EXPECT_EQ(result.approx->getMilestoneCount(), options_.samples);
+    expectMilestonesSatisfyConstraints(result.approx);
+
+    // the parallel connection pass produces the same graph as connecting the milestones one by one
+    const std::vector<std::set<std::size_t>> edges = getEdges(result.approx);
+    EXPECT_EQ(edges, getSequentialEdges(result.approx));
+  }
+}
+
+TEST_F(PandaConstraintsLibrary, AugmentKeepsExistingGraph)
+{
+  options_.threads = 2;
+  options_.samples = 30;
+  ompl_interface::ConstraintsLibrary library(context_.get());
+  const ompl_interface::ConstraintApproximationPtr existing =
+      library.addConstraintApproximation(constraints_, group_name_, planning_scene_, options_).approx;
+  ASSERT_TRUE(existing);
+  const std::vector<std::set<std::size_t>> existing_edges = getEdges(existing);
+
+  options_.samples = 20;
+  ompl_interface::ConstraintApproximationConstructionResults result =
+      library.augmentConstraintApproximation(constraints_, group_name_, planning_scene_, options_);
+  ASSERT_TRUE(result.approx);
+  EXPECT_EQ(library.getConstraintApproximation(constraints_), result.approx);
+  ASSERT_EQ(result.approx->getMilestoneCount(), 50u);
+  expectMilestonesSatisfyConstraints(result.approx);
+
+  // the existing milestones come first and keep their edges among each other
+  const ompl_interface::ModelBasedStateSpacePtr& space = context_->getOMPLStateSpace();
+  const std::vector<std::set<std::size_t>> edges = getEdges(result.approx);
+  for (std::size_t i = 0; i < existing->getMilestoneCount(); ++i)
+  {
+    EXPECT_TRUE(space->equalStates(getStorage(existing).getState(i), getStorage(result.approx).getState(i)));
+    std::set<std::size_t> old_neighbors;
+    std::copy_if(edges[i].begin(), edges[i].end(), std::inserter(old_neighbors, old_neighbors.end()),
+                 [&existing](std::size_t n) { return n < existing->getMilestoneCount(); });
+    EXPECT_EQ(old_neighbors, existing_edges[i]) << "milestone " << i;
+  }
+  for (const std::set<std::size_t>& neighbors : edges)
+    EXPECT_LE(neighbors.size(), options_.edges_per_sample);
+}
+
+TEST_F(PandaConstraintsLibrary, BinaryStorageRoundTrip)
+{
+  options_.threads = 2;
+  options_.explicit_motions = true;
+  ompl_interface::ConstraintsLibrary library(context_.get());
+  const ompl_interface::ConstraintApproximationPtr approx =
+      library.addConstraintApproximation(constraints_, group_name_, planning_scene_, options_).approx;
+  ASSERT_TRUE(approx);
+
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "moveit_constraints_library_test";
+  std::filesystem::remove_all(path);
+  library.saveConstraintApproximations(path.string(), true);
+
+  ompl_interface::ConstraintsLibrary loaded_library(context_.get());
+  loaded_library.loadConstraintApproximations(path.string());
+  const ompl_interface::ConstraintApproximationPtr loaded = loaded_library.getConstraintApproximation(constraints_);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->getMilestoneCount(), approx->getMilestoneCount());
+  EXPECT_EQ(loaded->hasExplicitMotions(), approx->hasExplicitMotions());
+
+  const ompl_interface::ConstraintApproximationStateStorage& storage = getStorage(approx);
+  const ompl_interface::ConstraintApproximationStateStorage& loaded_storage = getStorage(loaded);
+  ASSERT_EQ(loaded_storage.size(), storage.size());
+  for (std::size_t i = 0; i < storage.size(); ++i)
+  {
+    EXPECT_TRUE(context_->getOMPLStateSpace()->equalStates(loaded_storage.getState(i), storage.getState(i)));
+    EXPECT_EQ(loaded_storage.getMetadata(i), storage.getMetadata(i)) << "state " << i;
+  }
+
+  // a truncated file is rejected instead of being read past its end
+  const std::filesystem::path storage_file = path / approx->getFilename();
+  std::filesystem::resize_file(storage_file, std::filesystem::file_size(storage_file) / 2);
+  loaded_library.loadConstraintApproximations(path.string());
+  EXPECT_FALSE(loaded_library.getConstraintApproximation(constraints_));
+
+  std::filesystem::remove_all(path);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(argc, argv);
+
+  const int ret = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return ret;
+}
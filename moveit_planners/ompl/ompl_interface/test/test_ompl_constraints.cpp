@@ -46,6 +46,8 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <Eigen/Dense>
@@ -297,6 +299,57 @@ protected:
     EXPECT_NE(jac.row(0).squaredNorm(), 0.0);
   }
 
+  void setOrientationConstraints()
+  {
+    moveit_msgs::msg::OrientationConstraint orientation_constraint;
+    orientation_constraint.header.frame_id = base_link_name_;
+    orientation_constraint.link_name = ee_link_name_;
+    orientation_constraint.orientation.w = 1.0;
+    orientation_constraint.absolute_x_axis_tolerance = 0.1;
+    orientation_constraint.absolute_y_axis_tolerance = 0.1;
+    orientation_constraint.absolute_z_axis_tolerance = 0.1;
+
+    moveit_msgs::msg::Constraints constraint_msgs;
+    constraint_msgs.orientation_constraints.push_back(orientation_constraint);
+
+    constraint_ = std::make_shared<ompl_interface::OrientationConstraint>(robot_model_, group_name_, num_dofs_);
+    constraint_->init(constraint_msgs);
+  }
+
+  void testCachedEvaluation()
+  {
+    SCOPED_TRACE("testCachedEvaluation");
+
+    // the kinematics are cached for the last joint values, so alternate between states and compare the results with
+    // a direct evaluation of the error
+    const Eigen::VectorXd q1 = getRandomState();
+    const Eigen::VectorXd q2 = getRandomState();
+
+    Eigen::VectorXd f1(3), f2(3), f1_again(3);
+    Eigen::MatrixXd jac1(3, num_dofs_), jac2(3, num_dofs_), jac1_again(3, num_dofs_);
+    constraint_->function(q1, f1);
+    constraint_->jacobian(q1, jac1);
+    constraint_->function(q2, f2);
+    constraint_->jacobian(q2, jac2);
+    constraint_->jacobian(q1, jac1_again);
+    constraint_->function(q1, f1_again);
+
+    EXPECT_TRUE(f1.isApprox(f1_again));
+    EXPECT_TRUE(jac1.isApprox(jac1_again));
+
+    // compare with the definition of BaseConstraint::function and BaseConstraint::jacobian
+    const ompl_interface::Bounds bounds =
+        ompl_interface::positionConstraintMsgToBoundVector(createPositionConstraint(base_link_name_, ee_link_name_));
+    const Eigen::VectorXd error = constraint_->calcError(q2);
+    const Eigen::VectorXd derivative = bounds.derivative(error);
+    const Eigen::MatrixXd error_jacobian = constraint_->calcErrorJacobian(q2);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      EXPECT_NEAR((jac2.row(i) - derivative[i] * error_jacobian.row(i)).lpNorm<1>(), 0.0, 1e-12);
+    }
+    EXPECT_NEAR((f2 - bounds.penalty(error)).lpNorm<1>(), 0.0, 1e-12);
+  }
+
 protected:
   std::shared_ptr<ompl_interface::BaseConstraint> constraint_;
 };
@@ -345,6 +398,83 @@ TEST_F(PandaConstraintTest, EqualityPositionConstraints)
   testOMPLProjectedStateSpaceConstruction();
   testEqualityPositionConstraints();
 }
+
+TEST_F(PandaConstraintTest, CachedEvaluation)
+{
+  setPositionConstraints();
+  testCachedEvaluation();
+}
+
+TEST_F(PandaConstraintTest, OrientationConstraintCachedEvaluation)
+{
+  setOrientationConstraints();
+
+  const Eigen::VectorXd q = getRandomState();
+  const Eigen::VectorXd error = constraint_->calcError(q);
+  const Eigen::MatrixXd error_jacobian = constraint_->calcErrorJacobian(q);
+  EXPECT_TRUE(error_jacobian.allFinite());
+
+  // evaluating other joint values in between does not change the result
+  constraint_->calcErrorJacobian(getRandomState());
+  EXPECT_TRUE(error.isApprox(constraint_->calcError(q)));
+  EXPECT_TRUE(error_jacobian.isApprox(constraint_->calcErrorJacobian(q)));
+}
+
+TEST_F(PandaConstraintTest, CachedEvaluationOfManyConstraints)
+{
+  // GIVEN more constraints on different links than a thread keeps kinematics for
+  std::string different_link = joint_model_group_->getLinkModelNames().at(num_dofs_ - DIFFERENT_LINK_OFFSET);
+  const auto create_constraints = [&](std::size_t offset) {
+    std::vector<std::shared_ptr<ompl_interface::BaseConstraint>> constraints;
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+      std::string link_name = (i + offset) % 2 == 0 ? ee_link_name_ : different_link;
+      moveit_msgs::msg::Constraints constraint_msgs;
+      constraint_msgs.position_constraints.push_back(createPositionConstraint(base_link_name_, link_name));
+      constraints.push_back(std::make_shared<ompl_interface::BoxConstraint>(robot_model_, group_name_, num_dofs_));
+      constraints.back()->init(constraint_msgs);
+    }
+    return constraints;
+  };
+  const Eigen::VectorXd q = getRandomState();
+  const Eigen::VectorXd other_q = getRandomState();
+
+  // WHEN they are evaluated alternately, also after constraints were replaced by new ones
+  for (std::size_t offset = 0; offset < 2; ++offset)
+  {
+    const auto constraints = create_constraints(offset);
+    std::vector<Eigen::VectorXd> expected_errors;
+    for (const auto& constraint : constraints)
+    {
+      // A new thread starts without cached kinematics
+      std::thread([&] { expected_errors.push_back(constraint->calcError(q)); }).join();
+    }
+
+    // THEN every constraint evaluates its own link for the given joint values
+    for (std::size_t round = 0; round < 3; ++round)
+    {
+      for (std::size_t i = 0; i < constraints.size(); ++i)
+      {
+        EXPECT_TRUE(constraints[i]->calcError(q).isApprox(expected_errors[i])) << "constraint " << i;
+        constraints[i]->calcErrorJacobian(other_q);
+      }
+    }
+  }
+}
+
+TEST(OMPLConstraints, AngularVelocityToAngleAxisSmallAngles)
+{
+  // at the target orientation the mapping is the identity (and not 0/0)
+  const Eigen::Matrix3d at_zero = ompl_interface::angularVelocityToAngleAxis(0.0, Eigen::Vector3d::UnitZ());
+  EXPECT_TRUE(at_zero.allFinite());
+  EXPECT_TRUE(at_zero.isApprox(Eigen::Matrix3d::Identity()));
+
+  // the small angle approximation connects to the exact expression
+  const Eigen::Vector3d axis = Eigen::Vector3d(1.0, 2.0, 3.0).normalized();
+  EXPECT_TRUE(ompl_interface::angularVelocityToAngleAxis(0.999e-3, axis)
+                  .isApprox(ompl_interface::angularVelocityToAngleAxis(1.001e-3, axis), 1e-5));
+}
+
 /***************************************************************************
  * Run all tests on the Fanuc robot
  * ************************************************************************/
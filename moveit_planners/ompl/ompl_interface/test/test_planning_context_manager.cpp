@@ -56,6 +56,9 @@
 
 #include <tf2_eigen/tf2_eigen.hpp>
 
+#include <chrono>
+#include <thread>
+
 #include <moveit/ompl_interface/planning_context_manager.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/planning_interface/planning_request.h>
@@ -64,6 +67,7 @@
 #include <moveit/constraint_samplers/constraint_sampler_manager.h>
 #include <moveit/ompl_interface/parameterization/joint_space/joint_model_state_space.h>
 #include <moveit/ompl_interface/parameterization/joint_space/constrained_planning_state_space.h>
+#include <moveit/ompl_interface/detail/constrained_goal_sampler.h>
 #include <moveit/utils/logger.hpp>
 
 /** \brief Generic implementation of the tests that can be executed on different robots. **/
@@ -112,6 +116,98 @@ public:
     ASSERT_TRUE(res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
   }
 
+  void testContextReuse(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testContextReuse");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" }, { "type", "geometric::RRTConnect" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+    planning_interface::MotionPlanRequest request = createRequest(start, goal);
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+    pcm.warmContextPool(1);
+
+    auto pc = pcm.getPlanningContext(planning_scene_, request, error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    planning_interface::MotionPlanDetailedResponse res;
+    pc->solve(res);
+    ASSERT_TRUE(res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+    const ompl::base::PlannerPtr planner = pc->getOMPLSimpleSetup()->getPlanner();
+    ASSERT_NE(planner, nullptr);
+    pc.reset();
+
+    // an unchanged configuration should hand out the cached context without rebuilding its planner
+    auto reused_pc = pcm.getPlanningContext(planning_scene_, request, error_code, node_, false);
+    ASSERT_NE(reused_pc, nullptr);
+    EXPECT_EQ(reused_pc->getOMPLSimpleSetup()->getPlanner(), planner);
+
+    planning_interface::MotionPlanDetailedResponse reused_res;
+    reused_pc->solve(reused_res);
+    ASSERT_TRUE(reused_res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+  }
+
+  void testParallelGoalSampling(const std::vector<double>& start, const std::vector<double>& goal)
+  {
+    SCOPED_TRACE("testParallelGoalSampling");
+
+    planning_interface::PlannerConfigurationSettings pconfig_settings;
+    pconfig_settings.group = group_name_;
+    pconfig_settings.name = group_name_;
+    pconfig_settings.config = { { "enforce_joint_model_state_space", "0" },
+                                { "goal_sampling_threads", "4" },
+                                { "type", "geometric::RRTConnect" } };
+
+    planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+    moveit_msgs::msg::MoveItErrorCodes error_code;
+    planning_interface::MotionPlanRequest request = createRequest(start, goal);
+
+    ompl_interface::PlanningContextManager pcm(robot_model_, constraint_sampler_manager_);
+    pcm.setPlannerConfigurations(pconfig_map);
+
+    auto pc = pcm.getPlanningContext(planning_scene_, request, error_code, node_, false);
+    ASSERT_NE(pc, nullptr);
+    EXPECT_EQ(pc->getGoalSamplingThreads(), 4u);
+
+    auto goal_sampler = std::dynamic_pointer_cast<ompl_interface::ConstrainedGoalSampler>(
+        pc->getOMPLSimpleSetup()->getGoal());
+    ASSERT_NE(goal_sampler, nullptr);
+    EXPECT_EQ(goal_sampler->getWorkerCount(), 3u);
+
+    kinematic_constraints::KinematicConstraintSet goal_constraints(robot_model_);
+    goal_constraints.add(request.goal_constraints[0], planning_scene_->getTransforms());
+    moveit::core::RobotState goal_state(robot_model_);
+    goal_state.setToDefaultValues();
+
+    // solve twice, to make sure the goal sampling threads restart with a new request
+    for (int i = 0; i < 2; ++i)
+    {
+      planning_interface::MotionPlanDetailedResponse res;
+      pc->solve(res);
+      ASSERT_TRUE(res.error_code.val == moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+
+      // the workers are stopped together with the sampling thread, so no goals are added after the solve
+      EXPECT_FALSE(goal_sampler->isSampling());
+      const unsigned int goal_count = goal_sampler->getStateCount();
+      EXPECT_GT(goal_count, 0u);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      EXPECT_EQ(goal_sampler->getStateCount(), goal_count);
+
+      // every goal added by any of the threads satisfies the goal constraints
+      for (unsigned int j = 0; j < goal_count; ++j)
+      {
+        pc->getOMPLStateSpace()->copyToRobotState(goal_state, goal_sampler->getState(j));
+        goal_state.update();
+        EXPECT_TRUE(goal_constraints.decide(goal_state).satisfied);
+      }
+    }
+  }
+
   void testPathConstraints(const std::vector<double>& start, const std::vector<double>& goal)
   {
     SCOPED_TRACE("testPathConstraints");
@@ -324,6 +420,16 @@ TEST_F(PandaTestPlanningContext, testSimpleRequest)
   testSimpleRequest({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
 }
 
+TEST_F(PandaTestPlanningContext, testParallelGoalSampling)
+{
+  testParallelGoalSampling({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
+TEST_F(PandaTestPlanningContext, testContextReuse)
+{
+  testContextReuse({ 0., -0.785, 0., -2.356, 0, 1.571, 0.785 }, { 0., -0.785, 0., -2.356, 0, 1.571, 0.685 });
+}
+
 // TODO(seng): This test is temporarily disabled as it is flaky since #1300. Re-enable when #2015 is resolved.
 // TEST_F(PandaTestPlanningContext, testPathConstraints)
 // {
@@ -351,6 +457,69 @@ TEST_F(FanucTestPlanningContext, testPathConstraints)
   testPathConstraints({ 0., 0., 0., 0., 0., 0. }, { 0., 0., 0., 0., 0., 0.1 });
 }
 
+/***************************************************************************
+ * Reuse a planning context for a robot whose state space depends on the workspace
+ * ************************************************************************/
+TEST(PlanarTestPlanningContext, testContextReuseWithChangedWorkspace)
+{
+  // GIVEN a robot with a planar base, whose state space is bounded by the workspace parameters
+  moveit::core::RobotModelBuilder builder("planar_robot", "base_link");
+  builder.addVirtualJoint("world", "base_link", "planar", "base_joint");
+  builder.addGroup({}, { "base_joint" }, "base");
+  const moveit::core::RobotModelPtr robot_model = builder.build();
+  ASSERT_TRUE(builder.isValid());
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("base");
+  const auto planning_scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+  const auto node = std::make_shared<rclcpp::Node>("planning_context_manager_workspace_test");
+
+  planning_interface::PlannerConfigurationSettings pconfig_settings;
+  pconfig_settings.group = "base";
+  pconfig_settings.name = "base";
+  pconfig_settings.config = { { "enforce_joint_model_state_space", "0" }, { "type", "geometric::RRTConnect" } };
+  planning_interface::PlannerConfigurationMap pconfig_map{ { pconfig_settings.name, pconfig_settings } };
+  ompl_interface::PlanningContextManager pcm(robot_model,
+                                             std::make_shared<constraint_samplers::ConstraintSamplerManager>());
+  pcm.setPlannerConfigurations(pconfig_map);
+
+  planning_interface::MotionPlanRequest request;
+  request.group_name = "base";
+  request.allowed_planning_time = 5.0;
+  moveit::core::RobotState goal_state(robot_model);
+  goal_state.setToDefaultValues();
+  goal_state.setJointGroupPositions(jmg, std::vector<double>{ 0.5, 0.0, 0.0 });
+  request.goal_constraints.push_back(kinematic_constraints::constructGoalConstraints(goal_state, jmg, 0.001));
+  const auto set_workspace = [&request](double size) {
+    request.workspace_parameters.min_corner.x = request.workspace_parameters.min_corner.y = -size;
+    request.workspace_parameters.min_corner.z = -size;
+    request.workspace_parameters.max_corner.x = request.workspace_parameters.max_corner.y = size;
+    request.workspace_parameters.max_corner.z = size;
+  };
+  const auto get_range = [](const ompl_interface::ModelBasedPlanningContextPtr& pc) {
+    std::string range;
+    EXPECT_TRUE(pc->getOMPLSimpleSetup()->getPlanner()->params().getParam("range", range));
+    return std::stod(range);
+  };
+
+  // WHEN a context is created for a small workspace
+  moveit_msgs::msg::MoveItErrorCodes error_code;
+  set_workspace(1.0);
+  auto pc = pcm.getPlanningContext(planning_scene, request, error_code, node, false);
+  ASSERT_NE(pc, nullptr);
+  const double small_range = get_range(pc);
+  EXPECT_GT(small_range, 0.0);
+  pc.reset();
+
+  // WHEN the context is reused for a larger workspace
+  // THEN the default range of the planner is derived from the larger state space
+  set_workspace(10.0);
+  pc = pcm.getPlanningContext(planning_scene, request, error_code, node, false);
+  ASSERT_NE(pc, nullptr);
+  EXPECT_GT(get_range(pc), 2.0 * small_range);
+  planning_interface::MotionPlanDetailedResponse res;
+  pc->solve(res);
+  EXPECT_EQ(res.error_code.val, moveit_msgs::msg::MoveItErrorCodes::SUCCESS);
+}
+
 /***************************************************************************
  * MAIN
  * ************************************************************************/
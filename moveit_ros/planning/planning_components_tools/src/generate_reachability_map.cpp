@@ -0,0 +1,146 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Description: Precomputes a reachability map for a planning group, to be used by IK-based constraint samplers */
+
+#include <moveit/constraint_samplers/reachability_map.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <rclcpp/node.hpp>
+#include <rclcpp/utilities.hpp>
+#include <moveit/utils/logger.hpp>
+
+static const std::string ROBOT_DESCRIPTION = "robot_description";
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  auto node = rclcpp::Node::make_shared("generate_reachability_map");
+  moveit::setNodeLoggerName(node->get_name());
+
+  std::string group_name, link_name, output;
+  double resolution = 0.05;
+  std::size_t samples = 1000000;
+  std::size_t max_solutions = 8;
+  unsigned int seed = 0;
+  boost::program_options::options_description desc;
+  desc.add_options()("help", "this screen")("group", boost::program_options::value<std::string>(&group_name),
+                                            "Name of the planning group (required)")(
+      "link", boost::program_options::value<std::string>(&link_name),
+      "Link whose reachability is recorded (defaults to the tip of the group's IK solver)")(
+      "output", boost::program_options::value<std::string>(&output), "File the map is written to (required)")(
+      "resolution", boost::program_options::value<double>(&resolution)->default_value(resolution),
+      "Edge length of a map cell, in meters")(
+      "samples", boost::program_options::value<std::size_t>(&samples)->default_value(samples),
+      "Number of random configurations to sample")(
+      "max-solutions", boost::program_options::value<std::size_t>(&max_solutions)->default_value(max_solutions),
+      "Maximum number of joint solutions stored per cell")(
+      "seed", boost::program_options::value<unsigned int>(&seed), "Seed of the random number generator")(
+      "allow-collisions", "Also store configurations that are in self-collision");
+  boost::program_options::variables_map vm;
+  boost::program_options::parsed_options po =
+      boost::program_options::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+  boost::program_options::store(po, vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("help") || group_name.empty() || output.empty())
+  {
+    std::cout << desc << '\n';
+    rclcpp::shutdown();
+    return vm.count("help") ? 0 : 1;
+  }
+
+  robot_model_loader::RobotModelLoader rml(node, ROBOT_DESCRIPTION);
+  const moveit::core::RobotModelPtr& robot_model = rml.getModel();
+  if (!robot_model || !robot_model->hasJointModelGroup(group_name))
+  {
+    RCLCPP_ERROR(node->get_logger(), "Group '%s' is not known to the robot model", group_name.c_str());
+    rclcpp::shutdown();
+    return 1;
+  }
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup(group_name);
+
+  if (link_name.empty())
+  {
+    if (const kinematics::KinematicsBaseConstPtr solver = jmg->getSolverInstance())
+    {
+      link_name = solver->getTipFrame();
+      if (!link_name.empty() && link_name[0] == '/')
+        link_name.erase(link_name.begin());
+    }
+    else if (!jmg->getLinkModels().empty())
+    {
+      link_name = jmg->getLinkModels().back()->getName();
+    }
+  }
+
+  auto map = std::make_shared<constraint_samplers::ReachabilityMap>(jmg, link_name, resolution, max_solutions);
+  if (!map->getTipLink())
+  {
+    rclcpp::shutdown();
+    return 1;
+  }
+
+  planning_scene::PlanningScene scene(robot_model);
+  moveit::core::GroupStateValidityCallbackFn validity_callback;
+  if (!vm.count("allow-collisions"))
+  {
+    validity_callback = [&scene](moveit::core::RobotState* state, const moveit::core::JointModelGroup* group,
+                                 const double* values) {
+      state->setJointGroupPositions(group, values);
+      state->update();
+      return !scene.isStateColliding(*state, group->getName());
+    };
+  }
+
+  moveit::core::RobotState reference_state(robot_model);
+  reference_state.setToDefaultValues();
+  reference_state.update();
+
+  random_numbers::RandomNumberGenerator rng =
+      vm.count("seed") ? random_numbers::RandomNumberGenerator(seed) : random_numbers::RandomNumberGenerator();
+  RCLCPP_INFO(node->get_logger(), "Sampling %zu configurations of group '%s' for link '%s'", samples,
+              group_name.c_str(), link_name.c_str());
+  const std::size_t inserted = map->generate(reference_state, samples, rng, validity_callback);
+  RCLCPP_INFO(node->get_logger(), "Stored %zu configurations in %zu cells", inserted, map->getCellCount());
+
+  const bool saved = map->saveToFile(output);
+  if (saved)
+    RCLCPP_INFO(node->get_logger(), "Reachability map written to '%s'", output.c_str());
+
+  rclcpp::shutdown();
+  return saved ? 0 : 1;
+}
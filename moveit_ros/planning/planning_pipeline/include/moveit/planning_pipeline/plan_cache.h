@@ -0,0 +1,178 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_interface/planning_request.h>
+#include <moveit/planning_interface/planning_response.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit_planning_pipeline_export.h>
+
+namespace planning_pipeline
+{
+MOVEIT_CLASS_FORWARD(PlanCache);  // Defines PlanCachePtr, ConstPtr, WeakPtr... etc
+
+/** \brief Cache of motion plan solutions, keyed on the planning scene fingerprint, the start state and the query.
+
+    The query consists of the planning group, the goal and path constraints, the planner id and the scaling factors
+    of the request. Start states are compared on the positions of all their variables, quantized to
+    Options::start_state_resolution.
+
+    There are two kinds of lookups:
+     - lookup() returns the cached solution of a query that was solved before from the same start state in a scene
+       with the same fingerprint. The solution is re-validated against the current scene before it is returned,
+       including the motion between waypoints, which also covers bodies attached in the requested start state.
+     - findSeed() returns the cached solution of the same query whose planning group start positions are closest to
+       the requested ones, independent of the scene. It is meant as reference trajectory for planners that can use one.
+
+    Scene fingerprints of scenes containing octomaps are not stable across processes, so entries that were persisted
+    and loaded again only serve as seeds for such scenes. This class is thread safe. */
+class MOVEIT_PLANNING_PIPELINE_EXPORT PlanCache
+{
+public:
+  struct Options
+  {
+    /** \brief Resolution used to quantize the joint positions of start states for exact lookups */
+    double start_state_resolution = 1e-3;
+    /** \brief Maximum joint space distance between the requested and a cached start state for findSeed() */
+    double max_seed_start_distance = 0.5;
+    /** \brief Maximum number of cached solutions, the oldest solutions are evicted first */
+    std::size_t max_size = 1000;
+    /** \brief Maximum displacement of the robot links between the states checked when a cached solution is validated,
+        in meters (see planning_scene::PathValidationOptions::max_link_step) */
+    double validation_link_step = 0.01;
+  };
+
+  /** \brief A cached solution */
+  struct Entry
+  {
+    /** \brief Fingerprint of the query, see getQueryFingerprint() */
+    uint64_t query_fingerprint = 0;
+    /** \brief Fingerprint of the planning scene the solution was computed in */
+    uint64_t scene_fingerprint = 0;
+    /** \brief The solution, its first waypoint is the start state of the query */
+    robot_trajectory::RobotTrajectoryConstPtr trajectory;
+    /** \brief Time it took to compute the solution */
+    double planning_time = 0.0;
+  };
+
+  PlanCache(const moveit::core::RobotModelConstPtr& robot_model, const Options& options);
+  explicit PlanCache(const moveit::core::RobotModelConstPtr& robot_model) : PlanCache(robot_model, Options())
+  {
+  }
+
+  /** \brief Look up a solution for \e req that was computed from the same start state in a scene with the same
+      fingerprint as \e planning_scene. The solution is moved onto the exact start state of \e req and validated
+      against \e planning_scene. Returns true and fills \e res on success. */
+  bool lookup(const planning_scene::PlanningSceneConstPtr& planning_scene,
+              const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res) const;
+
+  /** \brief Find the solution of a query equal to \e req whose start state is closest to the start state of \e req,
+      within Options::max_seed_start_distance. The returned trajectory is not validated. Returns nullptr if there is
+      none. */
+  robot_trajectory::RobotTrajectoryPtr findSeed(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                const planning_interface::MotionPlanRequest& req) const;
+
+  /** \brief Add the successful solution \e res of \e req in \e planning_scene. Returns false if it cannot be cached. */
+  bool insert(const planning_scene::PlanningSceneConstPtr& planning_scene,
+              const planning_interface::MotionPlanRequest& req, const planning_interface::MotionPlanResponse& res);
+
+  /** \brief Add a previously cached \e entry, e.g. one restored from persistent storage. Returns false if it is
+      invalid. */
+  bool insert(const Entry& entry);
+
+  /** \brief Get all cached solutions, from oldest to newest */
+  std::vector<Entry> getEntries() const;
+
+  /** \brief Get the number of cached solutions */
+  std::size_t size() const;
+
+  /** \brief Remove all cached solutions */
+  void clear();
+
+  const moveit::core::RobotModelConstPtr& getRobotModel() const
+  {
+    return robot_model_;
+  }
+
+  const Options& getOptions() const
+  {
+    return options_;
+  }
+
+  /** \brief Compute the fingerprint of the query part of \e req. This is stable across processes. */
+  static uint64_t getQueryFingerprint(const planning_interface::MotionPlanRequest& req);
+
+private:
+  struct StoredEntry
+  {
+    Entry entry;
+    std::vector<double> start_positions;
+    uint64_t start_key;
+  };
+  using StoredEntryPtr = std::shared_ptr<const StoredEntry>;
+
+  /** \brief Compute the full start state of \e req and the positions of its planning group in it. Returns nullptr if
+      the planning group is unknown. */
+  moveit::core::RobotStatePtr getStartState(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                            const planning_interface::MotionPlanRequest& req,
+                                            std::vector<double>& start_positions) const;
+
+  /** \brief Quantize the positions of all variables of \e state and fingerprint the result */
+  uint64_t getStartKey(const moveit::core::RobotState& state) const;
+
+  /** \brief Add \e stored, replacing an entry with the same key and evicting the oldest entries. Requires lock_. */
+  void insertLocked(const StoredEntryPtr& stored);
+
+  /** \brief Remove \e stored from the query index. Requires lock_. */
+  void eraseLocked(const StoredEntryPtr& stored);
+
+  moveit::core::RobotModelConstPtr robot_model_;
+  const Options options_;
+
+  mutable std::mutex lock_;
+  // Cached solutions by query fingerprint
+  std::unordered_map<uint64_t, std::vector<StoredEntryPtr>> entries_;
+  // Cached solutions in insertion order, for eviction
+  std::deque<StoredEntryPtr> insertion_order_;
+};
+}  // namespace planning_pipeline
@@ -44,9 +44,11 @@
 #include <moveit/planning_interface/planning_interface.h>
 #include <moveit/planning_interface/planning_request_adapter.h>
 #include <moveit/planning_interface/planning_response_adapter.h>
+#include <moveit/planning_pipeline/plan_cache.h>
 #include <pluginlib/class_loader.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <moveit_msgs/msg/pipeline_state.hpp>
+#include <statistics_msgs/msg/metrics_message.hpp>
 #include <memory>
 #include <moveit_planning_pipeline_export.h>
 #include <planning_pipeline_parameters.hpp>
@@ -177,7 +179,8 @@ public:
   */
 
   /** \brief Call the chain of planning request adapters, motion planner plugin, and planning response adapters in
-     sequence. \param planning_scene The planning scene where motion planning is to be done \param req The request for
+     sequence. The time spent in each of them is stored in res.stage_timings.
+     \param planning_scene The planning scene where motion planning is to be done \param req The request for
      motion planning \param res The motion planning response \param publish_received_requests Flag indicating whether
      received requests should be published just before beginning processing (useful for debugging)
       */
@@ -236,6 +239,19 @@ public:
     return planner_map_.at(planner_name);
   }
 
+  /** \brief Get the cache of solutions used by generatePlan(), nullptr if caching is disabled */
+  [[nodiscard]] const PlanCachePtr& getPlanCache() const
+  {
+    return plan_cache_;
+  }
+
+  /** \brief Set the cache of solutions used by generatePlan(), e.g. to share it between pipelines or to restore a
+      persisted cache. Pass nullptr to disable caching. Must not be called while generatePlan() is running. */
+  void setPlanCache(const PlanCachePtr& plan_cache)
+  {
+    plan_cache_ = plan_cache;
+  }
+
 private:
   /// \brief Helper function that is called by both constructors to configure and initialize a PlanningPipeline instance
   void configure();
@@ -250,6 +266,25 @@ private:
   void publishPipelineState(moveit_msgs::msg::MotionPlanRequest req, const planning_interface::MotionPlanResponse& res,
                             const std::string& pipeline_stage) const;
 
+  /**
+   * @brief Run the pipeline stages, see generatePlan()
+   *
+   * @param stage_timings Timings of the stages that were run, appended even if a stage fails
+   */
+  bool runPipeline(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                   const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
+                   const bool publish_received_requests,
+                   std::vector<planning_interface::PlanningStageTiming>& stage_timings) const;
+
+  /**
+   * @brief Helper function to publish the time spent in each pipeline stage
+   *
+   * @param stage_timings Timings of the stages
+   * @param start_time Time at which the planning request was received
+   */
+  void publishStageTimings(const std::vector<planning_interface::PlanningStageTiming>& stage_timings,
+                           const rclcpp::Time& start_time) const;
+
   // Flag that indicates whether or not the planning pipeline is currently solving a planning problem
   mutable std::atomic<bool> active_;
 
@@ -273,9 +308,15 @@ private:
   // Robot model
   moveit::core::RobotModelConstPtr robot_model_;
 
+  // Cache of solutions, consulted before the planners are called
+  PlanCachePtr plan_cache_;
+
   /// Publish the planning pipeline progress
   rclcpp::Publisher<moveit_msgs::msg::PipelineState>::SharedPtr progress_publisher_;
 
+  /// Publish the time spent in the planning pipeline stages
+  rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr metrics_publisher_;
+
   rclcpp::Logger logger_;
 };
 
@@ -0,0 +1,318 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/planning_pipeline/plan_cache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <moveit/collision_detection/fingerprint.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/utils/logger.hpp>
+#include <rclcpp/serialization.hpp>
+#include <rclcpp/serialized_message.hpp>
+
+namespace planning_pipeline
+{
+namespace
+{
+rclcpp::Logger getLogger()
+{
+  return moveit::getLogger("moveit.ros.plan_cache");
+}
+
+// Stamps do not change the meaning of a query, clear them so that equal queries yield equal fingerprints
+void clearStamps(moveit_msgs::msg::Constraints& constraints)
+{
+  for (auto& constraint : constraints.position_constraints)
+    constraint.header.stamp = builtin_interfaces::msg::Time();
+  for (auto& constraint : constraints.orientation_constraints)
+    constraint.header.stamp = builtin_interfaces::msg::Time();
+  for (auto& constraint : constraints.visibility_constraints)
+  {
+    constraint.target_pose.header.stamp = builtin_interfaces::msg::Time();
+    constraint.sensor_pose.header.stamp = builtin_interfaces::msg::Time();
+  }
+}
+}  // namespace
+
+PlanCache::PlanCache(const moveit::core::RobotModelConstPtr& robot_model, const Options& options)
+  : robot_model_(robot_model), options_(options)
+{
+}
+
+uint64_t PlanCache::getQueryFingerprint(const planning_interface::MotionPlanRequest& req)
+{
+  // Only the fields that determine the solution are part of the query. Start state, workspace and the reference
+  // trajectory are left out.
+  moveit_msgs::msg::MotionPlanRequest query;
+  query.group_name = req.group_name;
+  query.goal_constraints = req.goal_constraints;
+  query.path_constraints = req.path_constraints;
+  query.planner_id = req.planner_id;
+  query.max_velocity_scaling_factor = req.max_velocity_scaling_factor;
+  query.max_acceleration_scaling_factor = req.max_acceleration_scaling_factor;
+  query.max_cartesian_speed = req.max_cartesian_speed;
+  query.cartesian_speed_limited_link = req.cartesian_speed_limited_link;
+  for (auto& goal_constraints : query.goal_constraints)
+    clearStamps(goal_constraints);
+  clearStamps(query.path_constraints);
+
+  static const rclcpp::Serialization<moveit_msgs::msg::MotionPlanRequest> SERIALIZER;
+  rclcpp::SerializedMessage serialized;
+  SERIALIZER.serialize_message(&query, &serialized);
+  const rcl_serialized_message_t& buffer = serialized.get_rcl_serialized_message();
+  return collision_detection::combineFingerprint(
+      0, std::string(reinterpret_cast<const char*>(buffer.buffer), buffer.buffer_length));
+}
+
+moveit::core::RobotStatePtr PlanCache::getStartState(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                     const planning_interface::MotionPlanRequest& req,
+                                                     std::vector<double>& start_positions) const
+{
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(req.group_name);
+  if (!jmg)
+    return nullptr;
+  moveit::core::RobotStatePtr start_state = planning_scene->getCurrentStateUpdated(req.start_state);
+  start_state->copyJointGroupPositions(jmg, start_positions);
+  return start_state;
+}
+
+uint64_t PlanCache::getStartKey(const moveit::core::RobotState& state) const
+{
+  // The variables outside of the planning group are part of the key, since they change the validity of the solution
+  const std::size_t count = robot_model_->getVariableCount();
+  const double* positions = state.getVariablePositions();
+  uint64_t key = count;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    key = collision_detection::combineFingerprint(
+        key, static_cast<uint64_t>(std::llround(positions[i] / options_.start_state_resolution)));
+  }
+  return key;
+}
+
+bool PlanCache::lookup(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                       const planning_interface::MotionPlanRequest& req,
+                       planning_interface::MotionPlanResponse& res) const
+{
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<double> start_positions;
+  const moveit::core::RobotStatePtr start_state = getStartState(planning_scene, req, start_positions);
+  if (!start_state)
+    return false;
+  const uint64_t query_fingerprint = getQueryFingerprint(req);
+  const uint64_t scene_fingerprint = planning_scene->getFingerprint();
+  const uint64_t start_key = getStartKey(*start_state);
+
+  StoredEntryPtr stored;
+  {
+    std::scoped_lock slock(lock_);
+    const auto it = entries_.find(query_fingerprint);
+    if (it == entries_.end())
+      return false;
+    for (const StoredEntryPtr& candidate : it->second)
+    {
+      if (candidate->entry.scene_fingerprint == scene_fingerprint && candidate->start_key == start_key)
+      {
+        stored = candidate;
+        break;
+      }
+    }
+  }
+  if (!stored)
+    return false;
+
+  // Move the cached solution onto the requested start state. The planning group follows the cached waypoints, all
+  // other variables and the attached bodies are taken from the start state.
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(req.group_name);
+  const robot_trajectory::RobotTrajectory& cached = *stored->entry.trajectory;
+  auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, jmg);
+  trajectory->addSuffixWayPoint(*start_state, 0.0);
+  std::vector<double> positions;
+  for (std::size_t i = 1; i < cached.getWayPointCount(); ++i)
+  {
+    auto waypoint = std::make_shared<moveit::core::RobotState>(*start_state);
+    cached.getWayPoint(i).copyJointGroupPositions(jmg, positions);
+    waypoint->setJointGroupPositions(jmg, positions);
+    waypoint->update();
+    trajectory->addSuffixWayPoint(waypoint, cached.getWayPointDurationFromPrevious(i));
+  }
+
+  // The cached waypoints were only checked by the planner that produced them, and the start state may carry different
+  // attached bodies, so the motion between the waypoints is checked as well
+  planning_scene::PathValidationOptions validation_options;
+  validation_options.max_link_step = options_.validation_link_step;
+  if (!planning_scene->isPathValid(*trajectory, req.path_constraints, req.goal_constraints, validation_options,
+                                   req.group_name))
+  {
+    RCLCPP_DEBUG(getLogger(), "Cached solution for group '%s' is not valid in the current planning scene",
+                 req.group_name.c_str());
+    return false;
+  }
+
+  res.trajectory = trajectory;
+  moveit::core::robotStateToRobotStateMsg(*start_state, res.start_state);
+  res.planner_id = req.planner_id;
+  res.error_code = moveit::core::MoveItErrorCode::SUCCESS;
+  res.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return true;
+}
+
+robot_trajectory::RobotTrajectoryPtr PlanCache::findSeed(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                         const planning_interface::MotionPlanRequest& req) const
+{
+  std::vector<double> start_positions;
+  if (!getStartState(planning_scene, req, start_positions))
+    return nullptr;
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(req.group_name);
+  const uint64_t query_fingerprint = getQueryFingerprint(req);
+
+  StoredEntryPtr nearest;
+  double nearest_distance = std::numeric_limits<double>::infinity();
+  {
+    std::scoped_lock slock(lock_);
+    const auto it = entries_.find(query_fingerprint);
+    if (it == entries_.end())
+      return nullptr;
+    for (const StoredEntryPtr& candidate : it->second)
+    {
+      const double distance = jmg->distance(candidate->start_positions.data(), start_positions.data());
+      if (distance <= options_.max_seed_start_distance && distance < nearest_distance)
+      {
+        nearest = candidate;
+        nearest_distance = distance;
+      }
+    }
+  }
+  if (!nearest)
+    return nullptr;
+  return std::make_shared<robot_trajectory::RobotTrajectory>(*nearest->entry.trajectory, true);
+}
+
+bool PlanCache::insert(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                       const planning_interface::MotionPlanRequest& req,
+                       const planning_interface::MotionPlanResponse& res)
+{
+  if (!res.error_code || !res.trajectory || res.trajectory->empty() || res.trajectory->getGroupName() != req.group_name)
+    return false;
+
+  Entry entry;
+  entry.query_fingerprint = getQueryFingerprint(req);
+  entry.scene_fingerprint = planning_scene->getFingerprint();
+  entry.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(*res.trajectory, true);
+  entry.planning_time = res.planning_time;
+  return insert(entry);
+}
+
+bool PlanCache::insert(const Entry& entry)
+{
+  if (!entry.trajectory || entry.trajectory->empty() || !entry.trajectory->getGroup())
+  {
+    RCLCPP_ERROR(getLogger(), "Cannot cache a solution without waypoints or planning group");
+    return false;
+  }
+
+  auto stored = std::make_shared<StoredEntry>();
+  stored->entry = entry;
+  entry.trajectory->getFirstWayPoint().copyJointGroupPositions(entry.trajectory->getGroup(), stored->start_positions);
+  stored->start_key = getStartKey(entry.trajectory->getFirstWayPoint());
+
+  std::scoped_lock slock(lock_);
+  insertLocked(stored);
+  return true;
+}
+
+void PlanCache::insertLocked(const StoredEntryPtr& stored)
+{
+  std::vector<StoredEntryPtr>& bucket = entries_[stored->entry.query_fingerprint];
+  const auto same_key = std::find_if(bucket.begin(), bucket.end(), [&stored](const StoredEntryPtr& candidate) {
+    return candidate->entry.scene_fingerprint == stored->entry.scene_fingerprint &&
+           candidate->start_key == stored->start_key;
+  });
+  if (same_key != bucket.end())
+  {
+    insertion_order_.erase(std::find(insertion_order_.begin(), insertion_order_.end(), *same_key));
+    *same_key = stored;
+  }
+  else
+  {
+    bucket.push_back(stored);
+  }
+  insertion_order_.push_back(stored);
+
+  while (insertion_order_.size() > std::max<std::size_t>(options_.max_size, 1))
+  {
+    eraseLocked(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+void PlanCache::eraseLocked(const StoredEntryPtr& stored)
+{
+  const auto it = entries_.find(stored->entry.query_fingerprint);
+  if (it == entries_.end())
+    return;
+  std::vector<StoredEntryPtr>& bucket = it->second;
+  bucket.erase(std::remove(bucket.begin(), bucket.end(), stored), bucket.end());
+  if (bucket.empty())
+    entries_.erase(it);
+}
+
+std::vector<PlanCache::Entry> PlanCache::getEntries() const
+{
+  std::scoped_lock slock(lock_);
+  std::vector<Entry> entries;
+  entries.reserve(insertion_order_.size());
+  for (const StoredEntryPtr& stored : insertion_order_)
+    entries.push_back(stored->entry);
+  return entries;
+}
+
+std::size_t PlanCache::size() const
+{
+  std::scoped_lock slock(lock_);
+  return insertion_order_.size();
+}
+
+void PlanCache::clear()
+{
+  std::scoped_lock slock(lock_);
+  entries_.clear();
+  insertion_order_.clear();
+}
+}  // namespace planning_pipeline
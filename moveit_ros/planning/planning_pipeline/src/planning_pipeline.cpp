@@ -37,6 +37,13 @@
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <fmt/format.h>
 #include <moveit/utils/logger.hpp>
+#include <statistics_msgs/msg/statistic_data_type.hpp>
+
+#include <chrono>
+#include <ctime>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace
 {
@@ -77,6 +84,59 @@ getTrajectoryConstraints(const robot_trajectory::RobotTrajectoryPtr& trajectory)
   }
   return trajectory_constraints;
 }
+
+/** @brief Get the CPU time consumed by the calling thread in seconds, 0 if the platform does not provide it */
+double getThreadCpuTime()
+{
+#if defined(_POSIX_THREAD_CPUTIME) && _POSIX_THREAD_CPUTIME >= 0
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0)
+  {
+    return static_cast<double>(time.tv_sec) + 1e-9 * static_cast<double>(time.tv_nsec);
+  }
+#endif
+  return 0.0;
+}
+
+/** @brief Measures the wall and CPU time from construction to destruction and appends it to a list of stage timings,
+ * so that stages which are left early are recorded as well */
+class StageTimer
+{
+public:
+  StageTimer(std::vector<planning_interface::PlanningStageTiming>& stage_timings, std::string stage)
+    : stage_timings_(stage_timings)
+    , stage_(std::move(stage))
+    , wall_start_(std::chrono::steady_clock::now())
+    , cpu_start_(getThreadCpuTime())
+  {
+  }
+
+  ~StageTimer()
+  {
+    planning_interface::PlanningStageTiming timing;
+    timing.stage = std::move(stage_);
+    timing.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start_).count();
+    timing.cpu_time = getThreadCpuTime() - cpu_start_;
+    stage_timings_.push_back(std::move(timing));
+  }
+
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+  std::vector<planning_interface::PlanningStageTiming>& stage_timings_;
+  std::string stage_;
+  const std::chrono::steady_clock::time_point wall_start_;
+  const double cpu_start_;
+};
+
+void appendMetric(std::vector<statistics_msgs::msg::StatisticDataPoint>& statistics, uint8_t data_type, double data)
+{
+  statistics_msgs::msg::StatisticDataPoint point;
+  point.data_type = data_type;
+  point.data = data;
+  statistics.push_back(point);
+}
 }  // namespace
 
 namespace planning_pipeline
@@ -114,6 +174,16 @@ PlanningPipeline::PlanningPipeline(const moveit::core::RobotModelConstPtr& model
 
 void PlanningPipeline::configure()
 {
+  if (pipeline_parameters_.plan_cache.enable)
+  {
+    PlanCache::Options options;
+    options.start_state_resolution = pipeline_parameters_.plan_cache.start_state_resolution;
+    options.max_seed_start_distance = pipeline_parameters_.plan_cache.max_seed_start_distance;
+    options.max_size = static_cast<std::size_t>(pipeline_parameters_.plan_cache.max_size);
+    options.validation_link_step = pipeline_parameters_.plan_cache.validation_link_step;
+    plan_cache_ = std::make_shared<PlanCache>(robot_model_, options);
+  }
+
   // If progress topic parameter is not empty, initialize publisher
   if (!pipeline_parameters_.progress_topic.empty())
   {
@@ -121,6 +191,13 @@ void PlanningPipeline::configure()
                                                                                    rclcpp::SystemDefaultsQoS());
   }
 
+  // If metrics topic parameter is not empty, initialize publisher
+  if (!pipeline_parameters_.metrics_topic.empty())
+  {
+    metrics_publisher_ = node_->create_publisher<statistics_msgs::msg::MetricsMessage>(
+        pipeline_parameters_.metrics_topic, rclcpp::SystemDefaultsQoS());
+  }
+
   // Create planner plugin loader
   try
   {
@@ -248,10 +325,57 @@ void PlanningPipeline::publishPipelineState(moveit_msgs::msg::MotionPlanRequest
   }
 }
 
+void PlanningPipeline::publishStageTimings(const std::vector<planning_interface::PlanningStageTiming>& stage_timings,
+                                           const rclcpp::Time& start_time) const
+{
+  if (!metrics_publisher_)
+  {
+    return;
+  }
+
+  // Every stage is a single sample within the window of the planning request
+  statistics_msgs::msg::MetricsMessage metrics;
+  metrics.measurement_source_name = parameter_namespace_;
+  metrics.unit = "ms";
+  metrics.window_start = start_time;
+  metrics.window_stop = node_->now();
+  for (const auto& timing : stage_timings)
+  {
+    for (const auto& [kind, seconds] : { std::make_pair("wall_time", timing.wall_time),
+                                         std::make_pair("cpu_time", timing.cpu_time) })
+    {
+      metrics.metrics_source = timing.stage + "/" + kind;
+      metrics.statistics.clear();
+      appendMetric(metrics.statistics, statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE,
+                   seconds * 1e3);
+      appendMetric(metrics.statistics, statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_MINIMUM,
+                   seconds * 1e3);
+      appendMetric(metrics.statistics, statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_MAXIMUM,
+                   seconds * 1e3);
+      appendMetric(metrics.statistics, statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT, 1.0);
+      metrics_publisher_->publish(metrics);
+    }
+  }
+}
+
 bool PlanningPipeline::generatePlan(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                     const planning_interface::MotionPlanRequest& req,
                                     planning_interface::MotionPlanResponse& res,
                                     const bool publish_received_requests) const
+{
+  const rclcpp::Time start_time = node_->now();
+  std::vector<planning_interface::PlanningStageTiming> stage_timings;
+  const bool success = runPipeline(planning_scene, req, res, publish_received_requests, stage_timings);
+  // Planners may replace the response, so the timings are attached at the end
+  res.stage_timings = std::move(stage_timings);
+  publishStageTimings(res.stage_timings, start_time);
+  return success;
+}
+
+bool PlanningPipeline::runPipeline(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                   const planning_interface::MotionPlanRequest& req,
+                                   planning_interface::MotionPlanResponse& res, const bool publish_received_requests,
+                                   std::vector<planning_interface::PlanningStageTiming>& stage_timings) const
 {
   assert(!planner_map_.empty());
 
@@ -276,7 +400,11 @@ bool PlanningPipeline::generatePlan(const planning_scene::PlanningSceneConstPtr&
     {
       assert(req_adapter);
       RCLCPP_INFO(node_->get_logger(), "Calling PlanningRequestAdapter '%s'", req_adapter->getDescription().c_str());
-      const auto status = req_adapter->adapt(planning_scene, mutable_request);
+      moveit::core::MoveItErrorCode status;
+      {
+        StageTimer timer(stage_timings, req_adapter->getDescription());
+        status = req_adapter->adapt(planning_scene, mutable_request);
+      }
       res.error_code = status.val;
       // Publish progress
       publishPipelineState(mutable_request, res, req_adapter->getDescription());
@@ -291,44 +419,93 @@ bool PlanningPipeline::generatePlan(const planning_scene::PlanningSceneConstPtr&
       }
     }
 
-    // Call planners
-    for (const auto& planner_name : pipeline_parameters_.planning_plugins)
+    // Reuse a cached solution of the same query if it is still valid, otherwise seed the planners with the cached
+    // solution from the nearest start state, if they accept trajectory constraints
+    bool cache_hit = false;
+    if (plan_cache_)
+    {
+      StageTimer timer(stage_timings, "PlanCache");
+      cache_hit = plan_cache_->lookup(planning_scene, mutable_request, res);
+    }
+    if (cache_hit)
+    {
+      RCLCPP_INFO(node_->get_logger(), "Reusing cached solution");
+      publishPipelineState(mutable_request, res, "PlanCache");
+    }
+    std::vector<moveit_msgs::msg::Constraints> seed_constraints;
+    if (!cache_hit && plan_cache_ && plan_cache_->getOptions().max_seed_start_distance > 0.0 &&
+        mutable_request.trajectory_constraints.constraints.empty())
     {
-      const auto& planner = planner_map_.at(planner_name);
-      // Update reference trajectory with latest solution (if available)
-      if (res.trajectory)
+      if (const auto seed = plan_cache_->findSeed(planning_scene, mutable_request))
       {
-        mutable_request.trajectory_constraints.constraints = getTrajectoryConstraints(res.trajectory);
+        seed_constraints = getTrajectoryConstraints(seed);
       }
+    }
 
-      // Try creating a planning context
-      planning_interface::PlanningContextPtr context =
-          planner->getPlanningContext(planning_scene, mutable_request, res.error_code);
-      if (!context)
+    // Call planners
+    if (!cache_hit)
+    {
+      for (const auto& planner_name : pipeline_parameters_.planning_plugins)
       {
-        RCLCPP_ERROR(node_->get_logger(),
-                     "Failed to create PlanningContext for planner '%s'. Aborting planning pipeline.",
-                     planner->getDescription().c_str());
-        res.error_code = moveit::core::MoveItErrorCode::PLANNING_FAILED;
-        active_ = false;
-        return false;
-      }
+        const auto& planner = planner_map_.at(planner_name);
+        // Update reference trajectory with latest solution (if available)
+        if (res.trajectory)
+        {
+          mutable_request.trajectory_constraints.constraints = getTrajectoryConstraints(res.trajectory);
+        }
+        // Otherwise seed the planner with the cached solution, unless it does not accept trajectory constraints
+        else if (!seed_constraints.empty())
+        {
+          mutable_request.trajectory_constraints.constraints = seed_constraints;
+          if (!planner->canServiceRequest(mutable_request))
+          {
+            RCLCPP_DEBUG(node_->get_logger(), "Planner '%s' cannot use the cached solution as seed",
+                         planner->getDescription().c_str());
+            mutable_request.trajectory_constraints.constraints.clear();
+          }
+        }
+
+        planning_interface::PlanningContextPtr context;
+        {
+          StageTimer timer(stage_timings, planner->getDescription());
+          // Try creating a planning context
+          context = planner->getPlanningContext(planning_scene, mutable_request, res.error_code);
+          if (context)
+          {
+            // Run planner
+            RCLCPP_INFO(node_->get_logger(), "Calling Planner '%s'", planner->getDescription().c_str());
+            context->solve(res);
+          }
+        }
+        if (!context)
+        {
+          RCLCPP_ERROR(node_->get_logger(),
+                       "Failed to create PlanningContext for planner '%s'. Aborting planning pipeline.",
+                       planner->getDescription().c_str());
+          res.error_code = moveit::core::MoveItErrorCode::PLANNING_FAILED;
+          active_ = false;
+          return false;
+        }
 
-      // Run planner
-      RCLCPP_INFO(node_->get_logger(), "Calling Planner '%s'", planner->getDescription().c_str());
-      context->solve(res);
-      publishPipelineState(mutable_request, res, planner->getDescription());
+        publishPipelineState(mutable_request, res, planner->getDescription());
 
-      // If planner does not succeed, break chain and return false
-      if (!res.error_code)
-      {
-        RCLCPP_ERROR(node_->get_logger(), "Planner '%s' failed with error code %s", planner->getDescription().c_str(),
-                     errorCodeToString(res.error_code).c_str());
-        active_ = false;
-        return false;
+        // If planner does not succeed, break chain and return false
+        if (!res.error_code)
+        {
+          RCLCPP_ERROR(node_->get_logger(), "Planner '%s' failed with error code %s", planner->getDescription().c_str(),
+                       errorCodeToString(res.error_code).c_str());
+          active_ = false;
+          return false;
+        }
       }
     }
 
+    // Cache the planner solution, the response adapters are applied to cached solutions again when they are reused
+    if (plan_cache_ && !cache_hit && res.error_code)
+    {
+      plan_cache_->insert(planning_scene, mutable_request, res);
+    }
+
     // Call plan response adapter chain
     if (res.error_code)
     {
@@ -337,7 +514,10 @@ bool PlanningPipeline::generatePlan(const planning_scene::PlanningSceneConstPtr&
       {
         assert(res_adapter);
         RCLCPP_INFO(node_->get_logger(), "Calling PlanningResponseAdapter '%s'", res_adapter->getDescription().c_str());
-        res_adapter->adapt(planning_scene, mutable_request, res);
+        {
+          StageTimer timer(stage_timings, res_adapter->getDescription());
+          res_adapter->adapt(planning_scene, mutable_request, res);
+        }
         publishPipelineState(mutable_request, res, res_adapter->getDescription());
         // If adapter does not succeed, break chain and return false
         if (!res.error_code)
@@ -35,6 +35,8 @@
 /* Author: Sebastian Jahr */
 
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <moveit/planning_interface/planning_interface.h>
 #include <moveit/planning_interface/planning_request_adapter.h>
 #include <moveit/planning_interface/planning_response_adapter.h>
@@ -127,9 +129,100 @@ public:
     return std::string("DummyPlannerManager");
   }
 };
+
+/// @brief A dummy planning context that plans until it is terminated
+class TerminablePlanningContext : public planning_interface::PlanningContext
+{
+public:
+  TerminablePlanningContext() : planning_interface::PlanningContext("TerminablePlanningContext", "empty_group")
+  {
+  }
+  void solve(planning_interface::MotionPlanResponse& res) override
+  {
+    res.error_code.val = waitForTermination() ? moveit_msgs::msg::MoveItErrorCodes::PREEMPTED :
+                                                moveit_msgs::msg::MoveItErrorCodes::TIMED_OUT;
+  }
+  void solve(planning_interface::MotionPlanDetailedResponse& res) override
+  {
+    res.error_code.val = waitForTermination() ? moveit_msgs::msg::MoveItErrorCodes::PREEMPTED :
+                                                moveit_msgs::msg::MoveItErrorCodes::TIMED_OUT;
+  }
+  bool terminate() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      terminated_ = true;
+    }
+    terminated_cv_.notify_all();
+    return true;
+  }
+  void clear() override{};
+
+private:
+  /// @brief Returns true if the context was terminated before the timeout
+  bool waitForTermination()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return terminated_cv_.wait_for(lock, std::chrono::seconds(30), [this] { return terminated_; });
+  }
+
+  std::mutex mutex_;
+  std::condition_variable terminated_cv_;
+  bool terminated_ = false;
+};
+
+/// @brief A dummy planning manager whose planners only stop when they are terminated
+class TerminablePlannerManager : public planning_interface::PlannerManager
+{
+public:
+  planning_interface::PlanningContextPtr
+  getPlanningContext(const planning_scene::PlanningSceneConstPtr& /*planning_scene*/,
+                     const planning_interface::MotionPlanRequest& /*req*/,
+                     moveit_msgs::msg::MoveItErrorCodes& /*error_code*/) const override
+  {
+    return std::make_shared<TerminablePlanningContext>();
+  }
+  bool canServiceRequest(const planning_interface::MotionPlanRequest& /*req*/) const override
+  {
+    return true;
+  }
+  std::string getDescription() const override
+  {
+    return std::string("TerminablePlannerManager");
+  }
+};
+
+/// @brief A dummy planning manager that rejects requests with trajectory constraints, like the Pilz planners
+class NoTrajectoryConstraintsPlannerManager : public planning_interface::PlannerManager
+{
+public:
+  planning_interface::PlanningContextPtr
+  getPlanningContext(const planning_scene::PlanningSceneConstPtr& /*planning_scene*/,
+                     const planning_interface::MotionPlanRequest& req,
+                     moveit_msgs::msg::MoveItErrorCodes& error_code) const override
+  {
+    if (!canServiceRequest(req))
+    {
+      error_code.val = moveit_msgs::msg::MoveItErrorCodes::INVALID_MOTION_PLAN;
+      return nullptr;
+    }
+    return std::make_shared<DummyPlanningContext>();
+  }
+  bool canServiceRequest(const planning_interface::MotionPlanRequest& req) const override
+  {
+    return req.trajectory_constraints.constraints.empty();
+  }
+  std::string getDescription() const override
+  {
+    return std::string("NoTrajectoryConstraintsPlannerManager");
+  }
+};
 }  // namespace planning_pipeline_test
 
 CLASS_LOADER_REGISTER_CLASS(planning_pipeline_test::DummyPlannerManager, planning_interface::PlannerManager)
+CLASS_LOADER_REGISTER_CLASS(planning_pipeline_test::TerminablePlannerManager, planning_interface::PlannerManager)
+CLASS_LOADER_REGISTER_CLASS(planning_pipeline_test::NoTrajectoryConstraintsPlannerManager,
+                            planning_interface::PlannerManager)
 CLASS_LOADER_REGISTER_CLASS(planning_pipeline_test::AlwaysSuccessRequestAdapter,
                             planning_interface::PlanningRequestAdapter)
 CLASS_LOADER_REGISTER_CLASS(planning_pipeline_test::AlwaysSuccessResponseAdapter,
@@ -36,6 +36,7 @@
 
 #include <gtest/gtest.h>
 
+#include <moveit/planning_pipeline/plan_cache.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
@@ -95,6 +96,18 @@ TEST_F(TestPlanningPipeline, HappyPath)
   const auto planning_scene_ptr = std::make_shared<planning_scene::PlanningScene>(robot_model_);
   EXPECT_TRUE(pipeline_ptr_->generatePlan(planning_scene_ptr, motion_plan_request, motion_plan_response));
   EXPECT_TRUE(motion_plan_response.error_code);
+  // THEN the time spent in every adapter and planner is reported in the order they were called
+  const auto& stage_timings = motion_plan_response.stage_timings;
+  ASSERT_EQ(stage_timings.size(), REQUEST_ADAPTERS.size() + PLANNER_PLUGINS.size() + RESPONSE_ADAPTERS.size());
+  EXPECT_EQ(stage_timings.front().stage, "AlwaysSuccessRequestAdapter");
+  EXPECT_EQ(stage_timings.at(REQUEST_ADAPTERS.size()).stage, "DummyPlannerManager");
+  EXPECT_EQ(stage_timings.back().stage, "AlwaysSuccessResponseAdapter");
+  for (const auto& timing : stage_timings)
+  {
+    // All test plugins sleep for at least 100ms
+    EXPECT_GE(timing.wall_time, 0.1) << timing.stage;
+    EXPECT_GE(timing.cpu_time, 0.0) << timing.stage;
+  }
 }
 
 TEST_F(TestPlanningPipeline, NoPlannerPluginConfigured)
@@ -115,6 +128,175 @@ TEST_F(TestPlanningPipeline, NoPlannerPluginConfigured)
                std::runtime_error);
 }
 
+TEST_F(TestPlanningPipeline, SeedIsOnlyPassedToPlannersThatAcceptIt)
+{
+  // GIVEN a pipeline with a planner that rejects trajectory constraints
+  moveit::core::RobotModelBuilder builder("chain_robot", "base_link");
+  builder.addChain("base_link->a->b", "continuous");
+  builder.addGroupChain("base_link", "b", "arm");
+  robot_model_ = builder.build();
+  const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("arm");
+  const auto planning_scene_ptr = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+  const std::vector<std::string> planner_plugins{ "planning_pipeline_test/NoTrajectoryConstraintsPlannerManager" };
+  pipeline_ptr_ = std::make_shared<planning_pipeline::PlanningPipeline>(robot_model_, node_, "", planner_plugins,
+                                                                        REQUEST_ADAPTERS, RESPONSE_ADAPTERS);
+  pipeline_ptr_->setPlanCache(std::make_shared<planning_pipeline::PlanCache>(robot_model_));
+
+  // GIVEN a cached solution of the same query from a nearby start state
+  planning_interface::MotionPlanRequest motion_plan_request;
+  motion_plan_request.group_name = "arm";
+  moveit_msgs::msg::JointConstraint goal;
+  goal.joint_name = "a-b-joint";
+  goal.position = 1.0;
+  goal.tolerance_above = goal.tolerance_below = 0.01;
+  goal.weight = 1.0;
+  motion_plan_request.goal_constraints.resize(1);
+  motion_plan_request.goal_constraints[0].joint_constraints.push_back(goal);
+
+  moveit::core::RobotState state = planning_scene_ptr->getCurrentState();
+  state.setJointGroupPositions(jmg, std::vector<double>{ 0.1, 0.0 });
+  planning_interface::MotionPlanResponse cached_response;
+  cached_response.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, jmg);
+  cached_response.trajectory->addSuffixWayPoint(state, 0.0);
+  state.setJointGroupPositions(jmg, std::vector<double>{ 0.1, 1.0 });
+  cached_response.trajectory->addSuffixWayPoint(state, 1.0);
+  cached_response.error_code = moveit::core::MoveItErrorCode::SUCCESS;
+  ASSERT_TRUE(pipeline_ptr_->getPlanCache()->insert(planning_scene_ptr, motion_plan_request, cached_response));
+  ASSERT_NE(pipeline_ptr_->getPlanCache()->findSeed(planning_scene_ptr, motion_plan_request), nullptr);
+
+  // WHEN generatePlan is called from the default start state
+  // THEN the planner is called without the seed and succeeds
+  planning_interface::MotionPlanResponse motion_plan_response;
+  EXPECT_TRUE(pipeline_ptr_->generatePlan(planning_scene_ptr, motion_plan_request, motion_plan_response));
+  EXPECT_TRUE(motion_plan_response.error_code);
+}
+
+TEST(PlanCache, LookupAndSeed)
+{
+  // GIVEN a robot with a planning group of two joints and a cache with a solution from the default state
+  moveit::core::RobotModelBuilder builder("chain_robot", "base_link");
+  builder.addChain("base_link->a->b", "continuous");
+  builder.addChain("base_link->c", "continuous");
+  builder.addGroupChain("base_link", "b", "arm");
+  const moveit::core::RobotModelPtr robot_model = builder.build();
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("arm");
+  auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+  planning_pipeline::PlanCache::Options options;
+  options.max_seed_start_distance = 0.2;
+  planning_pipeline::PlanCache cache(robot_model, options);
+
+  planning_interface::MotionPlanRequest request;
+  request.group_name = "arm";
+  moveit_msgs::msg::JointConstraint goal;
+  goal.joint_name = "a-b-joint";
+  goal.position = 1.0;
+  goal.tolerance_above = goal.tolerance_below = 0.01;
+  goal.weight = 1.0;
+  request.goal_constraints.resize(1);
+  request.goal_constraints[0].joint_constraints.push_back(goal);
+
+  moveit::core::RobotState state = scene->getCurrentState();
+  planning_interface::MotionPlanResponse response;
+  response.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, jmg);
+  response.trajectory->addSuffixWayPoint(state, 0.0);
+  state.setJointGroupPositions(jmg, std::vector<double>{ 0.0, 1.0 });
+  response.trajectory->addSuffixWayPoint(state, 1.0);
+  response.error_code = moveit::core::MoveItErrorCode::SUCCESS;
+  ASSERT_TRUE(cache.insert(scene, request, response));
+  EXPECT_EQ(cache.size(), 1u);
+
+  // WHEN the same query is looked up in the same scene
+  // THEN the cached solution is returned
+  planning_interface::MotionPlanResponse cached_response;
+  ASSERT_TRUE(cache.lookup(scene, request, cached_response));
+  EXPECT_TRUE(cached_response.error_code);
+  EXPECT_EQ(cached_response.trajectory->getWayPointCount(), 2u);
+
+  // WHEN the start state differs by less than the resolution
+  // THEN the solution starts at the requested start state
+  request.start_state.joint_state.name = { "base_link-a-joint", "a-b-joint" };
+  request.start_state.joint_state.position = { 0.0002, 0.0 };
+  ASSERT_TRUE(cache.lookup(scene, request, cached_response));
+  EXPECT_DOUBLE_EQ(cached_response.trajectory->getFirstWayPoint().getVariablePosition("base_link-a-joint"), 0.0002);
+
+  // WHEN a joint outside of the planning group differs
+  // THEN there is no exact match, but the cached solution is returned as seed
+  request.start_state.joint_state.name = { "base_link-c-joint" };
+  request.start_state.joint_state.position = { 0.5 };
+  EXPECT_FALSE(cache.lookup(scene, request, cached_response));
+  EXPECT_NE(cache.findSeed(scene, request), nullptr);
+
+  // WHEN the start state differs by more than the resolution
+  request.start_state.joint_state.name = { "base_link-a-joint", "a-b-joint" };
+  // THEN there is no exact match, but the cached solution is returned as seed
+  request.start_state.joint_state.position = { 0.1, 0.0 };
+  EXPECT_FALSE(cache.lookup(scene, request, cached_response));
+  EXPECT_NE(cache.findSeed(scene, request), nullptr);
+
+  // WHEN the planning scene changes
+  // THEN there is no exact match, but the cached solution is returned as seed
+  request.start_state = moveit_msgs::msg::RobotState();
+  scene->getWorldNonConst()->addToObject("box", std::make_shared<shapes::Box>(0.1, 0.1, 0.1),
+                                         Eigen::Isometry3d::Identity());
+  EXPECT_FALSE(cache.lookup(scene, request, cached_response));
+  EXPECT_NE(cache.findSeed(scene, request), nullptr);
+
+  // WHEN the goal differs
+  // THEN nothing is returned
+  request.goal_constraints[0].joint_constraints[0].position = 2.0;
+  EXPECT_EQ(cache.findSeed(scene, request), nullptr);
+
+  // WHEN the cache is cleared
+  // THEN it is empty
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(PlanCache, LookupValidatesMotionBetweenWaypoints)
+{
+  // GIVEN a link that swings on a circle around the x axis, and an obstacle on that circle
+  moveit::core::RobotModelBuilder builder("swing_robot", "base_link");
+  builder.addChain("base_link->a", "continuous");
+  geometry_msgs::msg::Pose box_origin;
+  box_origin.position.y = 1.0;
+  box_origin.orientation.w = 1.0;
+  builder.addCollisionBox("a", { 0.1, 0.1, 0.1 }, box_origin);
+  builder.addGroupChain("base_link", "a", "arm");
+  const moveit::core::RobotModelPtr robot_model = builder.build();
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("arm");
+  auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+  Eigen::Isometry3d obstacle_pose = Eigen::Isometry3d::Identity();
+  obstacle_pose.translation().z() = 1.0;
+  scene->getWorldNonConst()->addToObject("obstacle", std::make_shared<shapes::Box>(0.1, 0.1, 0.1), obstacle_pose);
+  planning_pipeline::PlanCache cache(robot_model);
+
+  // GIVEN a cached solution in that scene whose waypoints lie on either side of the obstacle
+  planning_interface::MotionPlanRequest request;
+  request.group_name = "arm";
+  moveit_msgs::msg::JointConstraint goal;
+  goal.joint_name = "base_link-a-joint";
+  goal.position = 3.0;
+  goal.tolerance_above = goal.tolerance_below = 0.01;
+  goal.weight = 1.0;
+  request.goal_constraints.resize(1);
+  request.goal_constraints[0].joint_constraints.push_back(goal);
+
+  moveit::core::RobotState state = scene->getCurrentState();
+  planning_interface::MotionPlanResponse response;
+  response.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, jmg);
+  response.trajectory->addSuffixWayPoint(state, 0.0);
+  state.setJointGroupPositions(jmg, std::vector<double>{ 3.0 });
+  response.trajectory->addSuffixWayPoint(state, 1.0);
+  response.error_code = moveit::core::MoveItErrorCode::SUCCESS;
+  ASSERT_TRUE(cache.insert(scene, request, response));
+  ASSERT_TRUE(scene->isPathValid(*response.trajectory, "arm"));
+
+  // WHEN the query is looked up in the same scene
+  // THEN the solution is rejected, since the link passes through the obstacle between the waypoints
+  planning_interface::MotionPlanResponse cached_response;
+  EXPECT_FALSE(cache.lookup(scene, request, cached_response));
+}
+
 int main(int argc, char** argv)
 {
   rclcpp::init(argc, argv);
@@ -37,6 +37,10 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 #include <moveit/planning_interface/planning_response.h>
 #include <moveit/planning_interface/planning_request.h>
 
@@ -61,14 +65,25 @@ public:
    */
   void pushBack(const ::planning_interface::MotionPlanResponse& plan_solution);
 
-  /** \brief Get solutions
-   * \return Read-only access to the responses vector
+  /** \brief Thread safe method to get the solutions added so far
+   * \return Copy of the responses vector, in the order the responses were added
+   */
+  std::vector<::planning_interface::MotionPlanResponse> getSolutions() const;
+
+  /** \brief Get the number of solutions added so far */
+  size_t size() const;
+
+  /** \brief Block until the container holds more than \e count solutions. Allows consumers to process responses as
+   * they arrive instead of waiting for all of them
+   * \param [in] count Number of solutions the caller already knows about
+   * \return Number of solutions in the container
    */
-  const std::vector<::planning_interface::MotionPlanResponse>& getSolutions() const;
+  size_t waitForSolutions(const size_t count) const;
 
 private:
   std::vector<::planning_interface::MotionPlanResponse> solutions_;
-  std::mutex solutions_mutex_;
+  mutable std::mutex solutions_mutex_;
+  mutable std::condition_variable solutions_cv_;
 };
 }  // namespace planning_pipeline_interfaces
 }  // namespace moveit
@@ -82,8 +82,9 @@ typedef std::function<::planning_interface::MotionPlanResponse(
  * \param [in] planning_pipelines Pipelines available to solve the problems, if a requested pipeline is not provided the
  MotionPlanResponse will be FAILURE
  * \param [in] stopping_criterion_callback If this function returns true, the planning pipelines that are still running
- will be terminated and the existing solutions will be evaluated. If no callback is provided, all planning pipelines
- terminate after the max. planning time defined in the MotionPlanningRequest is reached.
+ will be terminated. This function returns once the terminated pipelines have stopped, their responses are included in
+ the evaluated solutions. If no callback is provided, all planning pipelines terminate after the max. planning time
+ defined in the MotionPlanningRequest is reached.
  * \param [in] solution_selection_function Function to select a specific solution out of all available solution. If no
  function is provided, all solutions are returned.
  + \return If a solution_selection_function is provided a vector containing the selected response is returned, otherwise
@@ -0,0 +1,111 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc: A persistent, work-stealing pool of threads to run planning pipelines */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace moveit
+{
+namespace planning_pipeline_interfaces
+{
+/** \brief A pool of threads that is kept alive across planning requests, so that parallel planning does not pay for
+ * creating threads.
+ *
+ * Every worker has its own task queue. Tasks submitted by a worker go to its own queue, other tasks are distributed
+ * round-robin. Idle workers steal tasks from the other queues. Planning tasks block for a long time, so the pool
+ * starts another worker whenever a task is submitted and no worker is idle, up to \e max_threads. Workers are never
+ * shut down before the pool is destroyed.
+ */
+class PlanningThreadPool
+{
+public:
+  /** \brief Constructor
+   * \param [in] max_threads Maximum number of worker threads, at least one worker is allowed
+   */
+  explicit PlanningThreadPool(std::size_t max_threads);
+
+  /** \brief Destructor, waits for all submitted tasks to finish */
+  ~PlanningThreadPool();
+
+  PlanningThreadPool(const PlanningThreadPool&) = delete;
+  PlanningThreadPool& operator=(const PlanningThreadPool&) = delete;
+
+  /** \brief Run \e task on one of the workers. Tasks must not throw. This function is thread safe. */
+  void submit(std::function<void()> task);
+
+  /** \brief Get the number of worker threads that have been started */
+  std::size_t getThreadCount() const;
+
+  /** \brief Get the pool shared by all parallel planning requests of this process. It is never destroyed, so its
+   * workers are not joined during static destruction. */
+  static PlanningThreadPool& getSharedPool();
+
+private:
+  struct TaskQueue
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /** \brief Start another worker. Requires state_mutex_. */
+  void startWorker();
+
+  void workerLoop(std::size_t index);
+
+  /** \brief Take a task from the back of the own queue, or steal one from the front of another queue */
+  bool popTask(std::size_t index, std::function<void()>& task);
+
+  // One queue per possible worker, allocated up front so that workers can be added without synchronizing access
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Protects the members below and workers_
+  mutable std::mutex state_mutex_;
+  std::condition_variable work_cv_;
+  std::size_t pending_tasks_ = 0;
+  std::size_t idle_workers_ = 0;
+  std::size_t next_queue_ = 0;
+  bool stop_ = false;
+};
+}  // namespace planning_pipeline_interfaces
+}  // namespace moveit
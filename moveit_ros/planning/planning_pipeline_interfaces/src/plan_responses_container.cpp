@@ -48,13 +48,30 @@ PlanResponsesContainer::PlanResponsesContainer(const size_t expected_size)
 
 void PlanResponsesContainer::pushBack(const ::planning_interface::MotionPlanResponse& plan_solution)
 {
-  std::lock_guard<std::mutex> lock_guard(solutions_mutex_);
-  solutions_.push_back(plan_solution);
+  {
+    std::lock_guard<std::mutex> lock_guard(solutions_mutex_);
+    solutions_.push_back(plan_solution);
+  }
+  solutions_cv_.notify_all();
 }
 
-const std::vector<::planning_interface::MotionPlanResponse>& PlanResponsesContainer::getSolutions() const
+std::vector<::planning_interface::MotionPlanResponse> PlanResponsesContainer::getSolutions() const
 {
+  std::lock_guard<std::mutex> lock_guard(solutions_mutex_);
   return solutions_;
 }
+
+size_t PlanResponsesContainer::size() const
+{
+  std::lock_guard<std::mutex> lock_guard(solutions_mutex_);
+  return solutions_.size();
+}
+
+size_t PlanResponsesContainer::waitForSolutions(const size_t count) const
+{
+  std::unique_lock<std::mutex> lock(solutions_mutex_);
+  solutions_cv_.wait(lock, [this, count] { return solutions_.size() > count; });
+  return solutions_.size();
+}
 }  // namespace planning_pipeline_interfaces
 }  // namespace moveit
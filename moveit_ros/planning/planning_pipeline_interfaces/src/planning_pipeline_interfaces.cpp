@@ -35,8 +35,10 @@
 /* Author: Sebastian Jahr */
 
 #include <moveit/planning_pipeline_interfaces/planning_pipeline_interfaces.hpp>
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
 #include <moveit/utils/logger.hpp>
 
+#include <atomic>
 #include <thread>
 
 namespace moveit
@@ -83,10 +85,22 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
     const StoppingCriterionFunction& stopping_criterion_callback,
     const SolutionSelectionFunction& solution_selection_function)
 {
-  // Create solutions container
-  PlanResponsesContainer plan_responses_container{ motion_plan_requests.size() };
-  std::vector<std::thread> planning_threads;
-  planning_threads.reserve(motion_plan_requests.size());
+  // Everything the planning tasks use is owned by this state, so that the tasks never refer to the arguments of this
+  // function, even if it is left by an exception of the stopping criterion
+  struct ParallelPlanningState
+  {
+    ParallelPlanningState(const std::vector<::planning_interface::MotionPlanRequest>& requests,
+                          const ::planning_scene::PlanningSceneConstPtr& scene,
+                          const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>& pipelines)
+      : planning_scene(scene), planning_pipelines(pipelines), plan_responses_container(requests.size())
+    {
+    }
+    const ::planning_scene::PlanningSceneConstPtr planning_scene;
+    const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr> planning_pipelines;
+    PlanResponsesContainer plan_responses_container;
+    std::atomic<bool> stopped{ false };
+  };
+  const auto state = std::make_shared<ParallelPlanningState>(motion_plan_requests, planning_scene, planning_pipelines);
 
   // Print a warning if more parallel planning problems than available concurrent threads are defined. If
   // std::thread::hardware_concurrency() is not defined, the command returns 0 so the check does not work
@@ -99,73 +113,79 @@ const std::vector<::planning_interface::MotionPlanResponse> planWithParallelPipe
                 motion_plan_requests.size(), hardware_concurrency);
   }
 
-  // Launch planning threads
+  // Submit planning tasks to the shared thread pool
   for (const auto& request : motion_plan_requests)
   {
-    auto planning_thread = std::thread([&]() {
+    PlanningThreadPool::getSharedPool().submit([state, request]() {
       auto plan_solution = ::planning_interface::MotionPlanResponse();
-      try
+      // Skip pipelines that did not start before the stopping criterion was met
+      if (state->stopped)
       {
-        // Use planning scene if provided, otherwise the planning scene from planning scene monitor is used
-        plan_solution = planWithSinglePipeline(request, planning_scene, planning_pipelines);
+        plan_solution.error_code = moveit::core::MoveItErrorCode::PREEMPTED;
       }
-      catch (const std::exception& e)
+      else
       {
-        RCLCPP_ERROR(getLogger(), "Planning pipeline '%s' threw exception '%s'", request.pipeline_id.c_str(), e.what());
-        plan_solution = ::planning_interface::MotionPlanResponse();
-        plan_solution.error_code = moveit::core::MoveItErrorCode::FAILURE;
+        try
+        {
+          plan_solution = planWithSinglePipeline(request, state->planning_scene, state->planning_pipelines);
+        }
+        catch (const std::exception& e)
+        {
+          RCLCPP_ERROR(getLogger(), "Planning pipeline '%s' threw exception '%s'", request.pipeline_id.c_str(),
+                       e.what());
+          plan_solution = ::planning_interface::MotionPlanResponse();
+          plan_solution.error_code = moveit::core::MoveItErrorCode::FAILURE;
+        }
       }
       plan_solution.planner_id = request.planner_id;
-      plan_responses_container.pushBack(plan_solution);
+      state->plan_responses_container.pushBack(plan_solution);
+    });
+  }
 
-      if (stopping_criterion_callback != nullptr)
+  // Evaluate the stopping criterion whenever a response arrives. Terminated pipelines are still waited for, because the
+  // next request must not use a pipeline while it is planning for this one.
+  size_t num_responses = 0;
+  while (num_responses < motion_plan_requests.size())
+  {
+    num_responses = state->plan_responses_container.waitForSolutions(num_responses);
+    if (!state->stopped && num_responses < motion_plan_requests.size() && stopping_criterion_callback != nullptr &&
+        stopping_criterion_callback(state->plan_responses_container, motion_plan_requests))
+    {
+      // Terminate the planning pipelines that are still running
+      RCLCPP_INFO(getLogger(), "Stopping criterion met: Terminating planning pipelines that are still active");
+      state->stopped = true;
+      for (const auto& request : motion_plan_requests)
       {
-        if (stopping_criterion_callback(plan_responses_container, motion_plan_requests))
+        try
         {
-          // Terminate planning pipelines
-          RCLCPP_INFO(getLogger(), "Stopping criterion met: Terminating planning pipelines that are still active");
-          for (const auto& request : motion_plan_requests)
+          const auto& planning_pipeline = planning_pipelines.at(request.pipeline_id);
+          if (planning_pipeline->isActive())
           {
-            try
-            {
-              const auto& planning_pipeline = planning_pipelines.at(request.pipeline_id);
-              if (planning_pipeline->isActive())
-              {
-                planning_pipeline->terminate();
-              }
-            }
-            catch (const std::out_of_range&)
-            {
-              RCLCPP_WARN(getLogger(), "Cannot terminate pipeline '%s' because no pipeline with that name exists",
-                          request.pipeline_id.c_str());
-            }
+            planning_pipeline->terminate();
           }
         }
+        catch (const std::out_of_range&)
+        {
+          RCLCPP_WARN(getLogger(), "Cannot terminate pipeline '%s' because no pipeline with that name exists",
+                      request.pipeline_id.c_str());
+        }
       }
-    });
-    planning_threads.push_back(std::move(planning_thread));
-  }
-
-  // Wait for threads to finish
-  for (auto& planning_thread : planning_threads)
-  {
-    if (planning_thread.joinable())
-    {
-      planning_thread.join();
     }
   }
 
+  std::vector<::planning_interface::MotionPlanResponse> solutions = state->plan_responses_container.getSolutions();
+
   // If a solution selection function is provided, it is used to compute the return value
   if (solution_selection_function)
   {
-    std::vector<::planning_interface::MotionPlanResponse> solutions;
-    solutions.reserve(1);
-    solutions.push_back(solution_selection_function(plan_responses_container.getSolutions()));
-    return solutions;
+    std::vector<::planning_interface::MotionPlanResponse> selected_solutions;
+    selected_solutions.reserve(1);
+    selected_solutions.push_back(solution_selection_function(solutions));
+    return selected_solutions;
   }
 
   // Otherwise, just return the unordered list of solutions
-  return plan_responses_container.getSolutions();
+  return solutions;
 }
 
 std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr>
@@ -0,0 +1,180 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
+
+#include <algorithm>
+
+namespace moveit
+{
+namespace planning_pipeline_interfaces
+{
+namespace
+{
+// Planning tasks mostly wait for planners, so the shared pool may have more workers than cores
+constexpr std::size_t MAX_SHARED_POOL_THREADS = 64;
+
+// Pool and queue of the worker running on this thread, if any
+thread_local const PlanningThreadPool* current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+}  // namespace
+
+PlanningThreadPool::PlanningThreadPool(std::size_t max_threads)
+{
+  queues_.resize(std::max<std::size_t>(max_threads, 1));
+  for (auto& queue : queues_)
+  {
+    queue = std::make_unique<TaskQueue>();
+  }
+  workers_.reserve(queues_.size());
+}
+
+PlanningThreadPool::~PlanningThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (std::thread& worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+PlanningThreadPool& PlanningThreadPool::getSharedPool()
+{
+  // Never destroyed: joining the workers during static destruction could wait for planners whose plugin libraries have
+  // already been unloaded. Planning requests wait for their tasks, so the workers are idle when the process exits.
+  static PlanningThreadPool* const pool =
+      new PlanningThreadPool(std::max<std::size_t>(MAX_SHARED_POOL_THREADS, std::thread::hardware_concurrency()));
+  return *pool;
+}
+
+void PlanningThreadPool::submit(std::function<void()> task)
+{
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  // Make sure a worker is free to pick up the task, unless the maximum number of workers is reached
+  if (idle_workers_ <= pending_tasks_ && workers_.size() < queues_.size())
+  {
+    startWorker();
+  }
+
+  const std::size_t index = current_pool == this ? current_queue : next_queue_++ % workers_.size();
+  {
+    std::lock_guard<std::mutex> queue_lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  ++pending_tasks_;
+  work_cv_.notify_one();
+}
+
+std::size_t PlanningThreadPool::getThreadCount() const
+{
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  return workers_.size();
+}
+
+void PlanningThreadPool::startWorker()
+{
+  const std::size_t index = workers_.size();
+  workers_.emplace_back([this, index] { workerLoop(index); });
+}
+
+void PlanningThreadPool::workerLoop(std::size_t index)
+{
+  current_pool = this;
+  current_queue = index;
+
+  std::function<void()> task;
+  while (true)
+  {
+    if (popTask(index, task))
+    {
+      task();
+      // Release the captures of the task before going to sleep
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    // Another worker is about to account for a task it took, look again
+    if (pending_tasks_ > 0)
+    {
+      continue;
+    }
+    if (stop_)
+    {
+      return;
+    }
+    ++idle_workers_;
+    work_cv_.wait(lock, [this] { return stop_ || pending_tasks_ > 0; });
+    --idle_workers_;
+  }
+}
+
+bool PlanningThreadPool::popTask(std::size_t index, std::function<void()>& task)
+{
+  bool found = false;
+  for (std::size_t offset = 0; offset < queues_.size() && !found; ++offset)
+  {
+    TaskQueue& queue = *queues_[(index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> queue_lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+      continue;
+    }
+    // The own queue is processed newest first, other queues are robbed of their oldest task
+    if (offset == 0)
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    found = true;
+  }
+
+  if (found)
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    --pending_tasks_;
+  }
+  return found;
+}
+}  // namespace planning_pipeline_interfaces
+}  // namespace moveit
@@ -0,0 +1,166 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc: Tests of the planning thread pool and of parallel planning with multiple pipelines */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+
+#include <moveit/planning_pipeline_interfaces/planning_pipeline_interfaces.hpp>
+#include <moveit/planning_pipeline_interfaces/planning_thread_pool.hpp>
+#include <moveit/planning_pipeline_interfaces/stopping_criterion_functions.hpp>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/utils/robot_model_test_utils.h>
+
+using moveit::planning_pipeline_interfaces::PlanningThreadPool;
+
+TEST(PlanningThreadPool, RunsAllTasks)
+{
+  // GIVEN a pool with a few workers
+  std::atomic<std::size_t> num_finished{ 0 };
+  {
+    PlanningThreadPool pool(4);
+    // WHEN more tasks than workers are submitted
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+      pool.submit([&num_finished] { ++num_finished; });
+    }
+    // THEN no more workers than allowed are started
+    EXPECT_LE(pool.getThreadCount(), 4u);
+  }
+  // THEN the destructor waits until all tasks are finished
+  EXPECT_EQ(num_finished, 100u);
+}
+
+TEST(PlanningThreadPool, StartsWorkersForBlockingTasks)
+{
+  std::mutex mutex;
+  std::condition_variable started_cv;
+  std::size_t num_started = 0;
+  std::atomic<std::size_t> num_concurrent{ 0 };
+  {
+    // GIVEN a pool with two workers
+    PlanningThreadPool pool(2);
+    // WHEN two tasks are submitted that block until both of them are running
+    const auto task = [&] {
+      std::unique_lock<std::mutex> lock(mutex);
+      ++num_started;
+      started_cv.notify_all();
+      if (started_cv.wait_for(lock, std::chrono::seconds(10), [&] { return num_started >= 2; }))
+      {
+        ++num_concurrent;
+      }
+    };
+    pool.submit(task);
+    pool.submit(task);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      started_cv.wait_for(lock, std::chrono::seconds(10), [&] { return num_started >= 2; });
+    }
+    // THEN a worker is started for every task
+    EXPECT_EQ(pool.getThreadCount(), 2u);
+
+    // WHEN another task is submitted
+    pool.submit([] {});
+    // THEN the maximum number of workers is not exceeded
+    EXPECT_EQ(pool.getThreadCount(), 2u);
+  }
+  // THEN both blocking tasks ran at the same time
+  EXPECT_EQ(num_concurrent, 2u);
+}
+
+TEST(PlanningThreadPool, TasksSubmittedByWorkersAreRun)
+{
+  // GIVEN a pool with a single worker
+  PlanningThreadPool pool(1);
+  // WHEN a task submits another task
+  std::promise<void> nested_task_finished;
+  pool.submit([&pool, &nested_task_finished] {
+    pool.submit([&nested_task_finished] { nested_task_finished.set_value(); });
+  });
+  // THEN the nested task is run by the worker after the submitting task
+  EXPECT_EQ(nested_task_finished.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+TEST(ParallelPlanning, WaitsForTerminatedPipelines)
+{
+  // GIVEN a pipeline that finds a solution quickly and a pipeline that plans until it is terminated
+  const auto robot_model = moveit::core::RobotModelBuilder("empty_robot", "base_link").build();
+  const auto node = rclcpp::Node::make_shared("planning_pipeline_interfaces_test");
+  const std::unordered_map<std::string, planning_pipeline::PlanningPipelinePtr> pipelines{
+    { "fast", std::make_shared<planning_pipeline::PlanningPipeline>(
+                  robot_model, node, "fast",
+                  std::vector<std::string>{ "planning_pipeline_test/DummyPlannerManager" }) },
+    { "slow", std::make_shared<planning_pipeline::PlanningPipeline>(
+                  robot_model, node, "slow",
+                  std::vector<std::string>{ "planning_pipeline_test/TerminablePlannerManager" }) }
+  };
+  std::vector<planning_interface::MotionPlanRequest> requests(2);
+  requests.at(0).pipeline_id = requests.at(0).planner_id = "fast";
+  requests.at(1).pipeline_id = requests.at(1).planner_id = "slow";
+  const auto scene = std::make_shared<planning_scene::PlanningScene>(robot_model);
+
+  // WHEN planning is stopped at the first solution
+  const auto start_time = std::chrono::steady_clock::now();
+  const auto responses = moveit::planning_pipeline_interfaces::planWithParallelPipelines(
+      requests, scene, pipelines, &moveit::planning_pipeline_interfaces::stopAtFirstSolution);
+
+  // THEN the slow pipeline is terminated instead of running into its timeout
+  EXPECT_LT(std::chrono::steady_clock::now() - start_time, std::chrono::seconds(10));
+  // THEN the responses of both pipelines are returned
+  ASSERT_EQ(responses.size(), 2u);
+  for (const auto& response : responses)
+  {
+    const int expected_error_code = response.planner_id == "fast" ? moveit::core::MoveItErrorCode::SUCCESS :
+                                                                    moveit::core::MoveItErrorCode::PREEMPTED;
+    EXPECT_EQ(response.error_code.val, expected_error_code) << response.planner_id;
+  }
+  // THEN no pipeline is still planning, so the pipelines can be used for the next request
+  for (const auto& [name, pipeline] : pipelines)
+  {
+    EXPECT_FALSE(pipeline->isActive()) << name;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,393 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Desc: Response adapter that shortens and smooths a solution path. Random shortcuts, partial (single joint)
+ * shortcuts and B-spline smoothing steps are proposed in batches and the motions they introduce are validated in
+ * parallel against the planning scene passed to the adapter.
+ */
+
+#include <moveit/planning_interface/planning_response_adapter.h>
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <class_loader/class_loader.hpp>
+#include <moveit/utils/logger.hpp>
+#include <moveit/utils/parallel_for.h>
+#include <random_numbers/random_numbers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <default_response_adapter_parameters.hpp>
+
+namespace default_planning_response_adapters
+{
+namespace
+{
+using Configuration = std::vector<double>;
+
+/** @brief A modification of the path: the waypoints in the open interval (start, end) are replaced by 'waypoints' */
+struct PathEdit
+{
+  std::size_t start = 0;
+  std::size_t end = 0;
+  std::vector<Configuration> waypoints;
+  double length_reduction = 0.0;
+  bool valid = false;
+};
+}  // namespace
+
+/**
+ * @brief Adapter that shortens and smooths the solution path with randomized full and partial shortcutting followed by
+ * B-spline smoothing. Candidate modifications are validated in parallel. The adapter works on the path geometry, so it
+ * has to run before time parameterization.
+ */
+class ShortcutPath : public planning_interface::PlanningResponseAdapter
+{
+public:
+  ShortcutPath() : logger_(moveit::getLogger("moveit.ros.shortcut_path"))
+  {
+  }
+
+  void initialize(const rclcpp::Node::SharedPtr& node, const std::string& parameter_namespace) override
+  {
+    param_listener_ = std::make_unique<default_response_adapter_parameters::ParamListener>(node, parameter_namespace);
+  }
+
+  [[nodiscard]] std::string getDescription() const override
+  {
+    return std::string("ShortcutPath");
+  }
+
+  void adapt(const planning_scene::PlanningSceneConstPtr& planning_scene,
+             const planning_interface::MotionPlanRequest& req,
+             planning_interface::MotionPlanResponse& res) const override
+  {
+    RCLCPP_DEBUG(logger_, " Running '%s'", getDescription().c_str());
+    if (!res.trajectory)
+    {
+      RCLCPP_ERROR(logger_, "Cannot apply response adapter '%s' because MotionPlanResponse does not contain a path.",
+                   getDescription().c_str());
+      res.error_code = moveit::core::MoveItErrorCode::INVALID_MOTION_PLAN;
+      return;
+    }
+
+    const moveit::core::JointModelGroup* group = res.trajectory->getGroup();
+    if (!group || res.trajectory->getWayPointCount() < 3)
+    {
+      RCLCPP_DEBUG(logger_, "Path has no group or fewer than three waypoints, nothing to shortcut.");
+      return;
+    }
+
+    const auto params = param_listener_->get_params().shortcut_path;
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                           std::chrono::duration<double>(params.timeout));
+
+    kinematic_constraints::KinematicConstraintSet path_constraints(planning_scene->getRobotModel());
+    path_constraints.add(req.path_constraints, planning_scene->getTransforms());
+
+    Context context{ planning_scene.get(), &path_constraints, group, res.trajectory->getWayPoint(0), params.max_step,
+                     deadline, static_cast<std::size_t>(params.num_threads) };
+
+    std::vector<Configuration> path(res.trajectory->getWayPointCount());
+    for (std::size_t i = 0; i < path.size(); ++i)
+    {
+      res.trajectory->getWayPoint(i).copyJointGroupPositions(group, path[i]);
+    }
+    const double initial_length = pathLength(group, path);
+
+    random_numbers::RandomNumberGenerator rng;
+    std::size_t stale_rounds = 0;
+    for (int round = 0; round < params.max_rounds && stale_rounds < static_cast<std::size_t>(params.max_stale_rounds) &&
+                        std::chrono::steady_clock::now() < deadline;
+         ++round)
+    {
+      if (path.size() < 3)
+      {
+        break;
+      }
+      std::vector<PathEdit> edits = proposeShortcuts(group, path, params.candidates_per_round,
+                                                     params.partial_shortcuts, rng);
+      validateEdits(context, path, edits);
+      stale_rounds = applyEdits(path, edits) ? 0 : stale_rounds + 1;
+    }
+
+    if (params.smoothing_passes > 0 && std::chrono::steady_clock::now() < deadline)
+    {
+      subdivide(group, path);
+      for (int pass = 0; pass < params.smoothing_passes && std::chrono::steady_clock::now() < deadline; ++pass)
+      {
+        // Odd and even waypoints are smoothed in separate batches, so the neighbors of all candidates of a batch stay
+        // fixed while the batch is validated
+        for (std::size_t parity = 1; parity <= 2; ++parity)
+        {
+          std::vector<PathEdit> edits = proposeSmoothing(group, path, parity);
+          validateEdits(context, path, edits);
+          applyEdits(path, edits);
+        }
+      }
+    }
+
+    moveit::core::RobotState state = context.reference_state;
+    res.trajectory->clear();
+    for (const Configuration& configuration : path)
+    {
+      state.setJointGroupPositions(group, configuration);
+      state.update();
+      res.trajectory->addSuffixWayPoint(state, 0.0);
+    }
+
+    RCLCPP_DEBUG(logger_, "Shortened path from length %f to %f with %zu waypoints in %f s", initial_length,
+                 pathLength(group, path), path.size(),
+                 std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count());
+  }
+
+private:
+  struct Context
+  {
+    const planning_scene::PlanningScene* scene;
+    const kinematic_constraints::KinematicConstraintSet* path_constraints;
+    const moveit::core::JointModelGroup* group;
+    moveit::core::RobotState reference_state;
+    double max_step;
+    std::chrono::steady_clock::time_point deadline;
+    std::size_t num_threads;
+  };
+
+  static double pathLength(const moveit::core::JointModelGroup* group, const std::vector<Configuration>& path,
+                           std::size_t begin = 0, std::size_t end = std::numeric_limits<std::size_t>::max())
+  {
+    double length = 0.0;
+    for (std::size_t i = begin + 1; i < path.size() && i <= end; ++i)
+    {
+      length += group->distance(path[i - 1].data(), path[i].data());
+    }
+    return length;
+  }
+
+  static bool isMotionValid(const Context& context, moveit::core::RobotState& state, const Configuration& from,
+                            const Configuration& to)
+  {
+    const double distance = context.group->distance(from.data(), to.data());
+    const std::size_t steps =
+        std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(distance / context.max_step)));
+    Configuration configuration(from.size());
+    for (std::size_t step = 1; step <= steps; ++step)
+    {
+      context.group->interpolate(from.data(), to.data(), static_cast<double>(step) / static_cast<double>(steps),
+                                 configuration.data());
+      state.setJointGroupPositions(context.group, configuration);
+      state.update();
+      if (!context.scene->isStateValid(state, *context.path_constraints, context.group->getName()))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** @brief Propose straight shortcuts between random waypoints and, optionally, partial shortcuts which only move a
+   * single joint on a straight line between two waypoints */
+  static std::vector<PathEdit> proposeShortcuts(const moveit::core::JointModelGroup* group,
+                                                const std::vector<Configuration>& path, int count,
+                                                bool partial_shortcuts, random_numbers::RandomNumberGenerator& rng)
+  {
+    std::vector<PathEdit> edits;
+    const std::vector<const moveit::core::JointModel*>& joints = group->getActiveJointModels();
+    const int last_index = static_cast<int>(path.size()) - 1;
+    for (int i = 0; i < count; ++i)
+    {
+      std::size_t start = static_cast<std::size_t>(rng.uniformInteger(0, last_index));
+      std::size_t end = static_cast<std::size_t>(rng.uniformInteger(0, last_index));
+      if (start > end)
+      {
+        std::swap(start, end);
+      }
+      if (end - start < 2)
+      {
+        continue;
+      }
+
+      PathEdit edit;
+      edit.start = start;
+      edit.end = end;
+      const double length = pathLength(group, path, start, end);
+      if (partial_shortcuts && i % 2 == 1 && !joints.empty())
+      {
+        // Interpolate one joint over the arc length of the original section. The joint model interpolates, so
+        // continuous joints take the short way around.
+        const moveit::core::JointModel* joint =
+            joints[static_cast<std::size_t>(rng.uniformInteger(0, static_cast<int>(joints.size()) - 1))];
+        const std::size_t offset = static_cast<std::size_t>(group->getVariableGroupIndex(joint->getName()));
+        double arc = 0.0;
+        edit.waypoints.reserve(end - start - 1);
+        for (std::size_t k = start + 1; k < end; ++k)
+        {
+          arc += group->distance(path[k - 1].data(), path[k].data());
+          edit.waypoints.push_back(path[k]);
+          joint->interpolate(path[start].data() + offset, path[end].data() + offset, length > 0.0 ? arc / length : 0.0,
+                             edit.waypoints.back().data() + offset);
+        }
+        double new_length = group->distance(path[start].data(), edit.waypoints.front().data()) +
+                            group->distance(edit.waypoints.back().data(), path[end].data());
+        for (std::size_t k = 1; k < edit.waypoints.size(); ++k)
+        {
+          new_length += group->distance(edit.waypoints[k - 1].data(), edit.waypoints[k].data());
+        }
+        edit.length_reduction = length - new_length;
+      }
+      else
+      {
+        edit.length_reduction = length - group->distance(path[start].data(), path[end].data());
+      }
+      if (edit.length_reduction > std::numeric_limits<double>::epsilon())
+      {
+        edits.push_back(std::move(edit));
+      }
+    }
+    return edits;
+  }
+
+  /** @brief Propose to replace each interior waypoint with the given parity by the midpoint of the midpoints of its two
+   * adjacent segments, which is one subdivision step of a uniform cubic B-spline */
+  static std::vector<PathEdit> proposeSmoothing(const moveit::core::JointModelGroup* group,
+                                                const std::vector<Configuration>& path, std::size_t parity)
+  {
+    std::vector<PathEdit> edits;
+    Configuration before(group->getVariableCount());
+    Configuration after(group->getVariableCount());
+    for (std::size_t i = parity; i + 1 < path.size(); i += 2)
+    {
+      group->interpolate(path[i - 1].data(), path[i].data(), 0.5, before.data());
+      group->interpolate(path[i].data(), path[i + 1].data(), 0.5, after.data());
+      PathEdit edit;
+      edit.start = i - 1;
+      edit.end = i + 1;
+      edit.waypoints.emplace_back(group->getVariableCount());
+      group->interpolate(before.data(), after.data(), 0.5, edit.waypoints.back().data());
+      edit.length_reduction = pathLength(group, path, i - 1, i + 1) -
+                              group->distance(path[i - 1].data(), edit.waypoints.back().data()) -
+                              group->distance(edit.waypoints.back().data(), path[i + 1].data());
+      edits.push_back(std::move(edit));
+    }
+    return edits;
+  }
+
+  /** @brief Insert the midpoint of every segment, so that smoothing has waypoints to work with */
+  static void subdivide(const moveit::core::JointModelGroup* group, std::vector<Configuration>& path)
+  {
+    std::vector<Configuration> subdivided;
+    subdivided.reserve(2 * path.size() - 1);
+    for (std::size_t i = 0; i + 1 < path.size(); ++i)
+    {
+      subdivided.push_back(path[i]);
+      subdivided.emplace_back(group->getVariableCount());
+      group->interpolate(path[i].data(), path[i + 1].data(), 0.5, subdivided.back().data());
+    }
+    subdivided.push_back(path.back());
+    path = std::move(subdivided);
+  }
+
+  /** @brief Validate the edits in parallel. Edits that are not reached before the deadline stay invalid. */
+  static void validateEdits(const Context& context, const std::vector<Configuration>& path,
+                            std::vector<PathEdit>& edits)
+  {
+    moveit::core::parallelFor(
+        edits.size(), context.num_threads, [&context] { return context.reference_state; },
+        [&context, &path, &edits](moveit::core::RobotState& state, std::size_t i) {
+          if (std::chrono::steady_clock::now() >= context.deadline)
+          {
+            return;
+          }
+          PathEdit& edit = edits[i];
+          const Configuration* from = &path[edit.start];
+          for (const Configuration& waypoint : edit.waypoints)
+          {
+            if (!isMotionValid(context, state, *from, waypoint))
+            {
+              return;
+            }
+            from = &waypoint;
+          }
+          edit.valid = isMotionValid(context, state, *from, path[edit.end]);
+        });
+  }
+
+  /** @brief Apply the valid edits with the largest length reduction whose sections do not overlap. Returns true if the
+   * path was modified. */
+  static bool applyEdits(std::vector<Configuration>& path, std::vector<PathEdit>& edits)
+  {
+    edits.erase(std::remove_if(edits.begin(), edits.end(), [](const PathEdit& edit) { return !edit.valid; }),
+                edits.end());
+    std::sort(edits.begin(), edits.end(),
+              [](const PathEdit& a, const PathEdit& b) { return a.length_reduction > b.length_reduction; });
+
+    std::vector<const PathEdit*> selected;
+    for (const PathEdit& edit : edits)
+    {
+      // Sections may share their end points only, as those are kept
+      const bool overlaps = std::any_of(selected.begin(), selected.end(), [&edit](const PathEdit* other) {
+        return edit.start < other->end && other->start < edit.end;
+      });
+      if (!overlaps)
+      {
+        selected.push_back(&edit);
+      }
+    }
+    if (selected.empty())
+    {
+      return false;
+    }
+
+    // Apply from the back of the path, so that the indices of the remaining edits stay valid
+    std::sort(selected.begin(), selected.end(),
+              [](const PathEdit* a, const PathEdit* b) { return a->start > b->start; });
+    for (const PathEdit* edit : selected)
+    {
+      const auto first = path.begin() + static_cast<std::ptrdiff_t>(edit->start + 1);
+      const auto last = path.begin() + static_cast<std::ptrdiff_t>(edit->end);
+      const auto position = path.erase(first, last);
+      path.insert(position, edit->waypoints.begin(), edit->waypoints.end());
+    }
+    return true;
+  }
+
+  std::unique_ptr<default_response_adapter_parameters::ParamListener> param_listener_;
+  rclcpp::Logger logger_;
+};
+}  // namespace default_planning_response_adapters
+
+CLASS_LOADER_REGISTER_CLASS(default_planning_response_adapters::ShortcutPath,
+                            planning_interface::PlanningResponseAdapter)
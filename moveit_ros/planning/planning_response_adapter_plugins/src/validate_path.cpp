@@ -43,6 +43,10 @@
 #include <moveit/collision_detection/collision_tools.h>
 
 #include <default_response_adapter_parameters.hpp>
+
+#include <algorithm>
+#include <iterator>
+
 namespace default_planning_response_adapters
 {
 /**
@@ -63,6 +67,9 @@ public:
     // Read parameters
     const auto params = param_listener->get_params();
 
+    path_validation_options_.max_joint_step = params.validate_path.max_joint_step;
+    path_validation_options_.max_link_step = params.validate_path.max_link_step;
+
     if (!params.display_contacts_topic.empty())
     {
       contacts_publisher_ = node->create_publisher<visualization_msgs::msg::MarkerArray>(params.display_contacts_topic,
@@ -95,7 +102,9 @@ public:
     arr.markers.push_back(m);
 
     std::vector<std::size_t> indices;
-    if (!planning_scene->isPathValid(*res.trajectory, req.path_constraints, req.group_name, false, &indices))
+    const std::vector<moveit_msgs::msg::Constraints> no_goal_constraints;
+    if (!planning_scene->isPathValid(*res.trajectory, req.path_constraints, no_goal_constraints,
+                                     path_validation_options_, req.group_name, false, &indices))
     {
       // check to see if there is any problem with the states that are found to be invalid
       res.error_code.val = moveit_msgs::msg::MoveItErrorCodes::INVALID_MOTION_PLAN;
@@ -103,20 +112,49 @@ public:
       // If a contact publisher exists, publish contacts
       if (contacts_publisher_)
       {
+        // A waypoint is reported both if it is invalid and if the motion into it is. The waypoints are checked again
+        // on their own to tell both cases apart.
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        std::vector<std::size_t> invalid_states;
+        planning_scene->isPathValid(*res.trajectory, req.path_constraints, no_goal_constraints,
+                                    planning_scene::PathValidationOptions(), req.group_name, false, &invalid_states);
+        std::sort(invalid_states.begin(), invalid_states.end());
+        invalid_states.erase(std::unique(invalid_states.begin(), invalid_states.end()), invalid_states.end());
+        std::vector<std::size_t> invalid_motions;
+        std::set_difference(indices.begin(), indices.end(), invalid_states.begin(), invalid_states.end(),
+                            std::back_inserter(invalid_motions));
+
         // display error messages
-        std::stringstream ss;
-        for (std::size_t it : indices)
+        std::stringstream states_ss, motions_ss;
+        for (std::size_t it : invalid_states)
         {
-          ss << it << ' ';
+          states_ss << it << ' ';
+        }
+        for (std::size_t it : invalid_motions)
+        {
+          motions_ss << it << ' ';
         }
 
         RCLCPP_ERROR_STREAM(logger_, "Computed path is not valid. Invalid states at index locations: [ "
-                                         << ss.str() << "] out of " << state_count
+                                         << states_ss.str() << "], invalid motions into index locations: [ "
+                                         << motions_ss.str() << "] out of " << state_count
                                          << ". Explanations follow in command line. Contacts are published on "
                                          << contacts_publisher_->get_topic_name());
 
+        // check the motions in verbose mode, which explains the first invalid state found between the waypoints
+        for (std::size_t it : invalid_motions)
+        {
+          RCLCPP_ERROR(logger_, "Explaining the motion between waypoints %zu and %zu", it - 1, it);
+          robot_trajectory::RobotTrajectory motion(res.trajectory->getRobotModel(), res.trajectory->getGroup());
+          motion.addSuffixWayPoint(res.trajectory->getWayPoint(it - 1), 0.0);
+          motion.addSuffixWayPoint(res.trajectory->getWayPoint(it), 0.0);
+          planning_scene->isPathValid(motion, req.path_constraints, no_goal_constraints, path_validation_options_,
+                                      req.group_name, true);
+        }
+
         // call validity checks in verbose mode for the problematic states
-        for (std::size_t it : indices)
+        for (std::size_t it : invalid_states)
         {
           // check validity with verbose on
           const moveit::core::RobotState& robot_state = res.trajectory->getWayPoint(it);
@@ -146,6 +184,7 @@ public:
 
 private:
   rclcpp::Logger logger_;
+  planning_scene::PathValidationOptions path_validation_options_;
   rclcpp::Publisher<visualization_msgs::msg::MarkerArray>::SharedPtr contacts_publisher_;
 };
 }  // namespace default_planning_response_adapters
@@ -0,0 +1,177 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <moveit/planning_interface/planning_response_adapter.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <pluginlib/class_loader.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
+
+namespace
+{
+const std::string GROUP = "panda_arm";
+
+double pathLength(const robot_trajectory::RobotTrajectory& trajectory)
+{
+  double length = 0.0;
+  for (std::size_t i = 1; i < trajectory.getWayPointCount(); ++i)
+  {
+    length += trajectory.getWayPoint(i - 1).distance(trajectory.getWayPoint(i), trajectory.getGroup());
+  }
+  return length;
+}
+}  // namespace
+
+class TestShortcutPath : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    robot_model_ = moveit::core::loadTestingRobotModel("panda");
+    scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+    node_ = rclcpp::Node::make_shared("test_shortcut_path",
+                                      rclcpp::NodeOptions().parameter_overrides(
+                                          { { "shortcut_path.num_threads", 2 }, { "shortcut_path.timeout", 10.0 } }));
+    adapter_loader_ = std::make_unique<pluginlib::ClassLoader<planning_interface::PlanningResponseAdapter>>(
+        "moveit_core", "planning_interface::PlanningResponseAdapter");
+    adapter_ = adapter_loader_->createSharedInstance("default_planning_response_adapters/ShortcutPath");
+    adapter_->initialize(node_, "");
+  }
+
+  /** Create a path through waypoints given as (panda_joint1, panda_joint2) */
+  robot_trajectory::RobotTrajectoryPtr createPath(const std::vector<std::pair<double, double>>& waypoints) const
+  {
+    auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, GROUP);
+    moveit::core::RobotState state = scene_->getCurrentState();
+    state.setToDefaultValues();
+    for (const auto& [joint1, joint2] : waypoints)
+    {
+      state.setVariablePosition("panda_joint1", joint1);
+      state.setVariablePosition("panda_joint2", joint2);
+      state.update();
+      trajectory->addSuffixWayPoint(state, 0.0);
+    }
+    return trajectory;
+  }
+
+  bool isPathValid(const robot_trajectory::RobotTrajectory& trajectory) const
+  {
+    planning_scene::PathValidationOptions options;
+    options.max_joint_step = 0.005;
+    return scene_->isPathValid(trajectory, moveit_msgs::msg::Constraints(),
+                               std::vector<moveit_msgs::msg::Constraints>(), options, GROUP);
+  }
+
+  moveit::core::RobotModelPtr robot_model_;
+  planning_scene::PlanningScenePtr scene_;
+  rclcpp::Node::SharedPtr node_;
+  std::unique_ptr<pluginlib::ClassLoader<planning_interface::PlanningResponseAdapter>> adapter_loader_;
+  planning_interface::PlanningResponseAdapterPtr adapter_;
+};
+
+TEST_F(TestShortcutPath, ShortensPathInFreeSpace)
+{
+  // GIVEN a detour in an empty scene
+  planning_interface::MotionPlanRequest req;
+  planning_interface::MotionPlanResponse res;
+  res.trajectory = createPath({ { -0.6, 0.0 }, { -0.6, 0.6 }, { 0.0, 0.6 }, { 0.6, 0.6 }, { 0.6, 0.0 } });
+  const moveit::core::RobotState start = res.trajectory->getFirstWayPoint();
+  const moveit::core::RobotState goal = res.trajectory->getLastWayPoint();
+
+  // WHEN the path is shortcut
+  adapter_->adapt(scene_, req, res);
+
+  // THEN it is the straight motion between the unchanged end points
+  ASSERT_GE(res.trajectory->getWayPointCount(), 2u);
+  EXPECT_EQ(res.trajectory->getFirstWayPoint().distance(start), 0.0);
+  EXPECT_EQ(res.trajectory->getLastWayPoint().distance(goal), 0.0);
+  EXPECT_NEAR(pathLength(*res.trajectory), start.distance(goal, robot_model_->getJointModelGroup(GROUP)), 1e-6);
+}
+
+TEST_F(TestShortcutPath, KeepsPathCollisionFree)
+{
+  // GIVEN a body held far away from the arm, so that the first two joints move it on a large sphere
+  moveit_msgs::msg::AttachedCollisionObject aco;
+  aco.link_name = "panda_link2";
+  aco.object.header.frame_id = "panda_link2";
+  aco.object.id = "tip";
+  aco.object.operation = moveit_msgs::msg::CollisionObject::ADD;
+  shape_msgs::msg::SolidPrimitive sphere;
+  sphere.type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  sphere.dimensions = { 0.05 };
+  aco.object.primitives.push_back(sphere);
+  aco.object.primitive_poses.push_back(tf2::toMsg(Eigen::Isometry3d(Eigen::Translation3d(10.0, 0.0, 0.0))));
+  ASSERT_TRUE(scene_->processAttachedCollisionObjectMsg(aco));
+
+  // AND an obstacle where the body is in the middle of the straight motion between start and goal
+  const robot_trajectory::RobotTrajectoryPtr middle = createPath({ { 0.0, 0.0 } });
+  moveit_msgs::msg::CollisionObject co;
+  co.header.frame_id = robot_model_->getModelFrame();
+  co.id = "obstacle";
+  co.operation = moveit_msgs::msg::CollisionObject::ADD;
+  sphere.dimensions = { 1.0 };
+  co.primitives.push_back(sphere);
+  co.primitive_poses.push_back(
+      tf2::toMsg(middle->getFirstWayPoint().getAttachedBody("tip")->getGlobalCollisionBodyTransforms().front()));
+  scene_->processCollisionObjectMsg(co);
+
+  ASSERT_FALSE(isPathValid(*createPath({ { -0.6, 0.0 }, { 0.6, 0.0 } })));
+
+  // AND a valid detour around the obstacle
+  planning_interface::MotionPlanRequest req;
+  planning_interface::MotionPlanResponse res;
+  res.trajectory = createPath({ { -0.6, 0.0 }, { -0.6, 0.6 }, { 0.0, 0.6 }, { 0.6, 0.6 }, { 0.6, 0.0 } });
+  ASSERT_TRUE(isPathValid(*res.trajectory));
+  const double initial_length = pathLength(*res.trajectory);
+
+  // WHEN the path is shortcut
+  adapter_->adapt(scene_, req, res);
+
+  // THEN it is shorter and still avoids the obstacle
+  EXPECT_LT(pathLength(*res.trajectory), initial_length);
+  EXPECT_TRUE(isPathValid(*res.trajectory));
+}
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -36,10 +36,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <optional>
 #include <string>
-#include <condition_variable>
 #include <mutex>
 
 #include <boost/signals2.hpp>
@@ -249,6 +250,31 @@ public:
     return haveCompleteStateHelper(middleware_handle_->now() - age, &missing_joints);
   }
 
+  /** @brief A copy of the latest joint values and their time stamps, see getStateSnapshot() */
+  struct StateSnapshot
+  {
+    /// Variable positions, in the order of the variables of the RobotModel
+    std::vector<double> positions;
+
+    /// Variable velocities, empty unless velocities are copied (see enableCopyDynamics()) and were received
+    std::vector<double> velocities;
+
+    /// Variable efforts, empty unless efforts are copied (see enableCopyDynamics()) and were received
+    std::vector<double> efforts;
+
+    /// Time of the last update of each joint, indexed by JointModel::getJointIndex(). Unset for joints never updated.
+    std::vector<std::optional<rclcpp::Time>> joint_times;
+
+    /// Time stamp of the latest joint state message
+    rclcpp::Time time = rclcpp::Time(0, 0, RCL_ROS_TIME);
+  };
+
+  /** @brief Copy the latest joint values and time stamps into \e snapshot.
+   *  This does not lock: readers never wait for each other or for the thread receiving joint states. If an update is
+   *  written while copying, the copy is repeated. The storage of \e snapshot is reused, so calling this repeatedly
+   *  with the same instance does not allocate. All other accessors of the current state are built on this. */
+  void getStateSnapshot(StateSnapshot& snapshot) const;
+
   /** @brief Get the current state
    *  @return Returns the current state */
   moveit::core::RobotStatePtr getCurrentState() const;
@@ -268,6 +294,8 @@ public:
   std::map<std::string, double> getCurrentStateValues() const;
 
   /** @brief Wait for at most \e wait_time_s seconds (default 1s) for a robot state more recent than t
+   *  The time stamp of the latest state is polled with a short, growing sleep interval, so waiting threads do not
+   *  contend with the thread receiving joint states.
    *  @return true on success, false if up-to-date robot state wasn't received within \e wait_time_s
    */
   bool waitForCurrentState(const rclcpp::Time& t = rclcpp::Clock(RCL_ROS_TIME).now(), double wait_time_s = 1.0) const;
@@ -324,6 +352,9 @@ private:
 
   void jointStateCallback(const sensor_msgs::msg::JointState::ConstSharedPtr& joint_state);
   void updateMultiDofJoints();
+
+  // copy robot_state_, joint_time_ and current_state_time_ to the published_* members; requires state_update_lock_
+  void publishState();
   void transformCallback(const tf2_msgs::msg::TFMessage::ConstSharedPtr& msg, const bool is_static);
 
   std::unique_ptr<MiddlewareHandle> middleware_handle_;
@@ -337,10 +368,23 @@ private:
   double error_;
   rclcpp::Time current_state_time_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
 
+  // Serializes writers of robot_state_, joint_time_ and current_state_time_. Readers use the published_* members.
   mutable std::mutex state_update_lock_;
-  mutable std::condition_variable state_update_condition_;
   std::vector<JointStateUpdateCallback> update_callbacks_;
 
+  // Sequence lock for the published_* members: odd while publishState() writes them
+  std::atomic<uint64_t> published_sequence_{ 0 };
+  std::vector<std::atomic<double>> published_positions_;
+  std::vector<std::atomic<double>> published_velocities_;
+  std::vector<std::atomic<double>> published_efforts_;
+  std::atomic<bool> published_has_velocities_{ false };
+  std::atomic<bool> published_has_effort_{ false };
+  std::vector<std::atomic<int64_t>> published_joint_times_;  // nanoseconds, or NEVER_UPDATED
+  std::atomic<int64_t> published_state_time_{ 0 };
+
+  // Time stamp of the latest joint state, stored after the update callbacks ran. Polled by waitForCurrentState().
+  std::atomic<int64_t> notified_state_time_{ 0 };
+
   bool use_sim_time_;
 
   rclcpp::Logger logger_;
@@ -46,6 +46,8 @@
 #include <moveit/planning_scene_monitor/current_state_monitor.h>
 #include <moveit/collision_plugin_loader/collision_plugin_loader.h>
 #include <moveit_msgs/srv/get_planning_scene.hpp>
+#include <std_msgs/msg/u_int64.hpp>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <shared_mutex>
@@ -204,6 +206,40 @@ public:
       or if a parent of the scene is the one maintained. */
   bool updatesScene(const planning_scene::PlanningScenePtr& scene) const;
 
+  /** @brief An immutable copy of the monitored planning scene, tagged with a version number */
+  struct SceneSnapshot
+  {
+    /** @brief The scene at the time of the snapshot, or nullptr if no snapshot was taken yet */
+    planning_scene::PlanningSceneConstPtr scene;
+    /** @brief Incremented for every new snapshot, starting at 1 for the first one */
+    uint64_t version = 0;
+  };
+
+  /** @brief Enable or disable maintaining immutable snapshots of the monitored scene.
+   *
+   * Snapshots are built on demand: an update of the monitored scene (i.e. a call to triggerSceneUpdateEvent()) only
+   * marks the latest snapshot as outdated, and the next call to getSceneSnapshot() builds a new one. So the scene is
+   * copied at most once per update that is actually read, however often it is updated. Readers keep their snapshot
+   * without blocking updates, unlike LockedPlanningSceneRO, which holds the scene lock while it lives.
+   * Collision objects are shared between the snapshot and the monitored scene until they are modified. The octomap is
+   * copied only when it changed, so snapshots are not affected by updates of the octomap monitor either. */
+  void setSceneSnapshotsEnabled(bool flag);
+
+  /** @brief Return true if immutable snapshots of the scene are maintained */
+  bool getSceneSnapshotsEnabled() const
+  {
+    return scene_snapshots_enabled_;
+  }
+
+  /** @brief Get the latest snapshot of the monitored scene.
+   *
+   * The returned scene is never modified by the monitor. It remains valid for as long as the caller holds it, even
+   * after newer snapshots were published. If snapshots are not enabled, the returned scene is nullptr.
+   * If the scene was updated since the last snapshot, this briefly takes a read lock on the scene to copy it, so like
+   * LockedPlanningSceneRO it must not be called by a thread that holds a LockedPlanningSceneRW. Otherwise the latest
+   * snapshot is returned without locking the scene. */
+  SceneSnapshot getSceneSnapshot() const;
+
   /** @brief Get the stored robot description
    *  @return An instance of the stored robot description*/
   const std::string& getRobotDescription() const
@@ -266,6 +302,34 @@ public:
     return publish_planning_scene_frequency_;
   }
 
+  /** \brief Get the version of the last planning scene message that was published. Every published message increments
+      the version by one, starting at 1 for the first message. 0 means that nothing was published yet.
+
+      The version of each message is also published on the topic "<planning_scene_topic>_version", right after the
+      message itself. Subscribers that see a gap in the versions missed a message and need to catch up, either through
+      getPublishedSceneUpdates() or by requesting the full scene from the get_planning_scene service. */
+  uint64_t getPublishedSceneVersion() const;
+
+  /** \brief Get the published messages that bring a subscriber from \e version up to the latest published version.
+   *
+   * The last published messages are kept in a bounded history (see setPublishedSceneHistorySize() and
+   * setPublishedSceneHistoryMemoryLimit()). The updates start right after \e version, or at the most recent full scene
+   * in the history if that comes later or if the history does not reach back to \e version. Meshes of objects that
+   * were only moved are not part of the published diffs.
+   * @param version The version the subscriber has applied, 0 if it has not received any scene yet
+   * @param updates The messages to apply in order
+   * @param latest_version The version the subscriber is at after applying \e updates
+   * @return False if the history cannot bring the subscriber up to date; the full scene needs to be requested then */
+  bool getPublishedSceneUpdates(uint64_t version, std::vector<moveit_msgs::msg::PlanningScene::ConstSharedPtr>& updates,
+                                uint64_t& latest_version) const;
+
+  /** \brief Set the number of published messages kept for getPublishedSceneUpdates() (default is 100) */
+  void setPublishedSceneHistorySize(std::size_t size);
+
+  /** \brief Set the approximate memory in bytes the messages kept for getPublishedSceneUpdates() may use (default is
+      64 MiB). The oldest messages are dropped first; a single message larger than the limit is not kept at all. */
+  void setPublishedSceneHistoryMemoryLimit(std::size_t bytes);
+
   /** @brief Get the stored instance of the stored current state monitor
    *  @return An instance of the stored current state monitor*/
   const CurrentStateMonitorPtr& getStateMonitor() const
@@ -377,7 +441,8 @@ public:
 
   void publishDebugInformation(bool flag);
 
-  /** @brief This function is called every time there is a change to the planning scene */
+  /** @brief This function is called every time there is a change to the planning scene. It does not lock the scene,
+   * so it may be called while holding a LockedPlanningSceneRW. */
   void triggerSceneUpdateEvent(SceneUpdateType update_type);
 
   /** \brief Wait for robot state to become more recent than time t.
@@ -400,6 +465,20 @@ public:
   bool processAttachedCollisionObjectMsg(
       const moveit_msgs::msg::AttachedCollisionObject::ConstSharedPtr& attached_collision_object_msg);
 
+  /** @brief Queue an update of the scene from the monitored state, a collision object or an attached collision object.
+   *
+   * These are the updates the monitor's own subscriptions make. Queued updates are applied in order of arrival by the
+   * calling thread, unless another thread is already applying queued updates; then that thread also applies this one
+   * before it returns. Updates that arrive while a batch is applied are merged and applied together in the next batch,
+   * under one write lock and with one update event, so the number of scene modifications follows the rate at which
+   * they can be applied rather than the message rate. Consecutive state updates become one, and a pose-only MOVE of an
+   * object replaces a queued MOVE of the same object unless another update of that object or of all objects lies in
+   * between. Octomap updates are applied separately by the octomap monitor's thread.
+   */
+  void queueStateUpdate();
+  void queueCollisionObjectUpdate(const moveit_msgs::msg::CollisionObject::ConstSharedPtr& object);
+  void queueAttachedCollisionObjectUpdate(const moveit_msgs::msg::AttachedCollisionObject::ConstSharedPtr& object);
+
 protected:
   /** @brief Initialize the planning scene monitor
    *  @param scene The scene instance to fill with data (an instance is allocated if the one passed in is not allocated)
@@ -494,6 +573,7 @@ protected:
 
   // variables for planning scene publishing
   rclcpp::Publisher<moveit_msgs::msg::PlanningScene>::SharedPtr planning_scene_publisher_;
+  rclcpp::Publisher<std_msgs::msg::UInt64>::SharedPtr planning_scene_version_publisher_;
   std::unique_ptr<std::thread> publish_planning_scene_;
   double publish_planning_scene_frequency_;
   SceneUpdateType publish_update_types_;
@@ -547,6 +627,34 @@ private:
   // called by state_update_timer_ when a state update it pending
   void stateUpdateTimerCallback();
 
+  /// An update that waits to be applied: a collision object or an attached collision object message, or the state of
+  /// current_state_monitor_ if neither is set
+  struct PendingSceneUpdate
+  {
+    moveit_msgs::msg::CollisionObject::ConstSharedPtr collision_object;
+    moveit_msgs::msg::AttachedCollisionObject::ConstSharedPtr attached_collision_object;
+  };
+
+  // apply the octree of octomap_monitor_ in its own lock scope and update event, merging notifications that arrive
+  // while it is applied. The octomap is never applied by the threads that apply state and object updates.
+  void queueOctomapUpdate();
+
+  // apply pending_scene_updates_ in batches until none are left, unless another thread is already doing so
+  void processPendingSceneUpdates();
+
+  // apply a batch of updates in order under a single write lock and trigger a single update event. Applied updates are
+  // removed from the batch, so on an exception it holds the updates that follow the one that failed.
+  void applySceneUpdates(std::deque<PendingSceneUpdate>& updates);
+
+  // set the scene state from current_state_monitor_; requires scene_update_mutex_ to be locked for writing
+  void applyCurrentState();
+
+  // set the scene octomap from octomap_monitor_; requires scene_update_mutex_ to be locked for writing
+  void applyOctomapUpdate();
+
+  // warn (throttled) if current_state_monitor_ does not know all joints yet
+  void warnIfStateIncomplete();
+
   // Callback for a new planning scene msg
   void newPlanningSceneCallback(const moveit_msgs::msg::PlanningScene::ConstSharedPtr& scene);
 
@@ -557,6 +665,74 @@ private:
   void updatePublishSettings(bool publish_geom_updates, bool publish_state_updates, bool publish_transform_updates,
                              bool publish_planning_scene, double publish_planning_scene_hz);
 
+  // build a copy of scene_ and publish it as the latest snapshot, if scene_ changed since the last one
+  void updateSceneSnapshot() const;
+
+  // publish a message of the maintained scene and add it to published_scenes_
+  void publishPlanningSceneMsg(moveit_msgs::msg::PlanningScene::ConstSharedPtr msg);
+
+  // drop the oldest messages from published_scenes_ until it fits the history limits
+  void trimPublishedScenes();
+
+  struct PublishedScene
+  {
+    uint64_t version;
+    moveit_msgs::msg::PlanningScene::ConstSharedPtr msg;
+    std::size_t bytes;
+  };
+
+  /// Recently published messages of the maintained scene and their versions, oldest first
+  std::deque<PublishedScene> published_scenes_;
+
+  /// The maximum number of messages in published_scenes_
+  std::size_t published_scenes_history_size_{ 100 };
+
+  /// The approximate memory used by the messages in published_scenes_ and its upper bound
+  std::size_t published_scenes_bytes_{ 0 };
+  std::size_t published_scenes_history_max_bytes_{ 64 * 1024 * 1024 };
+
+  /// The version of the last published message
+  uint64_t published_scene_version_{ 0 };
+
+  /// Protects published_scenes_, its limits and published_scene_version_
+  mutable std::mutex published_scenes_mutex_;
+
+  /// True when snapshots of the scene are maintained
+  std::atomic<bool> scene_snapshots_enabled_{ false };
+
+  /// The latest snapshot. Only access this through std::atomic_load() and std::atomic_store()
+  mutable std::shared_ptr<const SceneSnapshot> scene_snapshot_;
+
+  /// True when the scene was updated since scene_snapshot_ was built
+  mutable std::atomic<bool> scene_snapshot_outdated_{ true };
+
+  /// Serializes building snapshots, and protects snapshot_octree_
+  mutable std::mutex scene_snapshot_mutex_;
+
+  /// Copy of the monitored octree that is shared by all snapshots taken since the octomap was last updated
+  mutable std::shared_ptr<const octomap::OcTree> snapshot_octree_;
+
+  /// True when the monitored octree changed since snapshot_octree_ was copied
+  mutable std::atomic<bool> snapshot_octree_outdated_{ true };
+
+  /// Updates waiting to be applied by processPendingSceneUpdates(), in order of arrival
+  std::deque<PendingSceneUpdate> pending_scene_updates_;
+
+  /// The number of updates that were merged into later ones since the last batch
+  std::size_t merged_scene_updates_{ 0 };
+
+  /// True while a thread applies pending_scene_updates_
+  bool processing_scene_updates_{ false };
+
+  /// True when the octree of octomap_monitor_ changed since it was last applied
+  bool octomap_update_pending_{ false };
+
+  /// True while a thread applies the octree of octomap_monitor_
+  bool processing_octomap_update_{ false };
+
+  /// Protects the pending updates and the processing flags
+  std::mutex pending_scene_updates_mutex_;
+
   // Lock for state_update_pending_ and dt_state_update_
   std::mutex state_pending_mutex_;
 
@@ -41,14 +41,26 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <thread>
 
 namespace planning_scene_monitor
 {
 using namespace std::chrono_literals;
 
+namespace
+{
+// published time of joints that were never updated
+constexpr int64_t NEVER_UPDATED = std::numeric_limits<int64_t>::min();
+
+// bounds of the polling interval of waitForCurrentState()
+constexpr std::chrono::nanoseconds MIN_WAIT_SLEEP = 50us;
+constexpr std::chrono::nanoseconds MAX_WAIT_SLEEP = 1ms;
+}  // namespace
+
 CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::MiddlewareHandle> middleware_handle,
                                          const moveit::core::RobotModelConstPtr& robot_model,
                                          const std::shared_ptr<tf2_ros::Buffer>& tf_buffer, bool use_sim_time)
@@ -63,6 +75,12 @@ CurrentStateMonitor::CurrentStateMonitor(std::unique_ptr<CurrentStateMonitor::Mi
   , logger_(moveit::getLogger("moveit.ros.current_state_monitor"))
 {
   robot_state_.setToDefaultValues();
+
+  published_positions_ = std::vector<std::atomic<double>>(robot_model_->getVariableCount());
+  published_velocities_ = std::vector<std::atomic<double>>(robot_model_->getVariableCount());
+  published_efforts_ = std::vector<std::atomic<double>>(robot_model_->getVariableCount());
+  published_joint_times_ = std::vector<std::atomic<int64_t>>(robot_model_->getJointModelCount());
+  publishState();
 }
 
 CurrentStateMonitor::CurrentStateMonitor(const rclcpp::Node::SharedPtr& node,
@@ -78,59 +96,138 @@ CurrentStateMonitor::~CurrentStateMonitor()
   stopStateMonitor();
 }
 
+void CurrentStateMonitor::publishState()
+{
+  const uint64_t sequence = published_sequence_.load(std::memory_order_relaxed);
+  published_sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const double* positions = robot_state_.getVariablePositions();
+  for (std::size_t i = 0; i < published_positions_.size(); ++i)
+    published_positions_[i].store(positions[i], std::memory_order_relaxed);
+
+  const bool has_velocities = robot_state_.hasVelocities();
+  published_has_velocities_.store(has_velocities, std::memory_order_relaxed);
+  if (has_velocities)
+  {
+    const double* velocities = robot_state_.getVariableVelocities();
+    for (std::size_t i = 0; i < published_velocities_.size(); ++i)
+      published_velocities_[i].store(velocities[i], std::memory_order_relaxed);
+  }
+
+  const bool has_effort = robot_state_.hasEffort();
+  published_has_effort_.store(has_effort, std::memory_order_relaxed);
+  if (has_effort)
+  {
+    const double* efforts = robot_state_.getVariableEffort();
+    for (std::size_t i = 0; i < published_efforts_.size(); ++i)
+      published_efforts_[i].store(efforts[i], std::memory_order_relaxed);
+  }
+
+  for (const moveit::core::JointModel* joint : robot_model_->getJointModels())
+  {
+    const auto it = joint_time_.find(joint);
+    const int64_t time = it == joint_time_.end() ? NEVER_UPDATED : it->second.nanoseconds();
+    published_joint_times_[joint->getJointIndex()].store(time, std::memory_order_relaxed);
+  }
+  published_state_time_.store(current_state_time_.nanoseconds(), std::memory_order_relaxed);
+
+  published_sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void CurrentStateMonitor::getStateSnapshot(StateSnapshot& snapshot) const
+{
+  snapshot.positions.resize(published_positions_.size());
+  snapshot.joint_times.resize(published_joint_times_.size());
+  while (true)
+  {
+    const uint64_t sequence = published_sequence_.load(std::memory_order_acquire);
+    if (sequence % 2 == 1)
+    {
+      // an update is being written
+      std::this_thread::yield();
+      continue;
+    }
+
+    for (std::size_t i = 0; i < published_positions_.size(); ++i)
+      snapshot.positions[i] = published_positions_[i].load(std::memory_order_relaxed);
+
+    const bool has_velocities = published_has_velocities_.load(std::memory_order_relaxed);
+    snapshot.velocities.resize(has_velocities ? published_velocities_.size() : 0);
+    for (std::size_t i = 0; i < snapshot.velocities.size(); ++i)
+      snapshot.velocities[i] = published_velocities_[i].load(std::memory_order_relaxed);
+
+    const bool has_effort = published_has_effort_.load(std::memory_order_relaxed);
+    snapshot.efforts.resize(has_effort ? published_efforts_.size() : 0);
+    for (std::size_t i = 0; i < snapshot.efforts.size(); ++i)
+      snapshot.efforts[i] = published_efforts_[i].load(std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < published_joint_times_.size(); ++i)
+    {
+      const int64_t time = published_joint_times_[i].load(std::memory_order_relaxed);
+      if (time == NEVER_UPDATED)
+        snapshot.joint_times[i].reset();
+      else
+        snapshot.joint_times[i] = rclcpp::Time(time, RCL_ROS_TIME);
+    }
+    snapshot.time = rclcpp::Time(published_state_time_.load(std::memory_order_relaxed), RCL_ROS_TIME);
+
+    // the copy is consistent if no update was written in the meantime
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (published_sequence_.load(std::memory_order_relaxed) == sequence)
+      return;
+  }
+}
+
 moveit::core::RobotStatePtr CurrentStateMonitor::getCurrentState() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return moveit::core::RobotStatePtr(result);
+  return getCurrentStateAndTime().first;
 }
 
 rclcpp::Time CurrentStateMonitor::getCurrentStateTime() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  return current_state_time_;
+  return rclcpp::Time(published_state_time_.load(std::memory_order_acquire), RCL_ROS_TIME);
 }
 
 std::pair<moveit::core::RobotStatePtr, rclcpp::Time> CurrentStateMonitor::getCurrentStateAndTime() const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  moveit::core::RobotState* result = new moveit::core::RobotState(robot_state_);
-  return std::make_pair(moveit::core::RobotStatePtr(result), current_state_time_);
+  thread_local StateSnapshot snapshot;
+  getStateSnapshot(snapshot);
+
+  auto result = std::make_shared<moveit::core::RobotState>(robot_model_);
+  result->setVariablePositions(snapshot.positions.data());
+  if (!snapshot.velocities.empty())
+    result->setVariableVelocities(snapshot.velocities.data());
+  if (!snapshot.efforts.empty())
+    result->setVariableEffort(snapshot.efforts.data());
+  return std::make_pair(result, snapshot.time);
 }
 
 std::map<std::string, double> CurrentStateMonitor::getCurrentStateValues() const
 {
+  thread_local StateSnapshot snapshot;
+  getStateSnapshot(snapshot);
+
   std::map<std::string, double> m;
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  const double* pos = robot_state_.getVariablePositions();
-  const std::vector<std::string>& names = robot_state_.getVariableNames();
+  const std::vector<std::string>& names = robot_model_->getVariableNames();
   for (std::size_t i = 0; i < names.size(); ++i)
-    m[names[i]] = pos[i];
+    m[names[i]] = snapshot.positions[i];
   return m;
 }
 
 void CurrentStateMonitor::setToCurrentState(moveit::core::RobotState& upd) const
 {
-  std::unique_lock<std::mutex> slock(state_update_lock_);
-  const double* pos = robot_state_.getVariablePositions();
-  upd.setVariablePositions(pos);
+  thread_local StateSnapshot snapshot;
+  getStateSnapshot(snapshot);
+
+  upd.setVariablePositions(snapshot.positions.data());
   if (copy_dynamics_)
   {
-    if (robot_state_.hasVelocities())
-    {
-      const double* vel = robot_state_.getVariableVelocities();
-      upd.setVariableVelocities(vel);
-    }
-    if (robot_state_.hasAccelerations())
-    {
-      const double* acc = robot_state_.getVariableAccelerations();
-      upd.setVariableAccelerations(acc);
-    }
-    if (robot_state_.hasEffort())
-    {
-      const double* eff = robot_state_.getVariableEffort();
-      upd.setVariableEffort(eff);
-    }
+    // accelerations are never received, so they are not copied
+    if (!snapshot.velocities.empty())
+      upd.setVariableVelocities(snapshot.velocities.data());
+    if (!snapshot.efforts.empty())
+      upd.setVariableEffort(snapshot.efforts.data());
   }
 }
 
@@ -149,7 +246,11 @@ void CurrentStateMonitor::startStateMonitor(const std::string& joint_states_topi
 {
   if (!state_monitor_started_ && robot_model_)
   {
-    joint_time_.clear();
+    {
+      std::unique_lock<std::mutex> slock(state_update_lock_);
+      joint_time_.clear();
+      publishState();
+    }
     if (joint_states_topic.empty())
     {
       RCLCPP_ERROR(logger_, "The joint states topic cannot be an empty string");
@@ -201,18 +302,19 @@ bool CurrentStateMonitor::haveCompleteStateHelper(const rclcpp::Time& oldest_all
                                                   std::vector<std::string>* missing_joints) const
 {
   const std::vector<const moveit::core::JointModel*>& active_joints = robot_model_->getActiveJointModels();
-  std::unique_lock<std::mutex> slock(state_update_lock_);
   for (const moveit::core::JointModel* joint : active_joints)
   {
-    std::map<const moveit::core::JointModel*, rclcpp::Time>::const_iterator it = joint_time_.find(joint);
-    if (it == joint_time_.end())
+    // the time stamps of individual joints are read without the sequence lock, they need not be consistent
+    const int64_t joint_time = published_joint_times_[joint->getJointIndex()].load(std::memory_order_acquire);
+    if (joint_time == NEVER_UPDATED)
     {
       RCLCPP_DEBUG(logger_, "Joint '%s' has never been updated", joint->getName().c_str());
     }
-    else if (it->second < oldest_allowed_update_time)
+    else if (rclcpp::Time(joint_time, RCL_ROS_TIME) < oldest_allowed_update_time)
     {
       RCLCPP_DEBUG(logger_, "Joint '%s' was last updated %0.3lf seconds before requested time",
-                   joint->getName().c_str(), (oldest_allowed_update_time - it->second).seconds());
+                   joint->getName().c_str(),
+                   (oldest_allowed_update_time - rclcpp::Time(joint_time, RCL_ROS_TIME)).seconds());
     }
     else
       continue;
@@ -236,27 +338,32 @@ bool CurrentStateMonitor::waitForCurrentState(const rclcpp::Time& t, double wait
   rclcpp::Duration timeout = rclcpp::Duration::from_seconds(wait_time_s);
 
   rclcpp::Clock steady_clock(RCL_STEADY_TIME);
-  std::unique_lock<std::mutex> lock(state_update_lock_);
-  while (current_state_time_ < t)
+  int64_t state_time = notified_state_time_.load(std::memory_order_acquire);
+  auto last_update_wall_time = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds sleep_step = MIN_WAIT_SLEEP;
+  while (rclcpp::Time(state_time, RCL_ROS_TIME) < t)
   {
-    if (use_sim_time_)
+    // poll with a growing interval, and restart with a short one after each update, since the next one is likely close
+    middleware_handle_->sleepFor(sleep_step);
+    sleep_step = std::min(2 * sleep_step, MAX_WAIT_SLEEP);
+    const int64_t latest_state_time = notified_state_time_.load(std::memory_order_acquire);
+    if (latest_state_time != state_time)
     {
-      if (state_update_condition_.wait_for(lock, 100ms) == std::cv_status::timeout)
-      {
-        /* We cannot know if the reason of timeout is slow time or absence of
-         * state messages, warn the user. */
+      state_time = latest_state_time;
+      last_update_wall_time = std::chrono::steady_clock::now();
+      sleep_step = MIN_WAIT_SLEEP;
+    }
+    else if (use_sim_time_ && std::chrono::steady_clock::now() - last_update_wall_time > 100ms)
+    {
+      /* We cannot know if the reason of timeout is slow time or absence of
+       * state messages, warn the user. */
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
-        RCLCPP_WARN_SKIPFIRST_THROTTLE(logger_, steady_clock, 1000,
-                                       "No state update received within 100ms of system clock. "
-                                       "Have been waiting for %fs, timeout is %fs",
-                                       elapsed.seconds(), wait_time_s);
+      RCLCPP_WARN_SKIPFIRST_THROTTLE(logger_, steady_clock, 1000,
+                                     "No state update received within 100ms of system clock. "
+                                     "Have been waiting for %fs, timeout is %fs",
+                                     elapsed.seconds(), wait_time_s);
 #pragma GCC diagnostic pop
-      }
-    }
-    else
-    {
-      state_update_condition_.wait_for(lock, (timeout - elapsed).to_chrono<std::chrono::duration<double>>());
     }
     elapsed = middleware_handle_->now() - start;
     if (elapsed > timeout)
@@ -265,7 +372,7 @@ bool CurrentStateMonitor::waitForCurrentState(const rclcpp::Time& t, double wait
                   "Didn't receive robot state (joint angles) with recent timestamp within "
                   "%f seconds. Requested time %f, but latest received state has time %f.\n"
                   "Check clock synchronization if your are running ROS across multiple machines!",
-                  wait_time_s, t.seconds(), current_state_time_.seconds());
+                  wait_time_s, t.seconds(), rclcpp::Time(state_time, RCL_ROS_TIME).seconds());
       return false;
     }
     if (!middleware_handle_->ok())
@@ -401,6 +508,7 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
         }
       }
     }
+    publishState();
   }
 
   // callbacks, if needed
@@ -411,7 +519,7 @@ void CurrentStateMonitor::jointStateCallback(const sensor_msgs::msg::JointState:
   }
 
   // notify waitForCurrentState() *after* potential update callbacks
-  state_update_condition_.notify_all();
+  notified_state_time_.store(rclcpp::Time(joint_state->header.stamp).nanoseconds(), std::memory_order_release);
 }
 
 void CurrentStateMonitor::updateMultiDofJoints()
@@ -474,6 +582,8 @@ void CurrentStateMonitor::updateMultiDofJoints()
       robot_state_.setJointPositions(joint, new_values.data());
       update = true;
     }
+    if (update)
+      publishState();
   }
 
   // callbacks, if needed
@@ -485,12 +595,6 @@ void CurrentStateMonitor::updateMultiDofJoints()
     for (JointStateUpdateCallback& update_callback : update_callbacks_)
       update_callback(joint_state);
   }
-
-  if (update)
-  {
-    // notify waitForCurrentState() *after* potential update callbacks
-    state_update_condition_.notify_all();
-  }
 }
 
 // Copied from https://github.com/ros2/geometry2/blob/ros2/tf2_ros/src/transform_listener.cpp
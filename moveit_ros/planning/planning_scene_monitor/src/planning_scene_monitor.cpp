@@ -47,7 +47,11 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
 #include <fmt/format.h>
+#include <geometric_shapes/shapes.h>
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <utility>
 
 #include <std_msgs/msg/string.hpp>
 
@@ -408,6 +412,7 @@ void PlanningSceneMonitor::stopPublishingPlanningScene()
     copy->join();
     monitorDiffs(false);
     planning_scene_publisher_.reset();
+    planning_scene_version_publisher_.reset();
     RCLCPP_INFO(logger_, "Stopped publishing maintained planning scene.");
   }
 }
@@ -426,6 +431,8 @@ void PlanningSceneMonitor::startPublishingPlanningScene(SceneUpdateType update_t
   if (scene_)
   {
     planning_scene_publisher_ = pnode_->create_publisher<moveit_msgs::msg::PlanningScene>(planning_scene_topic, 100);
+    planning_scene_version_publisher_ =
+        pnode_->create_publisher<std_msgs::msg::UInt64>(planning_scene_topic + "_version", 100);
     RCLCPP_INFO(logger_, "Publishing maintained planning scene on '%s'", planning_scene_topic.c_str());
     monitorDiffs(true);
     publish_planning_scene_ = std::make_unique<std::thread>([this] { scenePublishingThread(); });
@@ -449,8 +456,8 @@ void PlanningSceneMonitor::scenePublishingThread()
         lock = octomap_monitor_->getOcTreePtr()->reading();
       scene_->getPlanningSceneMsg(msg);
     }
-    planning_scene_publisher_->publish(msg);
-    RCLCPP_DEBUG(logger_, "Published the full planning scene: '%s'", msg.name.c_str());
+    RCLCPP_DEBUG(logger_, "Publishing the full planning scene: '%s'", msg.name.c_str());
+    publishPlanningSceneMsg(std::make_shared<const moveit_msgs::msg::PlanningScene>(std::move(msg)));
   }
 
   do
@@ -476,7 +483,8 @@ void PlanningSceneMonitor::scenePublishingThread()
             collision_detection::OccMapTree::ReadLock lock;
             if (octomap_monitor_)
               lock = octomap_monitor_->getOcTreePtr()->reading();
-            scene_->getPlanningSceneDiffMsg(msg);
+            // subscribers receive every diff in order, so moved objects do not need to be sent with their geometry
+            scene_->getPlanningSceneDiffMsg(msg, true);
             if (new_scene_update_ == UPDATE_STATE)
             {
               msg.robot_state.attached_collision_objects.clear();
@@ -519,14 +527,124 @@ void PlanningSceneMonitor::scenePublishingThread()
     }
     if (publish_msg)
     {
-      planning_scene_publisher_->publish(msg);
       if (is_full)
-        RCLCPP_DEBUG(logger_, "Published full planning scene: '%s'", msg.name.c_str());
+        RCLCPP_DEBUG(logger_, "Publishing full planning scene: '%s'", msg.name.c_str());
+      publishPlanningSceneMsg(std::make_shared<const moveit_msgs::msg::PlanningScene>(std::move(msg)));
       rate.sleep();
     }
   } while (publish_planning_scene_);
 }
 
+namespace
+{
+// Approximate memory used by a planning scene message, dominated by octomaps and meshes
+std::size_t estimateMessageBytes(const moveit_msgs::msg::PlanningScene& msg)
+{
+  std::size_t bytes = sizeof(msg) + msg.world.octomap.octomap.data.size();
+  const auto add_object = [&bytes](const moveit_msgs::msg::CollisionObject& object) {
+    bytes += sizeof(object) + object.primitives.size() * sizeof(shape_msgs::msg::SolidPrimitive) +
+             object.planes.size() * sizeof(shape_msgs::msg::Plane);
+    for (const shape_msgs::msg::Mesh& mesh : object.meshes)
+    {
+      bytes += sizeof(mesh) + mesh.vertices.size() * sizeof(geometry_msgs::msg::Point) +
+               mesh.triangles.size() * sizeof(shape_msgs::msg::MeshTriangle);
+    }
+  };
+  for (const moveit_msgs::msg::CollisionObject& object : msg.world.collision_objects)
+    add_object(object);
+  for (const moveit_msgs::msg::AttachedCollisionObject& object : msg.robot_state.attached_collision_objects)
+    add_object(object.object);
+  return bytes;
+}
+}  // namespace
+
+void PlanningSceneMonitor::publishPlanningSceneMsg(moveit_msgs::msg::PlanningScene::ConstSharedPtr msg)
+{
+  planning_scene_publisher_->publish(*msg);
+
+  std_msgs::msg::UInt64 version_msg;
+  {
+    const std::size_t bytes = estimateMessageBytes(*msg);
+    std::scoped_lock lock(published_scenes_mutex_);
+    version_msg.data = ++published_scene_version_;
+    published_scenes_.push_back(PublishedScene{ version_msg.data, std::move(msg), bytes });
+    published_scenes_bytes_ += bytes;
+    trimPublishedScenes();
+  }
+  planning_scene_version_publisher_->publish(version_msg);
+}
+
+void PlanningSceneMonitor::trimPublishedScenes()
+{
+  while (!published_scenes_.empty() && (published_scenes_.size() > published_scenes_history_size_ ||
+                                        published_scenes_bytes_ > published_scenes_history_max_bytes_))
+  {
+    published_scenes_bytes_ -= published_scenes_.front().bytes;
+    published_scenes_.pop_front();
+  }
+}
+
+uint64_t PlanningSceneMonitor::getPublishedSceneVersion() const
+{
+  std::scoped_lock lock(published_scenes_mutex_);
+  return published_scene_version_;
+}
+
+bool PlanningSceneMonitor::getPublishedSceneUpdates(
+    uint64_t version, std::vector<moveit_msgs::msg::PlanningScene::ConstSharedPtr>& updates,
+    uint64_t& latest_version) const
+{
+  std::scoped_lock lock(published_scenes_mutex_);
+  updates.clear();
+  latest_version = published_scene_version_;
+  if (version == published_scene_version_)
+    return true;
+  if (version > published_scene_version_ || published_scenes_.empty())
+  {
+    RCLCPP_ERROR_STREAM(logger_, "Cannot provide planning scene updates since unknown version " << version);
+    return false;
+  }
+
+  // versions in the history are consecutive, up to published_scene_version_
+  std::size_t first = published_scenes_.size();
+  if (published_scenes_.front().version <= version + 1)
+    first = version + 1 - published_scenes_.front().version;
+
+  // a full scene replaces everything published before it
+  for (std::size_t i = published_scenes_.size(); i-- > 0 && (first == published_scenes_.size() || i > first);)
+  {
+    if (!published_scenes_[i].msg->is_diff)
+    {
+      first = i;
+      break;
+    }
+  }
+
+  if (first == published_scenes_.size())
+  {
+    RCLCPP_DEBUG_STREAM(logger_, "The history of published planning scenes does not reach back to version " << version);
+    return false;
+  }
+
+  for (std::size_t i = first; i < published_scenes_.size(); ++i)
+    updates.push_back(published_scenes_[i].msg);
+  return true;
+}
+
+void PlanningSceneMonitor::setPublishedSceneHistorySize(std::size_t size)
+{
+  std::scoped_lock lock(published_scenes_mutex_);
+  published_scenes_history_size_ = size;
+  trimPublishedScenes();
+}
+
+void PlanningSceneMonitor::setPublishedSceneHistoryMemoryLimit(std::size_t bytes)
+{
+  std::scoped_lock lock(published_scenes_mutex_);
+  published_scenes_history_max_bytes_ = bytes;
+  trimPublishedScenes();
+}
+
 void PlanningSceneMonitor::getMonitoredTopics(std::vector<std::string>& topics) const
 {
   // TODO(anasarrak): Do we need this for ROS2?
@@ -572,8 +690,81 @@ bool PlanningSceneMonitor::updatesScene(const planning_scene::PlanningSceneConst
   return sceneIsParentOf(scene_const_, scene.get());
 }
 
+void PlanningSceneMonitor::setSceneSnapshotsEnabled(bool flag)
+{
+  std::scoped_lock lock(scene_snapshot_mutex_);
+  scene_snapshots_enabled_ = flag;
+  scene_snapshot_outdated_ = true;
+  if (!flag)
+  {
+    std::atomic_store(&scene_snapshot_, std::shared_ptr<const SceneSnapshot>());
+    snapshot_octree_.reset();
+    snapshot_octree_outdated_ = true;
+  }
+}
+
+PlanningSceneMonitor::SceneSnapshot PlanningSceneMonitor::getSceneSnapshot() const
+{
+  if (!scene_snapshots_enabled_)
+    return SceneSnapshot();
+  if (scene_snapshot_outdated_)
+    updateSceneSnapshot();
+  const std::shared_ptr<const SceneSnapshot> snapshot = std::atomic_load(&scene_snapshot_);
+  return snapshot ? *snapshot : SceneSnapshot();
+}
+
+void PlanningSceneMonitor::updateSceneSnapshot() const
+{
+  std::scoped_lock lock(scene_snapshot_mutex_);
+  // another reader may have built the snapshot while this one waited for the lock. Updates after this point mark the
+  // new snapshot as outdated again.
+  if (!scene_snapshots_enabled_ || !scene_snapshot_outdated_.exchange(false))
+    return;
+
+  planning_scene::PlanningScenePtr scene;
+  {
+    std::shared_lock<std::shared_mutex> slock(scene_update_mutex_);
+    if (!scene_)
+    {
+      scene_snapshot_outdated_ = true;
+      return;
+    }
+    scene = planning_scene::PlanningScene::clone(scene_);
+  }
+
+  // The clone shares the octree that is updated in place by the octomap monitor. Replace it by a copy, which is shared
+  // by all snapshots until the monitored octree changes.
+  if (octomap_monitor_)
+  {
+    const collision_detection::World::ObjectConstPtr map = scene->getWorld()->getObject(scene->OCTOMAP_NS);
+    if (map && map->shapes_.size() == 1)
+    {
+      const auto* shape = static_cast<const shapes::OcTree*>(map->shapes_[0].get());
+      const collision_detection::OccMapTreePtr& tree = octomap_monitor_->getOcTreePtr();
+      if (shape->octree == tree)
+      {
+        if (!snapshot_octree_ || snapshot_octree_outdated_.exchange(false))
+        {
+          auto read_lock = tree->reading();
+          snapshot_octree_ = std::make_shared<const octomap::OcTree>(*tree);
+        }
+        scene->processOctomapPtr(snapshot_octree_, map->shape_poses_[0]);
+      }
+    }
+  }
+
+  auto snapshot = std::make_shared<SceneSnapshot>();
+  const std::shared_ptr<const SceneSnapshot> previous = std::atomic_load(&scene_snapshot_);
+  snapshot->version = previous ? previous->version + 1 : 1;
+  snapshot->scene = scene;
+  std::atomic_store(&scene_snapshot_, std::shared_ptr<const SceneSnapshot>(snapshot));
+}
+
 void PlanningSceneMonitor::triggerSceneUpdateEvent(SceneUpdateType update_type)
 {
+  if (update_type != UPDATE_NONE)
+    scene_snapshot_outdated_ = true;
+
   // do not modify update functions while we are calling them
   std::scoped_lock lock(update_lock_);
 
@@ -698,6 +889,7 @@ void PlanningSceneMonitor::clearOctomap()
       octomap_monitor_->getOcTreePtr()->lockWrite();
       octomap_monitor_->getOcTreePtr()->clear();
       octomap_monitor_->getOcTreePtr()->unlockWrite();
+      snapshot_octree_outdated_ = true;
     }
     else
     {
@@ -1275,7 +1467,7 @@ void PlanningSceneMonitor::startWorldGeometryMonitor(const std::string& collisio
   {
     collision_object_subscriber_ = pnode_->create_subscription<moveit_msgs::msg::CollisionObject>(
         collision_objects_topic, rclcpp::SystemDefaultsQoS(),
-        [this](const moveit_msgs::msg::CollisionObject::ConstSharedPtr& obj) { processCollisionObjectMsg(obj); });
+        [this](const moveit_msgs::msg::CollisionObject::ConstSharedPtr& obj) { queueCollisionObjectUpdate(obj); });
     RCLCPP_INFO(logger_, "Listening to '%s'", collision_objects_topic.c_str());
   }
 
@@ -1358,7 +1550,7 @@ void PlanningSceneMonitor::startStateMonitor(const std::string& joint_states_top
       attached_collision_object_subscriber_ = pnode_->create_subscription<moveit_msgs::msg::AttachedCollisionObject>(
           attached_objects_topic, rclcpp::SystemDefaultsQoS(),
           [this](const moveit_msgs::msg::AttachedCollisionObject::ConstSharedPtr& obj) {
-            processAttachedCollisionObjectMsg(obj);
+            queueAttachedCollisionObjectUpdate(obj);
           });
       RCLCPP_INFO(logger_, "Listening to '%s' for attached collision objects",
                   attached_collision_object_subscriber_->get_topic_name());
@@ -1406,7 +1598,7 @@ void PlanningSceneMonitor::onStateUpdate(const sensor_msgs::msg::JointState::Con
   }
   // run the state update with state_pending_mutex_ unlocked
   if (update)
-    updateSceneWithCurrentState();
+    queueStateUpdate();
 }
 
 void PlanningSceneMonitor::stateUpdateTimerCallback()
@@ -1434,7 +1626,7 @@ void PlanningSceneMonitor::stateUpdateTimerCallback()
     // run the state update with state_pending_mutex_ unlocked
     if (update)
     {
-      updateSceneWithCurrentState();
+      queueStateUpdate();
       RCLCPP_DEBUG(logger_, "performPendingStateUpdate done");
     }
   }
@@ -1445,23 +1637,221 @@ void PlanningSceneMonitor::octomapUpdateCallback()
   if (!octomap_monitor_)
     return;
 
-  updateFrameTransforms();
+  queueOctomapUpdate();
+}
+
+void PlanningSceneMonitor::applyOctomapUpdate()
+{
+  last_update_time_ = rclcpp::Clock().now();
+  octomap_monitor_->getOcTreePtr()->lockRead();
+  try
   {
-    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
-    last_update_time_ = rclcpp::Clock().now();
-    octomap_monitor_->getOcTreePtr()->lockRead();
-    try
+    scene_->processOctomapPtr(octomap_monitor_->getOcTreePtr(), Eigen::Isometry3d::Identity());
+    octomap_monitor_->getOcTreePtr()->unlockRead();
+    snapshot_octree_outdated_ = true;
+  }
+  catch (...)
+  {
+    octomap_monitor_->getOcTreePtr()->unlockRead();  // unlock and rethrow
+    throw;
+  }
+}
+
+void PlanningSceneMonitor::queueStateUpdate()
+{
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    // the state is read from current_state_monitor_ when applied, so one pending update covers any number of messages
+    // that arrive after the last object update
+    const bool last_is_state = !pending_scene_updates_.empty() && !pending_scene_updates_.back().collision_object &&
+                               !pending_scene_updates_.back().attached_collision_object;
+    if (last_is_state)
+      ++merged_scene_updates_;
+    else
+      pending_scene_updates_.emplace_back();
+  }
+  processPendingSceneUpdates();
+}
+
+void PlanningSceneMonitor::queueOctomapUpdate()
+{
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    // the octree is read from octomap_monitor_ when applied, so one pending update covers any number of updates
+    octomap_update_pending_ = true;
+    if (processing_octomap_update_)
+      return;
+    processing_octomap_update_ = true;
+  }
+
+  try
+  {
+    while (true)
     {
-      scene_->processOctomapPtr(octomap_monitor_->getOcTreePtr(), Eigen::Isometry3d::Identity());
-      octomap_monitor_->getOcTreePtr()->unlockRead();
+      {
+        std::scoped_lock lock(pending_scene_updates_mutex_);
+        if (!octomap_update_pending_)
+        {
+          processing_octomap_update_ = false;
+          return;
+        }
+        octomap_update_pending_ = false;
+      }
+      if (!scene_)
+        continue;
+
+      updateFrameTransforms();
+      {
+        std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+        applyOctomapUpdate();
+      }
+      triggerSceneUpdateEvent(UPDATE_GEOMETRY);
     }
-    catch (...)
+  }
+  catch (...)
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    processing_octomap_update_ = false;
+    throw;
+  }
+}
+
+void PlanningSceneMonitor::queueCollisionObjectUpdate(const moveit_msgs::msg::CollisionObject::ConstSharedPtr& object)
+{
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    std::deque<PendingSceneUpdate>& updates = pending_scene_updates_;
+
+    // A move only sets the object pose, so it supersedes a pending move of the same object. Look for one, but do not
+    // reorder across other pending updates of that object or across updates that affect all objects.
+    if (object->operation == moveit_msgs::msg::CollisionObject::MOVE && !object->id.empty())
     {
-      octomap_monitor_->getOcTreePtr()->unlockRead();  // unlock and rethrow
-      throw;
+      for (auto it = updates.rbegin(); it != updates.rend(); ++it)
+      {
+        if (!it->collision_object && !it->attached_collision_object)
+          continue;  // the moved pose does not depend on a state that is applied before it
+        const std::string& id =
+            it->collision_object ? it->collision_object->id : it->attached_collision_object->object.id;
+        if (id.empty())
+          break;
+        if (id != object->id)
+          continue;
+        if (it->collision_object && it->collision_object->operation == moveit_msgs::msg::CollisionObject::MOVE)
+        {
+          updates.erase(std::next(it).base());
+          ++merged_scene_updates_;
+        }
+        break;
+      }
     }
+    updates.push_back({ object, nullptr });
+  }
+  processPendingSceneUpdates();
+}
+
+void PlanningSceneMonitor::queueAttachedCollisionObjectUpdate(
+    const moveit_msgs::msg::AttachedCollisionObject::ConstSharedPtr& object)
+{
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    pending_scene_updates_.push_back({ nullptr, object });
+  }
+  processPendingSceneUpdates();
+}
+
+void PlanningSceneMonitor::processPendingSceneUpdates()
+{
+  {
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    // if another thread is applying updates, it will also apply the ones queued by this thread
+    if (processing_scene_updates_)
+      return;
+    processing_scene_updates_ = true;
+  }
+
+  std::deque<PendingSceneUpdate> updates;
+  try
+  {
+    while (true)
+    {
+      std::size_t merged = 0;
+      {
+        std::scoped_lock lock(pending_scene_updates_mutex_);
+        if (pending_scene_updates_.empty())
+        {
+          processing_scene_updates_ = false;
+          return;
+        }
+        std::swap(updates, pending_scene_updates_);
+        merged = std::exchange(merged_scene_updates_, 0);
+      }
+      RCLCPP_DEBUG(logger_, "Applying %zu scene updates (%zu merged)", updates.size(), merged);
+      applySceneUpdates(updates);
+    }
+  }
+  catch (...)
+  {
+    // the update that failed is dropped, the ones after it are applied with the next batch
+    std::scoped_lock lock(pending_scene_updates_mutex_);
+    pending_scene_updates_.insert(pending_scene_updates_.begin(), std::make_move_iterator(updates.begin()),
+                                  std::make_move_iterator(updates.end()));
+    processing_scene_updates_ = false;
+    throw;
   }
-  triggerSceneUpdateEvent(UPDATE_GEOMETRY);
+}
+
+void PlanningSceneMonitor::applySceneUpdates(std::deque<PendingSceneUpdate>& updates)
+{
+  if (!scene_)
+  {
+    updates.clear();
+    return;
+  }
+
+  const auto is_state = [](const PendingSceneUpdate& update) {
+    return !update.collision_object && !update.attached_collision_object;
+  };
+  if (current_state_monitor_ && std::any_of(updates.begin(), updates.end(), is_state))
+    warnIfStateIncomplete();
+  if (!std::all_of(updates.begin(), updates.end(), is_state))
+    updateFrameTransforms();
+
+  int update_type = UPDATE_NONE;
+  try
+  {
+    std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
+    while (!updates.empty())
+    {
+      const PendingSceneUpdate update = std::move(updates.front());
+      updates.pop_front();
+      if (is_state(update))
+      {
+        if (current_state_monitor_)
+        {
+          applyCurrentState();
+          update_type |= UPDATE_STATE;
+        }
+        continue;
+      }
+
+      last_update_time_ = rclcpp::Clock().now();
+      const bool applied = update.collision_object ?
+                               scene_->processCollisionObjectMsg(*update.collision_object) :
+                               scene_->processAttachedCollisionObjectMsg(*update.attached_collision_object);
+      if (applied)
+        update_type |= UPDATE_GEOMETRY;
+    }
+  }
+  catch (...)
+  {
+    // announce the updates that were applied before the failure
+    if (update_type != UPDATE_NONE)
+      triggerSceneUpdateEvent(static_cast<SceneUpdateType>(update_type));
+    throw;
+  }
+
+  if (update_type != UPDATE_NONE)
+    triggerSceneUpdateEvent(static_cast<SceneUpdateType>(update_type));
 }
 
 void PlanningSceneMonitor::setStateUpdateFrequency(double hz)
@@ -1495,33 +1885,18 @@ void PlanningSceneMonitor::setStateUpdateFrequency(double hz)
 
 void PlanningSceneMonitor::updateSceneWithCurrentState()
 {
-  rclcpp::Time time = node_->now();
-  rclcpp::Clock steady_clock = rclcpp::Clock(RCL_STEADY_TIME);
   if (current_state_monitor_)
   {
-    std::vector<std::string> missing;
-    if (!current_state_monitor_->haveCompleteState(missing) &&
-        (time - current_state_monitor_->getMonitorStartTime()).seconds() > 1.0)
-    {
-      std::string missing_str = fmt::format("{}", fmt::join(missing, ", "));
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-      RCLCPP_WARN_THROTTLE(logger_, steady_clock, 1000, "The complete state of the robot is not yet known.  Missing %s",
-                           missing_str.c_str());
-#pragma GCC diagnostic pop
-    }
-
+    warnIfStateIncomplete();
     {
       std::unique_lock<std::shared_mutex> ulock(scene_update_mutex_);
-      last_update_time_ = last_robot_motion_time_ = current_state_monitor_->getCurrentStateTime();
-      RCLCPP_DEBUG(logger_, "robot state update %f", fmod(last_robot_motion_time_.seconds(), 10.));
-      current_state_monitor_->setToCurrentState(scene_->getCurrentStateNonConst());
-      scene_->getCurrentStateNonConst().update();  // compute all transforms
+      applyCurrentState();
     }
     triggerSceneUpdateEvent(UPDATE_STATE);
   }
   else
   {
+    rclcpp::Clock steady_clock = rclcpp::Clock(RCL_STEADY_TIME);
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
     RCLCPP_ERROR_THROTTLE(logger_, steady_clock, 1000,
@@ -1530,6 +1905,31 @@ void PlanningSceneMonitor::updateSceneWithCurrentState()
   }
 }
 
+void PlanningSceneMonitor::warnIfStateIncomplete()
+{
+  rclcpp::Time time = node_->now();
+  rclcpp::Clock steady_clock = rclcpp::Clock(RCL_STEADY_TIME);
+  std::vector<std::string> missing;
+  if (!current_state_monitor_->haveCompleteState(missing) &&
+      (time - current_state_monitor_->getMonitorStartTime()).seconds() > 1.0)
+  {
+    std::string missing_str = fmt::format("{}", fmt::join(missing, ", "));
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    RCLCPP_WARN_THROTTLE(logger_, steady_clock, 1000, "The complete state of the robot is not yet known.  Missing %s",
+                         missing_str.c_str());
+#pragma GCC diagnostic pop
+  }
+}
+
+void PlanningSceneMonitor::applyCurrentState()
+{
+  last_update_time_ = last_robot_motion_time_ = current_state_monitor_->getCurrentStateTime();
+  RCLCPP_DEBUG(logger_, "robot state update %f", fmod(last_robot_motion_time_.seconds(), 10.));
+  current_state_monitor_->setToCurrentState(scene_->getCurrentStateNonConst());
+  scene_->getCurrentStateNonConst().update();  // compute all transforms
+}
+
 void PlanningSceneMonitor::addUpdateCallback(const std::function<void(SceneUpdateType)>& fn)
 {
   std::scoped_lock lock(update_lock_);
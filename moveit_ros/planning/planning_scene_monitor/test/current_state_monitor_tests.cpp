@@ -199,6 +199,48 @@ TEST(CurrentStateMonitorTests, WaitForCompleteStateWaits)
   EXPECT_NEAR(nanoseconds_slept.count(), 1e+9, 1e3);
 }
 
+TEST(CurrentStateMonitorTests, StateSnapshotTest)
+{
+  auto mock_middleware_handle = std::make_unique<MockMiddlewareHandle>();
+  planning_scene_monitor::JointStateUpdateCallback joint_state_callback;
+  ON_CALL(*mock_middleware_handle, createJointStateSubscription)
+      .WillByDefault(testing::SaveArg<1>(&joint_state_callback));
+
+  // GIVEN a CurrentStateMonitor that is started
+  moveit::core::RobotModelPtr robot_model = moveit::core::loadTestingRobotModel("panda");
+  planning_scene_monitor::CurrentStateMonitor current_state_monitor{
+    std::move(mock_middleware_handle), robot_model,
+    std::make_shared<tf2_ros::Buffer>(std::make_shared<rclcpp::Clock>()), false
+  };
+  current_state_monitor.startStateMonitor();
+  ASSERT_TRUE(joint_state_callback);
+
+  // WHEN a joint state is received
+  auto joint_state = std::make_shared<sensor_msgs::msg::JointState>();
+  joint_state->header.stamp = rclcpp::Time(2, 0, RCL_ROS_TIME);
+  joint_state->name = { "panda_joint1" };
+  joint_state->position = { 0.5 };
+  joint_state_callback(joint_state);
+
+  // THEN we expect the snapshot to contain its value and time stamps
+  planning_scene_monitor::CurrentStateMonitor::StateSnapshot snapshot;
+  current_state_monitor.getStateSnapshot(snapshot);
+  const moveit::core::JointModel* joint1 = robot_model->getJointModel("panda_joint1");
+  const moveit::core::JointModel* joint2 = robot_model->getJointModel("panda_joint2");
+  EXPECT_EQ(snapshot.positions[joint1->getFirstVariableIndex()], 0.5);
+  ASSERT_TRUE(snapshot.joint_times[joint1->getJointIndex()].has_value());
+  EXPECT_EQ(snapshot.joint_times[joint1->getJointIndex()]->seconds(), 2.0);
+  EXPECT_FALSE(snapshot.joint_times[joint2->getJointIndex()].has_value());
+  EXPECT_EQ(snapshot.time.seconds(), 2.0);
+  EXPECT_TRUE(snapshot.velocities.empty());
+
+  // THEN we expect the other accessors to agree
+  EXPECT_EQ(current_state_monitor.getCurrentState()->getVariablePosition("panda_joint1"), 0.5);
+  EXPECT_EQ(current_state_monitor.getCurrentStateTime().seconds(), 2.0);
+  EXPECT_FALSE(current_state_monitor.haveCompleteState());
+  EXPECT_TRUE(current_state_monitor.waitForCurrentState(rclcpp::Time(1, 0, RCL_ROS_TIME), 0.0));
+}
+
 int main(int argc, char** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -46,6 +46,8 @@
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/robot_state/conversions.h>
 
+#include <mutex>
+
 class PlanningSceneMonitorTest : public ::testing::Test
 {
 public:
@@ -144,6 +146,253 @@ TEST_F(PlanningSceneMonitorTest, UpdateTypes)
   TRIGGERS_UPDATE(msg, UpdateType::UPDATE_SCENE);
 }
 
+TEST_F(PlanningSceneMonitorTest, SceneSnapshots)
+{
+  EXPECT_FALSE(planning_scene_monitor_->getSceneSnapshot().scene);
+
+  planning_scene_monitor_->setSceneSnapshotsEnabled(true);
+  const auto first = planning_scene_monitor_->getSceneSnapshot();
+  ASSERT_TRUE(first.scene);
+  EXPECT_EQ(first.version, 1u);
+  EXPECT_FALSE(planning_scene_monitor_->updatesScene(first.scene));
+
+  // a scene update publishes a new snapshot, and leaves the previous one untouched
+  moveit_msgs::msg::PlanningScene msg;
+  msg.is_diff = msg.robot_state.is_diff = true;
+  moveit_msgs::msg::CollisionObject collision_object;
+  collision_object.header.frame_id = "base_link";
+  collision_object.id = "object";
+  collision_object.operation = moveit_msgs::msg::CollisionObject::ADD;
+  collision_object.pose.orientation.w = 1.0;
+  collision_object.primitives.emplace_back();
+  collision_object.primitives.back().type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  collision_object.primitives.back().dimensions = { 1.0 };
+  msg.world.collision_objects.emplace_back(collision_object);
+  planning_scene_monitor_->newPlanningSceneMessage(msg);
+
+  const auto second = planning_scene_monitor_->getSceneSnapshot();
+  ASSERT_TRUE(second.scene);
+  EXPECT_EQ(second.version, 2u);
+  EXPECT_TRUE(second.scene->getWorld()->hasObject("object"));
+  EXPECT_FALSE(first.scene->getWorld()->hasObject("object"));
+
+  // an empty diff does not change the scene
+  msg.world.collision_objects.clear();
+  planning_scene_monitor_->newPlanningSceneMessage(msg);
+  EXPECT_EQ(planning_scene_monitor_->getSceneSnapshot().version, 2u);
+
+  // updates only mark the snapshot as outdated, so they can be announced while the scene is locked for writing
+  {
+    planning_scene_monitor::LockedPlanningSceneRW locked_scene(planning_scene_monitor_);
+    locked_scene->getWorldNonConst()->removeObject("object");
+    planning_scene_monitor_->triggerSceneUpdateEvent(UpdateType::UPDATE_GEOMETRY);
+    planning_scene_monitor_->triggerSceneUpdateEvent(UpdateType::UPDATE_GEOMETRY);
+  }
+  const auto third = planning_scene_monitor_->getSceneSnapshot();
+  EXPECT_EQ(third.version, 3u);
+  EXPECT_FALSE(third.scene->getWorld()->hasObject("object"));
+  EXPECT_TRUE(second.scene->getWorld()->hasObject("object"));
+  // and the snapshot is only rebuilt when the scene changed
+  EXPECT_EQ(planning_scene_monitor_->getSceneSnapshot().scene, third.scene);
+
+  planning_scene_monitor_->setSceneSnapshotsEnabled(false);
+  EXPECT_FALSE(planning_scene_monitor_->getSceneSnapshot().scene);
+}
+
+TEST_F(PlanningSceneMonitorTest, PublishedSceneUpdates)
+{
+  std::mutex versions_mutex;
+  std::vector<uint64_t> received_versions;
+  const auto version_subscriber = test_node_->create_subscription<std_msgs::msg::UInt64>(
+      std::string(planning_scene_monitor::PlanningSceneMonitor::MONITORED_PLANNING_SCENE_TOPIC) + "_version", 100,
+      [&](const std_msgs::msg::UInt64::ConstSharedPtr& msg) {
+        std::scoped_lock lock(versions_mutex);
+        received_versions.push_back(msg->data);
+      });
+
+  planning_scene_monitor_->setPlanningScenePublishingFrequency(100.0);
+  planning_scene_monitor_->startPublishingPlanningScene(UpdateType::UPDATE_GEOMETRY);
+
+  const auto wait_for_version = [this](uint64_t version) {
+    for (std::size_t i = 0; i < 500 && planning_scene_monitor_->getPublishedSceneVersion() < version; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return planning_scene_monitor_->getPublishedSceneVersion() >= version;
+  };
+  // the full scene is published first
+  ASSERT_TRUE(wait_for_version(1));
+
+  moveit_msgs::msg::PlanningScene msg;
+  msg.is_diff = msg.robot_state.is_diff = true;
+  moveit_msgs::msg::CollisionObject collision_object;
+  collision_object.header.frame_id = "base_link";
+  collision_object.id = "object";
+  collision_object.operation = moveit_msgs::msg::CollisionObject::ADD;
+  collision_object.pose.orientation.w = 1.0;
+  collision_object.primitives.emplace_back();
+  collision_object.primitives.back().type = shape_msgs::msg::SolidPrimitive::SPHERE;
+  collision_object.primitives.back().dimensions = { 1.0 };
+  msg.world.collision_objects.emplace_back(collision_object);
+  planning_scene_monitor_->newPlanningSceneMessage(msg);
+  ASSERT_TRUE(wait_for_version(2));
+
+  // moving the object publishes it without its geometry
+  msg.world.collision_objects[0].operation = moveit_msgs::msg::CollisionObject::MOVE;
+  msg.world.collision_objects[0].primitives.clear();
+  msg.world.collision_objects[0].pose.position.x = 1.0;
+  planning_scene_monitor_->newPlanningSceneMessage(msg);
+  ASSERT_TRUE(wait_for_version(3));
+  planning_scene_monitor_->stopPublishingPlanningScene();
+
+  // the version of every message is published along with it
+  for (std::size_t i = 0; i < 500; ++i)
+  {
+    {
+      std::scoped_lock lock(versions_mutex);
+      if (received_versions.size() >= 3)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  {
+    std::scoped_lock lock(versions_mutex);
+    EXPECT_EQ(received_versions, std::vector<uint64_t>({ 1, 2, 3 }));
+  }
+
+  std::vector<moveit_msgs::msg::PlanningScene::ConstSharedPtr> updates;
+  uint64_t latest_version = 0;
+
+  // a new subscriber starts from the full scene
+  ASSERT_TRUE(planning_scene_monitor_->getPublishedSceneUpdates(0, updates, latest_version));
+  ASSERT_EQ(updates.size(), 3u);
+  EXPECT_FALSE(updates[0]->is_diff);
+  EXPECT_TRUE(updates[1]->is_diff);
+  EXPECT_TRUE(updates[2]->is_diff);
+  EXPECT_EQ(latest_version, 3u);
+
+  // a subscriber that missed the last updates only gets the diffs
+  ASSERT_TRUE(planning_scene_monitor_->getPublishedSceneUpdates(1, updates, latest_version));
+  ASSERT_EQ(updates.size(), 2u);
+  ASSERT_EQ(updates[0]->world.collision_objects.size(), 1u);
+  EXPECT_EQ(updates[0]->world.collision_objects[0].id, "object");
+  EXPECT_EQ(updates[0]->world.collision_objects[0].primitives.size(), 1u);
+  ASSERT_EQ(updates[1]->world.collision_objects.size(), 1u);
+  EXPECT_EQ(updates[1]->world.collision_objects[0].operation, moveit_msgs::msg::CollisionObject::MOVE);
+  EXPECT_TRUE(updates[1]->world.collision_objects[0].primitives.empty());
+
+  // nothing is missing for an up to date subscriber
+  ASSERT_TRUE(planning_scene_monitor_->getPublishedSceneUpdates(3, updates, latest_version));
+  EXPECT_TRUE(updates.empty());
+
+  // the history cannot bring a subscriber from a version it does not contain
+  planning_scene_monitor_->setPublishedSceneHistorySize(1);
+  EXPECT_FALSE(planning_scene_monitor_->getPublishedSceneUpdates(0, updates, latest_version));
+  EXPECT_FALSE(planning_scene_monitor_->getPublishedSceneUpdates(4, updates, latest_version));
+  ASSERT_TRUE(planning_scene_monitor_->getPublishedSceneUpdates(2, updates, latest_version));
+  EXPECT_EQ(updates.size(), 1u);
+
+  // messages that exceed the memory limit are dropped from the history
+  planning_scene_monitor_->setPublishedSceneHistoryMemoryLimit(0);
+  EXPECT_FALSE(planning_scene_monitor_->getPublishedSceneUpdates(2, updates, latest_version));
+  EXPECT_TRUE(planning_scene_monitor_->getPublishedSceneUpdates(3, updates, latest_version));
+}
+
+namespace
+{
+moveit_msgs::msg::CollisionObject::ConstSharedPtr makeBox(const std::string& id, const std::string& frame_id,
+                                                          uint8_t operation, double x = 0.0)
+{
+  auto object = std::make_shared<moveit_msgs::msg::CollisionObject>();
+  object->header.frame_id = frame_id;
+  object->id = id;
+  object->operation = operation;
+  object->pose.position.x = x;
+  object->pose.orientation.w = 1.0;
+  if (operation == moveit_msgs::msg::CollisionObject::ADD)
+  {
+    object->primitives.emplace_back();
+    object->primitives.back().type = shape_msgs::msg::SolidPrimitive::BOX;
+    object->primitives.back().dimensions = { 0.1, 0.1, 0.1 };
+  }
+  return object;
+}
+}  // namespace
+
+TEST_F(PlanningSceneMonitorTest, CoalescedSceneUpdates)
+{
+  std::size_t moves = 0;
+  const auto observer = scene_->getWorldNonConst()->addObserver(
+      [&moves](const collision_detection::World::ObjectConstPtr& object, collision_detection::World::Action action) {
+        if (object->id_ == "box" && (action & collision_detection::World::MOVE_SHAPE))
+          ++moves;
+      });
+
+  // updates queued while the first batch is announced are applied together in the next batch
+  std::vector<UpdateType> events;
+  planning_scene_monitor_->addUpdateCallback([&](UpdateType type) {
+    events.push_back(type);
+    if (events.size() == 1)
+    {
+      using moveit_msgs::msg::CollisionObject;
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("box", "base_link", CollisionObject::MOVE, 1.0));
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("box", "base_link", CollisionObject::MOVE, 2.0));
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("other", "base_link", CollisionObject::ADD));
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("box", "base_link", CollisionObject::MOVE, 3.0));
+    }
+  });
+  planning_scene_monitor_->queueCollisionObjectUpdate(
+      makeBox("box", "base_link", moveit_msgs::msg::CollisionObject::ADD));
+  scene_->getWorldNonConst()->removeObserver(observer);
+
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[1], UpdateType::UPDATE_GEOMETRY);
+  // the three moves of the box became one, since no other update of the box lies in between
+  EXPECT_EQ(moves, 1u);
+  EXPECT_TRUE(scene_->getWorld()->hasObject("other"));
+  ASSERT_TRUE(scene_->getWorld()->hasObject("box"));
+  EXPECT_DOUBLE_EQ(scene_->getWorld()->getObject("box")->pose_.translation().x(), 3.0);
+}
+
+TEST_F(PlanningSceneMonitorTest, SceneUpdatesKeepArrivalOrder)
+{
+  // nothing is published on this topic, so the monitored state keeps its default values
+  planning_scene_monitor_->startStateMonitor("planning_scene_monitor_test/joint_states", "");
+  const moveit::core::RobotState monitored_state = *planning_scene_monitor_->getStateMonitor()->getCurrentState();
+  {
+    planning_scene_monitor::LockedPlanningSceneRW locked_scene(planning_scene_monitor_);
+    locked_scene->getCurrentStateNonConst().setVariablePosition("panda_joint1", 1.0);
+    locked_scene->getCurrentStateNonConst().update();
+  }
+  const moveit::core::RobotState scene_state = scene_->getCurrentState();
+
+  // objects are placed relative to a link, so their pose depends on the state they are applied after
+  std::vector<UpdateType> events;
+  planning_scene_monitor_->addUpdateCallback([&](UpdateType type) {
+    events.push_back(type);
+    if (events.size() == 1)
+    {
+      using moveit_msgs::msg::CollisionObject;
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("before", "panda_link7", CollisionObject::ADD));
+      planning_scene_monitor_->queueStateUpdate();
+      planning_scene_monitor_->queueStateUpdate();
+      planning_scene_monitor_->queueCollisionObjectUpdate(makeBox("after", "panda_link7", CollisionObject::ADD));
+    }
+  });
+  planning_scene_monitor_->queueCollisionObjectUpdate(
+      makeBox("first", "base_link", moveit_msgs::msg::CollisionObject::ADD));
+
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[1], UpdateType::UPDATE_STATE | UpdateType::UPDATE_GEOMETRY);
+  ASSERT_TRUE(scene_->getWorld()->hasObject("before"));
+  ASSERT_TRUE(scene_->getWorld()->hasObject("after"));
+  const Eigen::Isometry3d& before = scene_->getWorld()->getObject("before")->pose_;
+  const Eigen::Isometry3d& after = scene_->getWorld()->getObject("after")->pose_;
+  EXPECT_TRUE(before.isApprox(scene_state.getGlobalLinkTransform("panda_link7")));
+  EXPECT_TRUE(after.isApprox(monitored_state.getGlobalLinkTransform("panda_link7")));
+  EXPECT_FALSE(before.isApprox(after));
+  EXPECT_DOUBLE_EQ(scene_->getCurrentState().getVariablePosition("panda_joint1"),
+                   monitored_state.getVariablePosition("panda_joint1"));
+}
+
 int main(int argc, char** argv)
 {
   rclcpp::init(argc, argv);
@@ -0,0 +1,81 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/warehouse/moveit_message_storage.h>
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_pipeline/plan_cache.h>
+#include <moveit_msgs/msg/robot_trajectory.hpp>
+#include <rclcpp/logger.hpp>
+
+namespace moveit_warehouse
+{
+typedef warehouse_ros::MessageWithMetadata<moveit_msgs::msg::RobotTrajectory>::ConstPtr PlanCacheEntryWithMetadata;
+typedef warehouse_ros::MessageCollection<moveit_msgs::msg::RobotTrajectory>::Ptr PlanCacheCollection;
+
+MOVEIT_CLASS_FORWARD(PlanCacheStorage);  // Defines PlanCacheStoragePtr, ConstPtr, WeakPtr... etc
+
+/** \brief Persists the solutions of a planning_pipeline::PlanCache, so that they survive restarts */
+class PlanCacheStorage : public MoveItMessageStorage
+{
+public:
+  static const std::string DATABASE_NAME;
+
+  static const std::string ROBOT_NAME;
+  static const std::string GROUP_NAME;
+  static const std::string QUERY_FINGERPRINT_NAME;
+  static const std::string SCENE_FINGERPRINT_NAME;
+  static const std::string PLANNING_TIME_NAME;
+
+  PlanCacheStorage(warehouse_ros::DatabaseConnection::Ptr conn);
+
+  /** \brief Replace the solutions stored for the robot of \e cache with the solutions in \e cache */
+  void storePlanCache(const planning_pipeline::PlanCache& cache);
+
+  /** \brief Add the solutions stored for the robot of \e cache to \e cache. Return the number of added solutions. */
+  std::size_t loadPlanCache(planning_pipeline::PlanCache& cache) const;
+
+  /** \brief Remove the solutions stored for \e robot, or for all robots if \e robot is empty */
+  void removePlanCache(const std::string& robot = "");
+
+  void reset();
+
+private:
+  void createCollections();
+
+  PlanCacheCollection plan_cache_collection_;
+  rclcpp::Logger logger_;
+};
+}  // namespace moveit_warehouse
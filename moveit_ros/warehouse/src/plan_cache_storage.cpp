@@ -0,0 +1,143 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/warehouse/plan_cache_storage.h>
+#include <moveit/utils/logger.hpp>
+
+#include <string>
+#include <utility>
+
+const std::string moveit_warehouse::PlanCacheStorage::DATABASE_NAME = "moveit_plan_cache";
+
+const std::string moveit_warehouse::PlanCacheStorage::ROBOT_NAME = "robot_id";
+const std::string moveit_warehouse::PlanCacheStorage::GROUP_NAME = "group_id";
+const std::string moveit_warehouse::PlanCacheStorage::QUERY_FINGERPRINT_NAME = "query_fingerprint";
+const std::string moveit_warehouse::PlanCacheStorage::SCENE_FINGERPRINT_NAME = "scene_fingerprint";
+const std::string moveit_warehouse::PlanCacheStorage::PLANNING_TIME_NAME = "planning_time";
+
+using warehouse_ros::Metadata;
+using warehouse_ros::Query;
+
+moveit_warehouse::PlanCacheStorage::PlanCacheStorage(warehouse_ros::DatabaseConnection::Ptr conn)
+  : MoveItMessageStorage(std::move(conn)), logger_(moveit::getLogger("moveit.ros.warehouse_plan_cache_storage"))
+{
+  createCollections();
+}
+
+void moveit_warehouse::PlanCacheStorage::createCollections()
+{
+  plan_cache_collection_ = conn_->openCollectionPtr<moveit_msgs::msg::RobotTrajectory>(DATABASE_NAME, "plan_cache");
+}
+
+void moveit_warehouse::PlanCacheStorage::reset()
+{
+  plan_cache_collection_.reset();
+  conn_->dropDatabase(DATABASE_NAME);
+  createCollections();
+}
+
+void moveit_warehouse::PlanCacheStorage::storePlanCache(const planning_pipeline::PlanCache& cache)
+{
+  const std::string& robot = cache.getRobotModel()->getName();
+  removePlanCache(robot);
+
+  // Fingerprints are unsigned 64 bit values, which the metadata cannot hold as numbers
+  const std::vector<planning_pipeline::PlanCache::Entry> entries = cache.getEntries();
+  for (const planning_pipeline::PlanCache::Entry& entry : entries)
+  {
+    // Store all joints rather than those of the planning group, since the whole start state is part of the cache key
+    robot_trajectory::RobotTrajectory all_joints(entry.trajectory->getRobotModel(), nullptr);
+    all_joints.append(*entry.trajectory, 0.0);
+    moveit_msgs::msg::RobotTrajectory msg;
+    all_joints.getRobotTrajectoryMsg(msg);
+    Metadata::Ptr metadata = plan_cache_collection_->createMetadata();
+    metadata->append(ROBOT_NAME, robot);
+    metadata->append(GROUP_NAME, entry.trajectory->getGroupName());
+    metadata->append(QUERY_FINGERPRINT_NAME, std::to_string(entry.query_fingerprint));
+    metadata->append(SCENE_FINGERPRINT_NAME, std::to_string(entry.scene_fingerprint));
+    metadata->append(PLANNING_TIME_NAME, entry.planning_time);
+    plan_cache_collection_->insert(msg, metadata);
+  }
+  RCLCPP_DEBUG(logger_, "Stored %zu cached solutions for robot '%s'", entries.size(), robot.c_str());
+}
+
+std::size_t moveit_warehouse::PlanCacheStorage::loadPlanCache(planning_pipeline::PlanCache& cache) const
+{
+  const moveit::core::RobotModelConstPtr& robot_model = cache.getRobotModel();
+  Query::Ptr q = plan_cache_collection_->createQuery();
+  q->append(ROBOT_NAME, robot_model->getName());
+  std::vector<PlanCacheEntryWithMetadata> stored_entries = plan_cache_collection_->queryList(q, false);
+
+  moveit::core::RobotState reference_state(robot_model);
+  reference_state.setToDefaultValues();
+  std::size_t loaded = 0;
+  for (const PlanCacheEntryWithMetadata& stored : stored_entries)
+  {
+    const std::string group = stored->lookupString(GROUP_NAME);
+    if (!robot_model->hasJointModelGroup(group))
+    {
+      RCLCPP_WARN(logger_, "Skipping cached solution for unknown group '%s'", group.c_str());
+      continue;
+    }
+
+    planning_pipeline::PlanCache::Entry entry;
+    try
+    {
+      entry.query_fingerprint = std::stoull(stored->lookupString(QUERY_FINGERPRINT_NAME));
+      entry.scene_fingerprint = std::stoull(stored->lookupString(SCENE_FINGERPRINT_NAME));
+    }
+    catch (const std::logic_error& e)
+    {
+      RCLCPP_WARN(logger_, "Skipping cached solution with invalid fingerprint: %s", e.what());
+      continue;
+    }
+    auto trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model, group);
+    trajectory->setRobotTrajectoryMsg(reference_state, *stored);
+    entry.trajectory = trajectory;
+    entry.planning_time = stored->lookupDouble(PLANNING_TIME_NAME);
+    if (cache.insert(entry))
+      ++loaded;
+  }
+  RCLCPP_DEBUG(logger_, "Loaded %zu cached solutions for robot '%s'", loaded, robot_model->getName().c_str());
+  return loaded;
+}
+
+void moveit_warehouse::PlanCacheStorage::removePlanCache(const std::string& robot)
+{
+  Query::Ptr q = plan_cache_collection_->createQuery();
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  unsigned int rem = plan_cache_collection_->removeMessages(q);
+  RCLCPP_DEBUG(logger_, "Removed %u cached solutions", rem);
+}
@@ -0,0 +1,172 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, the MoveIt contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <moveit/warehouse/plan_cache_storage.h>
+#include <rclcpp/rclcpp.hpp>
+#include <warehouse_ros/database_loader.h>
+
+class PlanCacheStorageTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    node_ = rclcpp::Node::make_shared("plan_cache_storage_test");
+    node_->declare_parameter<std::string>("warehouse_plugin", "warehouse_ros_sqlite::DatabaseConnection");
+    db_path_ = std::filesystem::temp_directory_path() / "moveit_plan_cache_storage_test.sqlite";
+    std::filesystem::remove(db_path_);
+
+    db_loader_ = std::make_unique<warehouse_ros::DatabaseLoader>(node_);
+    conn_ = db_loader_->loadDatabase();
+    conn_->setParams(db_path_.string(), 0);
+    ASSERT_TRUE(conn_->connect());
+
+    // a planning group of two joints, and a joint outside of it
+    moveit::core::RobotModelBuilder builder("chain_robot", "base_link");
+    builder.addChain("base_link->a->b", "continuous");
+    builder.addChain("base_link->c", "continuous");
+    builder.addGroupChain("base_link", "b", "arm");
+    robot_model_ = builder.build();
+    scene_ = std::make_shared<planning_scene::PlanningScene>(robot_model_);
+
+    request_.group_name = "arm";
+    moveit_msgs::msg::JointConstraint goal;
+    goal.joint_name = "a-b-joint";
+    goal.position = 1.0;
+    goal.tolerance_above = goal.tolerance_below = 0.01;
+    goal.weight = 1.0;
+    request_.goal_constraints.resize(1);
+    request_.goal_constraints[0].joint_constraints.push_back(goal);
+    request_.start_state.joint_state.name = { "base_link-c-joint" };
+    request_.start_state.joint_state.position = { 0.5 };
+  }
+
+  void TearDown() override
+  {
+    conn_.reset();
+    std::filesystem::remove(db_path_);
+  }
+
+  // Add a solution of request_ from its start state to the goal
+  void insertSolution(planning_pipeline::PlanCache& cache)
+  {
+    const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup("arm");
+    moveit::core::RobotState state = *scene_->getCurrentStateUpdated(request_.start_state);
+    planning_interface::MotionPlanResponse response;
+    response.trajectory = std::make_shared<robot_trajectory::RobotTrajectory>(robot_model_, jmg);
+    response.trajectory->addSuffixWayPoint(state, 0.0);
+    state.setJointGroupPositions(jmg, std::vector<double>{ 0.0, 1.0 });
+    response.trajectory->addSuffixWayPoint(state, 1.0);
+    response.error_code = moveit::core::MoveItErrorCode::SUCCESS;
+    response.planning_time = 0.25;
+    ASSERT_TRUE(cache.insert(scene_, request_, response));
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  std::filesystem::path db_path_;
+  std::unique_ptr<warehouse_ros::DatabaseLoader> db_loader_;
+  warehouse_ros::DatabaseConnection::Ptr conn_;
+  moveit::core::RobotModelPtr robot_model_;
+  planning_scene::PlanningScenePtr scene_;
+  planning_interface::MotionPlanRequest request_;
+};
+
+TEST_F(PlanCacheStorageTest, StoreAndLoad)
+{
+  // GIVEN a cache with a solution from a start state with a joint outside of the planning group moved
+  planning_pipeline::PlanCache cache(robot_model_);
+  insertSolution(cache);
+  moveit_warehouse::PlanCacheStorage storage(conn_);
+
+  // WHEN the cache is stored and loaded into an empty cache
+  storage.storePlanCache(cache);
+  planning_pipeline::PlanCache restored(robot_model_);
+  ASSERT_EQ(storage.loadPlanCache(restored), 1u);
+
+  // THEN the restored solution equals the stored one, including the start state outside of the planning group
+  const planning_pipeline::PlanCache::Entry stored_entry = cache.getEntries().front();
+  const planning_pipeline::PlanCache::Entry restored_entry = restored.getEntries().front();
+  EXPECT_EQ(restored_entry.query_fingerprint, stored_entry.query_fingerprint);
+  EXPECT_EQ(restored_entry.scene_fingerprint, stored_entry.scene_fingerprint);
+  EXPECT_DOUBLE_EQ(restored_entry.planning_time, 0.25);
+  EXPECT_EQ(restored_entry.trajectory->getGroupName(), "arm");
+  ASSERT_EQ(restored_entry.trajectory->getWayPointCount(), 2u);
+  EXPECT_DOUBLE_EQ(restored_entry.trajectory->getFirstWayPoint().getVariablePosition("base_link-c-joint"), 0.5);
+  EXPECT_DOUBLE_EQ(restored_entry.trajectory->getLastWayPoint().getVariablePosition("a-b-joint"), 1.0);
+
+  // THEN the restored solution is found for the same query
+  planning_interface::MotionPlanResponse response;
+  EXPECT_TRUE(restored.lookup(scene_, request_, response));
+}
+
+TEST_F(PlanCacheStorageTest, StoreReplacesAndRemove)
+{
+  planning_pipeline::PlanCache cache(robot_model_);
+  insertSolution(cache);
+  moveit_warehouse::PlanCacheStorage storage(conn_);
+
+  // WHEN the cache is stored twice
+  // THEN the second store replaces the solutions of the first
+  storage.storePlanCache(cache);
+  storage.storePlanCache(cache);
+  planning_pipeline::PlanCache restored(robot_model_);
+  EXPECT_EQ(storage.loadPlanCache(restored), 1u);
+
+  // WHEN the solutions of another robot are removed
+  // THEN the solutions of this robot are kept
+  storage.removePlanCache("other_robot");
+  restored.clear();
+  EXPECT_EQ(storage.loadPlanCache(restored), 1u);
+
+  // WHEN the solutions of this robot are removed
+  // THEN nothing is loaded
+  storage.removePlanCache(robot_model_->getName());
+  restored.clear();
+  EXPECT_EQ(storage.loadPlanCache(restored), 0u);
+  EXPECT_EQ(restored.size(), 0u);
+}
+
+int main(int argc, char** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}